@@ -346,6 +346,12 @@ class JumpParser:
         Requires compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER=1
         """
 
+    @staticmethod
+    def get_profiler_trace_json() -> str:
+        """
+        Returns profiler timings as Chrome trace event JSON. Requires compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER=1
+        """
+
     def has_error(self: JumpParser) -> bool: ...
 
     def next(self: JumpParser) -> bool: ...
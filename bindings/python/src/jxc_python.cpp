@@ -583,6 +583,11 @@ PYBIND11_MODULE(_pyjxc, m)
         .def_static("get_profiler_results", &JumpParser::get_profiler_results,
             py::arg("sort_by_runtime") = true,
             py::doc("Requires compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER=1"))
+        .def_static("set_profiler_trace_enabled", &JumpParser::set_profiler_trace_enabled, py::arg("enabled"),
+            py::doc("Enables recording trace events for get_profiler_trace_json. Requires compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER=1"))
+        .def_static("is_profiler_trace_enabled", &JumpParser::is_profiler_trace_enabled)
+        .def_static("get_profiler_trace_json", &JumpParser::get_profiler_trace_json,
+            py::doc("Returns profiler timings as Chrome trace event JSON. Requires set_profiler_trace_enabled(True) and compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER=1"))
     ;
 
     m.def("split_number_token_value", [](const Token& number_token) -> py::object
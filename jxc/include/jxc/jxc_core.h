@@ -41,6 +41,10 @@
 #define JXC_ENABLE_JUMP_BLOCK_PROFILER 0
 #endif
 
+#if !defined(JXC_ENABLE_SIMD)
+#define JXC_ENABLE_SIMD 1
+#endif
+
 #ifndef JXC_DEBUG
 #define JXC_DEBUG 1
 #endif
@@ -160,6 +164,36 @@ JXC_FORCEINLINE int32_t _jxc_internal_msvc_count_leading_zeros(uint32_t value)
 #endif
 #endif
 
+#if !defined(JXC_COUNT_TRAILING_ZEROS_U32)
+#if defined(__GNUC__) || defined(__clang__)
+#define JXC_COUNT_TRAILING_ZEROS_U32(VAL) __builtin_ctz(VAL)
+#elif JXC_CPP20
+#define JXC_COUNT_TRAILING_ZEROS_U32(VAL) std::countr_zero<uint32_t>(VAL)
+#elif defined(_MSC_VER)
+JXC_FORCEINLINE int32_t _jxc_internal_msvc_count_trailing_zeros(uint32_t value)
+{
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (int32_t)index;
+}
+#define JXC_COUNT_TRAILING_ZEROS_U32(VAL) _jxc_internal_msvc_count_trailing_zeros(VAL)
+#else
+#error JXC_COUNT_TRAILING_ZEROS_U32 not implemented for this compiler or platform
+#endif
+#endif
+
+#if !defined(JXC_POPCOUNT_U32)
+#if defined(__GNUC__) || defined(__clang__)
+#define JXC_POPCOUNT_U32(VAL) __builtin_popcount(VAL)
+#elif JXC_CPP20
+#define JXC_POPCOUNT_U32(VAL) std::popcount<uint32_t>(VAL)
+#elif defined(_MSC_VER)
+#define JXC_POPCOUNT_U32(VAL) __popcnt(VAL)
+#else
+#error JXC_POPCOUNT_U32 not implemented for this compiler or platform
+#endif
+#endif
+
 // fallbacks - make sure these macros are always defined
 #if !defined(JXC_ASSERT)
 #define JXC_ASSERT(COND)
@@ -1,6 +1,7 @@
 #pragma once
 #include "jxc/jxc_core.h"
 #include "jxc/jxc_util.h"
+#include <vector>
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -58,6 +59,7 @@ struct JXC_EXPORT Lexer
     }
 
 private:
+    bool scan_linebreak();
     bool scan_comment(size_t comment_token_len, std::string_view& out_comment);
     bool scan_hex_escape(std::string& out_error_message);
     bool scan_utf16_escape(std::string& out_error_message);
@@ -160,5 +162,62 @@ public:
 };
 
 
+// Stage-1 structural index for a JXC buffer.
+// A single vectorized pass over the buffer that records the offsets of all structural characters
+// (`{}[]():,` and line breaks) outside of strings and comments, along with the bounds of each string and comment.
+// JumpParser can use this to skip over values without lexing them, and it can be used to split a buffer into
+// top-level values without parsing it.
+//
+// The tape contains buffer offsets in ascending order. Offsets with `region_flag` set mark the start of a quoted string
+// (without escape chars) or a comment, and are always immediately followed by the offset of the region's end
+// (the closing quote char for strings, the line break or end of buffer for comments).
+// Strings with prefixes or escapes are skipped over but not marked, and are left to the lexer.
+//
+// If the pass hits something the lexer would report as an error (eg. an unterminated string), the tape stops at that point
+// and `is_complete()` returns false. That's not an error - the parser falls back to the lexer for the rest of the buffer.
+//
+// Stage 2 (reading tokens from the tape instead of lexing them) is not implemented. JumpParser only uses the tape in
+// skip_value(), and next() always lexes. The per-file structural index benchmark in jxc_benchmark compares the cost of
+// stage 1 against plain JumpParser.
+class JXC_EXPORT StructuralIndex
+{
+public:
+    static constexpr uint32_t region_flag = 0x80000000u;
+    static constexpr uint32_t offset_mask = ~region_flag;
+    static constexpr size_t max_buffer_size = static_cast<size_t>(offset_mask);
+
+private:
+    std::string_view buffer;
+    std::vector<uint32_t> tape;
+    bool complete = false;
+
+public:
+    StructuralIndex() = default;
+
+    explicit StructuralIndex(std::string_view buf)
+    {
+        build(buf);
+    }
+
+    // Builds the index for the given buffer. Returns false if the buffer is larger than max_buffer_size.
+    bool build(std::string_view buf);
+
+    void clear()
+    {
+        buffer = std::string_view{};
+        tape.clear();
+        complete = false;
+    }
+
+    inline std::string_view get_buffer() const { return buffer; }
+    inline const uint32_t* data() const { return tape.data(); }
+    inline size_t size() const { return tape.size(); }
+    inline bool is_complete() const { return complete; }
+
+    static inline uint32_t entry_offset(uint32_t entry) { return entry & offset_mask; }
+    static inline bool entry_is_region_start(uint32_t entry) { return (entry & region_flag) != 0; }
+};
+
+
 JXC_END_NAMESPACE(jxc)
 
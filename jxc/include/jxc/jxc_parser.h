@@ -1,7 +1,11 @@
 #pragma once
+#include <array>
 #include <string_view>
+#include <unordered_set>
 #include <charconv>
 #include <cmath>
+#include <cstdio>
+#include <iosfwd>
 #include "jxc/jxc_util.h"
 #include "jxc/jxc_stack_vector.h"
 #include "jxc/jxc_lexer.h"
@@ -272,8 +276,52 @@ using Element = TElement<TokenView>;
 using OwnedElement = TElement<TokenList>;
 
 
+// Optional statistics about a parsed document, for profiling and for sizing buffers ahead of time.
+// Pass one to JumpParser::set_stats() (or set detail::ValueParser::stats) to fill it in while parsing.
+// Stats accumulate across every parser they're attached to until reset() is called.
+struct JXC_EXPORT ParseStats
+{
+    static constexpr size_t num_element_types = static_cast<size_t>(ElementType::EndObject) + 1;
+
+    // number of elements of each ElementType
+    std::array<size_t, num_element_types> element_counts = {};
+
+    // deepest container nesting seen (a top-level array counts as depth 1)
+    size_t max_depth = 0;
+
+    // total length of string values and string object keys, excluding quotes and delimiters
+    size_t string_bytes = 0;
+
+    // string values and string object keys that contain at least one escape sequence
+    size_t num_strings_with_escapes = 0;
+
+    size_t num_annotations = 0;
+    std::unordered_set<uint64_t> annotation_hashes;
+
+    // number values and number object keys with a suffix, eg. `10_px`
+    size_t num_number_suffixes = 0;
+
+    // Heap allocations owned by Values built from the document (filled in by detail::ValueParser).
+    // This counts the allocations each Value holds once parsing is done, not temporary ones made while containers grow.
+    size_t value_heap_allocations = 0;
+    size_t value_heap_bytes = 0;
+
+    inline size_t get_element_count(ElementType type) const { return element_counts[static_cast<size_t>(type)]; }
+    inline size_t get_num_unique_annotations() const { return annotation_hashes.size(); }
+
+    void reset();
+
+    // Adds another set of stats to this one, eg. to combine stats from parsers on several threads
+    void merge(const ParseStats& rhs);
+
+    std::string to_string() const;
+};
+
+
 class JXC_EXPORT JumpParser
 {
+    friend class PushParser;
+
 protected:
     enum JumpState : uint8_t
     {
@@ -317,11 +365,21 @@ private:
     Token tok;
     Element current_value;
 
+    // optional stage-1 index (see StructuralIndex) used for skipping values, and the tape entry the last skip stopped at
+    const StructuralIndex* structural_index = nullptr;
+    size_t tape_idx = 0;
+
     detail::StackVector<Token, 32> annotation_buffer;
     detail::StackVector<JumpStackVars, 96> jump_stack;
 
     JumpStackVars* jump_vars = nullptr;
 
+    ParseStats* stats = nullptr;
+
+    void record_element_stats();
+
+    bool next_internal();
+
     inline std::string_view get_annotation_buffer_source_view() const
     {
         if (annotation_buffer.size() > 0)
@@ -358,17 +416,22 @@ private:
         }
     }
 
-    JXC_FORCEINLINE bool lexer_advance()
+    JXC_FORCEINLINE bool next_token()
     {
         return lexer.next(tok, error);
     }
 
+    JXC_FORCEINLINE bool lexer_advance()
+    {
+        return next_token();
+    }
+
     JXC_FORCEINLINE bool lexer_advance_skip_comments()
     {
-        if (!lexer.next(tok, error)) { return false; }
+        if (!next_token()) { return false; }
         while (tok.type == TokenType::Comment)
         {
-            if (!lexer.next(tok, error)) { return false; }
+            if (!next_token()) { return false; }
         }
         return true;
     }
@@ -377,13 +440,19 @@ private:
     {
         while (tok.type == TokenType::LineBreak || tok.type == TokenType::Comment)
         {
-            if (!lexer.next(tok, error)) { return false; }
+            if (!next_token()) { return false; }
         }
         return true;
     }
 
     bool lexer_advance_separator(TokenType container_close_type, const char* cur_jump_block_name);
 
+    // consumes tokens up to and including the close bracket of the innermost container, without yielding anything
+    bool skip_to_container_close();
+
+    // same as skip_to_container_close, but walks the structural index tape instead of lexing
+    bool tape_skip_to_container_close();
+
 public:
     JumpParser() = default;
 
@@ -393,6 +462,17 @@ public:
     {
     }
 
+    // Uses a prebuilt StructuralIndex for the same buffer so that skip_value() can jump over values without lexing them.
+    // Values that aren't skipped are still lexed as usual. The index must outlive the parser.
+    JumpParser(std::string_view buffer, const StructuralIndex& index)
+        : buffer(buffer)
+        , lexer(buffer.data(), buffer.size())
+        , structural_index(&index)
+    {
+        JXC_ASSERTF(index.get_buffer().data() == buffer.data() && index.get_buffer().size() == buffer.size(),
+            "StructuralIndex was built for a different buffer");
+    }
+
     void reset(std::string_view new_buffer)
     {
         buffer = new_buffer;
@@ -400,9 +480,49 @@ public:
         error = ErrorInfo{};
         annotation_buffer.clear();
         jump_stack.clear();
+        structural_index = nullptr;
+        tape_idx = 0;
     }
 
-    bool next();
+    void reset(std::string_view new_buffer, const StructuralIndex& index)
+    {
+        reset(new_buffer);
+        JXC_ASSERTF(index.get_buffer().data() == buffer.data() && index.get_buffer().size() == buffer.size(),
+            "StructuralIndex was built for a different buffer");
+        structural_index = &index;
+    }
+
+    // Optional up-front check that the whole buffer is valid UTF-8, using a single vectorized pass (see util::validate_utf8).
+    // Call before the first next(). If the buffer is invalid, the error points at the first invalid byte and next() returns false.
+    bool validate_utf8();
+
+    inline bool next()
+    {
+        if (!next_internal())
+        {
+            return false;
+        }
+        if (stats != nullptr)
+        {
+            record_element_stats();
+        }
+        return true;
+    }
+
+    // Optional statistics collection (see ParseStats). Elements skipped with skip_value() are not counted.
+    // The stats object must outlive the parser, or be unset with set_stats(nullptr).
+    inline void set_stats(ParseStats* new_stats) { stats = new_stats; }
+    inline ParseStats* get_stats() const { return stats; }
+
+    // Skips over the current value without yielding any elements for it.
+    // If the current element is BeginArray, BeginObject, or BeginExpression, this skips to the matching close bracket and value()
+    // becomes the matching End element, as if next() had just returned it. If the current element is an ObjectKey, the value
+    // for that key is skipped instead. Does nothing for any other element.
+    // Skipped values are only lexed and bracket-matched, so they may contain errors that next() would have reported.
+    bool skip_value();
+
+    // Skips the rest of the innermost array, object, or expression. value() becomes that container's End element.
+    bool skip_to_end_of_container();
 
     const Element& value() const { return current_value; }
 
@@ -412,11 +532,168 @@ public:
 
     inline size_t stack_depth() const { return jump_stack.size(); }
 
+    // True if the current element completes a top-level value (a top-level scalar, or the End element of a top-level container).
+    // next() keeps parsing top-level values after the first one, so this marks the boundaries in a buffer holding more than one document.
+    inline bool is_document_end() const { return jump_stack.size() == 0 && !error.is_err && current_value.type != ElementType::Invalid; }
+
     inline const ErrorInfo& get_error() const { return error; }
 
     // profiler requires compilation with JXC_ENABLE_JUMP_BLOCK_PROFILER set to 1
+    // Each thread records its timings into its own buffer, so parsers on multiple threads can be profiled at once.
+    // Results are aggregated across all threads when requested. When a thread exits, its timings are folded into a
+    // shared total and its trace events are discarded.
     static void reset_profiler();
+
+    // Returns a table with the total runtime of each jump block, summed over all threads
     static std::string get_profiler_results(bool sort_by_runtime = true);
+
+    // Trace capture is off by default. When enabled, each thread records every timed block (up to a fixed limit) for
+    // get_profiler_trace_json, and allocates its whole trace buffer the first time it records. Takes effect at the start
+    // of each thread's next outermost timed block. Events already recorded are kept until reset_profiler().
+    static void set_profiler_trace_enabled(bool enabled);
+    static bool is_profiler_trace_enabled();
+
+    // Returns every timed block as Chrome trace event JSON (for chrome://tracing or Perfetto), with one track per running thread.
+    // Has no events unless set_profiler_trace_enabled(true) was called before parsing.
+    static std::string get_profiler_trace_json();
+};
+
+
+// Push-style parser for input that arrives in chunks, eg. from a socket.
+// Call feed() as each chunk arrives, then call next() until it returns false to read every element that is complete so far.
+// Call finish() after the last chunk to parse whatever is left.
+//
+// Only the unconsumed tail of the input is buffered - once an element has been read, the bytes before it are dropped on the next feed().
+// When the buffered input ends partway through an element (including partway through a token, such as a string or raw string),
+// next() returns false without an error and needs_more_data() returns true. The parser then picks up from the start of that element
+// once more input arrives, so tokens that cross chunk boundaries are only ever copied into the tail buffer.
+//
+// Token offsets and error offsets are relative to get_buffer(). Add get_buffer_stream_offset() to get offsets from the start of the stream.
+class JXC_EXPORT PushParser
+{
+    // Parser state from before the last call to next(). A single call to next() pushes or pops at most one stack entry,
+    // so the stack can be restored from its previous depth and top entry without copying the whole thing.
+    struct Checkpoint
+    {
+        Lexer lexer;
+        size_t stack_depth = 0;
+        JumpParser::JumpStackVars stack_top = JumpParser::JumpStackVars::make();
+    };
+
+    std::string data;
+    size_t stream_offset = 0;
+    JumpParser parser;
+    Checkpoint checkpoint;
+    bool finished = false;
+    bool waiting_for_data = false;
+
+    void rebase_parser(size_t num_bytes_dropped);
+    bool lexer_stopped_before_end() const;
+    bool error_in_unterminated_string() const;
+
+public:
+    PushParser()
+        : parser(std::string_view{ data.data(), 0 })
+    {
+    }
+
+    PushParser(const PushParser&) = delete;
+    PushParser& operator=(const PushParser&) = delete;
+
+    // Appends a chunk of input. Invalidates value().
+    void feed(std::string_view chunk);
+
+    // Marks the end of the input. After this, next() parses to the end of the buffer the same way JumpParser does.
+    void finish();
+
+    // Discards all buffered input and parser state so the parser can be used for a new stream
+    void reset();
+
+    // Reads the next complete element. Returns false if the buffered input ends before the next element is complete,
+    // at the end of the stream, or on a parse error.
+    bool next();
+
+    // Returns true if the last call to next() returned false because it needs more input
+    inline bool needs_more_data() const { return waiting_for_data; }
+
+    inline bool is_finished() const { return finished; }
+
+    const Element& value() const { return parser.value(); }
+
+    // The buffered input. Token and error offsets are relative to this buffer.
+    inline std::string_view get_buffer() const { return std::string_view{ data.data(), data.size() }; }
+
+    // Offset of get_buffer() from the start of the stream
+    inline size_t get_buffer_stream_offset() const { return stream_offset; }
+
+    // Number of buffered bytes that next() hasn't finished reading yet
+    inline size_t num_pending_bytes() const { return data.size() - static_cast<size_t>(parser.lexer.current - parser.lexer.start); }
+
+    inline size_t stack_depth() const { return parser.stack_depth(); }
+
+    inline bool has_error() const { return parser.has_error(); }
+
+    inline const ErrorInfo& get_error() const { return parser.get_error(); }
+};
+
+
+// Parses a JXC stream from a FILE*, std::istream, file descriptor, or any other source that can be read in pieces,
+// using a fixed-size read window so that large files can be parsed without loading them into memory first.
+// Input is read window_size bytes at a time as next() needs it (see PushParser), so memory use stays at roughly the
+// window size plus the size of the largest element. If a single element needs more than max_buffer_size bytes, parsing stops with an error.
+// Element values are valid until the next call to next().
+//
+// The lexer is built with `re2c:yyfill:enable = 0`, and its string, comment, and whitespace scanners treat the end of the buffer
+// as the end of the input, so it can't ask for more input partway through a token. Instead, an element that runs past the end
+// of the window is lexed again from its start once more input has been read. To keep that linear for elements that span many
+// windows, each retry reads at least as much input as is already pending.
+class JXC_EXPORT StreamParser
+{
+public:
+    // Reads up to `size` bytes into `out_buffer`. Returns the number of bytes read, 0 at the end of the stream, or -1 if reading failed.
+    using ReadFunc = std::function<int64_t(char* out_buffer, size_t size)>;
+
+    static constexpr size_t default_window_size = 64 * 1024;
+    static constexpr size_t default_max_buffer_size = 64 * 1024 * 1024;
+
+private:
+    ReadFunc read_func;
+    PushParser push_parser;
+    std::string read_buffer;
+    size_t max_buffer_size = default_max_buffer_size;
+    ErrorInfo read_error;
+
+    bool read_next_chunk();
+
+public:
+    explicit StreamParser(ReadFunc read_func, size_t window_size = default_window_size, size_t max_buffer_size = default_max_buffer_size);
+
+    // Reads from a FILE* opened in binary mode. The file must stay open while parsing.
+    explicit StreamParser(FILE* fp, size_t window_size = default_window_size, size_t max_buffer_size = default_max_buffer_size);
+
+    // Reads from a std::istream. The stream must outlive the parser.
+    explicit StreamParser(std::istream& stream, size_t window_size = default_window_size, size_t max_buffer_size = default_max_buffer_size);
+
+    // Makes a ReadFunc that reads from a file descriptor (using `read()`, or `_read()` on Windows)
+    static ReadFunc make_fd_reader(int fd);
+
+    bool next();
+
+    const Element& value() const { return push_parser.value(); }
+
+    inline size_t stack_depth() const { return push_parser.stack_depth(); }
+
+    inline size_t get_window_size() const { return read_buffer.size(); }
+
+    // The buffered input. Token and error offsets are relative to this buffer.
+    inline std::string_view get_buffer() const { return push_parser.get_buffer(); }
+
+    // Offset of get_buffer() from the start of the stream
+    inline size_t get_buffer_stream_offset() const { return push_parser.get_buffer_stream_offset(); }
+
+    inline bool has_error() const { return read_error.is_err || push_parser.has_error(); }
+
+    inline const ErrorInfo& get_error() const { return read_error.is_err ? read_error : push_parser.get_error(); }
 };
 
 
@@ -606,6 +883,208 @@ constexpr bool unsigned_integer_value_fits_in_type(uint64_t value)
     return false;
 }
 
+// Loads 8 chars into an integer so that the first char is in the lowest byte, regardless of platform endianness
+// (compilers turn this into a single load on little-endian platforms).
+JXC_FORCEINLINE uint64_t load_u64_le(const char* ptr)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr);
+    return static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[1]) << 8) | (static_cast<uint64_t>(p[2]) << 16) | (static_cast<uint64_t>(p[3]) << 24)
+        | (static_cast<uint64_t>(p[4]) << 32) | (static_cast<uint64_t>(p[5]) << 40) | (static_cast<uint64_t>(p[6]) << 48) | (static_cast<uint64_t>(p[7]) << 56);
+}
+
+JXC_FORCEINLINE uint32_t load_u32_le(const char* ptr)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr);
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// SWAR digit checks - every byte must be in the range '0'..'9'
+JXC_FORCEINLINE bool is_eight_decimal_digits(uint64_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ull) | (((chunk + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull;
+}
+
+JXC_FORCEINLINE bool is_four_decimal_digits(uint32_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0u) | (((chunk + 0x06060606u) & 0xF0F0F0F0u) >> 4)) == 0x33333333u;
+}
+
+// SWAR conversion of 8 (or 4) decimal digit chars to an integer, combining pairs of digits, then pairs of pairs, and so on
+JXC_FORCEINLINE uint32_t parse_eight_decimal_digits(uint64_t chunk)
+{
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+    return static_cast<uint32_t>(((chunk & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32);
+}
+
+JXC_FORCEINLINE uint32_t parse_four_decimal_digits(uint32_t chunk)
+{
+    chunk = ((chunk & 0x0F0F0F0Fu) * 2561) >> 8;
+    return ((chunk & 0x00FF00FFu) * 6553601) >> 16;
+}
+
+// SWAR conversion of 8 digit values (one per byte, most significant first) in base 2^BitsPerDigit to an integer
+template<uint32_t BitsPerDigit>
+JXC_FORCEINLINE uint32_t combine_eight_radix_digits(uint64_t digits)
+{
+    static_assert(BitsPerDigit >= 1 && BitsPerDigit <= 4);
+    digits = ((digits & 0x00FF00FF00FF00FFull) << BitsPerDigit) | ((digits >> 8) & 0x00FF00FF00FF00FFull);
+    digits = ((digits & 0x0000FFFF0000FFFFull) << (2 * BitsPerDigit)) | ((digits >> 16) & 0x0000FFFF0000FFFFull);
+    return static_cast<uint32_t>(((digits & 0x00000000FFFFFFFFull) << (4 * BitsPerDigit)) | (digits >> 32));
+}
+
+// Converts a string of decimal digits to an unsigned 64-bit integer, 8 digits at a time.
+// Returns false if any char is not a decimal digit, or if the value doesn't fit (in which case out_overflow is set).
+inline bool decimal_digits_to_u64(std::string_view digits, uint64_t& out_value, bool& out_overflow)
+{
+    const char* ptr = digits.data();
+    const char* end = ptr + digits.size();
+    while (ptr < end && *ptr == '0')
+    {
+        ++ptr;
+    }
+
+    // max value for uint64 is 20 digits long
+    if (end - ptr > 20)
+    {
+        out_overflow = true;
+        return false;
+    }
+
+    // Only 20 digit values can overflow. Any 19 digit value fits, so the overflow check is only needed for the last digit.
+    const char* unchecked_end = (end - ptr == 20) ? end - 1 : end;
+
+    uint64_t result = 0;
+    while (unchecked_end - ptr >= 8)
+    {
+        const uint64_t chunk = load_u64_le(ptr);
+        if (!is_eight_decimal_digits(chunk))
+        {
+            return false;
+        }
+        result = result * 100000000ull + parse_eight_decimal_digits(chunk);
+        ptr += 8;
+    }
+
+    if (unchecked_end - ptr >= 4)
+    {
+        const uint32_t chunk = load_u32_le(ptr);
+        if (!is_four_decimal_digits(chunk))
+        {
+            return false;
+        }
+        result = result * 10000ull + parse_four_decimal_digits(chunk);
+        ptr += 4;
+    }
+
+    for (; ptr < end; ++ptr)
+    {
+        if (!util::is_decimal_digit(*ptr))
+        {
+            return false;
+        }
+
+        const uint64_t digit = static_cast<uint64_t>(*ptr - '0');
+        if (ptr >= unchecked_end && result > (UINT64_MAX - digit) / 10)
+        {
+            out_overflow = true;
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+
+    out_value = result;
+    return true;
+}
+
+// Converts a string of hex, octal, or binary digits (BitsPerDigit = 4, 3, or 1) to an unsigned 64-bit integer, 8 digits at a time.
+// Digits are assumed to be valid for the base (the lexer guarantees this for number tokens).
+// Returns false if the value doesn't fit (in which case out_overflow is set).
+template<uint32_t BitsPerDigit>
+inline bool radix_digits_to_u64(std::string_view digits, uint64_t& out_value, bool& out_overflow)
+{
+    static_assert(BitsPerDigit == 1 || BitsPerDigit == 3 || BitsPerDigit == 4);
+    constexpr uint64_t digit_mask = (BitsPerDigit == 4) ? 0x0F0F0F0F0F0F0F0Full : ((BitsPerDigit == 3) ? 0x0707070707070707ull : 0x0101010101010101ull);
+
+    const char* ptr = digits.data();
+    const char* end = ptr + digits.size();
+    while (ptr < end && *ptr == '0')
+    {
+        ++ptr;
+    }
+
+    uint64_t result = 0;
+    while (end - ptr >= 8)
+    {
+        uint64_t chunk = load_u64_le(ptr);
+        if constexpr (BitsPerDigit == 4)
+        {
+            // 'a'-'f' and 'A'-'F' have bit 6 set, and their low nibble is 9 less than their value
+            chunk = (chunk & digit_mask) + ((chunk & 0x4040404040404040ull) >> 6) * 9;
+        }
+        else
+        {
+            chunk &= digit_mask;
+        }
+
+        if ((result >> (64 - 8 * BitsPerDigit)) != 0)
+        {
+            out_overflow = true;
+            return false;
+        }
+        result = (result << (8 * BitsPerDigit)) | combine_eight_radix_digits<BitsPerDigit>(chunk);
+        ptr += 8;
+    }
+
+    for (; ptr < end; ++ptr)
+    {
+        if ((result >> (64 - BitsPerDigit)) != 0)
+        {
+            out_overflow = true;
+            return false;
+        }
+        result = (result << BitsPerDigit) | static_cast<uint64_t>(hex_char_to_byte_table[static_cast<uint8_t>(*ptr)]);
+    }
+
+    out_value = result;
+    return true;
+}
+
+// Converts an integer's absolute value to type T, applying the sign.
+// Returns false if the value is out of range for T (including any negative non-zero value for unsigned types).
+template<typename T>
+inline bool magnitude_to_number(uint64_t magnitude, char sign_char, T& out_result)
+{
+    static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>);
+    const bool negative = sign_char == '-';
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        out_result = negative ? -static_cast<T>(magnitude) : static_cast<T>(magnitude);
+        return true;
+    }
+    else if constexpr (std::is_unsigned_v<T>)
+    {
+        if ((negative && magnitude != 0) || magnitude > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+        {
+            return false;
+        }
+        out_result = static_cast<T>(magnitude);
+        return true;
+    }
+    else
+    {
+        const uint64_t max_magnitude = static_cast<uint64_t>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+        if (magnitude > max_magnitude)
+        {
+            return false;
+        }
+
+        // written this way to avoid overflow when magnitude is abs(min value)
+        out_result = (negative && magnitude > 0) ? static_cast<T>(-static_cast<int64_t>(magnitude - 1) - 1) : static_cast<T>(magnitude);
+        return true;
+    }
+}
+
 JXC_END_NAMESPACE(detail)
 
 
@@ -750,10 +1229,11 @@ inline bool string_to_number_decimal(char sign_char, std::string_view value, T&
     }
     else if constexpr (std::is_integral_v<T>)
     {
-        // max value for uint64 is 20 digits long, so if we have more than that, we can't store it in any standard integer type
-        if (value.size() > 20)
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        if (!detail::decimal_digits_to_u64(value, magnitude, overflow))
         {
-            if (out_overflow != nullptr)
+            if (overflow && out_overflow != nullptr)
             {
                 *out_overflow = true;
             }
@@ -761,32 +1241,7 @@ inline bool string_to_number_decimal(char sign_char, std::string_view value, T&
             return false;
         }
 
-        // check for invalid digits
-        for (size_t i = 0; i < value.size(); i++)
-        {
-            if (!is_decimal_digit(value[i]))
-            {
-                out_result = 0;
-                return false;
-            }
-        }
-
-        // if the value is signed and negative, check if it's greater than or equal to the minimum value for this int type
-        if constexpr (std::is_signed_v<T>)
-        {
-            if (sign_char == '-' && !detail::value_gte_int_min<T>(value))
-            {
-                if (out_overflow != nullptr)
-                {
-                    *out_overflow = true;
-                }
-                out_result = 0;
-                return false;
-            }
-        }
-
-        // check if the value is less than or equal to the maximum value for this int type
-        if (sign_char == '+' && !detail::value_lte_int_max<T>(value))
+        if (!detail::magnitude_to_number<T>(magnitude, sign_char, out_result))
         {
             if (out_overflow != nullptr)
             {
@@ -795,26 +1250,6 @@ inline bool string_to_number_decimal(char sign_char, std::string_view value, T&
             out_result = 0;
             return false;
         }
-
-        if constexpr (std::is_unsigned_v<T>)
-        {
-            out_result = static_cast<T>(strtoull(value.data(), nullptr, 10));
-        }
-        else
-        {
-            out_result = static_cast<T>(strtoll(value.data(), nullptr, 10)) * detail::sign_char_to_multiplier<T>(sign_char);
-
-            // edge case - if the value is exactly INT64_MIN, then we actually end up with INT64_MIN+1,
-            // because we can't represent abs(INT64_MIN) before factoring in the multiplier.
-            if constexpr (std::is_same_v<T, int64_t>)
-            {
-                if (sign_char == '-' && out_result == (INT64_MIN + 1) && value == "9223372036854775808")
-                {
-                    out_result = INT64_MIN;
-                }
-            }
-        }
-
         return true;
     }
 
@@ -824,7 +1259,7 @@ inline bool string_to_number_decimal(char sign_char, std::string_view value, T&
 
 
 template<typename T>
-inline bool string_to_number_hex(char sign_char, std::string_view value, T& out_result)
+inline bool string_to_number_hex(char sign_char, std::string_view value, T& out_result, bool* out_overflow = nullptr)
 {
     static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>, "string_to_number_hex requires a numeric type");
     if (value.size() == 0)
@@ -842,20 +1277,23 @@ inline bool string_to_number_hex(char sign_char, std::string_view value, T& out_
     }
 #endif
 
-    if constexpr (std::is_unsigned_v<T>)
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    if (!detail::radix_digits_to_u64<4>(value, magnitude, overflow) || !detail::magnitude_to_number<T>(magnitude, sign_char, out_result))
     {
-        out_result = static_cast<T>(strtoull(value.data(), nullptr, 16)) * detail::sign_char_to_multiplier<T>(sign_char);
-    }
-    else
-    {
-        out_result = static_cast<T>(strtoll(value.data(), nullptr, 16)) * detail::sign_char_to_multiplier<T>(sign_char);
+        if (out_overflow != nullptr)
+        {
+            *out_overflow = true;
+        }
+        out_result = 0;
+        return false;
     }
     return true;
 }
 
 
 template<typename T>
-inline bool string_to_number_octal(char sign_char, std::string_view value, T& out_result)
+inline bool string_to_number_octal(char sign_char, std::string_view value, T& out_result, bool* out_overflow = nullptr)
 {
     static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>, "string_to_number_octal requires a numeric type");
     if (value.size() == 0)
@@ -873,20 +1311,23 @@ inline bool string_to_number_octal(char sign_char, std::string_view value, T& ou
     }
 #endif
 
-    if constexpr (std::is_unsigned_v<T>)
-    {
-        out_result = static_cast<T>(strtoull(value.data(), nullptr, 8)) * detail::sign_char_to_multiplier<T>(sign_char);
-    }
-    else
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    if (!detail::radix_digits_to_u64<3>(value, magnitude, overflow) || !detail::magnitude_to_number<T>(magnitude, sign_char, out_result))
     {
-        out_result = static_cast<T>(strtoll(value.data(), nullptr, 8)) * detail::sign_char_to_multiplier<T>(sign_char);
+        if (out_overflow != nullptr)
+        {
+            *out_overflow = true;
+        }
+        out_result = 0;
+        return false;
     }
     return true;
 }
 
 
 template<typename T>
-inline bool string_to_number_binary(char sign_char, std::string_view value, T& out_result)
+inline bool string_to_number_binary(char sign_char, std::string_view value, T& out_result, bool* out_overflow = nullptr)
 {
     static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>, "string_to_number_binary requires a numeric type");
     if (value.size() == 0)
@@ -904,13 +1345,16 @@ inline bool string_to_number_binary(char sign_char, std::string_view value, T& o
     }
 #endif
 
-    if constexpr (std::is_unsigned_v<T>)
-    {
-        out_result = static_cast<T>(strtoull(value.data(), nullptr, 2)) * detail::sign_char_to_multiplier<T>(sign_char);
-    }
-    else
+    uint64_t magnitude = 0;
+    bool overflow = false;
+    if (!detail::radix_digits_to_u64<1>(value, magnitude, overflow) || !detail::magnitude_to_number<T>(magnitude, sign_char, out_result))
     {
-        out_result = static_cast<T>(strtoll(value.data(), nullptr, 2)) * detail::sign_char_to_multiplier<T>(sign_char);
+        if (out_overflow != nullptr)
+        {
+            *out_overflow = true;
+        }
+        out_result = 0;
+        return false;
     }
     return true;
 }
@@ -936,6 +1380,7 @@ struct JXC_EXPORT NumberTokenSplitResult
     int32_t exponent = 0;
     std::string_view suffix;
     FloatLiteralType float_type = FloatLiteralType::Finite;
+    std::string_view value_with_exponent = {}; // value followed by the exponent, if any (eg. `4.35e-7`) - lets floats round once instead of twice
 
     inline bool is_integer() const
     {
@@ -949,6 +1394,8 @@ struct JXC_EXPORT NumberTokenSplitResult
 };
 
 
+// Splits a number token into its parts by scanning the token's text. The lexer does not record these offsets while
+// matching, so every call re-reads the number's bytes.
 JXC_EXPORT bool split_number_token_value(const Token& number_token, NumberTokenSplitResult& out_result, ErrorInfo& out_error);
 
 
@@ -1001,33 +1448,40 @@ bool parse_number(const Token& tok, T& out_value, const NumberTokenSplitResult&
         }
     }
 
+    bool overflow_error = false;
     if (number.prefix.size() == 2)
     {
         switch (number.prefix[1])
         {
         case 'x':
         case 'X':
-            if (!string_to_number_hex<T>(number.sign, number.value, out_value))
+            if (!string_to_number_hex<T>(number.sign, number.value, out_value, &overflow_error))
             {
-                out_error = ErrorInfo{ jxc::format("Value {} is not a valid hex literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
+                out_error = overflow_error
+                    ? ErrorInfo{ jxc::format("Value {} is too large for integer type {}", detail::debug_string_repr(number.value), detail::get_type_name<T>()), tok.start_idx, tok.end_idx }
+                    : ErrorInfo{ jxc::format("Value {} is not a valid hex literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
                 return false;
             }
             return true;
 
         case 'b':
         case 'B':
-            if (!string_to_number_binary<T>(number.sign, number.value, out_value))
+            if (!string_to_number_binary<T>(number.sign, number.value, out_value, &overflow_error))
             {
-                out_error = ErrorInfo{ jxc::format("Value {} is not a valid binary literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
+                out_error = overflow_error
+                    ? ErrorInfo{ jxc::format("Value {} is too large for integer type {}", detail::debug_string_repr(number.value), detail::get_type_name<T>()), tok.start_idx, tok.end_idx }
+                    : ErrorInfo{ jxc::format("Value {} is not a valid binary literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
                 return false;
             }
             return true;
 
         case 'o':
         case 'O':
-            if (!string_to_number_octal<T>(number.sign, number.value, out_value))
+            if (!string_to_number_octal<T>(number.sign, number.value, out_value, &overflow_error))
             {
-                out_error = ErrorInfo{ jxc::format("Value {} is not a valid octal literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
+                out_error = overflow_error
+                    ? ErrorInfo{ jxc::format("Value {} is too large for integer type {}", detail::debug_string_repr(number.value), detail::get_type_name<T>()), tok.start_idx, tok.end_idx }
+                    : ErrorInfo{ jxc::format("Value {} is not a valid octal literal", detail::debug_string_repr(number.value)), tok.start_idx, tok.end_idx };
                 return false;
             }
             return true;
@@ -1039,7 +1493,6 @@ bool parse_number(const Token& tok, T& out_value, const NumberTokenSplitResult&
         return false;
     }
 
-    bool overflow_error = false;
     if (!string_to_number_decimal<T>(number.sign, number.value, out_value, &overflow_error))
     {
         if (overflow_error)
@@ -1057,27 +1510,52 @@ bool parse_number(const Token& tok, T& out_value, const NumberTokenSplitResult&
         return false;
     }
 
-    if (number.exponent > 0)
+    if constexpr (std::is_floating_point_v<T>)
     {
-        int32_t exp = number.exponent;
-        while (exp > 0)
+        if (number.exponent != 0)
         {
-            out_value *= 10;
-            --exp;
+            // Parse the value and exponent together - scaling the already-rounded value by a rounded power of 10
+            // rounds twice, which gives values like 4.3499999999999996e-07 for `4.35e-7`.
+            if (number.value_with_exponent.size() > number.value.size() && string_to_float<T>(number.value_with_exponent, out_value))
+            {
+                out_value *= detail::sign_char_to_multiplier<T>(number.sign);
+            }
+            else
+            {
+                out_value *= static_cast<T>(std::pow(static_cast<T>(10), static_cast<T>(number.exponent)));
+            }
         }
     }
-    else if (number.exponent < 0)
+    else if (number.exponent > 0 && out_value != 0)
     {
-        if constexpr (std::is_integral_v<T>)
+        // 10^(digits10 + 1) never fits in T, so larger exponents always overflow (this also keeps huge exponents from looping for ages)
+        bool exponent_overflow = number.exponent > std::numeric_limits<T>::digits10;
+        for (int32_t exp = number.exponent; exp > 0 && !exponent_overflow; --exp)
         {
-            out_error = ErrorInfo{ "parse_number got an integer type, but the number has a negative exponent", tok.start_idx, tok.end_idx };
-            return false;
+            if (out_value > std::numeric_limits<T>::max() / 10 || out_value < std::numeric_limits<T>::min() / 10)
+            {
+                exponent_overflow = true;
+            }
+            else
+            {
+                out_value *= 10;
+            }
         }
-        else
+
+        if (exponent_overflow)
         {
-            out_value = static_cast<T>(std::pow<T>(out_value, number.exponent));
+            out_error = ErrorInfo{ jxc::format("Value {} is too large for integer type {}",
+                detail::debug_string_repr(tok.value.as_view()), detail::get_type_name<T>()),
+                tok.start_idx, tok.end_idx };
+            out_value = 0;
+            return false;
         }
     }
+    else if (number.exponent < 0)
+    {
+        out_error = ErrorInfo{ "parse_number got an integer type, but the number has a negative exponent", tok.start_idx, tok.end_idx };
+        return false;
+    }
 
     return true;
 }
@@ -1177,6 +1655,10 @@ bool parse_number_object_key(const Token& tok, IntType& out_value, ErrorInfo& ou
 // This is half of the parsing process for strings - the other half is handling escape characters.
 JXC_EXPORT bool string_token_to_value(const Token& string_token, std::string_view& out_view, bool& out_is_raw_string, ErrorInfo& out_error);
 
+// Checks that a buffer is entirely valid UTF-8. On failure, out_error points at the first byte of the first invalid sequence.
+// Overlong encodings, surrogates, codepoints above U+10FFFF, and truncated sequences are all treated as invalid.
+JXC_EXPORT bool validate_utf8(std::string_view buffer, ErrorInfo& out_error);
+
 // Checks if a string contains any backslash characters
 JXC_EXPORT bool string_has_escape_chars(std::string_view string_value);
 
@@ -1203,6 +1685,9 @@ JXC_EXPORT bool get_string_token_required_buffer_size(const Token& string_token,
 JXC_EXPORT bool parse_string_escapes_to_buffer(std::string_view string_value, size_t string_token_start_idx, size_t string_token_end_idx, char* out_string_buffer,
     size_t string_buffer_size, size_t& out_num_chars_written, ErrorInfo& out_error);
 
+// Checks a string value's escape characters without parsing them to a buffer. Fails with the same errors as parse_string_escapes_to_buffer().
+JXC_EXPORT bool validate_string_escapes(std::string_view string_value, size_t string_token_start_idx, size_t string_token_end_idx, ErrorInfo& out_error);
+
 // Parses a string token to a string buffer. Use get_string_token_required_buffer_size() to compute the size of the output buffer.
 JXC_EXPORT bool parse_string_token_to_buffer(const Token& string_token, char* out_buffer, size_t buffer_size, size_t& out_num_chars_written, ErrorInfo& out_error);
 
@@ -1257,7 +1742,8 @@ JXC_EXPORT bool parse_bytes_token(const Token& bytes_token, uint8_t* out_data_bu
 template<JXC_CONCEPT(traits::ByteBuffer) T>
 bool parse_bytes_token(const Token& bytes_token, T& out_data, ErrorInfo& out_error)
 {
-    out_data.resize(bytes_token.value.size());
+    // decode straight into an exactly-sized buffer (for single-line base64 strings the size comes from the string length alone)
+    out_data.resize(get_byte_buffer_required_size(bytes_token.value.data(), bytes_token.value.size()));
     size_t num_bytes_written = 0;
     if (parse_bytes_token(bytes_token, out_data.data(), out_data.size(), num_bytes_written, out_error))
     {
@@ -1281,6 +1767,15 @@ JXC_EXPORT bool parse_date_token(const Token& datetime_token, Date& out_date, Er
 // If require_time_data is false and the token does not include time data, out_datetime will have a time of 00:00:00Z.
 JXC_EXPORT bool parse_datetime_token(const Token& datetime_token, DateTime& out_datetime, ErrorInfo& out_error, bool require_time_data = false);
 
+// Parses a date token directly into a Unix timestamp, for callers that only need a point in time.
+// Local times (no timezone) are treated as UTC, and date-only values use midnight UTC.
+// The fixed `YYYY-MM-DD` and `YYYY-MM-DDTHH:MM:SS(.fraction)(Z|+HH:MM|-HH:MM)` layouts never build a DateTime.
+JXC_EXPORT bool parse_datetime_token_to_epoch(const Token& datetime_token, int64_t& out_seconds, uint32_t& out_nanosecond, ErrorInfo& out_error);
+
+// Parses a date token directly into the number of nanoseconds since the Unix epoch.
+// Returns an error if the value is out of range for a 64-bit nanosecond count (roughly years 1678 through 2261).
+JXC_EXPORT bool parse_datetime_token_to_epoch_nanoseconds(const Token& datetime_token, int64_t& out_nanoseconds, ErrorInfo& out_error);
+
 JXC_END_NAMESPACE(util)
 
 JXC_END_NAMESPACE(jxc)
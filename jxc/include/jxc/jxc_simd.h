@@ -0,0 +1,201 @@
+#pragma once
+#include "jxc/jxc_core.h"
+
+// Pick the widest vector instruction set available at compile time.
+// Define JXC_ENABLE_SIMD=0 to force the scalar fallbacks.
+#if JXC_ENABLE_SIMD && defined(__AVX2__)
+#define JXC_SIMD_AVX2 1
+#define JXC_SIMD_SSE2 1
+#include <immintrin.h>
+#elif JXC_ENABLE_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define JXC_SIMD_AVX2 0
+#define JXC_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define JXC_SIMD_AVX2 0
+#define JXC_SIMD_SSE2 0
+#endif
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+JXC_BEGIN_NAMESPACE(detail)
+JXC_BEGIN_NAMESPACE(simd)
+
+enum class InstructionSet : uint8_t
+{
+    Scalar = 0,
+    SSE2,
+    SSSE3,
+    AVX2,
+};
+
+JXC_EXPORT const char* instruction_set_to_string(InstructionSet value);
+
+/// Returns the name of the vector instruction set that the inline scanning functions below were compiled with
+constexpr inline const char* instruction_set_name()
+{
+#if JXC_SIMD_AVX2
+    return "AVX2";
+#elif JXC_SIMD_SSE2
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+/// Returns the best instruction set supported by both this build and the CPU we're running on
+JXC_EXPORT InstructionSet get_supported_instruction_set();
+
+/// Returns the instruction set used by the runtime-dispatched scanning functions (defaults to get_supported_instruction_set())
+JXC_EXPORT InstructionSet get_runtime_instruction_set();
+
+/// Overrides the instruction set used by the runtime-dispatched scanning functions.
+/// Values higher than get_supported_instruction_set() are clamped. Mostly useful for testing and benchmarking.
+JXC_EXPORT void set_runtime_instruction_set(InstructionSet value);
+
+/// Returns a pointer to the first quote_char, backslash, or line break in [ptr, end), or end if there is none.
+/// Runtime-dispatched - uses AVX2 if the CPU supports it.
+JXC_EXPORT const uint8_t* find_string_special_char(const uint8_t* ptr, const uint8_t* end, uint8_t quote_char);
+
+/// Decodes complete groups of 4 base64 chars from [src, src_end) into [dst, dst_end), advancing both pointers.
+/// Stops before the first group that contains padding or a non-base64 char, or that doesn't fit in the output,
+/// so callers need to handle whatever is left over. Runtime-dispatched - uses SSSE3 or AVX2 if the CPU supports them.
+JXC_EXPORT void base64_decode_blocks(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end);
+
+/// Encodes complete groups of 3 bytes from [src, src_end) as base64, advancing both pointers. Leaves any remaining
+/// 1 or 2 bytes for the caller to pad. dst must have room for 4 chars per group. Runtime-dispatched like base64_decode_blocks.
+JXC_EXPORT void base64_encode_blocks(const uint8_t*& src, const uint8_t* src_end, char*& dst);
+
+/// Returns a pointer to the first byte of the first invalid UTF-8 sequence in [ptr, end), or end if the whole range is valid.
+/// Rejects overlong encodings, surrogates, codepoints above U+10FFFF, and sequences truncated by end.
+/// Runtime-dispatched - uses SSSE3 or AVX2 if the CPU supports them.
+JXC_EXPORT const uint8_t* find_invalid_utf8(const uint8_t* ptr, const uint8_t* end);
+
+#if JXC_SIMD_AVX2 || JXC_SIMD_SSE2
+
+/// A single vector register's worth of bytes, with helpers for building bitmasks (one bit per byte).
+/// All loads are unaligned, and callers are responsible for making sure a full block is readable.
+struct Block
+{
+#if JXC_SIMD_AVX2
+    static constexpr size_t size = 32;
+    static constexpr uint32_t all_bits = 0xFFFFFFFFu;
+    __m256i data;
+
+    static JXC_FORCEINLINE Block load(const uint8_t* ptr) { return Block{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)) }; }
+    JXC_FORCEINLINE uint32_t eq(uint8_t ch) const { return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, _mm256_set1_epi8(static_cast<char>(ch))))); }
+#else
+    static constexpr size_t size = 16;
+    static constexpr uint32_t all_bits = 0xFFFFu;
+    __m128i data;
+
+    static JXC_FORCEINLINE Block load(const uint8_t* ptr) { return Block{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr)) }; }
+    JXC_FORCEINLINE uint32_t eq(uint8_t ch) const { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8(static_cast<char>(ch))))); }
+#endif
+};
+
+#endif
+
+
+JXC_FORCEINLINE bool is_space(uint8_t ch) { return ch == ' ' || ch == '\t'; }
+JXC_FORCEINLINE bool is_whitespace(uint8_t ch) { return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n'; }
+
+
+/// Returns a pointer to the first char in [ptr, end) that is not a space or tab, or end if there is none
+JXC_FORCEINLINE const uint8_t* skip_spaces(const uint8_t* ptr, const uint8_t* end)
+{
+    // most runs of spaces are short (eg. a single space after a colon), so check the first char before doing any vector work
+    if (ptr >= end || !is_space(*ptr))
+    {
+        return ptr;
+    }
+#if JXC_SIMD_SSE2
+    while (end - ptr >= static_cast<ptrdiff_t>(Block::size))
+    {
+        const Block block = Block::load(ptr);
+        const uint32_t mask = ~(block.eq(' ') | block.eq('\t')) & Block::all_bits;
+        if (mask != 0)
+        {
+            return ptr + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+        }
+        ptr += Block::size;
+    }
+#endif
+    while (ptr < end && is_space(*ptr))
+    {
+        ++ptr;
+    }
+    return ptr;
+}
+
+
+/// Returns a pointer to the first char in [ptr, end) that is not a space, tab, or line break, or end if there is none
+JXC_FORCEINLINE const uint8_t* skip_whitespace(const uint8_t* ptr, const uint8_t* end)
+{
+#if JXC_SIMD_SSE2
+    while (end - ptr >= static_cast<ptrdiff_t>(Block::size))
+    {
+        const Block block = Block::load(ptr);
+        const uint32_t mask = ~(block.eq(' ') | block.eq('\t') | block.eq('\n') | block.eq('\r')) & Block::all_bits;
+        if (mask != 0)
+        {
+            return ptr + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+        }
+        ptr += Block::size;
+    }
+#endif
+    while (ptr < end && is_whitespace(*ptr))
+    {
+        ++ptr;
+    }
+    return ptr;
+}
+
+
+/// Returns a pointer to the first instance of ch in [ptr, end), or end if there is none
+JXC_FORCEINLINE const uint8_t* find_byte(const uint8_t* ptr, const uint8_t* end, uint8_t ch)
+{
+#if JXC_SIMD_SSE2
+    while (end - ptr >= static_cast<ptrdiff_t>(Block::size))
+    {
+        const uint32_t mask = Block::load(ptr).eq(ch);
+        if (mask != 0)
+        {
+            return ptr + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+        }
+        ptr += Block::size;
+    }
+#endif
+    while (ptr < end && *ptr != ch)
+    {
+        ++ptr;
+    }
+    return ptr;
+}
+
+
+/// Returns the number of instances of ch in [ptr, end)
+JXC_FORCEINLINE size_t count_byte(const uint8_t* ptr, const uint8_t* end, uint8_t ch)
+{
+    size_t count = 0;
+#if JXC_SIMD_SSE2
+    while (end - ptr >= static_cast<ptrdiff_t>(Block::size))
+    {
+        count += static_cast<size_t>(JXC_POPCOUNT_U32(Block::load(ptr).eq(ch)));
+        ptr += Block::size;
+    }
+#endif
+    while (ptr < end)
+    {
+        if (*ptr == ch)
+        {
+            ++count;
+        }
+        ++ptr;
+    }
+    return count;
+}
+
+JXC_END_NAMESPACE(simd)
+JXC_END_NAMESPACE(detail)
+JXC_END_NAMESPACE(jxc)
@@ -178,6 +178,26 @@ JXC_EXPORT std::string date_to_iso8601(const Date& dt);
 // If auto_strip_time is true, and the DateTime has no time data (see DateTime::has_time_or_timezone_data), this is serialized as just a Date.
 JXC_EXPORT std::string datetime_to_iso8601(const DateTime& dt, bool auto_strip_time = false);
 
+// Returns the number of days since 1970-01-01 for a date in the proleptic Gregorian calendar
+JXC_EXPORT int64_t civil_date_to_epoch_days(int64_t year, uint32_t month, uint32_t day);
+
+// Converts a DateTime to the number of seconds since the Unix epoch (1970-01-01T00:00:00Z), ignoring the nanosecond field.
+// Local times (no timezone) are treated as UTC.
+JXC_EXPORT int64_t datetime_to_epoch_seconds(const DateTime& dt);
+
+// Converts a DateTime to the number of nanoseconds since the Unix epoch.
+// Local times (no timezone) are treated as UTC. Returns false if the result does not fit in an int64_t (roughly years 1678 through 2261).
+JXC_EXPORT bool datetime_to_epoch_nanoseconds(const DateTime& dt, int64_t& out_nanoseconds);
+
+// Combines seconds and nanoseconds since the Unix epoch into nanoseconds. Returns false if the result does not fit in an int64_t.
+JXC_EXPORT bool epoch_seconds_to_nanoseconds(int64_t seconds, uint32_t nanosecond, int64_t& out_nanoseconds);
+
+// Converts a number of seconds since the Unix epoch to a UTC DateTime
+JXC_EXPORT DateTime epoch_seconds_to_datetime(int64_t seconds, uint32_t nanosecond = 0);
+
+// Converts a number of nanoseconds since the Unix epoch to a UTC DateTime
+JXC_EXPORT DateTime epoch_nanoseconds_to_datetime(int64_t nanoseconds);
+
 inline std::ostream& operator<<(std::ostream& os, const Date& dt)
 {
     return (os << date_to_iso8601(dt));
@@ -826,4 +846,44 @@ struct DebugTypeName<MiniBuffer<T, MaxSize>>
 JXC_END_NAMESPACE(detail)
 
 
+// Read-only memory mapping of a file, for parsing large files without reading them into a std::string first.
+// The mapping is private (writes are never visible to other processes or the file), and hints to the OS that it will be
+// read sequentially. Pass get_view() to JumpParser or jxc::parse, or the MappedBuffer itself to Document or conv::Parser.
+// Views into the mapping (including Values parsed with try_return_view) must not outlive the MappedBuffer.
+// Like std::string, the data is always followed by a readable null byte, because the lexer reads one byte past the end of its buffer.
+class JXC_EXPORT MappedBuffer
+{
+    const char* data_ptr = nullptr;
+    size_t data_size = 0;
+    // size of the whole mapping, including the zero-filled space after the file
+    size_t mapping_size = 0;
+    bool is_mapped = false;
+#if defined(_WIN32)
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+    // files that end on a page boundary have no zero-filled space after them, so they're copied instead of mapped
+    std::string file_copy;
+#endif
+
+public:
+    MappedBuffer() = default;
+    MappedBuffer(const MappedBuffer&) = delete;
+    MappedBuffer& operator=(const MappedBuffer&) = delete;
+    MappedBuffer(MappedBuffer&& rhs) noexcept;
+    MappedBuffer& operator=(MappedBuffer&& rhs) noexcept;
+    ~MappedBuffer() { close(); }
+
+    // Maps a file into memory. Returns false if the file can't be opened or mapped, with the reason in out_error if it's not null.
+    bool open(const std::string& file_path, std::string* out_error = nullptr);
+
+    void close();
+
+    inline bool is_open() const { return data_ptr != nullptr; }
+    inline const char* data() const { return data_ptr; }
+    inline size_t size() const { return data_size; }
+    inline std::string_view get_view() const { return std::string_view{ data_ptr, data_size }; }
+    inline operator std::string_view() const { return get_view(); }
+};
+
+
 JXC_END_NAMESPACE(jxc)
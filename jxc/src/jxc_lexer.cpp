@@ -1,5 +1,6 @@
 #include "jxc/jxc_lexer.h"
 #include "jxc/jxc_format.h"
+#include "jxc/jxc_simd.h"
 
 
 static inline bool is_valid_heredoc_first_char(char ch)
@@ -14,17 +15,66 @@ static inline bool is_valid_heredoc_char(char ch)
 }
 
 
+// chars recorded in the structural index, plus the ones that start a string or comment region
+static inline bool is_structural_index_char(uint8_t ch)
+{
+    switch (ch)
+    {
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case '(':
+    case ')':
+    case ':':
+    case ',':
+    case '\n':
+    case '"':
+    case '\'':
+    case '#':
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+#if JXC_SIMD_SSE2
+static JXC_FORCEINLINE uint32_t structural_index_block_mask(const jxc::detail::simd::Block& block)
+{
+    return block.eq('{') | block.eq('}') | block.eq('[') | block.eq(']')
+        | block.eq('(') | block.eq(')') | block.eq(':') | block.eq(',')
+        | block.eq('\n') | block.eq('"') | block.eq('\'') | block.eq('#');
+}
+#endif
+
+
 JXC_BEGIN_NAMESPACE(jxc)
 
 
+bool Lexer::scan_linebreak()
+{
+    JXC_DEBUG_ASSERT(this->current < this->limit && (*this->current == '\n' || *this->current == '\r'));
+
+    // Equivalent to the regex `linebreak (spaces linebreak)*` - find the end of the whitespace run,
+    // then back up over any trailing spaces so they're not included in the token.
+    const uint8_t* end = detail::simd::skip_whitespace(this->current, this->limit);
+    while (end > this->current && detail::simd::is_space(*(end - 1)))
+    {
+        --end;
+    }
+
+    this->line += detail::simd::count_byte(this->current, end, '\n');
+    this->current = end;
+    return true;
+}
+
+
 bool Lexer::scan_comment(size_t comment_token_len, std::string_view& out_comment)
 {
     const char* comment_start = reinterpret_cast<const char*>(this->current - comment_token_len);
     JXC_DEBUG_ASSERT(comment_start[0] == '#');
-    while (this->current < this->limit && *this->current != '\n')
-    {
-        ++this->current;
-    }
+    this->current = detail::simd::find_byte(this->current, this->limit, '\n');
     const int64_t comment_len = reinterpret_cast<const char*>(this->current) - comment_start;
     if (comment_len >= 0)
     {
@@ -181,13 +231,24 @@ bool Lexer::scan_string(std::string& out_error_message, uint8_t quote_char, std:
 
     const char* string_start = reinterpret_cast<const char*>(this->current - 1);
 
-    while (this->current < this->limit && *this->current != quote_char)
+    while (this->current < this->limit)
     {
+        // jump straight to the next char that needs special handling
+        this->current = detail::simd::find_string_special_char(this->current, this->limit, quote_char);
+        if (this->current >= this->limit || *this->current == quote_char)
+        {
+            break;
+        }
+
         switch (*this->current)
         {
         case '\\':
             // check the escape char type
             ++this->current;
+            if (this->current >= this->limit)
+            {
+                break;
+            }
 
             // except for the addition of a single-quote escape, this is intended to be exactly the same as the JSON spec for string escapes
             switch (*this->current)
@@ -313,6 +374,11 @@ bool Lexer::scan_raw_string(std::string& out_error_message, uint8_t quote_char,
             out_error_message = jxc::format("Raw string delimiter length is {} (max length {})", out_delim.size(), max_delimiter_length);
             return false;
         }
+        else if (this->current >= this->limit)
+        {
+            out_error_message = "End of stream reached while parsing raw string delimiter";
+            return false;
+        }
 
         JXC_DEBUG_ASSERT((*this->current) == '(');
     }
@@ -323,25 +389,13 @@ bool Lexer::scan_raw_string(std::string& out_error_message, uint8_t quote_char,
 
     auto delimiter_matches = [this, &out_delim, &delimiter_len](const uint8_t* start)
     {
-        if (start + delimiter_len > this->limit)
-        {
-            return false;
-        }
-
-        for (size_t i = 0; i < delimiter_len; ++i)
-        {
-            if (*(start + i) != out_delim[i])
-            {
-                return false;
-            }
-        }
-
-        return true;
+        return start + delimiter_len <= this->limit && memcmp(start, out_delim.data(), delimiter_len) == 0;
     };
 
     // minimum number of chars remaining is 2: `)"`
     if (this->current + 2 > this->limit)
     {
+        this->current = this->limit;
         out_error_message = "End of stream reached while parsing string";
         return false;
     }
@@ -358,10 +412,11 @@ bool Lexer::scan_raw_string(std::string& out_error_message, uint8_t quote_char,
         bool found_rhs_delimiter = false;
         while (this->current < this->limit)
         {
-            // scan for the next close paren
-            while (this->current < this->limit && *this->current != ')')
+            // Scan for the next close paren. Each candidate only gets a bounded delimiter comparison, so this stays linear.
+            this->current = detail::simd::find_byte(this->current, this->limit, ')');
+            if (this->current >= this->limit)
             {
-                ++this->current;
+                break;
             }
 
             if (delimiter_matches(this->current + 1))
@@ -415,17 +470,21 @@ bool Lexer::scan_raw_string(std::string& out_error_message, uint8_t quote_char,
         // no delimiter - just scan for the end of the string
         while (this->current < this->limit)
         {
-            const uint8_t prev_char = *this->current;
+            this->current = detail::simd::find_byte(this->current, this->limit, ')');
+            if (this->current >= this->limit)
+            {
+                break;
+            }
 
             ++this->current;
 
-            if (prev_char == ')' && *this->current == quote_char)
+            if (this->current < this->limit && *this->current == quote_char)
             {
                 break;
             }
         }
 
-        if (*this->current == quote_char)
+        if (this->current < this->limit && *this->current == quote_char)
         {
             ++this->current;
             const int64_t len = (int64_t)(this->current - raw_str_start);
@@ -440,6 +499,9 @@ bool Lexer::scan_raw_string(std::string& out_error_message, uint8_t quote_char,
 
     JXC_DEBUG_ASSERT(this->current <= this->limit && *(this->current - 1) == quote_char);
 
+    // raw strings are the only string type that can span multiple lines
+    this->line += detail::simd::count_byte(raw_str_start, this->current, '\n');
+
     out_string = std::string_view{ reinterpret_cast<const char*>(raw_str_start), raw_string_len };
     return true;
 }
@@ -477,15 +539,17 @@ bool Lexer::scan_base64_string(std::string& out_error_message, std::string_view&
             const char ch = static_cast<char>(*this->current);
             switch (ch)
             {
+            case '\n':
+                ++this->line;
+                break;
             case ' ':
             case '\t':
             case '\r':
-            case '\n':
                 // skip over whitespace
                 break;
             case ')':
                 // got a close paren followed by the correct quote char, so we're done
-                if (this->current < this->limit && static_cast<char>(*(this->current + 1)) == quote_char)
+                if (this->current + 1 < this->limit && static_cast<char>(*(this->current + 1)) == quote_char)
                 {
                     ++this->current;
                     goto parse_success;
@@ -612,6 +676,180 @@ bool Lexer::scan_datetime_string(std::string& out_error_message, std::string_vie
 }
 
 
+bool StructuralIndex::build(std::string_view buf)
+{
+    clear();
+    buffer = buf;
+    if (buf.size() > max_buffer_size)
+    {
+        return false;
+    }
+
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(buf.data());
+    const uint8_t* end = start + buf.size();
+
+    // rough guess based on the benchmark documents, which average one structural char every 5-10 bytes
+    tape.reserve(buf.size() / 8);
+
+    auto emit = [this, start](const uint8_t* ptr, uint32_t flags = 0)
+    {
+        tape.push_back(static_cast<uint32_t>(ptr - start) | flags);
+    };
+
+    // Skips over a string or comment starting at ptr. Returns a pointer to the first char after it,
+    // or nullptr if the lexer would fail to parse it (in which case we stop building the index).
+    auto skip_region = [&](const uint8_t* ptr) -> const uint8_t*
+    {
+        const uint8_t ch = *ptr;
+        if (ch == '#')
+        {
+            const uint8_t* comment_end = detail::simd::find_byte(ptr + 1, end, '\n');
+            emit(ptr, region_flag);
+            emit(comment_end);
+            // the comment's end offset doubles as the line break entry
+            return (comment_end < end) ? comment_end + 1 : comment_end;
+        }
+
+        JXC_DEBUG_ASSERT(ch == '"' || ch == '\'');
+        const bool is_raw = ptr > start && *(ptr - 1) == 'r' && (ptr - 1 == start || !is_valid_identifier_char(static_cast<char>(*(ptr - 2))));
+        const bool is_multiline_base64 = ptr - start >= 3 && ptr + 1 < end && *(ptr + 1) == '('
+            && *(ptr - 3) == 'b' && *(ptr - 2) == '6' && *(ptr - 1) == '4'
+            && (ptr - 3 == start || !is_valid_identifier_char(static_cast<char>(*(ptr - 4))));
+
+        if (is_raw)
+        {
+            const uint8_t* delim_start = ptr + 1;
+            const uint8_t* cur = detail::simd::find_byte(delim_start, end, '(');
+            if (cur >= end || cur - delim_start > JXC_MAX_HEREDOC_LENGTH)
+            {
+                return nullptr;
+            }
+            const size_t delim_len = static_cast<size_t>(cur - delim_start);
+            ++cur;
+
+            // matches the lexer - the first `){delimiter}` must be followed by the quote char
+            while (true)
+            {
+                cur = detail::simd::find_byte(cur, end, ')');
+                if (cur >= end)
+                {
+                    return nullptr;
+                }
+                else if (static_cast<size_t>(end - cur - 1) >= delim_len && memcmp(cur + 1, delim_start, delim_len) == 0)
+                {
+                    const uint8_t* quote_ptr = cur + 1 + delim_len;
+                    if (quote_ptr < end && *quote_ptr == ch)
+                    {
+                        return quote_ptr + 1;
+                    }
+                    else if (delim_len > 0)
+                    {
+                        return nullptr;
+                    }
+                }
+                ++cur;
+            }
+        }
+        else if (is_multiline_base64)
+        {
+            const uint8_t* cur = ptr + 2;
+            while (true)
+            {
+                cur = detail::simd::find_byte(cur, end, ')');
+                if (cur + 1 >= end)
+                {
+                    return nullptr;
+                }
+                else if (*(cur + 1) == ch)
+                {
+                    return cur + 2;
+                }
+                ++cur;
+            }
+        }
+
+        // regular string - escape chars are allowed, but those strings are left to the lexer because they need validation
+        const uint8_t* cur = ptr + 1;
+        bool has_escapes = false;
+        while (true)
+        {
+            cur = detail::simd::find_string_special_char(cur, end, ch);
+            if (cur >= end || *cur == '\n')
+            {
+                return nullptr;
+            }
+            else if (*cur == ch)
+            {
+                break;
+            }
+            has_escapes = true;
+            cur += 2;
+        }
+
+        if (!has_escapes)
+        {
+            emit(ptr, region_flag);
+            emit(cur);
+        }
+        return cur + 1;
+    };
+
+    const uint8_t* ptr = start;
+
+#if JXC_SIMD_SSE2
+    using detail::simd::Block;
+    while (end - ptr >= static_cast<ptrdiff_t>(Block::size))
+    {
+        const uint8_t* block_start = ptr;
+        uint32_t mask = structural_index_block_mask(Block::load(block_start));
+        ptr = block_start + Block::size;
+        while (mask != 0)
+        {
+            const uint8_t* cur = block_start + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+            const uint8_t ch = *cur;
+            if (ch == '"' || ch == '\'' || ch == '#')
+            {
+                // the rest of this block might be inside the region, so resume scanning after it
+                ptr = skip_region(cur);
+                if (ptr == nullptr)
+                {
+                    return true;
+                }
+                break;
+            }
+            emit(cur);
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    while (ptr < end)
+    {
+        const uint8_t ch = *ptr;
+        if (!is_structural_index_char(ch))
+        {
+            ++ptr;
+        }
+        else if (ch == '"' || ch == '\'' || ch == '#')
+        {
+            ptr = skip_region(ptr);
+            if (ptr == nullptr)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            emit(ptr);
+            ++ptr;
+        }
+    }
+
+    complete = true;
+    return true;
+}
+
+
 bool AnnotationLexer::next(Token& out_token)
 {
     const size_t token_idx = num_tokens;
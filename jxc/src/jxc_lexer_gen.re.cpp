@@ -1,6 +1,7 @@
 /* Generated by re2c 4.1 on Mon Oct  6 11:40:20 2025 */
 #line 1 "jxc/src/jxc_lexer_gen.re"
 #include "jxc/jxc_lexer.h"
+#include "jxc/jxc_simd.h"
 
 
 #define YYCTYPE  uint8_t
@@ -8,7 +9,7 @@
 #define YYMARKER this->marker
 
 
-#line 69 "jxc/src/jxc_lexer_gen.re"
+#line 70 "jxc/src/jxc_lexer_gen.re"
 
 
 
@@ -46,10 +47,19 @@ expr_start:
     {
         goto expr_end_of_stream;
     }
+
+    // fast path for whitespace (the `spaces` and `linebreak` rules below only handle what this misses)
+    this->current = detail::simd::skip_spaces(this->current, this->limit);
     this->token_start = this->current;
+    if (this->current < this->limit && (*this->current == '\n' || *this->current == '\r'))
+    {
+        scan_linebreak();
+        set_token();
+        return TokenType::LineBreak;
+    }
 
     
-#line 53 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 63 "jxc/src/jxc_lexer_gen.re.cpp"
 {
 	YYCTYPE yych;
 	unsigned int yyaccept = 0;
@@ -157,7 +167,7 @@ expr_start:
 	}
 yy1:
 	++this->current;
-#line 173 "jxc/src/jxc_lexer_gen.re"
+#line 183 "jxc/src/jxc_lexer_gen.re"
 	{
         if (this->current >= this->limit)
         {
@@ -169,7 +179,7 @@ yy1:
             return TokenType::Invalid;
         }
     }
-#line 173 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 183 "jxc/src/jxc_lexer_gen.re.cpp"
 yy2:
 	yych = *++this->current;
 	switch (yych) {
@@ -178,9 +188,9 @@ yy2:
 		default: goto yy3;
 	}
 yy3:
-#line 170 "jxc/src/jxc_lexer_gen.re"
+#line 180 "jxc/src/jxc_lexer_gen.re"
 	{ goto expr_start; }
-#line 184 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 194 "jxc/src/jxc_lexer_gen.re.cpp"
 yy4:
 	yyaccept = 0;
 	yych = *(this->marker = ++this->current);
@@ -192,24 +202,24 @@ yy4:
 		default: goto yy5;
 	}
 yy5:
-#line 171 "jxc/src/jxc_lexer_gen.re"
+#line 181 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::LineBreak; }
-#line 198 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 208 "jxc/src/jxc_lexer_gen.re.cpp"
 yy6:
 	++this->current;
-#line 143 "jxc/src/jxc_lexer_gen.re"
+#line 153 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::ExclamationPoint; }
-#line 203 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 213 "jxc/src/jxc_lexer_gen.re.cpp"
 yy7:
 	++this->current;
-#line 165 "jxc/src/jxc_lexer_gen.re"
+#line 175 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_string(out_error.message, this->current[-1], out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::String; } else { set_error(); return TokenType::Invalid; } }
-#line 208 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 218 "jxc/src/jxc_lexer_gen.re.cpp"
 yy8:
 	++this->current;
-#line 125 "jxc/src/jxc_lexer_gen.re"
+#line 135 "jxc/src/jxc_lexer_gen.re"
 	{ scan_comment(1, out_token_value); get_token_pos(out_start_idx, out_end_idx); return TokenType::Comment; }
-#line 213 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 223 "jxc/src/jxc_lexer_gen.re.cpp"
 yy9:
 	yych = *++this->current;
 yy10:
@@ -281,59 +291,59 @@ yy10:
 		default: goto yy11;
 	}
 yy11:
-#line 168 "jxc/src/jxc_lexer_gen.re"
+#line 178 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Identifier; }
-#line 287 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 297 "jxc/src/jxc_lexer_gen.re.cpp"
 yy12:
 	++this->current;
-#line 150 "jxc/src/jxc_lexer_gen.re"
+#line 160 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Percent; }
-#line 292 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 302 "jxc/src/jxc_lexer_gen.re.cpp"
 yy13:
 	++this->current;
-#line 142 "jxc/src/jxc_lexer_gen.re"
+#line 152 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Ampersand; }
-#line 297 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 307 "jxc/src/jxc_lexer_gen.re.cpp"
 yy14:
 	++this->current;
-#line 113 "jxc/src/jxc_lexer_gen.re"
+#line 123 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); ++expr_paren_depth; return TokenType::ParenOpen; }
-#line 302 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 312 "jxc/src/jxc_lexer_gen.re.cpp"
 yy15:
 	++this->current;
-#line 114 "jxc/src/jxc_lexer_gen.re"
+#line 124 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); --expr_paren_depth; if (expr_paren_depth < 0) { set_error_msg("Unexpected symbol `)` in expression"); return TokenType::Invalid; } else { return TokenType::ParenClose; } }
-#line 307 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 317 "jxc/src/jxc_lexer_gen.re.cpp"
 yy16:
 	++this->current;
-#line 147 "jxc/src/jxc_lexer_gen.re"
+#line 157 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Asterisk; }
-#line 312 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 322 "jxc/src/jxc_lexer_gen.re.cpp"
 yy17:
 	++this->current;
-#line 145 "jxc/src/jxc_lexer_gen.re"
+#line 155 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Plus; }
-#line 317 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 327 "jxc/src/jxc_lexer_gen.re.cpp"
 yy18:
 	++this->current;
-#line 138 "jxc/src/jxc_lexer_gen.re"
+#line 148 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Comma; }
-#line 322 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 332 "jxc/src/jxc_lexer_gen.re.cpp"
 yy19:
 	++this->current;
-#line 146 "jxc/src/jxc_lexer_gen.re"
+#line 156 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Minus; }
-#line 327 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 337 "jxc/src/jxc_lexer_gen.re.cpp"
 yy20:
 	++this->current;
-#line 152 "jxc/src/jxc_lexer_gen.re"
+#line 162 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Period; }
-#line 332 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 342 "jxc/src/jxc_lexer_gen.re.cpp"
 yy21:
 	++this->current;
-#line 148 "jxc/src/jxc_lexer_gen.re"
+#line 158 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Slash; }
-#line 337 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 347 "jxc/src/jxc_lexer_gen.re.cpp"
 yy22:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -349,9 +359,9 @@ yy22:
 		default: goto yy23;
 	}
 yy23:
-#line 128 "jxc/src/jxc_lexer_gen.re"
+#line 138 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 355 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 365 "jxc/src/jxc_lexer_gen.re.cpp"
 yy24:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -375,64 +385,64 @@ yy24:
 	}
 yy25:
 	++this->current;
-#line 139 "jxc/src/jxc_lexer_gen.re"
+#line 149 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Colon; }
-#line 381 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 391 "jxc/src/jxc_lexer_gen.re.cpp"
 yy26:
 	++this->current;
-#line 158 "jxc/src/jxc_lexer_gen.re"
+#line 168 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Semicolon; }
-#line 386 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 396 "jxc/src/jxc_lexer_gen.re.cpp"
 yy27:
 	++this->current;
-#line 155 "jxc/src/jxc_lexer_gen.re"
+#line 165 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::AngleBracketOpen; }
-#line 391 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 401 "jxc/src/jxc_lexer_gen.re.cpp"
 yy28:
 	++this->current;
-#line 144 "jxc/src/jxc_lexer_gen.re"
+#line 154 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Equals; }
-#line 396 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 406 "jxc/src/jxc_lexer_gen.re.cpp"
 yy29:
 	++this->current;
-#line 156 "jxc/src/jxc_lexer_gen.re"
+#line 166 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::AngleBracketClose; }
-#line 401 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 411 "jxc/src/jxc_lexer_gen.re.cpp"
 yy30:
 	++this->current;
-#line 153 "jxc/src/jxc_lexer_gen.re"
+#line 163 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::QuestionMark; }
-#line 406 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 416 "jxc/src/jxc_lexer_gen.re.cpp"
 yy31:
 	++this->current;
-#line 140 "jxc/src/jxc_lexer_gen.re"
+#line 150 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::AtSymbol; }
-#line 411 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 421 "jxc/src/jxc_lexer_gen.re.cpp"
 yy32:
 	++this->current;
-#line 117 "jxc/src/jxc_lexer_gen.re"
+#line 127 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); ++expr_bracket_depth; return TokenType::SquareBracketOpen; }
-#line 416 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 426 "jxc/src/jxc_lexer_gen.re.cpp"
 yy33:
 	++this->current;
-#line 149 "jxc/src/jxc_lexer_gen.re"
+#line 159 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Backslash; }
-#line 421 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 431 "jxc/src/jxc_lexer_gen.re.cpp"
 yy34:
 	++this->current;
-#line 118 "jxc/src/jxc_lexer_gen.re"
+#line 128 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); --expr_bracket_depth; if (expr_bracket_depth < 0) { set_error_msg("Unexpected symbol `]` in expression"); return TokenType::Invalid; } else { return TokenType::SquareBracketClose; } }
-#line 426 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 436 "jxc/src/jxc_lexer_gen.re.cpp"
 yy35:
 	++this->current;
-#line 151 "jxc/src/jxc_lexer_gen.re"
+#line 161 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Caret; }
-#line 431 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 441 "jxc/src/jxc_lexer_gen.re.cpp"
 yy36:
 	++this->current;
-#line 157 "jxc/src/jxc_lexer_gen.re"
+#line 167 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Backtick; }
-#line 436 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 446 "jxc/src/jxc_lexer_gen.re.cpp"
 yy37:
 	yych = *++this->current;
 	switch (yych) {
@@ -479,24 +489,24 @@ yy43:
 	}
 yy44:
 	++this->current;
-#line 121 "jxc/src/jxc_lexer_gen.re"
+#line 131 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); ++expr_brace_depth; return TokenType::BraceOpen; }
-#line 485 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 495 "jxc/src/jxc_lexer_gen.re.cpp"
 yy45:
 	++this->current;
-#line 141 "jxc/src/jxc_lexer_gen.re"
+#line 151 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Pipe; }
-#line 490 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 500 "jxc/src/jxc_lexer_gen.re.cpp"
 yy46:
 	++this->current;
-#line 122 "jxc/src/jxc_lexer_gen.re"
+#line 132 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); --expr_brace_depth; if (expr_brace_depth < 0) { set_error_msg("Unexpected symbol `}` in expression"); return TokenType::Invalid; } else { return TokenType::BraceClose; } }
-#line 495 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 505 "jxc/src/jxc_lexer_gen.re.cpp"
 yy47:
 	++this->current;
-#line 154 "jxc/src/jxc_lexer_gen.re"
+#line 164 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Tilde; }
-#line 500 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 510 "jxc/src/jxc_lexer_gen.re.cpp"
 yy48:
 	yych = *++this->current;
 	switch (yych) {
@@ -700,9 +710,9 @@ yy61:
 	}
 yy62:
 	++this->current;
-#line 161 "jxc/src/jxc_lexer_gen.re"
+#line 171 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_raw_string(out_error.message, this->current[-1], out_token_value, out_string_delim)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::String; } else { set_error(); return TokenType::Invalid; } }
-#line 706 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 716 "jxc/src/jxc_lexer_gen.re.cpp"
 yy63:
 	yych = *++this->current;
 	switch (yych) {
@@ -909,9 +919,9 @@ yy72:
 		default: goto yy73;
 	}
 yy73:
-#line 164 "jxc/src/jxc_lexer_gen.re"
+#line 174 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_datetime_string(out_error.message, out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::DateTime; } else { set_error(); return TokenType::Invalid; } }
-#line 915 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 925 "jxc/src/jxc_lexer_gen.re.cpp"
 yy74:
 	yyaccept = 2;
 	yych = *(this->marker = ++this->current);
@@ -1006,9 +1016,9 @@ yy76:
 		default: goto yy77;
 	}
 yy77:
-#line 135 "jxc/src/jxc_lexer_gen.re"
+#line 145 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 1012 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1022 "jxc/src/jxc_lexer_gen.re.cpp"
 yy78:
 	yych = *++this->current;
 	switch (yych) {
@@ -1079,9 +1089,9 @@ yy78:
 		default: goto yy79;
 	}
 yy79:
-#line 134 "jxc/src/jxc_lexer_gen.re"
+#line 144 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 1085 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1095 "jxc/src/jxc_lexer_gen.re.cpp"
 yy80:
 	yych = *++this->current;
 	switch (yych) {
@@ -1170,9 +1180,9 @@ yy83:
 		default: goto yy84;
 	}
 yy84:
-#line 162 "jxc/src/jxc_lexer_gen.re"
+#line 172 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_base64_string(out_error.message, out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::ByteString; } else { set_error(); return TokenType::Invalid; } }
-#line 1176 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1186 "jxc/src/jxc_lexer_gen.re.cpp"
 yy85:
 	yych = *++this->current;
 	switch (yych) {
@@ -1309,9 +1319,9 @@ yy90:
 		default: goto yy91;
 	}
 yy91:
-#line 133 "jxc/src/jxc_lexer_gen.re"
+#line 143 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Null; }
-#line 1315 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1325 "jxc/src/jxc_lexer_gen.re.cpp"
 yy92:
 	yych = *++this->current;
 	switch (yych) {
@@ -1382,9 +1392,9 @@ yy92:
 		default: goto yy93;
 	}
 yy93:
-#line 131 "jxc/src/jxc_lexer_gen.re"
+#line 141 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::True; }
-#line 1388 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1398 "jxc/src/jxc_lexer_gen.re.cpp"
 yy94:
 	yych = *++this->current;
 	switch (yych) {
@@ -1557,9 +1567,9 @@ yy98:
 		default: goto yy99;
 	}
 yy99:
-#line 132 "jxc/src/jxc_lexer_gen.re"
+#line 142 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::False; }
-#line 1563 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 1573 "jxc/src/jxc_lexer_gen.re.cpp"
 yy100:
 	yych = *++this->current;
 	switch (yych) {
@@ -2403,9 +2413,9 @@ yy126:
 	}
 yy127:
 	++this->current;
-#line 163 "jxc/src/jxc_lexer_gen.re"
+#line 173 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::DateTime; }
-#line 2409 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 2419 "jxc/src/jxc_lexer_gen.re.cpp"
 yy128:
 	yych = *++this->current;
 	switch (yych) {
@@ -3392,7 +3402,7 @@ yy186:
 		default: goto yy49;
 	}
 }
-#line 185 "jxc/src/jxc_lexer_gen.re"
+#line 195 "jxc/src/jxc_lexer_gen.re"
 
 
 expr_end_of_stream:
@@ -3446,10 +3456,19 @@ regular:
     {
         return TokenType::EndOfStream;
     }
+
+    // fast path for whitespace (the `spaces` and `linebreak` rules below only handle what this misses)
+    this->current = detail::simd::skip_spaces(this->current, this->limit);
     this->token_start = this->current;
+    if (this->current < this->limit && (*this->current == '\n' || *this->current == '\r'))
+    {
+        scan_linebreak();
+        set_token();
+        return TokenType::LineBreak;
+    }
 
     
-#line 3453 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3472 "jxc/src/jxc_lexer_gen.re.cpp"
 {
 	YYCTYPE yych;
 	unsigned int yyaccept = 0;
@@ -3550,7 +3569,7 @@ regular:
 yy188:
 	++this->current;
 yy189:
-#line 296 "jxc/src/jxc_lexer_gen.re"
+#line 315 "jxc/src/jxc_lexer_gen.re"
 	{
         if (this->current >= this->limit)
         {
@@ -3561,7 +3580,7 @@ yy189:
             set_error_msg("Invalid syntax"); return TokenType::Invalid;
         }
     }
-#line 3565 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3584 "jxc/src/jxc_lexer_gen.re.cpp"
 yy190:
 	yych = *++this->current;
 	switch (yych) {
@@ -3570,9 +3589,9 @@ yy190:
 		default: goto yy191;
 	}
 yy191:
-#line 293 "jxc/src/jxc_lexer_gen.re"
+#line 312 "jxc/src/jxc_lexer_gen.re"
 	{ goto regular; }
-#line 3576 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3595 "jxc/src/jxc_lexer_gen.re.cpp"
 yy192:
 	yyaccept = 0;
 	yych = *(this->marker = ++this->current);
@@ -3584,24 +3603,24 @@ yy192:
 		default: goto yy193;
 	}
 yy193:
-#line 294 "jxc/src/jxc_lexer_gen.re"
+#line 313 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::LineBreak; }
-#line 3590 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3609 "jxc/src/jxc_lexer_gen.re.cpp"
 yy194:
 	++this->current;
-#line 254 "jxc/src/jxc_lexer_gen.re"
+#line 273 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::ExclamationPoint; }
-#line 3595 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3614 "jxc/src/jxc_lexer_gen.re.cpp"
 yy195:
 	++this->current;
-#line 277 "jxc/src/jxc_lexer_gen.re"
+#line 296 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_string(out_error.message, this->current[-1], out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::String; } else { set_error(); return TokenType::Invalid; } }
-#line 3600 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3619 "jxc/src/jxc_lexer_gen.re.cpp"
 yy196:
 	++this->current;
-#line 261 "jxc/src/jxc_lexer_gen.re"
+#line 280 "jxc/src/jxc_lexer_gen.re"
 	{ scan_comment(1, out_token_value); get_token_pos(out_start_idx, out_end_idx); return TokenType::Comment; }
-#line 3605 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3624 "jxc/src/jxc_lexer_gen.re.cpp"
 yy197:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -3685,24 +3704,24 @@ yy198:
 		default: goto yy199;
 	}
 yy199:
-#line 291 "jxc/src/jxc_lexer_gen.re"
+#line 310 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Identifier; }
-#line 3691 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3710 "jxc/src/jxc_lexer_gen.re.cpp"
 yy200:
 	++this->current;
-#line 258 "jxc/src/jxc_lexer_gen.re"
+#line 277 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Ampersand; }
-#line 3696 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3715 "jxc/src/jxc_lexer_gen.re.cpp"
 yy201:
 	++this->current;
-#line 269 "jxc/src/jxc_lexer_gen.re"
+#line 288 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); ++expr_paren_depth; return TokenType::ParenOpen; }
-#line 3701 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3720 "jxc/src/jxc_lexer_gen.re.cpp"
 yy202:
 	++this->current;
-#line 270 "jxc/src/jxc_lexer_gen.re"
+#line 289 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); --expr_paren_depth; if (expr_paren_depth < 0) { set_error_msg("Unmatched parentheses"); return TokenType::Invalid; } else { return TokenType::ParenClose; } }
-#line 3706 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3725 "jxc/src/jxc_lexer_gen.re.cpp"
 yy203:
 	yyaccept = 2;
 	yych = *(this->marker = ++this->current);
@@ -3781,9 +3800,9 @@ yy203:
 		default: goto yy204;
 	}
 yy204:
-#line 255 "jxc/src/jxc_lexer_gen.re"
+#line 274 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Asterisk; }
-#line 3787 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3806 "jxc/src/jxc_lexer_gen.re.cpp"
 yy205:
 	yyaccept = 3;
 	yych = *(this->marker = ++this->current);
@@ -3803,14 +3822,14 @@ yy205:
 	}
 yy206:
 	++this->current;
-#line 244 "jxc/src/jxc_lexer_gen.re"
+#line 263 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Comma; }
-#line 3809 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3828 "jxc/src/jxc_lexer_gen.re.cpp"
 yy207:
 	++this->current;
-#line 245 "jxc/src/jxc_lexer_gen.re"
+#line 264 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Period; }
-#line 3814 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3833 "jxc/src/jxc_lexer_gen.re.cpp"
 yy208:
 	yyaccept = 4;
 	yych = *(this->marker = ++this->current);
@@ -3826,9 +3845,9 @@ yy208:
 		default: goto yy209;
 	}
 yy209:
-#line 288 "jxc/src/jxc_lexer_gen.re"
+#line 307 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 3832 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3851 "jxc/src/jxc_lexer_gen.re.cpp"
 yy210:
 	yyaccept = 4;
 	yych = *(this->marker = ++this->current);
@@ -3852,39 +3871,39 @@ yy210:
 	}
 yy211:
 	++this->current;
-#line 242 "jxc/src/jxc_lexer_gen.re"
+#line 261 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Colon; }
-#line 3858 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3877 "jxc/src/jxc_lexer_gen.re.cpp"
 yy212:
 	++this->current;
-#line 250 "jxc/src/jxc_lexer_gen.re"
+#line 269 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); ++angle_bracket_depth; return TokenType::AngleBracketOpen; }
-#line 3863 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3882 "jxc/src/jxc_lexer_gen.re.cpp"
 yy213:
 	++this->current;
-#line 243 "jxc/src/jxc_lexer_gen.re"
+#line 262 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Equals; }
-#line 3868 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3887 "jxc/src/jxc_lexer_gen.re.cpp"
 yy214:
 	++this->current;
-#line 251 "jxc/src/jxc_lexer_gen.re"
+#line 270 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); --angle_bracket_depth; if (angle_bracket_depth < 0) { set_error_msg("Unmatched angle brackets"); return TokenType::Invalid; } else { return TokenType::AngleBracketClose; } }
-#line 3873 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3892 "jxc/src/jxc_lexer_gen.re.cpp"
 yy215:
 	++this->current;
-#line 256 "jxc/src/jxc_lexer_gen.re"
+#line 275 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::QuestionMark; }
-#line 3878 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3897 "jxc/src/jxc_lexer_gen.re.cpp"
 yy216:
 	++this->current;
-#line 248 "jxc/src/jxc_lexer_gen.re"
+#line 267 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::SquareBracketOpen; }
-#line 3883 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3902 "jxc/src/jxc_lexer_gen.re.cpp"
 yy217:
 	++this->current;
-#line 249 "jxc/src/jxc_lexer_gen.re"
+#line 268 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::SquareBracketClose; }
-#line 3888 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3907 "jxc/src/jxc_lexer_gen.re.cpp"
 yy218:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -3938,19 +3957,19 @@ yy224:
 	}
 yy225:
 	++this->current;
-#line 246 "jxc/src/jxc_lexer_gen.re"
+#line 265 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::BraceOpen; }
-#line 3944 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3963 "jxc/src/jxc_lexer_gen.re.cpp"
 yy226:
 	++this->current;
-#line 257 "jxc/src/jxc_lexer_gen.re"
+#line 276 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Pipe; }
-#line 3949 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3968 "jxc/src/jxc_lexer_gen.re.cpp"
 yy227:
 	++this->current;
-#line 247 "jxc/src/jxc_lexer_gen.re"
+#line 266 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::BraceClose; }
-#line 3954 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 3973 "jxc/src/jxc_lexer_gen.re.cpp"
 yy228:
 	yych = *++this->current;
 	switch (yych) {
@@ -4129,9 +4148,9 @@ yy233:
 yy234:
 	++this->current;
 	this->current = this->ctxmarker;
-#line 283 "jxc/src/jxc_lexer_gen.re"
+#line 302 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Identifier; }
-#line 4135 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4154 "jxc/src/jxc_lexer_gen.re.cpp"
 yy235:
 	yych = *++this->current;
 	switch (yych) {
@@ -4331,9 +4350,9 @@ yy247:
 	}
 yy248:
 	++this->current;
-#line 273 "jxc/src/jxc_lexer_gen.re"
+#line 292 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_raw_string(out_error.message, this->current[-1], out_token_value, out_string_delim)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::String; } else { set_error(); return TokenType::Invalid; } }
-#line 4337 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4356 "jxc/src/jxc_lexer_gen.re.cpp"
 yy249:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -4548,9 +4567,9 @@ yy259:
 		default: goto yy260;
 	}
 yy260:
-#line 276 "jxc/src/jxc_lexer_gen.re"
+#line 295 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_datetime_string(out_error.message, out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::DateTime; } else { set_error(); return TokenType::Invalid; } }
-#line 4554 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4573 "jxc/src/jxc_lexer_gen.re.cpp"
 yy261:
 	yyaccept = 5;
 	yych = *(this->marker = ++this->current);
@@ -4654,9 +4673,9 @@ yy263:
 		default: goto yy264;
 	}
 yy264:
-#line 287 "jxc/src/jxc_lexer_gen.re"
+#line 306 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 4660 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4679 "jxc/src/jxc_lexer_gen.re.cpp"
 yy265:
 	yyaccept = 7;
 	yych = *(this->marker = ++this->current);
@@ -4735,9 +4754,9 @@ yy265:
 		default: goto yy266;
 	}
 yy266:
-#line 286 "jxc/src/jxc_lexer_gen.re"
+#line 305 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Number; }
-#line 4741 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4760 "jxc/src/jxc_lexer_gen.re.cpp"
 yy267:
 	yyaccept = 1;
 	yych = *(this->marker = ++this->current);
@@ -4831,9 +4850,9 @@ yy271:
 		default: goto yy272;
 	}
 yy272:
-#line 274 "jxc/src/jxc_lexer_gen.re"
+#line 293 "jxc/src/jxc_lexer_gen.re"
 	{ if (scan_base64_string(out_error.message, out_token_value)) { get_token_pos(out_start_idx, out_end_idx); return TokenType::ByteString; } else { set_error(); return TokenType::Invalid; } }
-#line 4837 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 4856 "jxc/src/jxc_lexer_gen.re.cpp"
 yy273:
 	yych = *++this->current;
 	switch (yych) {
@@ -4983,9 +5002,9 @@ yy278:
 		default: goto yy279;
 	}
 yy279:
-#line 266 "jxc/src/jxc_lexer_gen.re"
+#line 285 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Null; }
-#line 4989 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5008 "jxc/src/jxc_lexer_gen.re.cpp"
 yy280:
 	yyaccept = 9;
 	yych = *(this->marker = ++this->current);
@@ -5068,9 +5087,9 @@ yy280:
 		default: goto yy281;
 	}
 yy281:
-#line 264 "jxc/src/jxc_lexer_gen.re"
+#line 283 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::True; }
-#line 5074 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5093 "jxc/src/jxc_lexer_gen.re.cpp"
 yy282:
 	yych = *++this->current;
 	switch (yych) {
@@ -5255,9 +5274,9 @@ yy286:
 		default: goto yy287;
 	}
 yy287:
-#line 265 "jxc/src/jxc_lexer_gen.re"
+#line 284 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::False; }
-#line 5261 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5280 "jxc/src/jxc_lexer_gen.re.cpp"
 yy288:
 	yych = *++this->current;
 	switch (yych) {
@@ -5271,9 +5290,9 @@ yy288:
 yy289:
 	++this->current;
 	this->current = this->ctxmarker;
-#line 282 "jxc/src/jxc_lexer_gen.re"
+#line 301 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::Null; }
-#line 5277 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5296 "jxc/src/jxc_lexer_gen.re.cpp"
 yy290:
 	yych = *++this->current;
 	switch (yych) {
@@ -5287,9 +5306,9 @@ yy290:
 yy291:
 	++this->current;
 	this->current = this->ctxmarker;
-#line 280 "jxc/src/jxc_lexer_gen.re"
+#line 299 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::True; }
-#line 5293 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5312 "jxc/src/jxc_lexer_gen.re.cpp"
 yy292:
 	yych = *++this->current;
 	switch (yych) {
@@ -5402,9 +5421,9 @@ yy295:
 yy296:
 	++this->current;
 	this->current = this->ctxmarker;
-#line 281 "jxc/src/jxc_lexer_gen.re"
+#line 300 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::False; }
-#line 5408 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 5427 "jxc/src/jxc_lexer_gen.re.cpp"
 yy297:
 	yych = *++this->current;
 	switch (yych) {
@@ -6149,9 +6168,9 @@ yy320:
 	}
 yy321:
 	++this->current;
-#line 275 "jxc/src/jxc_lexer_gen.re"
+#line 294 "jxc/src/jxc_lexer_gen.re"
 	{ set_token(); return TokenType::DateTime; }
-#line 6155 "jxc/src/jxc_lexer_gen.re.cpp"
+#line 6174 "jxc/src/jxc_lexer_gen.re.cpp"
 yy322:
 	yych = *++this->current;
 	switch (yych) {
@@ -7138,7 +7157,7 @@ yy380:
 		default: goto yy229;
 	}
 }
-#line 307 "jxc/src/jxc_lexer_gen.re"
+#line 326 "jxc/src/jxc_lexer_gen.re"
 
 
 end_of_stream:
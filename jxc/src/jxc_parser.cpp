@@ -1,5 +1,19 @@
 #include "jxc/jxc_parser.h"
+#include "jxc/jxc_simd.h"
 #include "fastfloat.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <istream>
+#include <limits>
+#include <mutex>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -29,49 +43,276 @@ const char* element_type_to_string(ElementType type)
 }
 
 
+void ParseStats::reset()
+{
+    element_counts.fill(0);
+    max_depth = 0;
+    string_bytes = 0;
+    num_strings_with_escapes = 0;
+    num_annotations = 0;
+    annotation_hashes.clear();
+    num_number_suffixes = 0;
+    value_heap_allocations = 0;
+    value_heap_bytes = 0;
+}
+
+
+void ParseStats::merge(const ParseStats& rhs)
+{
+    for (size_t i = 0; i < num_element_types; i++)
+    {
+        element_counts[i] += rhs.element_counts[i];
+    }
+    max_depth = std::max(max_depth, rhs.max_depth);
+    string_bytes += rhs.string_bytes;
+    num_strings_with_escapes += rhs.num_strings_with_escapes;
+    num_annotations += rhs.num_annotations;
+    annotation_hashes.insert(rhs.annotation_hashes.begin(), rhs.annotation_hashes.end());
+    num_number_suffixes += rhs.num_number_suffixes;
+    value_heap_allocations += rhs.value_heap_allocations;
+    value_heap_bytes += rhs.value_heap_bytes;
+}
+
+
+std::string ParseStats::to_string() const
+{
+    size_t total_elements = 0;
+    std::string element_counts_str;
+    for (size_t i = 0; i < num_element_types; i++)
+    {
+        if (element_counts[i] == 0)
+        {
+            continue;
+        }
+        total_elements += element_counts[i];
+        if (element_counts_str.size() > 0)
+        {
+            element_counts_str += ", ";
+        }
+        element_counts_str += jxc::format("{}: {}", element_type_to_string(static_cast<ElementType>(i)), element_counts[i]);
+    }
+
+    std::string result = jxc::format("Elements: {} ({})\n", total_elements, element_counts_str);
+    result += jxc::format("Max depth: {}\n", max_depth);
+    result += jxc::format("Strings: {} bytes, {} with escapes\n", string_bytes, num_strings_with_escapes);
+    result += jxc::format("Annotations: {} ({} unique)\n", num_annotations, get_num_unique_annotations());
+    result += jxc::format("Number suffixes: {}\n", num_number_suffixes);
+    result += jxc::format("Value heap: {} allocations, {} bytes\n", value_heap_allocations, value_heap_bytes);
+    return result;
+}
+
+
 #if JXC_ENABLE_JUMP_BLOCK_PROFILER
+
+// Every block the profiler times. Blocks get integer IDs at compile time, so recording a timing is just an array index.
+#define JP_PROFILER_BLOCKS(X) \
+    X(next) \
+    X(jp_top) \
+    X(jp_value_with_annotation) \
+    X(jp_value_without_annotation) \
+    X(jp_arraybegin) \
+    X(jp_arrayvalue) \
+    X(jp_arrayend) \
+    X(jp_exprbegin) \
+    X(jp_expritem) \
+    X(jp_exprend) \
+    X(jp_objectbegin) \
+    X(jp_objectkey) \
+    X(jp_objectvalue) \
+    X(jp_objectend) \
+    X(advance_separator)
+
+enum JumpBlockId : uint8_t
+{
+#define JP_PROFILER_BLOCK_ID(NAME) JB_ ## NAME,
+    JP_PROFILER_BLOCKS(JP_PROFILER_BLOCK_ID)
+#undef JP_PROFILER_BLOCK_ID
+    JB_COUNT,
+};
+
+static constexpr const char* jump_block_names[JB_COUNT] = {
+#define JP_PROFILER_BLOCK_NAME(NAME) #NAME,
+    JP_PROFILER_BLOCKS(JP_PROFILER_BLOCK_NAME)
+#undef JP_PROFILER_BLOCK_NAME
+};
+
 struct BlockProfilerInfo
 {
-    int32_t num_runs = 0;
+    int64_t num_runs = 0;
     int64_t total_duration_ns = 0;
     size_t max_stack_depth = 0;
 };
 
-static std::unordered_map<std::string, BlockProfilerInfo> s_block_profiler_data;
+struct BlockTraceEvent
+{
+    int64_t start_ns = 0;
+    int64_t duration_ns = 0;
+    uint32_t stack_depth = 0;
+    JumpBlockId block = JB_COUNT;
+};
+
+// Each thread only records a limited number of trace events, so that profiling a long-running server doesn't use unbounded memory
+static constexpr size_t max_trace_events_per_thread = 1 << 20;
+
+// Trace capture is off by default, so timing blocks only pays for updating the per-block totals
+static std::atomic<bool> profiler_trace_enabled{ false };
+
+// Timings recorded by a single thread. Only the owning thread writes to it, and it holds the mutex for the duration of its outermost
+// timed block, so other threads can read or reset it without blocking the owner for longer than one parser call.
+struct ThreadBlockProfile
+{
+    std::mutex mutex;
+    size_t thread_index = 0;
+    size_t num_open_blocks = 0;
+    bool trace_enabled = false; // sampled at the start of each outermost timed block
+    std::array<BlockProfilerInfo, JB_COUNT> blocks;
+    std::vector<BlockTraceEvent> trace_events;
+    size_t num_dropped_trace_events = 0;
+};
+
+struct BlockProfilerRegistry
+{
+    std::mutex mutex;
+
+    // profiles of running threads
+    std::vector<std::shared_ptr<ThreadBlockProfile>> threads;
+    size_t next_thread_index = 0;
+
+    // When a thread exits, its timings are folded into these totals and its profile (including the trace buffer) is freed,
+    // so short-lived worker threads don't pile up memory. Trace events from exited threads are not kept.
+    std::array<BlockProfilerInfo, JB_COUNT> retired_totals;
+    size_t num_retired_threads = 0;
+
+    void retire_thread(const ThreadBlockProfile* profile)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto iter = threads.begin(); iter != threads.end(); ++iter)
+        {
+            if (iter->get() != profile)
+            {
+                continue;
+            }
+
+            bool has_data = false;
+            for (size_t i = 0; i < JB_COUNT; i++)
+            {
+                const BlockProfilerInfo& info = profile->blocks[i];
+                retired_totals[i].num_runs += info.num_runs;
+                retired_totals[i].total_duration_ns += info.total_duration_ns;
+                retired_totals[i].max_stack_depth = std::max(retired_totals[i].max_stack_depth, info.max_stack_depth);
+                has_data = has_data || info.num_runs > 0;
+            }
+            if (has_data)
+            {
+                ++num_retired_threads;
+            }
+            threads.erase(iter);
+            return;
+        }
+    }
+
+    // caller must hold the registry mutex
+    template<typename Func>
+    void for_each_thread(Func&& func)
+    {
+        for (auto& profile : threads)
+        {
+            std::lock_guard<std::mutex> profile_lock(profile->mutex);
+            func(*profile);
+        }
+    }
+};
+
+static BlockProfilerRegistry& get_block_profiler_registry()
+{
+    static BlockProfilerRegistry registry;
+    return registry;
+}
+
+// Registers the calling thread's profile on first use, and retires it when the thread exits
+struct ThreadBlockProfileOwner
+{
+    std::shared_ptr<ThreadBlockProfile> profile;
+
+    ThreadBlockProfileOwner()
+        : profile(std::make_shared<ThreadBlockProfile>())
+    {
+        BlockProfilerRegistry& registry = get_block_profiler_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        profile->thread_index = registry.next_thread_index++;
+        registry.threads.push_back(profile);
+    }
+
+    ~ThreadBlockProfileOwner()
+    {
+        get_block_profiler_registry().retire_thread(profile.get());
+    }
+
+    ThreadBlockProfileOwner(const ThreadBlockProfileOwner&) = delete;
+    ThreadBlockProfileOwner& operator=(const ThreadBlockProfileOwner&) = delete;
+};
+
+static ThreadBlockProfile& get_thread_block_profile()
+{
+    // the registry is constructed first, so it outlives the main thread's thread_local owner
+    get_block_profiler_registry();
+    thread_local ThreadBlockProfileOwner owner;
+    return *owner.profile;
+}
 
 struct JumpParserProfiler
 {
-    detail::Timer timer;
-    std::string block_name;
+    ThreadBlockProfile& profile;
+    std::chrono::steady_clock::time_point start;
     size_t stack_depth = 0;
+    JumpBlockId block = JB_COUNT;
 
-    explicit JumpParserProfiler(const char* in_block_name, const char* in_context = nullptr, size_t stack_depth = 0)
-        : block_name((in_context != nullptr) ? jxc::format("{}.{}", in_block_name, in_context) : std::string(in_block_name))
+    JumpParserProfiler(JumpBlockId block, size_t stack_depth)
+        : profile(get_thread_block_profile())
         , stack_depth(stack_depth)
+        , block(block)
     {
-        timer.reset();
+        if (profile.num_open_blocks++ == 0)
+        {
+            profile.mutex.lock();
+            profile.trace_enabled = profiler_trace_enabled.load(std::memory_order_relaxed);
+            if (profile.trace_enabled && profile.trace_events.capacity() == 0)
+            {
+                // allocate the whole trace buffer up front, so growing it doesn't show up in the timings
+                profile.trace_events.reserve(max_trace_events_per_thread);
+            }
+        }
+        start = std::chrono::steady_clock::now();
     }
 
     ~JumpParserProfiler()
     {
-        const int64_t runtime_ns = timer.elapsed().count();
-        auto iter = s_block_profiler_data.find(block_name);
-        BlockProfilerInfo* info = nullptr;
-        if (iter != s_block_profiler_data.end())
+        const int64_t runtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        BlockProfilerInfo& info = profile.blocks[block];
+        info.num_runs++;
+        info.total_duration_ns += runtime_ns;
+        if (stack_depth > info.max_stack_depth)
         {
-            info = &iter->second;
+            info.max_stack_depth = stack_depth;
         }
-        else
+
+        if (profile.trace_enabled)
         {
-            s_block_profiler_data.insert({ block_name, BlockProfilerInfo{} });
-            info = &s_block_profiler_data[block_name];
+            if (profile.trace_events.size() < max_trace_events_per_thread)
+            {
+                profile.trace_events.push_back(BlockTraceEvent{
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count(),
+                    runtime_ns, static_cast<uint32_t>(stack_depth), block });
+            }
+            else
+            {
+                ++profile.num_dropped_trace_events;
+            }
         }
 
-        info->num_runs++;
-        info->total_duration_ns += runtime_ns;
-        if (stack_depth > info->max_stack_depth)
+        if (--profile.num_open_blocks == 0)
         {
-            info->max_stack_depth = stack_depth;
+            profile.mutex.unlock();
         }
     }
 
@@ -86,7 +327,36 @@ struct JumpParserProfiler
 void JumpParser::reset_profiler()
 {
 #if JXC_ENABLE_JUMP_BLOCK_PROFILER
-    s_block_profiler_data.clear();
+    BlockProfilerRegistry& registry = get_block_profiler_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.retired_totals.fill(BlockProfilerInfo{});
+    registry.num_retired_threads = 0;
+    registry.for_each_thread([](ThreadBlockProfile& profile)
+    {
+        profile.blocks.fill(BlockProfilerInfo{});
+        profile.trace_events.clear();
+        profile.num_dropped_trace_events = 0;
+    });
+#endif
+}
+
+
+void JumpParser::set_profiler_trace_enabled(bool enabled)
+{
+#if JXC_ENABLE_JUMP_BLOCK_PROFILER
+    profiler_trace_enabled.store(enabled, std::memory_order_relaxed);
+#else
+    (void)enabled;
+#endif
+}
+
+
+bool JumpParser::is_profiler_trace_enabled()
+{
+#if JXC_ENABLE_JUMP_BLOCK_PROFILER
+    return profiler_trace_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
 #endif
 }
 
@@ -94,42 +364,157 @@ void JumpParser::reset_profiler()
 #if JXC_ENABLE_JUMP_BLOCK_PROFILER
 std::string JumpParser::get_profiler_results(bool sort_by_runtime)
 {
-    std::vector<std::string> sorted_keys;
-    for (const auto& pair: s_block_profiler_data)
+    BlockProfilerRegistry& registry = get_block_profiler_registry();
+    std::unique_lock<std::mutex> registry_lock(registry.mutex);
+    std::array<BlockProfilerInfo, JB_COUNT> totals = registry.retired_totals;
+    size_t num_threads = registry.num_retired_threads;
+    registry.for_each_thread([&](ThreadBlockProfile& profile)
+    {
+        bool has_data = false;
+        for (size_t i = 0; i < JB_COUNT; i++)
+        {
+            const BlockProfilerInfo& info = profile.blocks[i];
+            totals[i].num_runs += info.num_runs;
+            totals[i].total_duration_ns += info.total_duration_ns;
+            totals[i].max_stack_depth = std::max(totals[i].max_stack_depth, info.max_stack_depth);
+            has_data = has_data || info.num_runs > 0;
+        }
+        if (has_data)
+        {
+            ++num_threads;
+        }
+    });
+    registry_lock.unlock();
+
+    std::vector<size_t> sorted_blocks;
+    for (size_t i = 0; i < JB_COUNT; i++)
     {
-        sorted_keys.push_back(pair.first);
+        if (totals[i].num_runs > 0)
+        {
+            sorted_blocks.push_back(i);
+        }
     }
 
     if (sort_by_runtime)
     {
-        std::sort(sorted_keys.begin(), sorted_keys.end(),
-            [](const std::string& a, const std::string& b)
-            {
-                return s_block_profiler_data[a].total_duration_ns > s_block_profiler_data[b].total_duration_ns;
-            });
+        std::stable_sort(sorted_blocks.begin(), sorted_blocks.end(), [&totals](size_t a, size_t b)
+        {
+            return totals[a].total_duration_ns > totals[b].total_duration_ns;
+        });
     }
     else
     {
-        std::sort(sorted_keys.begin(), sorted_keys.end());
+        std::sort(sorted_blocks.begin(), sorted_blocks.end(), [](size_t a, size_t b)
+        {
+            return std::string_view(jump_block_names[a]) < std::string_view(jump_block_names[b]);
+        });
     }
 
-    std::ostringstream ss;
+    std::vector<std::array<std::string, 5>> rows;
+    rows.push_back({ "block", "calls", "total_runtime_ms", "avg_runtime_ns", "max_stack_depth" });
+    for (size_t block : sorted_blocks)
+    {
+        const BlockProfilerInfo& info = totals[block];
+        rows.push_back({
+            jump_block_names[block],
+            jxc::format("{}", info.num_runs),
+            jxc::format("{:.3f}", detail::Timer::ns_to_ms(info.total_duration_ns)),
+            jxc::format("{}", info.total_duration_ns / info.num_runs),
+            jxc::format("{}", info.max_stack_depth),
+        });
+    }
 
-    for (const std::string& key : sorted_keys)
+    std::array<size_t, 5> col_widths = {};
+    for (const auto& row : rows)
     {
-        const BlockProfilerInfo& info = s_block_profiler_data[key];
-        ss << jxc::format("{}: calls: {}, total_runtime: {}ns (avg runtime per call: {}ns), max_stack_depth: {}\n",
-            key,
-            info.num_runs,
-            info.total_duration_ns, //detail::Timer::ns_to_ms(info.total_duration_ns),
-            (info.num_runs > 0) ? (info.total_duration_ns / info.num_runs) : 0,
-            info.max_stack_depth);
+        for (size_t col = 0; col < row.size(); col++)
+        {
+            col_widths[col] = std::max(col_widths[col], row[col].size());
+        }
+    }
+
+    // block names are left-aligned, numbers are right-aligned
+    std::string result;
+    for (const auto& row : rows)
+    {
+        for (size_t col = 0; col < row.size(); col++)
+        {
+            const std::string padding(col_widths[col] - row[col].size(), ' ');
+            if (col == 0)
+            {
+                result += row[col];
+                result += padding;
+            }
+            else
+            {
+                result += "  ";
+                result += padding;
+                result += row[col];
+            }
+        }
+        result += '\n';
     }
+    result += jxc::format("({} thread{})\n", num_threads, (num_threads == 1) ? "" : "s");
+    return result;
+}
 
-    return ss.str();
+
+std::string JumpParser::get_profiler_trace_json()
+{
+    struct ThreadEvents
+    {
+        size_t thread_index = 0;
+        std::vector<BlockTraceEvent> events;
+        size_t num_dropped_events = 0;
+    };
+
+    // copy the events out so the parsing threads aren't blocked while we format them
+    std::vector<ThreadEvents> threads;
+    int64_t first_event_ns = std::numeric_limits<int64_t>::max();
+    BlockProfilerRegistry& registry = get_block_profiler_registry();
+    std::unique_lock<std::mutex> registry_lock(registry.mutex);
+    registry.for_each_thread([&](ThreadBlockProfile& profile)
+    {
+        if (profile.trace_events.size() > 0)
+        {
+            threads.push_back(ThreadEvents{ profile.thread_index, profile.trace_events, profile.num_dropped_trace_events });
+            for (const BlockTraceEvent& evt : profile.trace_events)
+            {
+                first_event_ns = std::min(first_event_ns, evt.start_ns);
+            }
+        }
+    });
+    registry_lock.unlock();
+
+    // Chrome trace event format (https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU),
+    // which can be opened in chrome://tracing or https://ui.perfetto.dev. Timestamps are in microseconds.
+    std::string result = "{\"traceEvents\":[\n";
+    bool first = true;
+    // (jxc::format doesn't support escaped close braces, so the braces are appended separately)
+    for (const ThreadEvents& thread : threads)
+    {
+        result += first ? "{" : ",\n{";
+        result += jxc::format("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":", thread.thread_index);
+        result += "{";
+        result += jxc::format("\"name\":\"jxc thread {}\",\"dropped_events\":{}", thread.thread_index, thread.num_dropped_events);
+        result += "}}";
+        first = false;
+        for (const BlockTraceEvent& evt : thread.events)
+        {
+            result += ",\n{";
+            result += jxc::format("\"name\":\"{}\",\"cat\":\"jxc\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":",
+                jump_block_names[evt.block], thread.thread_index, (double)(evt.start_ns - first_event_ns) / 1000.0, (double)evt.duration_ns / 1000.0);
+            result += "{";
+            result += jxc::format("\"stack_depth\":{}", evt.stack_depth);
+            result += "}}";
+        }
+    }
+    result += "\n]}\n";
+    return result;
 }
 #else
 std::string JumpParser::get_profiler_results(bool) { return std::string{}; }
+std::string JumpParser::get_profiler_trace_json() { return std::string{}; }
 #endif
 
 #define JP_PASTE(A, B) A ## B
@@ -148,16 +533,14 @@ std::string JumpParser::get_profiler_results(bool) { return std::string{}; }
 #define JP_ERRORF(FMT_STRING, ...) do { error = JP_MAKE_ERRORF(FMT_STRING, __VA_ARGS__); goto jp_end; } while(0)
 
 #if JXC_ENABLE_JUMP_BLOCK_PROFILER
-#define JP_BLOCK_TIMER() JumpParserProfiler JP_CONCAT(_block_profiler_, __LINE__) { cur_jump_block_name, nullptr, jump_stack.size() }
-#define JP_BLOCK_TIMER_CTX(CTX_NAME) JumpParserProfiler JP_CONCAT(_block_profiler_, __LINE__) { cur_jump_block_name, #CTX_NAME, jump_stack.size() }
+#define JP_BLOCK_TIMER(NAME) JumpParserProfiler JP_CONCAT(_block_profiler_, __LINE__) { JB_ ## NAME, jump_stack.size() }
 #else
-#define JP_BLOCK_TIMER()
-#define JP_BLOCK_TIMER_CTX(CTX_NAME)
+#define JP_BLOCK_TIMER(NAME)
 #endif
 
 bool JumpParser::lexer_advance_separator(TokenType container_close_type, const char* cur_jump_block_name)
 {
-    JP_BLOCK_TIMER_CTX(advance_separator);
+    JP_BLOCK_TIMER(advance_separator);
     bool found_comma = false;
     int found_linebreaks = 0;
     while (true)
@@ -203,12 +586,268 @@ bool JumpParser::lexer_advance_separator(TokenType container_close_type, const c
 }
 
 
-bool JumpParser::next()
+bool JumpParser::tape_skip_to_container_close()
+{
+    const char* cur_jump_block_name = "skip_to_container_close";
+    const uint8_t* skip_start = lexer.current;
+    const uint32_t offset = static_cast<uint32_t>(skip_start - lexer.start);
+    const uint32_t* tape = structural_index->data();
+    const size_t tape_size = structural_index->size();
+
+    // the lexer has moved on since the last skip, so find where it is on the tape
+    tape_idx = static_cast<size_t>(std::lower_bound(tape + tape_idx, tape + tape_size, offset, [](uint32_t entry, uint32_t target)
+    {
+        return StructuralIndex::entry_offset(entry) < target;
+    }) - tape);
+
+    int64_t depth = 0;
+    for (; tape_idx < tape_size; ++tape_idx)
+    {
+        const uint32_t entry = tape[tape_idx];
+        if (StructuralIndex::entry_is_region_start(entry))
+        {
+            // skip the string or comment's end offset too
+            ++tape_idx;
+            continue;
+        }
+
+        const uint8_t* ptr = lexer.start + StructuralIndex::entry_offset(entry);
+        switch (*ptr)
+        {
+        case '[':
+        case '{':
+        case '(':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+        case ')':
+            if (depth > 0)
+            {
+                --depth;
+                break;
+            }
+            ++tape_idx;
+            lexer.line += detail::simd::count_byte(skip_start, ptr, '\n');
+            lexer.token_start = ptr;
+            lexer.current = ptr + 1;
+            tok.type = (*ptr == ']') ? TokenType::SquareBracketClose : ((*ptr == '}') ? TokenType::BraceClose : TokenType::ParenClose);
+            tok.start_idx = static_cast<size_t>(ptr - lexer.start);
+            tok.end_idx = tok.start_idx + 1;
+            tok.value = FlexString::make_view(std::string_view{ reinterpret_cast<const char*>(ptr), 1 });
+            tok.tag = FlexString::make_view(std::string_view{});
+            return true;
+        default:
+            break;
+        }
+    }
+
+    // the index is complete, so running out of tape means the close bracket is missing
+    lexer.line += detail::simd::count_byte(skip_start, lexer.limit, '\n');
+    lexer.token_start = lexer.current = lexer.limit;
+    tok.reset();
+    tok.type = TokenType::EndOfStream;
+    tok.start_idx = tok.end_idx = static_cast<size_t>(lexer.limit - lexer.start);
+    error = JP_MAKE_ERROR("Unexpected end of stream while skipping value");
+    return false;
+}
+
+
+bool JumpParser::skip_to_container_close()
+{
+    // Expressions and annotations need the lexer's state tracking, so only use the tape if we're outside of both.
+    // The tape can't be used if it's incomplete either, because it stops wherever the index hit something it couldn't handle.
+    if (structural_index != nullptr && structural_index->is_complete() && lexer.expr_paren_depth == 0 && lexer.angle_bracket_depth == 0)
+    {
+        return tape_skip_to_container_close();
+    }
+
+    const char* cur_jump_block_name = "skip_to_container_close";
+    int64_t depth = 0;
+    while (true)
+    {
+        if (!next_token())
+        {
+            if (!error.is_err)
+            {
+                error = JP_MAKE_ERROR("Unexpected end of stream while skipping value");
+            }
+            return false;
+        }
+
+        switch (tok.type)
+        {
+        case TokenType::SquareBracketOpen:
+        case TokenType::BraceOpen:
+        case TokenType::ParenOpen:
+            ++depth;
+            break;
+        case TokenType::SquareBracketClose:
+        case TokenType::BraceClose:
+        case TokenType::ParenClose:
+            if (depth == 0)
+            {
+                return true;
+            }
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+bool JumpParser::skip_to_end_of_container()
+{
+    const char* cur_jump_block_name = "skip_to_end_of_container";
+    if (error.is_err)
+    {
+        return false;
+    }
+    else if (jump_stack.size() == 0)
+    {
+        error = JP_MAKE_ERROR("skip_to_end_of_container() called outside of a container");
+        return false;
+    }
+
+    if (!skip_to_container_close())
+    {
+        current_value.reset();
+        return false;
+    }
+
+    ElementType end_type = ElementType::Invalid;
+    TokenType expected_tok_type = TokenType::Invalid;
+    switch (jump_vars->state)
+    {
+    case JS_Array:
+        end_type = ElementType::EndArray;
+        expected_tok_type = TokenType::SquareBracketClose;
+        break;
+    case JS_Object:
+        end_type = ElementType::EndObject;
+        expected_tok_type = TokenType::BraceClose;
+        break;
+    case JS_Expr:
+        end_type = ElementType::EndExpression;
+        expected_tok_type = TokenType::ParenClose;
+        break;
+    default:
+        break;
+    }
+
+    if (tok.type != expected_tok_type)
+    {
+        error = JP_MAKE_ERRORF("Expected {} to close container, got {}", token_type_to_string(expected_tok_type), token_type_to_string(tok.type));
+        current_value.reset();
+        return false;
+    }
+
+    jump_stack_pop();
+    annotation_buffer.clear();
+    current_value.reset();
+    current_value.type = end_type;
+    current_value.token = tok;
+    return true;
+}
+
+
+bool JumpParser::skip_value()
+{
+    if (error.is_err)
+    {
+        return false;
+    }
+
+    switch (current_value.type)
+    {
+    case ElementType::BeginArray:
+    case ElementType::BeginObject:
+    case ElementType::BeginExpression:
+        return skip_to_end_of_container();
+
+    case ElementType::ObjectKey:
+        // the key's value might be a scalar, in which case reading it is all we need to do
+        if (!next_internal())
+        {
+            if (!error.is_err)
+            {
+                const char* cur_jump_block_name = "skip_value";
+                error = JP_MAKE_ERROR("Unexpected end of stream while skipping value");
+            }
+            return false;
+        }
+        return skip_value();
+
+    default:
+        return true;
+    }
+}
+
+
+void JumpParser::record_element_stats()
+{
+    JXC_DEBUG_ASSERT(stats != nullptr);
+    ParseStats& st = *stats;
+    st.element_counts[static_cast<size_t>(current_value.type)] += 1;
+    st.max_depth = std::max(st.max_depth, jump_stack.size());
+
+    if (current_value.annotation.size() > 0)
+    {
+        st.num_annotations += 1;
+        st.annotation_hashes.insert(current_value.annotation.hash());
+    }
+
+    const Token& value_tok = current_value.token;
+    if (current_value.type != ElementType::String && current_value.type != ElementType::Number && current_value.type != ElementType::ObjectKey)
+    {
+        return;
+    }
+
+    // stats are best-effort, so tokens that fail to split here are just not counted (the parser reports those errors elsewhere)
+    ErrorInfo stats_error;
+    if (value_tok.type == TokenType::String)
+    {
+        std::string_view str_value;
+        bool is_raw = false;
+        if (util::string_token_to_value(value_tok, str_value, is_raw, stats_error))
+        {
+            st.string_bytes += str_value.size();
+            if (!is_raw && util::string_has_escape_chars(str_value))
+            {
+                st.num_strings_with_escapes += 1;
+            }
+        }
+    }
+    else if (value_tok.type == TokenType::Number)
+    {
+        util::NumberTokenSplitResult number;
+        if (util::split_number_token_value(value_tok, number, stats_error) && number.suffix.size() > 0)
+        {
+            st.num_number_suffixes += 1;
+        }
+    }
+}
+
+
+bool JumpParser::validate_utf8()
+{
+    return util::validate_utf8(buffer, error);
+}
+
+
+bool JumpParser::next_internal()
 {
 #if JXC_ENABLE_JUMP_BLOCK_PROFILER
-    JumpParserProfiler _profiler_root_("next()", nullptr, jump_stack.size());
+    JumpParserProfiler _profiler_root_(JB_next, jump_stack.size());
 #endif
 
+    if (error.is_err)
+    {
+        return false;
+    }
+
     const char* cur_jump_block_name = "INVALID";
     tok.reset();
     annotation_buffer.clear();
@@ -273,7 +912,7 @@ JP_MAKE_GOTO(jp_post_parse_dotted_indent):
     // it causes the compiler to complain.
     cur_jump_block_name = "jp_top";
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_top);
         if (jump_stack.size() > 0)
         {
             switch (jump_vars->state)
@@ -315,7 +954,7 @@ JP_MAKE_GOTO(jp_post_parse_dotted_indent):
 
     JP_JUMP_BLOCK_BEGIN(jp_value_with_annotation);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_value_with_annotation);
         // parse annotation first?
         if (tok.type == TokenType::ExclamationPoint || tok.type == TokenType::Identifier)
         {
@@ -449,7 +1088,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_value_without_annotation);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_value_without_annotation);
         // skip over any line breaks before the value
         JP_SKIP_OVER_LINE_BREAKS();
 
@@ -485,7 +1124,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_arraybegin);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_arraybegin);
         JXC_DEBUG_ASSERT(tok.type == TokenType::SquareBracketOpen);
         jump_stack_push(JS_Array);
         JP_YIELD(ElementType::BeginArray);
@@ -494,7 +1133,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_arrayvalue);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_arrayvalue);
         if (jump_vars->container_size <= 0)
         {
             // empty array
@@ -530,7 +1169,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_arrayend);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_arrayend);
         JXC_DEBUG_ASSERT(tok.type == TokenType::SquareBracketClose);
         JXC_DEBUG_ASSERT(jump_vars->state == JS_Array);
         jump_stack_pop();
@@ -540,7 +1179,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_exprbegin);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_exprbegin);
         JXC_DEBUG_ASSERT(tok.type == TokenType::ParenOpen);
         jump_stack_push(JS_Expr);
         jump_vars->paren_depth = 1;
@@ -550,7 +1189,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_expritem);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_expritem);
         switch (tok.type)
         {
         // values
@@ -657,7 +1296,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_exprend);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_exprend);
         JXC_DEBUG_ASSERT(tok.type == TokenType::ParenClose);
         JXC_DEBUG_ASSERT(jump_vars->state == JS_Expr);
         jump_stack_pop();
@@ -667,7 +1306,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_objectbegin);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_objectbegin);
         JXC_DEBUG_ASSERT(tok.type == TokenType::BraceOpen);
         jump_stack_push(JS_Object, OBJ_Key);
         JP_YIELD(ElementType::BeginObject);
@@ -676,7 +1315,7 @@ jp_handle_annotation_type:
 
     JP_JUMP_BLOCK_BEGIN(jp_objectkey);
     {
-        JP_BLOCK_TIMER();
+        JP_BLOCK_TIMER(jp_objectkey);
         if (jump_vars->container_size > 0)
         {
             JP_ADVANCE_SEPARATOR(TokenType::BraceClose);
@@ -686,73 +1325,388 @@ jp_handle_annotation_type:
             }
         }
 
-        // allowed extra line breaks before the key starts
-        JP_SKIP_OVER_LINE_BREAKS();
+        // allowed extra line breaks before the key starts
+        JP_SKIP_OVER_LINE_BREAKS();
+
+        switch (tok.type)
+        {
+        case TokenType::Comment:
+            JP_YIELD(ElementType::Comment);
+        case TokenType::BraceClose:
+            goto jp_objectend;
+        case TokenType::String:
+        case TokenType::Null:
+        case TokenType::Number:
+        case TokenType::True:
+        case TokenType::False:
+        case TokenType::Identifier:
+            jump_vars->container_state = OBJ_Value;
+            JP_YIELD(ElementType::ObjectKey);
+        default:
+            JP_ERROR("Expected object key");
+        }
+    }
+    JP_JUMP_BLOCK_END(jp_objectkey);
+
+    JP_JUMP_BLOCK_BEGIN(jp_objectvalue);
+    {
+        JP_BLOCK_TIMER(jp_objectvalue);
+        JP_SKIP_OVER_LINE_BREAKS();
+
+        if (tok.type == TokenType::Colon)
+        {
+            JP_ADVANCE_SKIP_COMMENTS();
+        }
+        else
+        {
+            JP_ERROR("Expected colon after object key");
+        }
+
+        // line breaks after the colon are allowed
+        JP_SKIP_OVER_LINE_BREAKS();
+
+        // parse the value that goes with this key
+        jump_vars->container_state = OBJ_Key;
+        JP_GOTO_PARSE_VALUE(tok.type, ++(jump_vars->container_size));
+    }
+    JP_JUMP_BLOCK_END(jp_objectvalue);
+
+    JP_JUMP_BLOCK_BEGIN(jp_objectend);
+    {
+        JP_BLOCK_TIMER(jp_objectend);
+        JXC_DEBUG_ASSERT(tok.type == TokenType::BraceClose);
+        JXC_DEBUG_ASSERT(jump_vars->state == JS_Object);
+        jump_stack_pop();
+        JP_YIELD(ElementType::EndObject);
+    }
+    JP_JUMP_BLOCK_END(jp_objectend);
+
+jp_end:
+    current_value.reset();
+    return false;
+
+jp_jump_block_reached_end_without_yield:
+    // should never get here - it's just to check against control flow bugs
+    JP_ERROR("Reached end of jump block unexpectedly");
+
+#undef JP_ADVANCE
+#undef JP_ERROR
+#undef JP_ERRORF
+}
+
+
+void PushParser::rebase_parser(size_t num_bytes_dropped)
+{
+    Lexer& lex = parser.lexer;
+    const uint8_t* old_start = lex.start;
+    const uint8_t* new_start = reinterpret_cast<const uint8_t*>(data.data());
+    auto rebase_ptr = [&](const uint8_t* ptr) -> const uint8_t*
+    {
+        const size_t offset = static_cast<size_t>(ptr - old_start);
+        return new_start + ((offset > num_bytes_dropped) ? (offset - num_bytes_dropped) : 0);
+    };
+
+    lex.token_start = rebase_ptr(lex.token_start);
+    lex.current = rebase_ptr(lex.current);
+    lex.marker = rebase_ptr(lex.marker);
+    lex.ctxmarker = (lex.ctxmarker != nullptr) ? rebase_ptr(lex.ctxmarker) : nullptr;
+    lex.start = new_start;
+    lex.limit = new_start + data.size();
+    parser.buffer = get_buffer();
+
+    // the current element pointed into the old buffer
+    parser.tok.reset();
+    parser.current_value.reset();
+    parser.annotation_buffer.clear();
+}
+
+
+bool PushParser::lexer_stopped_before_end() const
+{
+    // The lexer can read past the end of a token to decide where it ends - through the rest of a run of token chars
+    // (eg. `1e` could still become `1e5`), and through whitespace looking for the `:` after an object key.
+    // If there's anything after both, the lexer's decision didn't depend on input we don't have yet.
+    const uint8_t* ptr = parser.lexer.current;
+    const uint8_t* end = parser.lexer.limit;
+    while (ptr < end && (*ptr >= 0x80 || is_valid_identifier_char(static_cast<char>(*ptr))
+        || *ptr == '.' || *ptr == '+' || *ptr == '-' || *ptr == '%' || *ptr == '*'))
+    {
+        ++ptr;
+    }
+    return ptr < end && detail::simd::skip_whitespace(ptr, end) < end;
+}
+
+
+bool PushParser::error_in_unterminated_string() const
+{
+    // The string scanners look ahead for their closing delimiter (eg. the quote char after the `)` in `b64"( ... )"`), so they can
+    // report an error partway through a string that was really just cut off by the end of the buffer. An error in a string token
+    // only holds once the buffer contains everything the scanner looks at to find the end of the string.
+    const std::string_view buf = get_buffer();
+    size_t idx = parser.get_error().buffer_start_idx;
+    if (idx >= buf.size())
+    {
+        return false;
+    }
+
+    enum StringKind { SK_Plain, SK_Raw, SK_Base64, SK_DateTime };
+    StringKind kind = SK_Plain;
+    if (buf.substr(idx, 3) == "b64")
+    {
+        kind = SK_Base64;
+        idx += 3;
+    }
+    else if (buf.substr(idx, 2) == "dt")
+    {
+        kind = SK_DateTime;
+        idx += 2;
+    }
+    else if (buf[idx] == 'r')
+    {
+        kind = SK_Raw;
+        ++idx;
+    }
+
+    if (idx >= buf.size() || (buf[idx] != '"' && buf[idx] != '\''))
+    {
+        // not a string token
+        return false;
+    }
+    const char quote_char = buf[idx++];
+
+    // returns true if the buffer ends before `str` is found, or right after it (the lexer reads one more char after it)
+    auto missing_end_sequence = [&](std::string_view str, size_t start_idx) -> bool
+    {
+        const size_t end_idx = buf.find(str, start_idx);
+        return end_idx == std::string_view::npos || end_idx + str.size() >= buf.size();
+    };
+
+    switch (kind)
+    {
+    case SK_Raw:
+    {
+        // the lexer scans up to 64 chars for the end of the delimiter
+        const size_t paren_idx = buf.substr(0, idx + 64).find('(', idx);
+        if (paren_idx == std::string_view::npos)
+        {
+            return idx + 64 > buf.size();
+        }
+
+        // the first `){delimiter}` ends the string, but without a delimiter the string only ends at `)"`
+        std::string end_seq = ")";
+        end_seq.append(buf.substr(idx, paren_idx - idx));
+        if (end_seq.size() == 1)
+        {
+            end_seq.push_back(quote_char);
+            return buf.find(end_seq, paren_idx + 1) == std::string_view::npos;
+        }
+        return missing_end_sequence(end_seq, paren_idx + 1);
+    }
+    case SK_Base64:
+        if (idx < buf.size() && buf[idx] == '(')
+        {
+            // multi-line base64 strings end at the first `)`, and the lexer checks that the quote char comes after it
+            return missing_end_sequence(")", idx + 1);
+        }
+        break;
+    default:
+        break;
+    }
+
+    // everything else ends at the closing quote char, and can't contain line breaks
+    for (size_t i = idx; i < buf.size(); i++)
+    {
+        if (buf[i] == quote_char || buf[i] == '\n')
+        {
+            return false;
+        }
+        else if (buf[i] == '\\' && kind == SK_Plain)
+        {
+            ++i;
+        }
+    }
+    return true;
+}
+
+
+void PushParser::feed(std::string_view chunk)
+{
+    // everything before the lexer's position has already been returned from next()
+    const size_t num_consumed = parser.has_error() ? 0 : static_cast<size_t>(parser.lexer.current - parser.lexer.start);
+    if (num_consumed > 0)
+    {
+        data.erase(0, num_consumed);
+        stream_offset += num_consumed;
+    }
+    data.append(chunk.data(), chunk.size());
+    rebase_parser(num_consumed);
+}
+
+
+void PushParser::finish()
+{
+    finished = true;
+    waiting_for_data = false;
+}
+
+
+void PushParser::reset()
+{
+    data.clear();
+    stream_offset = 0;
+    parser.reset(get_buffer());
+    finished = false;
+    waiting_for_data = false;
+}
+
+
+bool PushParser::next()
+{
+    if (finished)
+    {
+        return parser.next();
+    }
+    else if (parser.has_error())
+    {
+        return false;
+    }
+
+    checkpoint.lexer = parser.lexer;
+    checkpoint.stack_depth = parser.jump_stack.size();
+    if (checkpoint.stack_depth > 0)
+    {
+        checkpoint.stack_top = parser.jump_stack.back();
+    }
+
+    const bool success = parser.next();
+    if (lexer_stopped_before_end() && !(parser.has_error() && error_in_unterminated_string()))
+    {
+        waiting_for_data = false;
+        return success;
+    }
+
+    // The element (or the error) might change with more input, so rewind to where this element started and wait for more
+    parser.lexer = checkpoint.lexer;
+    JXC_DEBUG_ASSERT(parser.jump_stack.size() + 1 >= checkpoint.stack_depth && parser.jump_stack.size() <= checkpoint.stack_depth + 1);
+    if (parser.jump_stack.size() > checkpoint.stack_depth)
+    {
+        parser.jump_stack.pop_back();
+    }
+    if (parser.jump_stack.size() < checkpoint.stack_depth)
+    {
+        parser.jump_stack.push_back(checkpoint.stack_top);
+    }
+    else if (checkpoint.stack_depth > 0)
+    {
+        parser.jump_stack.back() = checkpoint.stack_top;
+    }
+    parser.jump_vars = (parser.jump_stack.size() > 0) ? &parser.jump_stack.back() : nullptr;
+    parser.error = ErrorInfo{};
+    parser.tok.reset();
+    parser.current_value.reset();
+    parser.annotation_buffer.clear();
+    waiting_for_data = true;
+    return false;
+}
+
+
+StreamParser::StreamParser(ReadFunc read_func, size_t window_size, size_t max_buffer_size)
+    : read_func(std::move(read_func))
+    , max_buffer_size(max_buffer_size)
+{
+    JXC_ASSERTF(window_size > 0, "StreamParser window size must be greater than zero");
+    JXC_ASSERTF(max_buffer_size >= window_size, "StreamParser max buffer size must be at least the window size");
+    read_buffer.resize(window_size);
+}
+
+
+StreamParser::StreamParser(FILE* fp, size_t window_size, size_t max_buffer_size)
+    : StreamParser([fp](char* out_buffer, size_t size) -> int64_t
+        {
+            const size_t num_read = fread(out_buffer, 1, size, fp);
+            return (num_read == 0 && ferror(fp) != 0) ? -1 : static_cast<int64_t>(num_read);
+        }, window_size, max_buffer_size)
+{
+    JXC_ASSERT(fp != nullptr);
+}
+
 
-        switch (tok.type)
+StreamParser::StreamParser(std::istream& stream, size_t window_size, size_t max_buffer_size)
+    : StreamParser([&stream](char* out_buffer, size_t size) -> int64_t
         {
-        case TokenType::Comment:
-            JP_YIELD(ElementType::Comment);
-        case TokenType::BraceClose:
-            goto jp_objectend;
-        case TokenType::String:
-        case TokenType::Null:
-        case TokenType::Number:
-        case TokenType::True:
-        case TokenType::False:
-        case TokenType::Identifier:
-            jump_vars->container_state = OBJ_Value;
-            JP_YIELD(ElementType::ObjectKey);
-        default:
-            JP_ERROR("Expected object key");
-        }
-    }
-    JP_JUMP_BLOCK_END(jp_objectkey);
+            stream.read(out_buffer, static_cast<std::streamsize>(size));
+            return stream.bad() ? -1 : static_cast<int64_t>(stream.gcount());
+        }, window_size, max_buffer_size)
+{
+}
 
-    JP_JUMP_BLOCK_BEGIN(jp_objectvalue);
+
+// static
+StreamParser::ReadFunc StreamParser::make_fd_reader(int fd)
+{
+    return [fd](char* out_buffer, size_t size) -> int64_t
     {
-        JP_BLOCK_TIMER();
-        JP_SKIP_OVER_LINE_BREAKS();
+#if defined(_WIN32)
+        const int num_read = _read(fd, out_buffer, static_cast<unsigned int>((size < INT32_MAX) ? size : INT32_MAX));
+#else
+        const ssize_t num_read = ::read(fd, out_buffer, size);
+#endif
+        return (num_read < 0) ? -1 : static_cast<int64_t>(num_read);
+    };
+}
 
-        if (tok.type == TokenType::Colon)
+
+bool StreamParser::read_next_chunk()
+{
+    // PushParser starts over from the beginning of an incomplete element each time it gets more input. When an element
+    // spans many windows, read at least as much as is already pending before trying again, so that a large element
+    // gets rescanned a logarithmic number of times instead of once per window.
+    const size_t num_pending_bytes = push_parser.num_pending_bytes();
+    const size_t min_read_size = (num_pending_bytes > read_buffer.size()) ? num_pending_bytes : 0;
+    size_t total_read = 0;
+    do
+    {
+        const int64_t num_read = read_func(read_buffer.data(), read_buffer.size());
+        if (num_read < 0)
+        {
+            read_error = ErrorInfo(jxc::format("Failed reading from stream at offset {}",
+                push_parser.get_buffer_stream_offset() + push_parser.get_buffer().size()));
+            return false;
+        }
+        else if (num_read == 0)
         {
-            JP_ADVANCE_SKIP_COMMENTS();
+            push_parser.finish();
+            return true;
         }
-        else
+
+        push_parser.feed(std::string_view{ read_buffer.data(), static_cast<size_t>(num_read) });
+        if (push_parser.get_buffer().size() > max_buffer_size)
         {
-            JP_ERROR("Expected colon after object key");
+            read_error = ErrorInfo(jxc::format("Element starting at stream offset {} is larger than the max buffer size ({} bytes)",
+                push_parser.get_buffer_stream_offset(), max_buffer_size));
+            return false;
         }
+        total_read += static_cast<size_t>(num_read);
+    } while (total_read < min_read_size);
 
-        // line breaks after the colon are allowed
-        JP_SKIP_OVER_LINE_BREAKS();
+    return true;
+}
 
-        // parse the value that goes with this key
-        jump_vars->container_state = OBJ_Key;
-        JP_GOTO_PARSE_VALUE(tok.type, ++(jump_vars->container_size));
-    }
-    JP_JUMP_BLOCK_END(jp_objectvalue);
 
-    JP_JUMP_BLOCK_BEGIN(jp_objectend);
+bool StreamParser::next()
+{
+    while (!read_error.is_err)
     {
-        JP_BLOCK_TIMER();
-        JXC_DEBUG_ASSERT(tok.type == TokenType::BraceClose);
-        JXC_DEBUG_ASSERT(jump_vars->state == JS_Object);
-        jump_stack_pop();
-        JP_YIELD(ElementType::EndObject);
+        if (push_parser.next())
+        {
+            return true;
+        }
+        else if (!push_parser.needs_more_data() || !read_next_chunk())
+        {
+            return false;
+        }
     }
-    JP_JUMP_BLOCK_END(jp_objectend);
-
-jp_end:
-    current_value.reset();
     return false;
-
-jp_jump_block_reached_end_without_yield:
-    // should never get here - it's just to check against control flow bugs
-    JP_ERROR("Reached end of jump block unexpectedly");
-
-#undef JP_ADVANCE
-#undef JP_ERROR
-#undef JP_ERRORF
 }
 
 
@@ -1086,6 +2040,10 @@ bool split_number_token_value(const Token& number_token, NumberTokenSplitResult&
     out_result.float_type = FloatLiteralType::Finite;
     out_result.sign = '+';
     out_result.exponent = 0;
+    out_result.prefix = std::string_view{};
+    out_result.value = std::string_view{};
+    out_result.value_with_exponent = std::string_view{};
+    out_result.suffix = std::string_view{};
 
     if (number_token.type != TokenType::Number)
     {
@@ -1113,6 +2071,7 @@ bool split_number_token_value(const Token& number_token, NumberTokenSplitResult&
     {
         out_result.prefix = {};
         out_result.value = value;
+        out_result.value_with_exponent = value;
         out_result.suffix = {};
         if (!is_decimal_digit(value[0]))
         {
@@ -1287,6 +2246,7 @@ bool split_number_token_value(const Token& number_token, NumberTokenSplitResult&
     JXC_ASSERT(value_len > 0);
 
     out_result.value = value.substr(0, value_len);
+    out_result.value_with_exponent = value.substr(0, idx);
     out_result.suffix = value.substr(idx);
 
     // if the suffix starts with an underscore, strip it (it's not part of the suffix)
@@ -1310,6 +2270,21 @@ bool split_number_token_value(const Token& number_token, NumberTokenSplitResult&
 }
 
 
+bool validate_utf8(std::string_view buffer, ErrorInfo& out_error)
+{
+    const uint8_t* start = reinterpret_cast<const uint8_t*>(buffer.data());
+    const uint8_t* end = start + buffer.size();
+    const uint8_t* invalid = detail::simd::find_invalid_utf8(start, end);
+    if (invalid < end)
+    {
+        const size_t idx = static_cast<size_t>(invalid - start);
+        out_error = ErrorInfo(jxc::format("Invalid UTF-8 sequence starting with byte {}", detail::debug_char_repr(static_cast<uint32_t>(*invalid))), idx, idx + 1);
+        return false;
+    }
+    return true;
+}
+
+
 bool string_token_to_value(const Token& string_token, std::string_view& out_view, bool& out_is_raw_string, ErrorInfo& out_error)
 {
     out_view = string_token.value.as_view();
@@ -1634,6 +2609,75 @@ bool parse_string_escapes_to_buffer(std::string_view value, size_t token_start_i
 }
 
 
+bool validate_string_escapes(std::string_view value, size_t token_start_idx, size_t token_end_idx, ErrorInfo& out_error)
+{
+    std::string deserialize_hex_error;
+    for (size_t val_idx = value.find('\\'); val_idx != std::string_view::npos; val_idx = value.find('\\', val_idx))
+    {
+        ++val_idx;
+        if (val_idx >= value.size())
+        {
+            out_error = ErrorInfo("Strings can not end with a backslash", token_start_idx, token_end_idx);
+            return false;
+        }
+
+        const char* hex_type = nullptr;
+        size_t req_num_hex_chars = 0;
+        switch (value[val_idx++])
+        {
+        case '0':
+        case 'a':
+        case 'b':
+        case 't':
+        case 'n':
+        case 'v':
+        case 'f':
+        case 'r':
+        case '\"':
+        case '\'':
+        case '\\':
+            // single-character escape
+            break;
+        case 'x':
+            hex_type = "hex";
+            req_num_hex_chars = 2;
+            break;
+        case 'u':
+            hex_type = "utf16";
+            req_num_hex_chars = 4;
+            break;
+        case 'U':
+            hex_type = "utf32";
+            req_num_hex_chars = 8;
+            break;
+        default:
+            out_error = ErrorInfo("Invalid escape sequence", token_start_idx, token_end_idx);
+            return false;
+        }
+
+        if (req_num_hex_chars > 0)
+        {
+            const std::string_view hex_seq = value.substr(val_idx, req_num_hex_chars);
+            if (hex_seq.size() != req_num_hex_chars)
+            {
+                out_error = ErrorInfo(jxc::format("Truncated {} escape sequence", hex_type), token_start_idx, token_end_idx);
+                return false;
+            }
+
+            const uint32_t hex_cp = detail::deserialize_hex_to_codepoint(hex_seq.data(), hex_seq.size(), &deserialize_hex_error);
+            if (hex_cp == 0 && deserialize_hex_error.size() > 0)
+            {
+                out_error = ErrorInfo(jxc::format("Failed deserialized hex characters for {} escape: {}",
+                    hex_type, deserialize_hex_error), token_start_idx, token_end_idx);
+                return false;
+            }
+            val_idx += req_num_hex_chars;
+        }
+    }
+    return true;
+}
+
+
 bool parse_string_token_to_buffer(const Token& string_token, char* out_buffer, size_t buffer_size, size_t& out_num_chars_written, ErrorInfo& out_error)
 {
     out_num_chars_written = 0;
@@ -1988,6 +3032,216 @@ struct DateTimeTokenParser
 };
 
 
+// Describes the expected contents of 8 consecutive chars, for matching fixed-layout datetime strings 8 chars at a time.
+// In the layout string, 'd' means any decimal digit, and anything else is a literal char.
+struct DateTimeChunkLayout
+{
+    uint64_t digit_mask = 0;
+    uint64_t literal_mask = 0;
+    uint64_t literal_value = 0;
+
+    constexpr DateTimeChunkLayout(const char (&layout)[9])
+    {
+        for (size_t i = 0; i < 8; ++i)
+        {
+            const uint64_t byte_mask = static_cast<uint64_t>(0xFF) << (i * 8);
+            if (layout[i] == 'd')
+            {
+                digit_mask |= byte_mask;
+            }
+            else
+            {
+                literal_mask |= byte_mask;
+                literal_value |= static_cast<uint64_t>(static_cast<uint8_t>(layout[i])) << (i * 8);
+            }
+        }
+    }
+};
+
+
+// Checks 8 chars against a layout. On success, out_digits holds the value of each digit in its byte position (and zero everywhere else).
+static JXC_FORCEINLINE bool match_datetime_chunk(const char* ptr, const DateTimeChunkLayout& layout, uint64_t& out_digits)
+{
+    const uint64_t chunk = detail::load_u64_le(ptr);
+    if ((chunk & layout.literal_mask) != layout.literal_value)
+    {
+        return false;
+    }
+
+    // After the xor, digit bytes are 0-9. Adding 0x76 sets the high bit of any byte >= 10, and any byte that already
+    // had its high bit set is caught by or-ing in the original value.
+    const uint64_t digits = (chunk ^ 0x3030303030303030ull) & layout.digit_mask;
+    if ((((digits + (0x7676767676767676ull & layout.digit_mask)) | digits) & 0x8080808080808080ull & layout.digit_mask) != 0)
+    {
+        return false;
+    }
+
+    out_digits = digits;
+    return true;
+}
+
+
+static JXC_FORCEINLINE int32_t datetime_chunk_digit(uint64_t digits, size_t byte_idx)
+{
+    return static_cast<int32_t>((digits >> (byte_idx * 8)) & 0xFF);
+}
+
+
+static JXC_FORCEINLINE int32_t datetime_chunk_two_digits(uint64_t digits, size_t byte_idx)
+{
+    return datetime_chunk_digit(digits, byte_idx) * 10 + datetime_chunk_digit(digits, byte_idx + 1);
+}
+
+
+// Fields read from a fixed-layout datetime string, before they're narrowed into a DateTime.
+// This lets callers that only need a timestamp skip the DateTime entirely.
+struct DateTimeFixedLayoutFields
+{
+    int32_t year = 0;
+    int32_t month = 0;
+    int32_t day = 0;
+    int32_t hour = 0;
+    int32_t minute = 0;
+    int32_t second = 0;
+    uint32_t nanosecond = 0;
+    int32_t tz_hour = 0;
+    int32_t tz_minute = 0;
+    bool tz_local = false;
+    bool has_time = false;
+
+    inline DateTime to_datetime() const
+    {
+        if (!has_time)
+        {
+            return DateTime(static_cast<int16_t>(year), static_cast<int8_t>(month), static_cast<int8_t>(day));
+        }
+        return DateTime(static_cast<int16_t>(year), static_cast<int8_t>(month), static_cast<int8_t>(day),
+            static_cast<int8_t>(hour), static_cast<int8_t>(minute), static_cast<int8_t>(second), nanosecond,
+            static_cast<int8_t>(tz_hour), static_cast<int8_t>(tz_minute), tz_local);
+    }
+
+    // Same result as datetime_to_epoch_seconds(to_datetime())
+    inline int64_t to_epoch_seconds() const
+    {
+        const int64_t days = civil_date_to_epoch_days(year, static_cast<uint32_t>(month), static_cast<uint32_t>(day));
+        int64_t seconds = days * 86400 + static_cast<int64_t>(hour) * 3600 + static_cast<int64_t>(minute) * 60 + static_cast<int64_t>(second);
+        if (!tz_local)
+        {
+            // tz_minute takes the sign of tz_hour
+            seconds -= (static_cast<int64_t>(tz_hour) * 60 + ((tz_hour < 0) ? -tz_minute : tz_minute)) * 60;
+        }
+        return seconds;
+    }
+};
+
+
+// Fast path for the common fixed-width ISO-8601 shapes: `YYYY-MM-DD` and `YYYY-MM-DDTHH:MM:SS(.fraction)(Z|+HH:MM|-HH:MM)`.
+// Returns false without setting an error if the value is not in one of these shapes, in which case the caller should
+// fall back to DateTimeTokenParser (which handles the rest of the syntax and reports errors).
+static bool parse_datetime_fixed_layout(std::string_view value, DateTimeFixedLayoutFields& out_fields)
+{
+    static constexpr DateTimeChunkLayout date_layout("dddd-dd-");
+    static constexpr DateTimeChunkLayout time_layout("ddTdd:dd");
+
+    if (value.size() != 10 && value.size() < 19)
+    {
+        return false;
+    }
+
+    uint64_t date_digits = 0;
+    if (!match_datetime_chunk(value.data(), date_layout, date_digits) || !is_decimal_digit(value[8]) || !is_decimal_digit(value[9]))
+    {
+        return false;
+    }
+
+    out_fields = DateTimeFixedLayoutFields{};
+    out_fields.year = datetime_chunk_two_digits(date_digits, 0) * 100 + datetime_chunk_two_digits(date_digits, 2);
+    out_fields.month = datetime_chunk_two_digits(date_digits, 5);
+    out_fields.day = char_to_int_unchecked(value[8]) * 10 + char_to_int_unchecked(value[9]);
+
+    if (value.size() == 10)
+    {
+        return true;
+    }
+
+    uint64_t time_digits = 0;
+    if (!match_datetime_chunk(value.data() + 8, time_layout, time_digits)
+        || value[16] != ':' || !is_decimal_digit(value[17]) || !is_decimal_digit(value[18]))
+    {
+        return false;
+    }
+
+    out_fields.hour = datetime_chunk_two_digits(time_digits, 3);
+    out_fields.minute = datetime_chunk_two_digits(time_digits, 6);
+    out_fields.second = char_to_int_unchecked(value[17]) * 10 + char_to_int_unchecked(value[18]);
+
+    size_t idx = 19;
+
+    // fractional seconds (1-12 digits), truncated to nanoseconds
+    uint32_t nanosecond = 0;
+    if (idx < value.size() && value[idx] == '.')
+    {
+        ++idx;
+        const size_t frac_start = idx;
+        while (idx < value.size() && is_decimal_digit(value[idx]))
+        {
+            if (idx - frac_start < 9)
+            {
+                nanosecond = nanosecond * 10 + static_cast<uint32_t>(char_to_int_unchecked(value[idx]));
+            }
+            ++idx;
+        }
+
+        const size_t num_digits = idx - frac_start;
+        if (num_digits == 0 || num_digits > 12)
+        {
+            return false;
+        }
+
+        static constexpr uint32_t nanosecond_multipliers[9] = { 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1 };
+        if (num_digits < 9)
+        {
+            nanosecond *= nanosecond_multipliers[num_digits - 1];
+        }
+    }
+
+    int32_t tz_hour = 0;
+    int32_t tz_minute = 0;
+    bool tz_local = false;
+    const size_t tz_len = value.size() - idx;
+    if (tz_len == 0)
+    {
+        tz_local = true;
+    }
+    else if (tz_len == 1 && value[idx] == 'Z')
+    {
+        // explicit UTC
+    }
+    else if (tz_len == 6 && (value[idx] == '+' || value[idx] == '-') && value[idx + 3] == ':'
+        && is_decimal_digit(value[idx + 1]) && is_decimal_digit(value[idx + 2])
+        && is_decimal_digit(value[idx + 4]) && is_decimal_digit(value[idx + 5]))
+    {
+        tz_hour = char_to_int_unchecked(value[idx + 1]) * 10 + char_to_int_unchecked(value[idx + 2]);
+        tz_minute = char_to_int_unchecked(value[idx + 4]) * 10 + char_to_int_unchecked(value[idx + 5]);
+        if (value[idx] == '-')
+        {
+            tz_hour = -tz_hour;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    out_fields.nanosecond = nanosecond;
+    out_fields.tz_hour = tz_hour;
+    out_fields.tz_minute = tz_minute;
+    out_fields.tz_local = tz_local;
+    out_fields.has_time = true;
+    return true;
+}
+
+
 bool parse_date_token(const Token& datetime_token, Date& out_date, ErrorInfo& out_error)
 {
     std::string_view value;
@@ -1997,6 +3251,16 @@ bool parse_date_token(const Token& datetime_token, Date& out_date, ErrorInfo& ou
         return false;
     }
 
+    if (value.size() == 10)
+    {
+        DateTimeFixedLayoutFields fields;
+        if (parse_datetime_fixed_layout(value, fields))
+        {
+            out_date = Date(static_cast<int16_t>(fields.year), static_cast<int8_t>(fields.month), static_cast<int8_t>(fields.day));
+            return true;
+        }
+    }
+
     DateTimeTokenParser parser(datetime_token, value);
 
     char year_sign = parser.peek_char();
@@ -2032,6 +3296,18 @@ bool parse_datetime_token(const Token& datetime_token, DateTime& out_datetime, E
         return false;
     }
 
+    DateTimeFixedLayoutFields fields;
+    if (parse_datetime_fixed_layout(value, fields))
+    {
+        out_datetime = fields.to_datetime();
+        if (require_time_data && !fields.has_time)
+        {
+            out_error = ErrorInfo("Invalid DateTime: expected time data", datetime_token.start_idx, datetime_token.end_idx);
+            return false;
+        }
+        return true;
+    }
+
     DateTimeTokenParser parser(datetime_token, value);
 
     // date component
@@ -2122,7 +3398,7 @@ bool parse_datetime_token(const Token& datetime_token, DateTime& out_datetime, E
             {
                 // convert to nanoseconds (lossy)
                 int64_t divisor = 1;
-                for (int64_t i = num_digits; i >= 9; --i)
+                for (int64_t i = num_digits; i > 9; --i)
                 {
                     divisor *= 10;
                 }
@@ -2178,6 +3454,47 @@ bool parse_datetime_token(const Token& datetime_token, DateTime& out_datetime, E
     return false;
 }
 
+bool parse_datetime_token_to_epoch(const Token& datetime_token, int64_t& out_seconds, uint32_t& out_nanosecond, ErrorInfo& out_error)
+{
+    // the fixed layouts go straight to a timestamp, everything else (including errors) goes through a DateTime
+    std::string_view value;
+    DateTimeFixedLayoutFields fields;
+    if (is_valid_datetime_token(datetime_token, value) && parse_datetime_fixed_layout(value, fields))
+    {
+        out_seconds = fields.to_epoch_seconds();
+        out_nanosecond = fields.nanosecond;
+        return true;
+    }
+
+    DateTime dt;
+    if (!parse_datetime_token(datetime_token, dt, out_error))
+    {
+        return false;
+    }
+    out_seconds = datetime_to_epoch_seconds(dt);
+    out_nanosecond = dt.nanosecond;
+    return true;
+}
+
+
+bool parse_datetime_token_to_epoch_nanoseconds(const Token& datetime_token, int64_t& out_nanoseconds, ErrorInfo& out_error)
+{
+    int64_t seconds = 0;
+    uint32_t nanosecond = 0;
+    if (!parse_datetime_token_to_epoch(datetime_token, seconds, nanosecond, out_error))
+    {
+        return false;
+    }
+
+    if (!epoch_seconds_to_nanoseconds(seconds, nanosecond, out_nanoseconds))
+    {
+        out_error = ErrorInfo(jxc::format("DateTime {} is out of range for a 64-bit nanosecond timestamp", datetime_token.value.as_view()),
+            datetime_token.start_idx, datetime_token.end_idx);
+        return false;
+    }
+    return true;
+}
+
 JXC_END_NAMESPACE(util)
 
 JXC_END_NAMESPACE(jxc)
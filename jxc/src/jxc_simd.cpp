@@ -0,0 +1,755 @@
+#include "jxc/jxc_simd.h"
+#include <atomic>
+#include <array>
+#include <cstring>
+
+// The SSSE3 and AVX2 code paths are compiled with per-function target attributes so that the library itself can still be
+// built for baseline x86-64, and only used if the CPU supports them.
+#if JXC_SIMD_SSE2 && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define JXC_SIMD_HAVE_TARGET_ATTRIBUTES 1
+#define JXC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define JXC_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif JXC_SIMD_SSE2 && defined(_MSC_VER)
+#define JXC_SIMD_HAVE_TARGET_ATTRIBUTES 1
+#define JXC_TARGET_SSSE3
+#define JXC_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#else
+#define JXC_SIMD_HAVE_TARGET_ATTRIBUTES 0
+#endif
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+JXC_BEGIN_NAMESPACE(detail)
+JXC_BEGIN_NAMESPACE(simd)
+
+namespace
+{
+
+InstructionSet detect_supported_instruction_set()
+{
+#if !JXC_SIMD_HAVE_TARGET_ATTRIBUTES
+#if JXC_SIMD_SSE2
+    return InstructionSet::SSE2;
+#else
+    return InstructionSet::Scalar;
+#endif
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4] = {};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 9)) == 0)
+    {
+        return InstructionSet::SSE2;
+    }
+
+    // AVX2 requires the OS to save the YMM registers (OSXSAVE + AVX, and XCR0 bits 1 and 2)
+    const bool have_osxsave = (info[2] & (1 << 27)) != 0;
+    const bool have_avx = (info[2] & (1 << 28)) != 0;
+    if (max_leaf < 7 || !have_osxsave || !have_avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return InstructionSet::SSSE3;
+    }
+
+    __cpuidex(info, 7, 0);
+    return ((info[1] & (1 << 5)) != 0) ? InstructionSet::AVX2 : InstructionSet::SSSE3;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return InstructionSet::AVX2;
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        return InstructionSet::SSSE3;
+    }
+    return InstructionSet::SSE2;
+#endif
+}
+
+
+const uint8_t* find_string_special_char_scalar(const uint8_t* ptr, const uint8_t* end, uint8_t quote_char)
+{
+    while (ptr < end && *ptr != quote_char && *ptr != '\\' && *ptr != '\n')
+    {
+        ++ptr;
+    }
+    return ptr;
+}
+
+
+#if JXC_SIMD_SSE2
+const uint8_t* find_string_special_char_sse2(const uint8_t* ptr, const uint8_t* end, uint8_t quote_char)
+{
+    const __m128i quote_vec = _mm_set1_epi8(static_cast<char>(quote_char));
+    const __m128i backslash_vec = _mm_set1_epi8('\\');
+    const __m128i newline_vec = _mm_set1_epi8('\n');
+    while (end - ptr >= 16)
+    {
+        const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        const __m128i matches = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(data, quote_vec), _mm_cmpeq_epi8(data, backslash_vec)), _mm_cmpeq_epi8(data, newline_vec));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0)
+        {
+            return ptr + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+        }
+        ptr += 16;
+    }
+    return find_string_special_char_scalar(ptr, end, quote_char);
+}
+#endif
+
+
+#if JXC_SIMD_HAVE_TARGET_ATTRIBUTES
+JXC_TARGET_AVX2 const uint8_t* find_string_special_char_avx2(const uint8_t* ptr, const uint8_t* end, uint8_t quote_char)
+{
+    const __m256i quote_vec = _mm256_set1_epi8(static_cast<char>(quote_char));
+    const __m256i backslash_vec = _mm256_set1_epi8('\\');
+    const __m256i newline_vec = _mm256_set1_epi8('\n');
+    while (end - ptr >= 32)
+    {
+        const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        const __m256i matches = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(data, quote_vec), _mm256_cmpeq_epi8(data, backslash_vec)), _mm256_cmpeq_epi8(data, newline_vec));
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+        if (mask != 0)
+        {
+            return ptr + JXC_COUNT_TRAILING_ZEROS_U32(mask);
+        }
+        ptr += 32;
+    }
+    return find_string_special_char_sse2(ptr, end, quote_char);
+}
+#endif
+
+
+static constexpr char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Decoding tables with each char's 6-bit value pre-shifted into position for each of the four chars in a group,
+// so that a group can be decoded by OR-ing four lookups together. Invalid chars (including padding) set bit 24.
+struct Base64DecodeTables
+{
+    static constexpr uint32_t invalid = 0x01000000u;
+    uint32_t shifted[4][256] = {};
+};
+
+constexpr Base64DecodeTables make_base64_decode_tables()
+{
+    Base64DecodeTables result;
+    for (size_t i = 0; i < 4; i++)
+    {
+        for (size_t ch = 0; ch < 256; ch++)
+        {
+            result.shifted[i][ch] = Base64DecodeTables::invalid;
+        }
+    }
+    for (uint32_t value = 0; value < 64; value++)
+    {
+        const uint8_t ch = static_cast<uint8_t>(base64_alphabet[value]);
+        result.shifted[0][ch] = value << 18;
+        result.shifted[1][ch] = value << 12;
+        result.shifted[2][ch] = value << 6;
+        result.shifted[3][ch] = value;
+    }
+    return result;
+}
+
+static constexpr Base64DecodeTables base64_decode_tables = make_base64_decode_tables();
+
+JXC_FORCEINLINE uint32_t base64_decode_group(const char* src)
+{
+    const auto& tbl = base64_decode_tables.shifted;
+    return tbl[0][static_cast<uint8_t>(src[0])] | tbl[1][static_cast<uint8_t>(src[1])]
+        | tbl[2][static_cast<uint8_t>(src[2])] | tbl[3][static_cast<uint8_t>(src[3])];
+}
+
+
+void base64_decode_blocks_swar(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+{
+    // two groups at a time so there's only one branch for validation per 8 chars
+    while (src_end - src >= 8 && dst_end - dst >= 6)
+    {
+        const uint32_t a = base64_decode_group(src);
+        const uint32_t b = base64_decode_group(src + 4);
+        if (((a | b) & Base64DecodeTables::invalid) != 0)
+        {
+            break;
+        }
+        dst[0] = static_cast<uint8_t>(a >> 16);
+        dst[1] = static_cast<uint8_t>(a >> 8);
+        dst[2] = static_cast<uint8_t>(a);
+        dst[3] = static_cast<uint8_t>(b >> 16);
+        dst[4] = static_cast<uint8_t>(b >> 8);
+        dst[5] = static_cast<uint8_t>(b);
+        src += 8;
+        dst += 6;
+    }
+
+    while (src_end - src >= 4 && dst_end - dst >= 3)
+    {
+        const uint32_t a = base64_decode_group(src);
+        if ((a & Base64DecodeTables::invalid) != 0)
+        {
+            break;
+        }
+        dst[0] = static_cast<uint8_t>(a >> 16);
+        dst[1] = static_cast<uint8_t>(a >> 8);
+        dst[2] = static_cast<uint8_t>(a);
+        src += 4;
+        dst += 3;
+    }
+}
+
+
+void base64_encode_blocks_swar(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+{
+    // 6 input bytes fit in one 64-bit word, which gives exactly 8 output chars
+    while (src_end - src >= 6)
+    {
+        const uint64_t word = (static_cast<uint64_t>(src[0]) << 40) | (static_cast<uint64_t>(src[1]) << 32)
+            | (static_cast<uint64_t>(src[2]) << 24) | (static_cast<uint64_t>(src[3]) << 16)
+            | (static_cast<uint64_t>(src[4]) << 8) | static_cast<uint64_t>(src[5]);
+        char out[8];
+        for (size_t i = 0; i < 8; i++)
+        {
+            out[i] = base64_alphabet[(word >> (42 - 6 * i)) & 0x3F];
+        }
+        memcpy(dst, out, sizeof(out));
+        src += 6;
+        dst += 8;
+    }
+
+    while (src_end - src >= 3)
+    {
+        const uint32_t group = (static_cast<uint32_t>(src[0]) << 16) | (static_cast<uint32_t>(src[1]) << 8) | static_cast<uint32_t>(src[2]);
+        dst[0] = base64_alphabet[(group >> 18) & 0x3F];
+        dst[1] = base64_alphabet[(group >> 12) & 0x3F];
+        dst[2] = base64_alphabet[(group >> 6) & 0x3F];
+        dst[3] = base64_alphabet[group & 0x3F];
+        src += 3;
+        dst += 4;
+    }
+}
+
+
+// The vectorized base64 code below uses the pshufb lookup approach described by Wojciech Mula and Daniel Lemire
+// in "Faster Base64 Encoding and Decoding Using AVX2 Instructions" (2018).
+#if JXC_SIMD_HAVE_TARGET_ATTRIBUTES
+JXC_TARGET_SSSE3 void base64_decode_blocks_ssse3(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+{
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2F);
+    const __m128i pack_shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    // each block writes 16 bytes, of which only the first 12 are used
+    while (src_end - src >= 16 && dst_end - dst >= 16)
+    {
+        __m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask_2f);
+        const __m128i lo_nibbles = _mm_and_si128(str, mask_2f);
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF)
+        {
+            break;
+        }
+
+        const __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask_2f), hi_nibbles));
+        str = _mm_add_epi8(str, roll);
+
+        const __m128i merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+        const __m128i packed = _mm_shuffle_epi8(_mm_madd_epi16(merged, _mm_set1_epi32(0x00011000)), pack_shuffle);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), packed);
+        src += 16;
+        dst += 12;
+    }
+    base64_decode_blocks_swar(src, src_end, dst, dst_end);
+}
+
+
+JXC_TARGET_SSSE3 JXC_FORCEINLINE __m128i base64_encode_translate_ssse3(__m128i indices)
+{
+    const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0);
+    __m128i offsets = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    offsets = _mm_sub_epi8(offsets, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+    return _mm_add_epi8(indices, _mm_shuffle_epi8(lut, offsets));
+}
+
+
+JXC_TARGET_SSSE3 void base64_encode_blocks_ssse3(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+{
+    const __m128i group_shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+
+    // each block reads 16 bytes, of which only the first 12 are used
+    while (src_end - src >= 16)
+    {
+        const __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), group_shuffle);
+        const __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+        const __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), base64_encode_translate_ssse3(_mm_or_si128(t0, t1)));
+        src += 12;
+        dst += 16;
+    }
+    base64_encode_blocks_swar(src, src_end, dst);
+}
+
+
+JXC_TARGET_AVX2 void base64_decode_blocks_avx2(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+{
+    const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A));
+    const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+    const __m256i lut_roll = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i mask_2f = _mm256_set1_epi8(0x2F);
+    const __m256i pack_shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    const __m256i pack_lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7);
+
+    // each block writes 32 bytes, of which only the first 24 are used
+    while (src_end - src >= 32 && dst_end - dst >= 32)
+    {
+        __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask_2f);
+        const __m256i lo_nibbles = _mm256_and_si256(str, mask_2f);
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+        if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256()))) != 0xFFFFFFFFu)
+        {
+            break;
+        }
+
+        const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask_2f), hi_nibbles));
+        str = _mm256_add_epi8(str, roll);
+
+        const __m256i merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_shuffle_epi8(_mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000)), pack_shuffle);
+        packed = _mm256_permutevar8x32_epi32(packed, pack_lanes);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+        src += 32;
+        dst += 24;
+    }
+    base64_decode_blocks_ssse3(src, src_end, dst, dst_end);
+}
+
+
+JXC_TARGET_AVX2 void base64_encode_blocks_avx2(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+{
+    const __m256i group_shuffle = _mm256_broadcastsi128_si256(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0));
+
+    // each 128-bit lane gets 12 input bytes, so the second load reads up to 28 bytes past src
+    while (src_end - src >= 28)
+    {
+        const __m128i lo_lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i hi_lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 12));
+        const __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo_lane), hi_lane, 1), group_shuffle);
+        const __m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+        const __m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t0, t1);
+
+        __m256i offsets = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        offsets = _mm256_sub_epi8(offsets, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_add_epi8(indices, _mm256_shuffle_epi8(lut, offsets)));
+        src += 24;
+        dst += 32;
+    }
+    base64_encode_blocks_ssse3(src, src_end, dst);
+}
+#endif
+
+
+const uint8_t* find_invalid_utf8_scalar(const uint8_t* ptr, const uint8_t* end)
+{
+    while (ptr < end)
+    {
+        // skip runs of ascii 8 bytes at a time
+        while (end - ptr >= 8)
+        {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, ptr, sizeof(chunk));
+            if ((chunk & 0x8080808080808080ull) != 0)
+            {
+                break;
+            }
+            ptr += 8;
+        }
+        if (ptr >= end)
+        {
+            break;
+        }
+
+        const uint8_t lead = *ptr;
+        if (lead < 0x80)
+        {
+            ++ptr;
+            continue;
+        }
+
+        // The second byte of a sequence has a narrower range for some lead bytes, which is what rules out
+        // overlong encodings, surrogates, and codepoints above U+10FFFF (see the table in RFC 3629 section 4)
+        ptrdiff_t seq_len = 0;
+        uint8_t second_min = 0x80;
+        uint8_t second_max = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            seq_len = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            seq_len = 3;
+            if (lead == 0xE0) { second_min = 0xA0; }
+            else if (lead == 0xED) { second_max = 0x9F; }
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            seq_len = 4;
+            if (lead == 0xF0) { second_min = 0x90; }
+            else if (lead == 0xF4) { second_max = 0x8F; }
+        }
+        else
+        {
+            return ptr;
+        }
+
+        if (end - ptr < seq_len || ptr[1] < second_min || ptr[1] > second_max)
+        {
+            return ptr;
+        }
+        for (ptrdiff_t i = 2; i < seq_len; ++i)
+        {
+            if ((ptr[i] & 0xC0) != 0x80)
+            {
+                return ptr;
+            }
+        }
+        ptr += seq_len;
+    }
+    return end;
+}
+
+
+// Returns the start of the utf8 sequence that ptr is in the middle of, or ptr if it is already on a sequence boundary.
+// Only valid if everything in [start, ptr) passed validation, apart from a truncated sequence at the very end.
+inline const uint8_t* rewind_to_utf8_sequence_start(const uint8_t* ptr, const uint8_t* start)
+{
+    const uint8_t* seq_start = ptr;
+    while (seq_start > start && ptr - seq_start < 3 && (*(seq_start - 1) & 0xC0) == 0x80)
+    {
+        --seq_start;
+    }
+    return (seq_start > start && *(seq_start - 1) >= 0xC0) ? seq_start - 1 : seq_start;
+}
+
+
+#if JXC_SIMD_HAVE_TARGET_ATTRIBUTES
+
+// Lookup tables for the utf8 validation algorithm from "Validating UTF-8 In Less Than One Instruction Per Byte"
+// (Keiser and Lemire, 2021). Each byte is checked against the byte before it using three 16-entry nibble tables,
+// where each bit is one kind of error. A pair of bytes is invalid if the same bit is set in all three lookups.
+struct Utf8ValidationTables
+{
+    static constexpr uint8_t too_short = 1 << 0;  // lead byte or ascii followed by a lead byte or ascii
+    static constexpr uint8_t too_long = 1 << 1;   // ascii followed by a continuation byte
+    static constexpr uint8_t overlong_3 = 1 << 2; // 11100000 100_____
+    static constexpr uint8_t too_large = 1 << 3;  // 11110100 1001____ and up (above U+10FFFF)
+    static constexpr uint8_t surrogate = 1 << 4;  // 11101101 101_____
+    static constexpr uint8_t overlong_2 = 1 << 5; // 1100000_ 10______
+    static constexpr uint8_t too_large_1000 = 1 << 6; // 11110101 1000____ and up
+    static constexpr uint8_t overlong_4 = 1 << 6; // 11110000 1000____
+    static constexpr uint8_t two_conts = 1 << 7;  // continuation byte followed by a continuation byte
+    static constexpr uint8_t carry = too_short | too_long | two_conts;
+
+    // indexed by the high nibble of the first byte
+    alignas(16) static constexpr uint8_t byte_1_high[16] = {
+        too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+        two_conts, two_conts, two_conts, two_conts,
+        too_short | overlong_2,
+        too_short,
+        too_short | overlong_3 | surrogate,
+        too_short | too_large | too_large_1000 | overlong_4,
+    };
+
+    // indexed by the low nibble of the first byte
+    alignas(16) static constexpr uint8_t byte_1_low[16] = {
+        carry | overlong_3 | overlong_2 | overlong_4,
+        carry | overlong_2,
+        carry,
+        carry,
+        carry | too_large,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000 | surrogate,
+        carry | too_large | too_large_1000,
+        carry | too_large | too_large_1000,
+    };
+
+    // indexed by the high nibble of the second byte
+    alignas(16) static constexpr uint8_t byte_2_high[16] = {
+        too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+        too_long | overlong_2 | two_conts | overlong_3 | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_long | overlong_2 | two_conts | surrogate | too_large,
+        too_short, too_short, too_short, too_short,
+    };
+
+    // Subtracting this (with saturation) from the last block leaves a non-zero byte if the block ends with
+    // a lead byte that needs more continuation bytes than are left in the block
+    alignas(32) static constexpr uint8_t incomplete_max[32] = {
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1,
+    };
+};
+
+
+JXC_TARGET_SSSE3 JXC_FORCEINLINE __m128i check_utf8_block_ssse3(__m128i input, __m128i prev_input)
+{
+    using T = Utf8ValidationTables;
+    const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+    const __m128i byte_1_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_1_high)),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble_mask));
+    const __m128i byte_1_low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_1_low)),
+        _mm_and_si128(prev1, nibble_mask));
+    const __m128i byte_2_high = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_2_high)),
+        _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+    const __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    // bytes that must be the 2nd continuation of a 3-byte sequence or the 3rd continuation of a 4-byte sequence.
+    // The two_conts bit from the tables must line up with exactly these.
+    const __m128i is_third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i is_fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third_byte, is_fourth_byte), _mm_set1_epi8(static_cast<char>(0x80)));
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+
+JXC_TARGET_SSSE3 const uint8_t* find_invalid_utf8_ssse3(const uint8_t* ptr, const uint8_t* end)
+{
+    const uint8_t* start = ptr;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i incomplete_max = _mm_load_si128(reinterpret_cast<const __m128i*>(Utf8ValidationTables::incomplete_max + 16));
+    __m128i prev_input = zero;
+    __m128i prev_incomplete = zero;
+    while (end - ptr >= 16)
+    {
+        const __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        __m128i error = prev_incomplete;
+        if (_mm_movemask_epi8(input) != 0)
+        {
+            error = check_utf8_block_ssse3(input, prev_input);
+            prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+        }
+        else
+        {
+            prev_incomplete = zero;
+        }
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xFFFF)
+        {
+            // the block only tells us that there's an error somewhere in it, so find the exact offset the slow way
+            break;
+        }
+        prev_input = input;
+        ptr += 16;
+    }
+    return find_invalid_utf8_scalar(rewind_to_utf8_sequence_start(ptr, start), end);
+}
+
+
+JXC_TARGET_AVX2 JXC_FORCEINLINE __m256i check_utf8_block_avx2(__m256i input, __m256i prev_input)
+{
+    using T = Utf8ValidationTables;
+    const __m256i nibble_mask = _mm256_set1_epi8(0x0F);
+
+    // alignr works per 128-bit lane, so the lookbehind needs the previous block's high lane next to this block's low lane
+    const __m256i prev_shifted = _mm256_permute2x128_si256(prev_input, input, 0x21);
+    const __m256i prev1 = _mm256_alignr_epi8(input, prev_shifted, 15);
+    const __m256i prev2 = _mm256_alignr_epi8(input, prev_shifted, 14);
+    const __m256i prev3 = _mm256_alignr_epi8(input, prev_shifted, 13);
+
+    const __m256i byte_1_high = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_1_high))),
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble_mask));
+    const __m256i byte_1_low = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_1_low))),
+        _mm256_and_si256(prev1, nibble_mask));
+    const __m256i byte_2_high = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(T::byte_2_high))),
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+    const __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    const __m256i is_third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte), _mm256_set1_epi8(static_cast<char>(0x80)));
+    return _mm256_xor_si256(must_be_continuation, special_cases);
+}
+
+
+JXC_TARGET_AVX2 const uint8_t* find_invalid_utf8_avx2(const uint8_t* ptr, const uint8_t* end)
+{
+    const uint8_t* start = ptr;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i incomplete_max = _mm256_load_si256(reinterpret_cast<const __m256i*>(Utf8ValidationTables::incomplete_max));
+    __m256i prev_input = zero;
+    __m256i prev_incomplete = zero;
+    while (end - ptr >= 32)
+    {
+        const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        __m256i error = prev_incomplete;
+        if (_mm256_movemask_epi8(input) != 0)
+        {
+            error = check_utf8_block_avx2(input, prev_input);
+            prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+        }
+        else
+        {
+            prev_incomplete = zero;
+        }
+
+        if (!_mm256_testz_si256(error, error))
+        {
+            break;
+        }
+        prev_input = input;
+        ptr += 32;
+    }
+    return find_invalid_utf8_ssse3(rewind_to_utf8_sequence_start(ptr, start), end);
+}
+#endif
+
+
+using find_string_special_char_func = JXC_DEFINE_FUNCTION_POINTER(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t);
+
+using base64_decode_blocks_func = JXC_DEFINE_FUNCTION_POINTER(void, const char*&, const char*, uint8_t*&, uint8_t*);
+using base64_encode_blocks_func = JXC_DEFINE_FUNCTION_POINTER(void, const uint8_t*&, const uint8_t*, char*&);
+using find_invalid_utf8_func = JXC_DEFINE_FUNCTION_POINTER(const uint8_t*, const uint8_t*, const uint8_t*);
+
+// resolved on first use so that this works correctly during static initialization in other translation units
+std::atomic<find_string_special_char_func> s_find_string_special_char{ nullptr };
+std::atomic<base64_decode_blocks_func> s_base64_decode_blocks{ nullptr };
+std::atomic<base64_encode_blocks_func> s_base64_encode_blocks{ nullptr };
+std::atomic<find_invalid_utf8_func> s_find_invalid_utf8{ nullptr };
+std::atomic<InstructionSet> s_runtime_instruction_set{ InstructionSet::Scalar };
+
+void apply_instruction_set(InstructionSet value)
+{
+    find_string_special_char_func find_func = &find_string_special_char_scalar;
+    base64_decode_blocks_func decode_func = &base64_decode_blocks_swar;
+    base64_encode_blocks_func encode_func = &base64_encode_blocks_swar;
+    find_invalid_utf8_func utf8_func = &find_invalid_utf8_scalar;
+#if JXC_SIMD_SSE2
+    if (value >= InstructionSet::SSE2)
+    {
+        find_func = &find_string_special_char_sse2;
+    }
+#endif
+#if JXC_SIMD_HAVE_TARGET_ATTRIBUTES
+    if (value >= InstructionSet::SSSE3)
+    {
+        decode_func = &base64_decode_blocks_ssse3;
+        encode_func = &base64_encode_blocks_ssse3;
+        utf8_func = &find_invalid_utf8_ssse3;
+    }
+    if (value >= InstructionSet::AVX2)
+    {
+        find_func = &find_string_special_char_avx2;
+        decode_func = &base64_decode_blocks_avx2;
+        encode_func = &base64_encode_blocks_avx2;
+        utf8_func = &find_invalid_utf8_avx2;
+    }
+#endif
+    s_runtime_instruction_set.store(value, std::memory_order_relaxed);
+    s_base64_decode_blocks.store(decode_func, std::memory_order_release);
+    s_base64_encode_blocks.store(encode_func, std::memory_order_release);
+    s_find_invalid_utf8.store(utf8_func, std::memory_order_release);
+    s_find_string_special_char.store(find_func, std::memory_order_release);
+}
+
+template<typename FuncType>
+JXC_FORCEINLINE FuncType resolve_function(std::atomic<FuncType>& func)
+{
+    if (FuncType result = func.load(std::memory_order_acquire))
+    {
+        return result;
+    }
+    apply_instruction_set(get_supported_instruction_set());
+    return func.load(std::memory_order_acquire);
+}
+
+} // namespace
+
+
+const char* instruction_set_to_string(InstructionSet value)
+{
+    switch (value)
+    {
+    case JXC_ENUMSTR(InstructionSet, Scalar);
+    case JXC_ENUMSTR(InstructionSet, SSE2);
+    case JXC_ENUMSTR(InstructionSet, SSSE3);
+    case JXC_ENUMSTR(InstructionSet, AVX2);
+    default:
+        break;
+    }
+    return "INVALID";
+}
+
+
+InstructionSet get_supported_instruction_set()
+{
+    static const InstructionSet supported = detect_supported_instruction_set();
+    return supported;
+}
+
+
+InstructionSet get_runtime_instruction_set()
+{
+    if (s_find_string_special_char.load(std::memory_order_acquire) == nullptr)
+    {
+        apply_instruction_set(get_supported_instruction_set());
+    }
+    return s_runtime_instruction_set.load(std::memory_order_relaxed);
+}
+
+
+void set_runtime_instruction_set(InstructionSet value)
+{
+    apply_instruction_set(std::min(value, get_supported_instruction_set()));
+}
+
+
+const uint8_t* find_string_special_char(const uint8_t* ptr, const uint8_t* end, uint8_t quote_char)
+{
+    return resolve_function(s_find_string_special_char)(ptr, end, quote_char);
+}
+
+
+void base64_decode_blocks(const char*& src, const char* src_end, uint8_t*& dst, uint8_t* dst_end)
+{
+    resolve_function(s_base64_decode_blocks)(src, src_end, dst, dst_end);
+}
+
+
+void base64_encode_blocks(const uint8_t*& src, const uint8_t* src_end, char*& dst)
+{
+    resolve_function(s_base64_encode_blocks)(src, src_end, dst);
+}
+
+
+const uint8_t* find_invalid_utf8(const uint8_t* ptr, const uint8_t* end)
+{
+    return resolve_function(s_find_invalid_utf8)(ptr, end);
+}
+
+JXC_END_NAMESPACE(simd)
+JXC_END_NAMESPACE(detail)
+JXC_END_NAMESPACE(jxc)
@@ -1,10 +1,27 @@
 #include "jxc/jxc_util.h"
 #include "jxc/jxc_lexer.h"
 #include "jxc/jxc_serializer.h"
+#include "jxc/jxc_simd.h"
 #include <sstream>
 #include <fstream>
 #include <filesystem>
 
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 
 namespace jxc
 {
@@ -34,14 +51,17 @@ std::optional<std::string> detail::read_file_to_string(const std::string& file_p
 
     if (fs::exists(file_path))
     {
-        std::ifstream fp(file_path, std::ios::in);
-        std::ostringstream ss;
-        ss << fp.rdbuf();
+        // read straight into the result instead of going through a stringstream, which would copy the whole file again
+        std::ifstream fp(file_path, std::ios::in | std::ios::binary);
+        std::string result;
+        result.resize(static_cast<size_t>(fs::file_size(file_path)));
+        fp.read(result.data(), static_cast<std::streamsize>(result.size()));
+        result.resize(static_cast<size_t>(fp.gcount()));
         if (out_error != nullptr)
         {
             out_error->clear();
         }
-        return ss.str();
+        return result;
     }
 
     if (out_error != nullptr)
@@ -52,6 +72,208 @@ std::optional<std::string> detail::read_file_to_string(const std::string& file_p
 }
 
 
+MappedBuffer::MappedBuffer(MappedBuffer&& rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+
+MappedBuffer& MappedBuffer::operator=(MappedBuffer&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        close();
+        data_ptr = rhs.data_ptr;
+        data_size = rhs.data_size;
+        mapping_size = rhs.mapping_size;
+        is_mapped = rhs.is_mapped;
+#if defined(_WIN32)
+        file_handle = rhs.file_handle;
+        mapping_handle = rhs.mapping_handle;
+        rhs.file_handle = nullptr;
+        rhs.mapping_handle = nullptr;
+        if (!rhs.is_mapped && rhs.data_ptr == rhs.file_copy.data())
+        {
+            file_copy = std::move(rhs.file_copy);
+            data_ptr = file_copy.data();
+        }
+#endif
+        rhs.data_ptr = nullptr;
+        rhs.data_size = 0;
+        rhs.mapping_size = 0;
+        rhs.is_mapped = false;
+    }
+    return *this;
+}
+
+
+bool MappedBuffer::open(const std::string& file_path, std::string* out_error)
+{
+    close();
+
+    auto set_error = [&](std::string_view reason)
+    {
+        if (out_error != nullptr)
+        {
+            *out_error = jxc::format("Failed to map file {}: {}", detail::debug_string_repr(file_path), reason);
+        }
+        close();
+        return false;
+    };
+
+    // empty files can't be mapped, but they're still valid (empty) buffers
+    static const char empty_buffer[1] = { '\0' };
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return set_error("could not open file");
+    }
+    file_handle = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        return set_error("could not get file size");
+    }
+    else if (file_size.QuadPart == 0)
+    {
+        data_ptr = empty_buffer;
+        return true;
+    }
+
+    // The rest of the last page of a view is zero-filled, which gives us the null byte after the data. Files that fill their
+    // last page exactly don't have one, and views can't be extended with anonymous memory, so read those into a string instead.
+    SYSTEM_INFO sys_info;
+    GetSystemInfo(&sys_info);
+    if (static_cast<uint64_t>(file_size.QuadPart) % static_cast<uint64_t>(sys_info.dwPageSize) == 0)
+    {
+        file_copy.resize(static_cast<size_t>(file_size.QuadPart));
+        size_t num_read = 0;
+        while (num_read < file_copy.size())
+        {
+            const DWORD chunk_size = static_cast<DWORD>(std::min<size_t>(file_copy.size() - num_read, 1 << 30));
+            DWORD chunk_read = 0;
+            if (!ReadFile(file, file_copy.data() + num_read, chunk_size, &chunk_read, nullptr) || chunk_read == 0)
+            {
+                return set_error("ReadFile failed");
+            }
+            num_read += static_cast<size_t>(chunk_read);
+        }
+        data_ptr = file_copy.data();
+        data_size = file_copy.size();
+        return true;
+    }
+
+    // PAGE_WRITECOPY + FILE_MAP_COPY is the equivalent of MAP_PRIVATE
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        return set_error("CreateFileMapping failed");
+    }
+    mapping_handle = mapping;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (view == nullptr)
+    {
+        return set_error("MapViewOfFile failed");
+    }
+    data_ptr = static_cast<const char*>(view);
+    data_size = static_cast<size_t>(file_size.QuadPart);
+    is_mapped = true;
+#else
+    const int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return set_error(strerror(errno));
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+        const int err = errno;
+        ::close(fd);
+        return set_error(strerror(err));
+    }
+    else if (file_stat.st_size == 0)
+    {
+        ::close(fd);
+        data_ptr = empty_buffer;
+        return true;
+    }
+
+    // mmap zero-fills the rest of the file's last page, which gives us the null byte after the data. Files that fill their last
+    // page exactly don't have one, so reserve at least one page past the end of the file with an anonymous (zeroed) mapping,
+    // then map the file over the start of it.
+    const size_t file_size = static_cast<size_t>(file_stat.st_size);
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t reserved_size = (file_size / page_size + 1) * page_size;
+    void* reservation = mmap(nullptr, reserved_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reservation == MAP_FAILED)
+    {
+        const int err = errno;
+        ::close(fd);
+        return set_error(strerror(err));
+    }
+
+    void* mapping = mmap(reservation, file_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    const int mmap_err = errno;
+
+    // the mapping keeps its own reference to the file
+    ::close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        munmap(reservation, reserved_size);
+        return set_error(strerror(mmap_err));
+    }
+
+    // only a hint, so failing here isn't an error
+    (void)madvise(mapping, file_size, MADV_SEQUENTIAL);
+
+    data_ptr = static_cast<const char*>(mapping);
+    data_size = file_size;
+    mapping_size = reserved_size;
+    is_mapped = true;
+#endif
+
+    return true;
+}
+
+
+void MappedBuffer::close()
+{
+#if defined(_WIN32)
+    if (is_mapped)
+    {
+        UnmapViewOfFile(data_ptr);
+    }
+    if (mapping_handle != nullptr)
+    {
+        CloseHandle(static_cast<HANDLE>(mapping_handle));
+        mapping_handle = nullptr;
+    }
+    if (file_handle != nullptr)
+    {
+        CloseHandle(static_cast<HANDLE>(file_handle));
+        file_handle = nullptr;
+    }
+    file_copy = std::string();
+#else
+    if (is_mapped)
+    {
+        munmap(const_cast<char*>(data_ptr), mapping_size);
+    }
+#endif
+    data_ptr = nullptr;
+    data_size = 0;
+    mapping_size = 0;
+    is_mapped = false;
+}
+
+
 std::string detail::debug_string_repr(std::string_view value, char quote_char)
 {
     std::ostringstream stream;
@@ -783,6 +1005,114 @@ std::string datetime_to_iso8601(const DateTime& dt, bool auto_strip_time)
 }
 
 
+// See http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+int64_t civil_date_to_epoch_days(int64_t year, uint32_t month, uint32_t day)
+{
+    year -= (month <= 2) ? 1 : 0;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint32_t year_of_era = static_cast<uint32_t>(year - era * 400);
+    const uint32_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+
+// Inverse of civil_date_to_epoch_days.
+// See http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+static void civil_from_days(int64_t days, int64_t& out_year, uint32_t& out_month, uint32_t& out_day)
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const uint32_t day_of_era = static_cast<uint32_t>(days - era * 146097);
+    const uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const uint32_t month_index = (5 * day_of_year + 2) / 153;
+    out_day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    out_month = (month_index < 10) ? month_index + 3 : month_index - 9;
+    out_year = static_cast<int64_t>(year_of_era) + era * 400 + ((out_month <= 2) ? 1 : 0);
+}
+
+
+int64_t datetime_to_epoch_seconds(const DateTime& dt)
+{
+    const int64_t days = civil_date_to_epoch_days(dt.year, static_cast<uint32_t>(dt.month), static_cast<uint32_t>(dt.day));
+    int64_t seconds = days * 86400 + static_cast<int64_t>(dt.hour) * 3600 + static_cast<int64_t>(dt.minute) * 60 + static_cast<int64_t>(dt.second);
+    if (!dt.is_timezone_local())
+    {
+        // tz_minute is unsigned, and takes the sign of tz_hour
+        const int64_t tz_minutes = static_cast<int64_t>(dt.tz_hour) * 60 + ((dt.tz_hour < 0) ? -static_cast<int64_t>(dt.tz_minute) : static_cast<int64_t>(dt.tz_minute));
+        seconds -= tz_minutes * 60;
+    }
+    return seconds;
+}
+
+
+bool epoch_seconds_to_nanoseconds(int64_t seconds, uint32_t nanosecond, int64_t& out_nanoseconds)
+{
+    static constexpr int64_t max_seconds = std::numeric_limits<int64_t>::max() / 1000000000;
+    static constexpr int64_t min_seconds = std::numeric_limits<int64_t>::min() / 1000000000;
+
+    if (seconds > max_seconds || seconds < min_seconds)
+    {
+        out_nanoseconds = 0;
+        return false;
+    }
+
+    // the nanosecond field is never negative, so only the upper bound can overflow here
+    const int64_t base = seconds * 1000000000;
+    if (base > std::numeric_limits<int64_t>::max() - static_cast<int64_t>(nanosecond))
+    {
+        out_nanoseconds = 0;
+        return false;
+    }
+
+    out_nanoseconds = base + static_cast<int64_t>(nanosecond);
+    return true;
+}
+
+
+bool datetime_to_epoch_nanoseconds(const DateTime& dt, int64_t& out_nanoseconds)
+{
+    return epoch_seconds_to_nanoseconds(datetime_to_epoch_seconds(dt), dt.nanosecond, out_nanoseconds);
+}
+
+
+DateTime epoch_seconds_to_datetime(int64_t seconds, uint32_t nanosecond)
+{
+    int64_t days = seconds / 86400;
+    int64_t seconds_of_day = seconds % 86400;
+    if (seconds_of_day < 0)
+    {
+        seconds_of_day += 86400;
+        --days;
+    }
+
+    int64_t year = 0;
+    uint32_t month = 0;
+    uint32_t day = 0;
+    civil_from_days(days, year, month, day);
+    JXC_DEBUG_ASSERTF(year >= std::numeric_limits<int16_t>::min() && year <= std::numeric_limits<int16_t>::max(),
+        "Epoch time {} is out of range for DateTime", seconds);
+
+    return DateTime::make_utc(static_cast<int16_t>(year), static_cast<int8_t>(month), static_cast<int8_t>(day),
+        static_cast<int8_t>(seconds_of_day / 3600), static_cast<int8_t>((seconds_of_day / 60) % 60), static_cast<int8_t>(seconds_of_day % 60),
+        nanosecond);
+}
+
+
+DateTime epoch_nanoseconds_to_datetime(int64_t nanoseconds)
+{
+    int64_t seconds = nanoseconds / 1000000000;
+    int64_t nanosecond = nanoseconds % 1000000000;
+    if (nanosecond < 0)
+    {
+        nanosecond += 1000000000;
+        --seconds;
+    }
+    return epoch_seconds_to_datetime(seconds, static_cast<uint32_t>(nanosecond));
+}
+
+
 const char* token_type_to_string(TokenType type)
 {
     switch (type)
@@ -1481,23 +1811,20 @@ namespace base64
             return 0;
         }
 
-        // tiny buffer to store the last four base64 chars so we can check if they're padding at the end
-        ::jxc::detail::MiniBuffer<char, 4> buf;
-        size_t buf_idx = 0;
-
         size_t num_base64_chars = 0;
+        size_t num_trailing_padding_chars = 0;
         for (size_t i = 0; i < base64_str_len; i++)
         {
-            if (is_base64_char(base64_str[i]))
+            const char ch = base64_str[i];
+            if (ch == '=')
             {
                 ++num_base64_chars;
-
-                buf[buf_idx] = base64_str[i];
-                ++buf_idx;
-                if (buf_idx >= buf.capacity())
-                {
-                    buf_idx = 0;
-                }
+                ++num_trailing_padding_chars;
+            }
+            else if (decoding_table[static_cast<uint8_t>(ch)] < 64)
+            {
+                ++num_base64_chars;
+                num_trailing_padding_chars = 0;
             }
         }
 
@@ -1507,21 +1834,8 @@ namespace base64
             return 0;
         }
 
-        size_t num_bytes = num_base64_chars / 4 * 3;
-
-        for (int i = (int)buf.capacity() - 1; i >= 0; --i)
-        {
-            if (buf[i] == '=')
-            {
-                --num_bytes;
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        return num_bytes;
+        // only padding in the last group counts
+        return num_base64_chars / 4 * 3 - std::min<size_t>(num_trailing_padding_chars, 4);
     }
 
     void bytes_to_base64(const uint8_t* bytes, size_t bytes_len, char* out_data, size_t out_size)
@@ -1530,10 +1844,18 @@ namespace base64
         JXC_ASSERTF(out_size >= req_out_size,
             "bytes_to_base64 requires {} bytes, but out_size is {}", req_out_size, out_size);
 
-        size_t i = 0;
+        if (bytes_len == 0)
+        {
+            return;
+        }
+
+        // encode all complete groups of 3 bytes using the vectorized path
+        const uint8_t* src = bytes;
         char* p = out_data;
+        detail::simd::base64_encode_blocks(src, bytes + bytes_len, p);
+        size_t i = static_cast<size_t>(src - bytes);
 
-        for (i = 0; i < bytes_len - 2; i += 3)
+        for (; i + 2 < bytes_len; i += 3)
         {
             *p++ = encoding_table[(bytes[i] >> 2) & 0x3F];
             *p++ = encoding_table[((bytes[i] & 0x3) << 4) | ((int)(bytes[i + 1] & 0xF0) >> 4)];
@@ -1559,26 +1881,28 @@ namespace base64
     }
 
 
-    void base64_to_bytes(const char* base64_str, size_t base64_str_len, uint8_t* out_data, size_t out_size)
+    // Decodes a base64 string with no whitespace (str_len must be a multiple of 4).
+    // Returns the number of bytes written, which is capped at out_size.
+    static size_t decode_base64_groups(const char* str, size_t str_len, uint8_t* out_data, size_t out_size)
     {
-        const size_t req_out_size = get_num_bytes_in_base64_string(base64_str, base64_str_len);
-        JXC_ASSERTF(out_size >= req_out_size,
-            "base64_to_bytes requires {} bytes, but out_size is {}", req_out_size, out_size);
+        // the vectorized path handles everything except padding and invalid chars
+        const char* src = str;
+        uint8_t* dst = out_data;
+        detail::simd::base64_decode_blocks(src, str + str_len, dst, out_data + out_size);
 
-        size_t out_data_idx = 0;
-        const size_t str_len = base64_str_len;
-        for (size_t i = 0; i < str_len;)
+        size_t out_data_idx = static_cast<size_t>(dst - out_data);
+        for (size_t i = static_cast<size_t>(src - str); i + 3 < str_len && out_data_idx < out_size;)
         {
-            const uint32_t a = (base64_str[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(base64_str[i])];
+            const uint32_t a = (str[i] == '=') ? (0 & i) : decoding_table[static_cast<uint8_t>(str[i])];
             ++i;
 
-            const uint32_t b = (base64_str[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(base64_str[i])];
+            const uint32_t b = (str[i] == '=') ? (0 & i) : decoding_table[static_cast<uint8_t>(str[i])];
             ++i;
 
-            const uint32_t c = (base64_str[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(base64_str[i])];
+            const uint32_t c = (str[i] == '=') ? (0 & i) : decoding_table[static_cast<uint8_t>(str[i])];
             ++i;
 
-            const uint32_t d = (base64_str[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(base64_str[i])];
+            const uint32_t d = (str[i] == '=') ? (0 & i) : decoding_table[static_cast<uint8_t>(str[i])];
             ++i;
 
             const uint32_t triple = (a << 3 * 6) + (b << 2 * 6) + (c << 1 * 6) + (d << 0 * 6);
@@ -1598,6 +1922,18 @@ namespace base64
                 out_data[out_data_idx++] = (triple >> 0 * 8) & 0xFF;
             }
         }
+
+        return out_data_idx;
+    }
+
+
+    void base64_to_bytes(const char* base64_str, size_t base64_str_len, uint8_t* out_data, size_t out_size)
+    {
+        const size_t req_out_size = get_num_bytes_in_base64_string(base64_str, base64_str_len);
+        JXC_ASSERTF(out_size >= req_out_size,
+            "base64_to_bytes requires {} bytes, but out_size is {}", req_out_size, out_size);
+
+        decode_base64_groups(base64_str, base64_str_len, out_data, out_size);
     }
 
 
@@ -1605,87 +1941,54 @@ namespace base64
     {
         JXC_ASSERT(base64_str != nullptr && base64_str_len >= 4);
         size_t out_data_idx = 0;
-        detail::MiniBuffer<char, 4> quad;
 
-#define JXC_B64_FASTFORWARD(STR_IDX) do { \
-    while (STR_IDX < base64_str_len && !is_base64_char(base64_str[STR_IDX])) { \
-        ++STR_IDX; \
-    } \
-} while(0)
+        // chars from a group that is split by whitespace
+        char quad[4] = { 0 };
+        size_t quad_len = 0;
 
         size_t str_idx = 0;
         while (str_idx < base64_str_len && out_data_idx < out_size)
         {
-            JXC_B64_FASTFORWARD(str_idx);
-            if (str_idx >= base64_str_len)
-            {
-                break;
-            }
-
-            quad[0] = base64_str[str_idx++];
-
-            JXC_B64_FASTFORWARD(str_idx);
-            if (str_idx >= base64_str_len)
+            if (!is_base64_char(base64_str[str_idx]))
             {
-                // error - stopped in the middle of a quad
-                return 0;
+                ++str_idx;
+                continue;
             }
 
-            quad[1] = base64_str[str_idx++];
-
-            JXC_B64_FASTFORWARD(str_idx);
-            if (str_idx >= base64_str_len)
-            {
-                // error - stopped in the middle of a quad
-                return 0;
-            }
-
-            quad[2] = base64_str[str_idx++];
-
-            JXC_B64_FASTFORWARD(str_idx);
-            if (str_idx >= base64_str_len)
+            if (quad_len == 0)
             {
-                // error - stopped in the middle of a quad
-                return 0;
-            }
-
-            quad[3] = base64_str[str_idx++];
-
-            // push quad to output
-            {
-                int i = 0;
-
-                const uint32_t a = (quad[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(quad[i])];
-                ++i;
-
-                const uint32_t b = (quad[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(quad[i])];
-                ++i;
-
-                const uint32_t c = (quad[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(quad[i])];
-                ++i;
-
-                const uint32_t d = (quad[i] == '=') ? (0 & i) : decoding_table[static_cast<int>(quad[i])];
-
-                const uint32_t triple = (a << 3 * 6) + (b << 2 * 6) + (c << 1 * 6) + (d << 0 * 6);
-
-                if (out_data_idx < out_size)
+                // Find the end of this run of base64 chars (usually a whole line), and decode all of its complete groups in one go.
+                size_t run_end = str_idx + 1;
+                while (run_end < base64_str_len && is_base64_char(base64_str[run_end]))
                 {
-                    out_data[out_data_idx++] = (triple >> 2 * 8) & 0xFF;
+                    ++run_end;
                 }
 
-                if (out_data_idx < out_size)
+                const size_t run_groups_len = (run_end - str_idx) & ~static_cast<size_t>(3);
+                if (run_groups_len > 0)
                 {
-                    out_data[out_data_idx++] = (triple >> 1 * 8) & 0xFF;
+                    out_data_idx += decode_base64_groups(base64_str + str_idx, run_groups_len, out_data + out_data_idx, out_size - out_data_idx);
+                    str_idx += run_groups_len;
+                    continue;
                 }
+            }
 
-                if (out_data_idx < out_size)
-                {
-                    out_data[out_data_idx++] = (triple >> 0 * 8) & 0xFF;
-                }
+            // quad_len is always less than 4 here because full groups are flushed below. The mask spells that out
+            // for the optimizer, which can't see it through the loop and otherwise warns with -Warray-bounds.
+            quad[quad_len & 3] = base64_str[str_idx++];
+            ++quad_len;
+            if (quad_len == sizeof(quad))
+            {
+                out_data_idx += decode_base64_groups(quad, quad_len, out_data + out_data_idx, out_size - out_data_idx);
+                quad_len = 0;
             }
         }
 
-#undef JXC_B64_FASTFORWARD
+        if (quad_len != 0)
+        {
+            // error - stopped in the middle of a quad
+            return 0;
+        }
 
         return out_data_idx;
     }
@@ -1,10 +1,17 @@
 #include <vector>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <optional>
+#include <algorithm>
 #include "jxc/jxc.h"
 #include "jxc/jxc_format.h"
+#include "jxc/jxc_simd.h"
 #include "jxc_cpp/jxc_value.h"
 #include "jxc_cpp/jxc_document.h"
+#include "jxc_cpp/jxc_query.h"
+#include "jxc_cpp/jxc_batch.h"
+#include "jxc_cpp/jxc_tape.h"
 
 
 #if !defined(COMPARE_AGAINST_NLOHMANN_JSON) && __has_include("nlohmann/json.hpp")
@@ -22,6 +29,7 @@ struct Args
 {
     int32_t num_iters = 64;
 	std::vector<std::string> files;
+    std::string query_path;
 
 	static Args parse(int argc, const char** argv)
 	{
@@ -40,7 +48,7 @@ struct Args
             {
                 if (args[i] == "/?" || args[i] == "-h" || args[i] == "-help" || args[i] == "--help")
                 {
-                    jxc::print("Usage: {} [--num-iters 64] [--input path/to/file.jxc]\n", argv[0]);
+                    jxc::print("Usage: {} [--num-iters 64] [--input path/to/file.jxc] [--query path.to[*].value]\n", argv[0]);
                     exit(0);
                 }
             }
@@ -71,6 +79,12 @@ struct Args
                         ++idx;
                     }
                 }
+                else if (args[idx] == "-q" || args[idx] == "--query")
+                {
+                    ++idx;
+                    result.query_path = std::string(args[idx]);
+                    ++idx;
+                }
                 else
                 {
                     jxc::print(stderr, "Invalid argument {}\n", args[idx]);
@@ -123,6 +137,25 @@ int64_t run_benchmark_and_get_average_runtime_ns(int64_t num_iters, Lambda&& cal
 }
 
 
+void lexer_benchmark(std::string_view buf)
+{
+    jxc::Lexer lexer(buf.data(), buf.size());
+    jxc::ErrorInfo err;
+    size_t start_idx = 0;
+    size_t end_idx = 0;
+    std::string_view token_value;
+    std::string_view token_tag;
+    while (lexer.next(err, start_idx, end_idx, token_value, token_tag) != jxc::TokenType::EndOfStream)
+    {
+        if (err.is_err)
+        {
+            err.get_line_and_col_from_buffer(buf);
+            JXC_ASSERTF(!err.is_err, "LexerError: {}", err.to_string(buf));
+        }
+    }
+}
+
+
 void jump_parser_benchmark(std::string_view buf)
 {
     jxc::JumpParser parser(buf);
@@ -144,6 +177,220 @@ void jump_parser_benchmark(std::string_view buf)
 }
 
 
+// Counts every value in a tree and the total length of its strings, so traversal benchmarks touch all the data
+void count_values(const jxc::Value& val, size_t& out_num_values, size_t& out_string_bytes)
+{
+    ++out_num_values;
+    if (val.is_string())
+    {
+        out_string_bytes += val.as_string().size();
+    }
+    else if (val.is_packed_array())
+    {
+        // packed items are all numbers, and as_array() would expand them
+        out_num_values += val.size();
+    }
+    else if (val.is_array())
+    {
+        for (const jxc::Value& item : val.as_array())
+        {
+            count_values(item, out_num_values, out_string_bytes);
+        }
+    }
+    else if (val.is_object())
+    {
+        for (const auto& pair : val.as_object())
+        {
+            count_values(pair.first, out_num_values, out_string_bytes);
+            count_values(pair.second, out_num_values, out_string_bytes);
+        }
+    }
+}
+
+
+void count_values(jxc::TapeCursor cur, size_t& out_num_values, size_t& out_string_bytes)
+{
+    ++out_num_values;
+    if (cur.is_string())
+    {
+        out_string_bytes += cur.as_string().size();
+    }
+    else if (cur.is_array() || cur.is_object())
+    {
+        for (jxc::TapeCursor child = cur.first_child(); child.is_valid(); child = child.next_sibling())
+        {
+            count_values(child, out_num_values, out_string_bytes);
+        }
+    }
+}
+
+
+// The integer parsing approach used before the SWAR parser (digit validation loop, overflow check by string comparison, then strtoll),
+// kept here to compare against.
+bool legacy_string_to_int64(char sign_char, std::string_view value, int64_t& out_result)
+{
+    while (value.size() >= 2 && value[0] == '0')
+    {
+        value = value.substr(1);
+    }
+
+    if (value.size() == 0 || value.size() > 20)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < value.size(); i++)
+    {
+        if (!jxc::util::is_decimal_digit(value[i]))
+        {
+            return false;
+        }
+    }
+
+    if ((sign_char == '-' && !jxc::detail::value_gte_int_min<int64_t>(value)) || (sign_char == '+' && !jxc::detail::value_lte_int_max<int64_t>(value)))
+    {
+        return false;
+    }
+
+    out_result = static_cast<int64_t>(strtoll(value.data(), nullptr, 10)) * ((sign_char == '-') ? -1 : 1);
+    return true;
+}
+
+
+void integer_parsing_benchmark(int32_t num_iters)
+{
+    // mostly short values (like counters and ids), with some full-width ones
+    std::vector<std::string> values;
+    uint32_t rng_state = 7;
+    for (size_t i = 0; i < 100000; i++)
+    {
+        rng_state = rng_state * 1664525u + 1013904223u;
+        const size_t num_digits = ((rng_state >> 24) % 8 == 0) ? 19 : (1 + (rng_state >> 16) % 8);
+        std::string value;
+        for (size_t d = 0; d < num_digits; d++)
+        {
+            rng_state = rng_state * 1664525u + 1013904223u;
+            value.push_back(static_cast<char>('1' + (rng_state >> 24) % 8));
+        }
+        values.push_back(std::move(value));
+    }
+
+    std::vector<std::string> hex_values;
+    for (const std::string& value : values)
+    {
+        hex_values.push_back(jxc::format("{:x}", static_cast<uint64_t>(strtoull(value.c_str(), nullptr, 10))));
+    }
+
+    auto print_result = [&values](const char* name, int64_t runtime_ns, int64_t checksum)
+    {
+        jxc::print("Integer parsing benchmark ({}): {:.2f} ns per value (checksum {})\n", name, (double)runtime_ns / (double)values.size(), checksum);
+    };
+
+    int64_t checksum = 0;
+    const int64_t swar_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const std::string& value : values)
+        {
+            int64_t result = 0;
+            jxc::util::string_to_number_decimal<int64_t>('+', value, result);
+            checksum += result;
+        }
+    });
+    print_result("decimal, SWAR", swar_runtime_ns, checksum);
+
+    checksum = 0;
+    const int64_t legacy_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const std::string& value : values)
+        {
+            int64_t result = 0;
+            legacy_string_to_int64('+', value, result);
+            checksum += result;
+        }
+    });
+    print_result("decimal, string compare + strtoll", legacy_runtime_ns, checksum);
+
+    checksum = 0;
+    const int64_t hex_swar_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const std::string& value : hex_values)
+        {
+            int64_t result = 0;
+            jxc::util::string_to_number_hex<int64_t>('+', value, result);
+            checksum += result;
+        }
+    });
+    print_result("hex, SWAR", hex_swar_runtime_ns, checksum);
+
+    checksum = 0;
+    const int64_t hex_legacy_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const std::string& value : hex_values)
+        {
+            checksum += static_cast<int64_t>(strtoll(value.c_str(), nullptr, 16));
+        }
+    });
+    print_result("hex, strtoll", hex_legacy_runtime_ns, checksum);
+}
+
+
+void datetime_parsing_benchmark(int32_t num_iters)
+{
+    // event-log style timestamps, mostly with millisecond fractions and a mix of timezone styles
+    std::vector<std::string> values;
+    uint32_t rng_state = 11;
+    auto next_rand = [&rng_state](uint32_t range)
+    {
+        rng_state = rng_state * 1664525u + 1013904223u;
+        return (rng_state >> 8) % range;
+    };
+    for (size_t i = 0; i < 100000; i++)
+    {
+        const char* tz = (next_rand(4) == 0) ? "-07:00" : "Z";
+        char buf[64];
+        snprintf(buf, sizeof(buf), "dt\"%04u-%02u-%02uT%02u:%02u:%02u.%03u%s\"",
+            2000 + next_rand(30), 1 + next_rand(12), 1 + next_rand(28), next_rand(24), next_rand(60), next_rand(60), next_rand(1000), tz);
+        values.push_back(buf);
+    }
+
+    std::vector<jxc::Token> tokens;
+    for (const std::string& value : values)
+    {
+        tokens.push_back(jxc::Token(jxc::TokenType::DateTime, 0, value.size(), jxc::FlexString::make_view(value)));
+    }
+
+    auto print_result = [&values](const char* name, int64_t runtime_ns, int64_t checksum)
+    {
+        jxc::print("DateTime parsing benchmark ({}): {:.2f} ns per value (checksum {})\n", name, (double)runtime_ns / (double)values.size(), checksum);
+    };
+
+    jxc::ErrorInfo err;
+    int64_t checksum = 0;
+    const int64_t datetime_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const jxc::Token& tok : tokens)
+        {
+            jxc::DateTime dt;
+            jxc::util::parse_datetime_token(tok, dt, err);
+            checksum += dt.second + dt.nanosecond;
+        }
+    });
+    print_result("DateTime", datetime_runtime_ns, checksum);
+
+    checksum = 0;
+    const int64_t epoch_runtime_ns = run_benchmark_and_get_average_runtime_ns(num_iters, [&]()
+    {
+        for (const jxc::Token& tok : tokens)
+        {
+            int64_t epoch_ns = 0;
+            jxc::util::parse_datetime_token_to_epoch_nanoseconds(tok, epoch_ns, err);
+            checksum += epoch_ns;
+        }
+    });
+    print_result("epoch nanoseconds", epoch_runtime_ns, checksum);
+}
+
+
 int main(int argc, const char** argv)
 {
     auto args = Args::parse(argc, argv);
@@ -158,6 +405,8 @@ int main(int argc, const char** argv)
         jxc::print("Input = {}\n", path);
     }
     jxc::print("Num iters = {}\n", args.num_iters);
+    jxc::print("SIMD = {} (runtime: {})\n", jxc::detail::simd::instruction_set_name(),
+        jxc::detail::simd::instruction_set_to_string(jxc::detail::simd::get_supported_instruction_set()));
 
     std::vector<std::string> file_data;
     size_t file_data_size = 0;
@@ -168,7 +417,7 @@ int main(int argc, const char** argv)
         if (auto data = jxc::detail::read_file_to_string(path, &err))
         {
             file_data_size += data->size();
-            file_data.push_back(data.value());
+            file_data.push_back(std::move(data.value()));
         }
         else
         {
@@ -182,12 +431,154 @@ int main(int argc, const char** argv)
 
     jxc::print("\n");
 
-    auto benchmark_result_to_string = [](int64_t runtime_ns, int32_t num_iters) -> std::string
+    // collected outside the timed runs, so the benchmarks themselves run without stats enabled
+    for (size_t i = 0; i < file_data.size(); i++)
+    {
+        jxc::ParseStats stats;
+        jxc::ErrorInfo err;
+        jxc::JumpParser parser(file_data[i]);
+        parser.set_stats(&stats);
+        jxc::detail::ValueParser value_parser(parser, err);
+        value_parser.stats = &stats;
+        while (parser.next())
+        {
+            value_parser.parse(parser.value());
+        }
+
+        if (parser.has_error() || err.is_err)
+        {
+            jxc::print(stderr, "Failed collecting parse stats for {}: {}\n", args.files[i],
+                parser.has_error() ? parser.get_error().to_string(file_data[i]) : err.to_string(file_data[i]));
+            return 1;
+        }
+        jxc::print("Parse stats for {}:\n{}\n", args.files[i], stats.to_string());
+    }
+
+    auto benchmark_result_to_string = [file_data_size_mb](int64_t runtime_ns, int32_t num_iters) -> std::string
     {
-        return jxc::format("Average {}ns ({:.4f} ms) over {} iterations\n",
-            runtime_ns, jxc::detail::Timer::ns_to_ms(runtime_ns), num_iters);
+        const double runtime_sec = (double)runtime_ns / 1e9;
+        const double throughput_mb_per_sec = (runtime_sec > 0.0) ? (file_data_size_mb / runtime_sec) : 0.0;
+        return jxc::format("Average {}ns ({:.4f} ms, {:.2f} MB/s) over {} iterations\n",
+            runtime_ns, jxc::detail::Timer::ns_to_ms(runtime_ns), throughput_mb_per_sec, num_iters);
     };
 
+    {
+        // string scanning is dispatched at runtime, so compare every instruction set this CPU supports
+        using jxc::detail::simd::InstructionSet;
+        const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+        for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2 })
+        {
+            if (iset > supported)
+            {
+                break;
+            }
+
+            jxc::detail::simd::set_runtime_instruction_set(iset);
+
+            const int64_t lexer_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                for (const auto& data : file_data)
+                {
+                    lexer_benchmark(data);
+                }
+            });
+
+            jxc::print("Lexer-only benchmark (string scanning: {}): {}\n",
+                jxc::detail::simd::instruction_set_to_string(iset), benchmark_result_to_string(lexer_avg_runtime_ns, args.num_iters));
+        }
+        jxc::detail::simd::set_runtime_instruction_set(supported);
+    }
+
+    {
+        // none of the benchmark files contain bytes values, so use a generated blob for base64
+        using jxc::detail::simd::InstructionSet;
+        std::vector<uint8_t> blob(4 * 1024 * 1024);
+        uint32_t rng_state = 1;
+        for (uint8_t& byte : blob)
+        {
+            rng_state = rng_state * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t>(rng_state >> 24);
+        }
+
+        std::string blob_b64(jxc::base64::get_base64_string_size(blob.size()), '\0');
+        std::vector<uint8_t> blob_decoded(blob.size());
+        const double blob_size_mb = (double)blob.size() / 1024.0 / 1024.0;
+
+        const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+        for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSSE3, InstructionSet::AVX2 })
+        {
+            if (iset > supported)
+            {
+                break;
+            }
+
+            jxc::detail::simd::set_runtime_instruction_set(iset);
+
+            const int64_t encode_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jxc::base64::bytes_to_base64(blob.data(), blob.size(), blob_b64.data(), blob_b64.size());
+            });
+
+            const int64_t decode_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jxc::base64::base64_to_bytes(blob_b64.data(), blob_b64.size(), blob_decoded.data(), blob_decoded.size());
+            });
+
+            JXC_ASSERT(blob_decoded == blob);
+            jxc::print("Base64 benchmark ({}): encode {:.2f} MB/s, decode {:.2f} MB/s ({:.2f} MB of bytes)\n",
+                jxc::detail::simd::instruction_set_to_string(iset),
+                blob_size_mb / ((double)encode_avg_runtime_ns / 1e9), blob_size_mb / ((double)decode_avg_runtime_ns / 1e9), blob_size_mb);
+        }
+        jxc::detail::simd::set_runtime_instruction_set(supported);
+    }
+
+    {
+        // the benchmark files are almost entirely ascii, so also validate generated text with a mix of 1-4 byte chars
+        using jxc::detail::simd::InstructionSet;
+        static constexpr const char* mixed_chars[] = { "a", "b", " ", "\xC3\xA9", "\xD0\x96", "\xE2\x82\xAC", "\xE3\x81\x82", "\xF0\x9F\x98\x80" };
+        std::string mixed_text;
+        uint32_t rng_state = 3;
+        while (mixed_text.size() < 4 * 1024 * 1024)
+        {
+            rng_state = rng_state * 1664525u + 1013904223u;
+            mixed_text += mixed_chars[(rng_state >> 24) % 8];
+        }
+        const double mixed_text_size_mb = (double)mixed_text.size() / 1024.0 / 1024.0;
+
+        const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+        for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSSE3, InstructionSet::AVX2 })
+        {
+            if (iset > supported)
+            {
+                break;
+            }
+
+            jxc::detail::simd::set_runtime_instruction_set(iset);
+
+            jxc::ErrorInfo err;
+            const int64_t files_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                for (const auto& data : file_data)
+                {
+                    JXC_ASSERT(jxc::util::validate_utf8(data, err));
+                }
+            });
+
+            const int64_t mixed_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                JXC_ASSERT(jxc::util::validate_utf8(mixed_text, err));
+            });
+
+            jxc::print("UTF-8 validation benchmark ({}): input files {:.2f} MB/s, mixed text {:.2f} MB/s\n",
+                jxc::detail::simd::instruction_set_to_string(iset),
+                file_data_size_mb / ((double)files_avg_runtime_ns / 1e9), mixed_text_size_mb / ((double)mixed_avg_runtime_ns / 1e9));
+        }
+        jxc::detail::simd::set_runtime_instruction_set(supported);
+    }
+
+    integer_parsing_benchmark(args.num_iters);
+    datetime_parsing_benchmark(args.num_iters);
+
     const int64_t parser_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
     {
         for (const auto& data : file_data)
@@ -198,6 +589,136 @@ int main(int argc, const char** argv)
 
     jxc::print("Parser-only benchmark: {}\n", benchmark_result_to_string(parser_avg_runtime_ns, args.num_iters));
 
+    {
+        const size_t chunk_size = 4096;
+        const int64_t push_parser_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            jxc::PushParser parser;
+            for (const auto& data : file_data)
+            {
+                parser.reset();
+                for (size_t i = 0; i < data.size(); i += chunk_size)
+                {
+                    parser.feed(std::string_view(data).substr(i, chunk_size));
+                    while (parser.next()) {}
+                }
+                parser.finish();
+                while (parser.next()) {}
+                JXC_ASSERTF(!parser.has_error(), "Parse error: {}", parser.get_error().to_string(parser.get_buffer()));
+            }
+        });
+
+        jxc::print("Push parser benchmark ({} byte chunks): {}\n", chunk_size, benchmark_result_to_string(push_parser_avg_runtime_ns, args.num_iters));
+    }
+
+    {
+        // reads the files from disk on each iteration instead of using file_data
+        const int64_t stream_parser_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            for (const auto& path : args.files)
+            {
+                FILE* fp = fopen(path.c_str(), "rb");
+                JXC_ASSERTF(fp != nullptr, "Failed to open {}", path);
+                jxc::StreamParser parser(fp);
+                while (parser.next()) {}
+                JXC_ASSERTF(!parser.has_error(), "Parse error: {}", parser.get_error().to_string(parser.get_buffer()));
+                fclose(fp);
+            }
+        });
+
+        jxc::print("Stream parser benchmark (from FILE*, {} byte window): {}\n", jxc::StreamParser::default_window_size,
+            benchmark_result_to_string(stream_parser_avg_runtime_ns, args.num_iters));
+    }
+
+    {
+        // maps the files on each iteration instead of using file_data
+        const int64_t mapped_parser_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            for (const auto& path : args.files)
+            {
+                jxc::MappedBuffer mapping;
+                JXC_ASSERTF(mapping.open(path), "Failed to map {}", path);
+                jxc::JumpParser parser(mapping);
+                while (parser.next()) {}
+                JXC_ASSERTF(!parser.has_error(), "Parse error: {}", parser.get_error().to_string(parser.get_buffer()));
+            }
+        });
+
+        jxc::print("Mapped file parser benchmark: {}\n", benchmark_result_to_string(mapped_parser_avg_runtime_ns, args.num_iters));
+    }
+
+    {
+        const int64_t index_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            jxc::StructuralIndex index;
+            for (const auto& data : file_data)
+            {
+                index.build(data);
+            }
+        });
+
+        jxc::print("Structural index benchmark (stage 1 only): {}\n", benchmark_result_to_string(index_avg_runtime_ns, args.num_iters));
+
+        // Compares stage 1 against plain JumpParser for each file (eg. canada, citm_catalog, and twitter behave quite
+        // differently). There is no stage 2 to compare - JumpParser only uses the index in skip_value().
+        jxc::print("Structural index per-file benchmark (parser / stage 1):\n");
+        for (size_t i = 0; i < file_data.size(); i++)
+        {
+            const std::string& data = file_data[i];
+            const double data_size_mb = (double)data.size() / 1024.0 / 1024.0;
+            auto ms_and_mb_per_sec = [data_size_mb](int64_t runtime_ns)
+            {
+                return jxc::format("{:.4f} ms ({:.2f} MB/s)", jxc::detail::Timer::ns_to_ms(runtime_ns),
+                    (runtime_ns > 0) ? (data_size_mb / ((double)runtime_ns / 1e9)) : 0.0);
+            };
+
+            const int64_t file_parser_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jump_parser_benchmark(data);
+            });
+
+            const int64_t file_index_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jxc::StructuralIndex index;
+                index.build(data);
+            });
+
+            jxc::print("    {}: {} / {}\n", args.files[i], ms_and_mb_per_sec(file_parser_avg_runtime_ns),
+                ms_and_mb_per_sec(file_index_avg_runtime_ns));
+        }
+
+        // skipping the whole document after its first element is the worst case for skip_value() - all of it gets skipped
+        const int64_t skip_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            for (const auto& data : file_data)
+            {
+                jxc::JumpParser parser(data);
+                if (parser.next())
+                {
+                    JXC_ASSERT(parser.skip_value());
+                }
+            }
+        });
+
+        jxc::print("Skip value benchmark: {}\n", benchmark_result_to_string(skip_avg_runtime_ns, args.num_iters));
+
+        const int64_t two_stage_skip_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            jxc::StructuralIndex index;
+            for (const auto& data : file_data)
+            {
+                index.build(data);
+                jxc::JumpParser parser(data, index);
+                if (parser.next())
+                {
+                    JXC_ASSERT(parser.skip_value());
+                }
+            }
+        });
+
+        jxc::print("Skip value benchmark (with structural index): {}\n", benchmark_result_to_string(two_stage_skip_avg_runtime_ns, args.num_iters));
+    }
+
     {
         const int64_t doc_value_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
         {
@@ -217,6 +738,343 @@ int main(int argc, const char** argv)
         jxc::print("Value parser benchmark: {}\n", benchmark_result_to_string(doc_value_avg_runtime_ns, args.num_iters));
     }
 
+    {
+        // per-file parse time and memory with and without packed numeric arrays (most of canada.jxc is packable)
+        auto parse_file = [&](size_t file_idx, bool pack_numeric_arrays) -> jxc::Value
+        {
+            jxc::ErrorInfo err;
+            jxc::JumpParser parser(file_data[file_idx]);
+            jxc::detail::ValueParser value_parser(parser, err);
+            value_parser.pack_numeric_arrays = pack_numeric_arrays;
+            jxc::Value result = parser.next() ? value_parser.parse(parser.value()) : jxc::Value();
+            JXC_ASSERTF(!parser.has_error() && !err.is_err, "Parse error: {}",
+                parser.has_error() ? parser.get_error().to_string(file_data[file_idx]) : err.to_string(file_data[file_idx]));
+            return result;
+        };
+
+        for (size_t i = 0; i < file_data.size(); i++)
+        {
+            for (const bool pack_numeric_arrays : { true, false })
+            {
+                const int64_t avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+                {
+                    parse_file(i, pack_numeric_arrays);
+                });
+
+                size_t num_allocations = 0;
+                const size_t heap_bytes = parse_file(i, pack_numeric_arrays).get_heap_usage(true, &num_allocations);
+                jxc::print("Value parser benchmark for {} ({} numeric arrays, {} heap bytes in {} allocations): average {:.4f} ms over {} iterations\n",
+                    args.files[i], pack_numeric_arrays ? "packed" : "unpacked", heap_bytes, num_allocations,
+                    jxc::detail::Timer::ns_to_ms(avg_runtime_ns), args.num_iters);
+            }
+        }
+    }
+
+    {
+        // Document parse time with eager and lazy scalars, and with lazy scalars when every value is read afterwards
+        for (const bool lazy_scalars : { false, true })
+        {
+            for (const bool read_all : { false, true })
+            {
+                if (read_all && !lazy_scalars)
+                {
+                    continue;
+                }
+
+                const int64_t avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+                {
+                    for (const std::string& data : file_data)
+                    {
+                        jxc::Document doc{ std::string_view(data) };
+                        doc.set_lazy_scalars(lazy_scalars);
+                        jxc::Value result = doc.parse();
+                        JXC_ASSERTF(!doc.has_error(), "Parse error: {}", doc.get_error().to_string(data));
+                        if (read_all)
+                        {
+                            jxc::ErrorInfo err;
+                            JXC_ASSERTF(result.materialize(err, true), "Parse error: {}", err.to_string(data));
+                        }
+                    }
+                });
+
+                jxc::print("Document parse benchmark ({}): {}\n",
+                    !lazy_scalars ? "eager scalars" : (read_all ? "lazy scalars, all read" : "lazy scalars"),
+                    benchmark_result_to_string(avg_runtime_ns, args.num_iters));
+            }
+        }
+    }
+
+    {
+        // parse every file into a Value tree, then destroy the trees, once with heap allocation and once with an arena
+        for (const bool use_arena : { false, true })
+        {
+            int64_t total_destroy_ns = 0;
+            const int64_t parse_destroy_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                std::optional<jxc::ValueArena> arena;
+                if (use_arena)
+                {
+                    arena.emplace(1024 * 1024);
+                }
+
+                jxc::ErrorInfo err;
+                std::vector<jxc::Value> results;
+                results.reserve(file_data.size());
+                for (const std::string& data : file_data)
+                {
+                    results.push_back(use_arena ? jxc::parse(data, err, *arena) : jxc::parse(data, err));
+                    JXC_ASSERTF(!err.is_err, "Parse error: {}", err.to_string(data));
+                }
+
+                jxc::detail::Timer destroy_timer;
+                results.clear();
+                arena.reset();
+                total_destroy_ns += destroy_timer.elapsed().count();
+            });
+
+            const int64_t destroy_avg_runtime_ns = (args.num_iters > 0) ? total_destroy_ns / args.num_iters : 0;
+            jxc::print("Parse+destroy benchmark ({}, destroy takes {:.4f} ms): {}", use_arena ? "arena" : "heap",
+                jxc::detail::Timer::ns_to_ms(destroy_avg_runtime_ns), benchmark_result_to_string(parse_destroy_avg_runtime_ns, args.num_iters));
+        }
+    }
+
+    {
+        // tape documents are reused across iterations, the same way a long-running reader would reuse them
+        std::vector<jxc::TapeDocument> tape_docs(file_data.size());
+        const int64_t tape_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            for (size_t i = 0; i < file_data.size(); i++)
+            {
+                const bool success = tape_docs[i].parse(file_data[i]);
+                JXC_ASSERTF(success, "Parse error: {}", tape_docs[i].get_error().to_string(file_data[i]));
+            }
+        });
+
+        jxc::print("Tape parser benchmark: {}\n", benchmark_result_to_string(tape_avg_runtime_ns, args.num_iters));
+
+        std::vector<jxc::Value> values;
+        values.reserve(file_data.size());
+        for (size_t i = 0; i < file_data.size(); i++)
+        {
+            jxc::Document doc(file_data[i]);
+            values.push_back(doc.parse());
+            JXC_ASSERTF(!doc.has_error(), "Parse error: {}", doc.get_error().to_string(file_data[i]));
+            jxc::print("Memory usage for {}: tape {} bytes ({} entries), Value tree {} bytes\n", args.files[i],
+                tape_docs[i].get_memory_usage(), tape_docs[i].get_num_entries(), values[i].get_heap_usage(true));
+        }
+
+        size_t tape_num_values = 0;
+        size_t tape_string_bytes = 0;
+        const int64_t tape_traversal_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            tape_num_values = 0;
+            tape_string_bytes = 0;
+            for (const jxc::TapeDocument& doc : tape_docs)
+            {
+                count_values(doc.root(), tape_num_values, tape_string_bytes);
+            }
+        });
+
+        size_t value_num_values = 0;
+        size_t value_string_bytes = 0;
+        const int64_t value_traversal_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            value_num_values = 0;
+            value_string_bytes = 0;
+            for (const jxc::Value& val : values)
+            {
+                count_values(val, value_num_values, value_string_bytes);
+            }
+        });
+
+        // duplicate object keys are collapsed in a Value tree, so the counts only match when there are none
+        jxc::print("Tape traversal benchmark ({} values, {} string bytes): {}", tape_num_values, tape_string_bytes,
+            benchmark_result_to_string(tape_traversal_avg_runtime_ns, args.num_iters));
+        jxc::print("Value traversal benchmark ({} values, {} string bytes): {}", value_num_values, value_string_bytes,
+            benchmark_result_to_string(value_traversal_avg_runtime_ns, args.num_iters));
+    }
+
+    {
+        // thread counts double up to the number of cores
+        const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+        std::vector<size_t> thread_counts;
+        for (size_t num_threads = 1; num_threads < max_threads; num_threads *= 2)
+        {
+            thread_counts.push_back(num_threads);
+        }
+        thread_counts.push_back(max_threads);
+
+        jxc::print("Parallel value parser benchmark:\n");
+        int64_t single_thread_runtime_ns = 0;
+        for (size_t num_threads : thread_counts)
+        {
+            jxc::ParallelParseSettings settings;
+            settings.num_threads = num_threads;
+            settings.min_buffer_size = 0;
+            const int64_t parallel_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jxc::ErrorInfo err;
+                for (const std::string& data : file_data)
+                {
+                    jxc::Value result = jxc::parse_parallel(data, err, settings);
+                    JXC_ASSERTF(!err.is_err, "Parse error: {}", err.to_string(data));
+                }
+            });
+
+            if (num_threads == 1)
+            {
+                single_thread_runtime_ns = parallel_avg_runtime_ns;
+            }
+            const double speedup = (parallel_avg_runtime_ns > 0) ? (double)single_thread_runtime_ns / (double)parallel_avg_runtime_ns : 0.0;
+            jxc::print("    {} threads ({:.2f}x): {}", num_threads, speedup, benchmark_result_to_string(parallel_avg_runtime_ns, args.num_iters));
+        }
+    }
+
+    {
+        // Split the input files into lots of small documents, by breaking up containers until their children are small enough
+        std::vector<std::string_view> message_sources;
+        std::vector<std::string_view> pending(file_data.begin(), file_data.end());
+        while (pending.size() > 0)
+        {
+            const std::string_view source = pending.back();
+            pending.pop_back();
+
+            jxc::JumpParser parser(source);
+            if (!parser.next())
+            {
+                continue;
+            }
+            const jxc::ElementType root_type = parser.value().type;
+            if (source.size() <= 16 * 1024 || (root_type != jxc::ElementType::BeginArray && root_type != jxc::ElementType::BeginObject))
+            {
+                message_sources.push_back(source);
+                continue;
+            }
+
+            while (parser.next())
+            {
+                if (parser.value().type == jxc::ElementType::ObjectKey && !parser.next())
+                {
+                    break;
+                }
+
+                const jxc::Element& ele = parser.value();
+                if (ele.type == jxc::ElementType::EndArray || ele.type == jxc::ElementType::EndObject)
+                {
+                    break;
+                }
+                const size_t start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+                if (!parser.skip_value())
+                {
+                    break;
+                }
+                pending.push_back(source.substr(start_idx, parser.value().token.end_idx - start_idx));
+            }
+        }
+
+        const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+        // batch parsers are kept across iterations, the same way a service would keep one for all its batches
+        jxc::print("Batch parse benchmark (BatchParser::parse_many):\n");
+        for (size_t num_docs : { 10, 100, 1000 })
+        {
+            std::vector<std::string_view> documents;
+            size_t documents_size = 0;
+            for (size_t i = 0; i < num_docs; i++)
+            {
+                documents.push_back(message_sources[i % message_sources.size()]);
+                documents_size += documents.back().size();
+            }
+
+            for (size_t num_threads = 1; num_threads <= max_threads; num_threads = (num_threads < max_threads && num_threads * 2 > max_threads) ? max_threads : num_threads * 2)
+            {
+                jxc::ParseManySettings settings;
+                settings.num_threads = num_threads;
+                jxc::BatchParser batch_parser(settings);
+                std::vector<jxc::ErrorInfo> errors;
+                const int64_t batch_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+                {
+                    std::vector<jxc::Value> results = batch_parser.parse_many(documents, errors);
+                });
+
+                const double runtime_sec = (double)batch_avg_runtime_ns / 1e9;
+                jxc::print("    {} docs ({:.2f} MB), {} threads: {:.0f} docs/sec, {:.2f} MB/s\n", num_docs, (double)documents_size / 1024.0 / 1024.0,
+                    num_threads, (runtime_sec > 0.0) ? (double)num_docs / runtime_sec : 0.0,
+                    (runtime_sec > 0.0) ? (double)documents_size / 1024.0 / 1024.0 / runtime_sec : 0.0);
+            }
+        }
+
+        // the same documents as a single JXC lines buffer, one document per line (documents may still span multiple lines)
+        std::string lines_buffer;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            lines_buffer += message_sources[i % message_sources.size()];
+            lines_buffer += '\n';
+        }
+
+        jxc::print("JXC lines benchmark (1000 docs, {:.2f} MB):\n", (double)lines_buffer.size() / 1024.0 / 1024.0);
+        const int64_t lines_serial_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            std::vector<jxc::Value> results;
+            jxc::LinesReader reader(lines_buffer);
+            jxc::Value val;
+            while (reader.next(val))
+            {
+                results.push_back(std::move(val));
+            }
+            JXC_ASSERTF(!reader.has_error(), "Parse error: {}", reader.get_error().to_string(lines_buffer));
+        });
+        auto lines_result_to_string = [&lines_buffer](int64_t runtime_ns)
+        {
+            const double runtime_sec = (double)runtime_ns / 1e9;
+            return jxc::format("{:.4f} ms, {:.2f} MB/s", jxc::detail::Timer::ns_to_ms(runtime_ns),
+                (runtime_sec > 0.0) ? (double)lines_buffer.size() / 1024.0 / 1024.0 / runtime_sec : 0.0);
+        };
+        jxc::print("    LinesReader: {}\n", lines_result_to_string(lines_serial_avg_runtime_ns));
+
+        for (size_t num_threads = 1; num_threads <= max_threads; num_threads = (num_threads < max_threads && num_threads * 2 > max_threads) ? max_threads : num_threads * 2)
+        {
+            jxc::ParseManySettings settings;
+            settings.num_threads = num_threads;
+            jxc::BatchParser batch_parser(settings);
+            const int64_t lines_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+            {
+                jxc::ErrorInfo err;
+                std::vector<jxc::Value> results = batch_parser.parse_lines(lines_buffer, err);
+                JXC_ASSERTF(!err.is_err, "Parse error: {}", err.to_string(lines_buffer));
+            });
+            jxc::print("    parse_lines, {} threads: {}\n", num_threads, lines_result_to_string(lines_avg_runtime_ns));
+        }
+    }
+
+    if (args.query_path.size() > 0)
+    {
+        jxc::QueryPath query_path;
+        jxc::ErrorInfo query_err;
+        if (!jxc::QueryPath::compile(args.query_path, query_path, query_err))
+        {
+            jxc::print(stderr, "{}\n", query_err.to_string());
+            return 1;
+        }
+
+        size_t num_matches = 0;
+        const int64_t query_avg_runtime_ns = run_benchmark_and_get_average_runtime_ns(args.num_iters, [&]()
+        {
+            num_matches = 0;
+            jxc::ErrorInfo err;
+            for (const std::string& data : file_data)
+            {
+                const bool success = jxc::query(data, query_path, [&num_matches](jxc::Value&&)
+                {
+                    ++num_matches;
+                    return true;
+                }, err);
+                JXC_ASSERTF(success, "Query error: {}", err.to_string(data));
+            }
+        });
+
+        jxc::print("Query benchmark ({}, {} matches): {}\n", args.query_path, num_matches, benchmark_result_to_string(query_avg_runtime_ns, args.num_iters));
+    }
+
 #if COMPARE_AGAINST_NLOHMANN_JSON
     {
         bool all_json_files = true;
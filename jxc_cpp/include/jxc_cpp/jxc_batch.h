@@ -0,0 +1,435 @@
+#pragma once
+#include "jxc_cpp/jxc_document.h"
+#include "jxc_cpp/jxc_converter.h"
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+JXC_BEGIN_NAMESPACE(detail)
+
+// Returns the number of worker threads to use for num_items items. If requested_num_threads is zero, uses std::thread::hardware_concurrency().
+size_t get_num_worker_threads(size_t requested_num_threads, size_t num_items);
+
+// Finds the spans of the records in a JXC lines buffer (see LinesReader), using a StructuralIndex to skip line breaks inside
+// strings and containers. Records are returned as [start, end) offsets, and may be blank or contain only comments.
+// Returns false if the buffer can't be indexed or has unbalanced brackets.
+// A record that fails to parse may just be a value that was split in the wrong place (eg. an annotation followed by a line break),
+// so callers should re-read the buffer with LinesReader to get the real error.
+bool find_line_records(std::string_view buffer, std::vector<std::pair<size_t, size_t>>& out_records);
+
+// Checks that there's a line break between the end of the previous document and the start of the next one in a JXC lines buffer
+bool check_line_separator(std::string_view buffer, size_t prev_document_end_idx, size_t document_start_idx, ErrorInfo& out_error);
+
+// The lexer keeps reading until it finds a null byte, so a view that's part of a larger buffer (eg. `12` out of `123`) would be
+// parsed past its end. Returns the document itself if it's followed by a null byte, otherwise copies it into scratch and returns that.
+// Like the lexer, this reads the byte after the end of the document.
+inline std::string_view get_null_terminated_buffer(std::string_view document, std::string& scratch)
+{
+    if (document.data() != nullptr && document.data()[document.size()] == '\0')
+    {
+        return document;
+    }
+    scratch.assign(document);
+    return std::string_view(scratch);
+}
+
+JXC_END_NAMESPACE(detail)
+
+
+/// Pool of worker threads that spreads items over its workers with work stealing. Each worker starts with an equal share of the
+/// items, then steals items from the other workers once it runs out, so a few slow items don't leave the other threads idle.
+/// The threads are started once and wait between calls to run(), so one pool can handle many small batches.
+/// The calling thread is always worker zero, so a pool with one worker doesn't start any threads.
+/// Only one thread may call run() at a time.
+class WorkerPool
+{
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+    // Zero means std::thread::hardware_concurrency()
+    explicit WorkerPool(size_t num_workers = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t get_num_workers() const;
+
+    // Calls func(worker_idx, item_idx) once for every item in [0, num_items), where worker_idx is less than get_num_workers().
+    // If func throws, the remaining items are skipped and the first exception is rethrown.
+    void run(size_t num_items, const std::function<void(size_t worker_idx, size_t item_idx)>& func);
+};
+
+
+struct ParseManySettings
+{
+    // Number of threads to parse with, including the calling thread. Zero means std::thread::hardware_concurrency().
+    size_t num_threads = 0;
+
+    // Same as the try_return_view argument for jxc::parse()
+    bool try_return_view = false;
+};
+
+
+/// Parses batches of independent documents on a WorkerPool, with one parser per worker that's reused for every document the worker
+/// handles. Keep one around to parse many batches without starting threads or building parsers for each one.
+/// Only one thread may use a BatchParser at a time.
+class BatchParser
+{
+    struct Worker;
+
+    WorkerPool pool;
+    std::vector<std::unique_ptr<Worker>> workers;
+    bool try_return_view = false;
+
+public:
+    explicit BatchParser(const ParseManySettings& settings = ParseManySettings{});
+    ~BatchParser();
+
+    BatchParser(const BatchParser&) = delete;
+    BatchParser& operator=(const BatchParser&) = delete;
+
+    inline size_t get_num_workers() const { return pool.get_num_workers(); }
+
+    /// Returns one Value per document, in the same order. out_errors is resized to match, and documents that fail to parse
+    /// get an invalid Value and have their error in out_errors.
+    /// Documents that aren't followed by a null byte (eg. views into a larger buffer) are copied before parsing, and never
+    /// return views even if try_return_view is set.
+    std::vector<Value> parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors);
+
+    /// Parses every document in a JXC lines buffer (see jxc::parse_lines())
+    std::vector<Value> parse_lines(std::string_view buffer, ErrorInfo& out_error);
+};
+
+
+/// Parses many independent documents on multiple threads, using a BatchParser that only lives for this call.
+/// Returns one Value per document, in the same order. out_errors is resized to match, and documents that fail to parse
+/// get an invalid Value and have their error in out_errors. Documents may be views into a larger buffer (see BatchParser::parse_many()).
+std::vector<Value> parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors,
+    const ParseManySettings& settings = ParseManySettings{});
+
+
+/// Reads newline-delimited documents ("JXC lines") one top-level value at a time, for event streams and logs that store one value per line.
+/// Documents may span multiple lines as long as each one starts on a new line, and blank lines and comments between them are ignored.
+/// The buffer must outlive the reader. Supports range-based for loops over the Values:
+///     jxc::LinesReader reader(buffer);
+///     for (jxc::Value& val : reader) { ... }
+///     if (reader.has_error()) { ... }
+class LinesReader
+{
+    std::string_view buffer;
+    JumpParser parser;
+    ErrorInfo error;
+    detail::ValueParser value_parser;
+    size_t prev_document_end_idx = invalid_idx;
+    size_t num_documents = 0;
+
+public:
+    explicit LinesReader(std::string_view buffer, bool try_return_view = false);
+
+    LinesReader(const LinesReader&) = delete;
+    LinesReader& operator=(const LinesReader&) = delete;
+
+    // Parses the next document into out_value. Returns false at the end of the buffer, or if there was an error.
+    bool next(Value& out_value);
+
+    inline size_t get_num_documents() const { return num_documents; }
+    inline std::string_view get_buffer() const { return buffer; }
+    inline bool has_error() const { return error.is_err; }
+    inline const ErrorInfo& get_error() const { return error; }
+
+    class iterator
+    {
+        LinesReader* reader = nullptr;
+        Value current;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value*;
+        using reference = Value&;
+
+        iterator() = default;
+        explicit iterator(LinesReader* in_reader) : reader(in_reader) { ++(*this); }
+
+        inline Value& operator*() { return current; }
+        inline Value* operator->() { return &current; }
+
+        inline iterator& operator++()
+        {
+            if (reader != nullptr && !reader->next(current))
+            {
+                reader = nullptr;
+            }
+            return *this;
+        }
+
+        inline bool operator==(const iterator& rhs) const { return reader == rhs.reader; }
+        inline bool operator!=(const iterator& rhs) const { return reader != rhs.reader; }
+    };
+
+    inline iterator begin() { return iterator(this); }
+    inline iterator end() { return iterator(); }
+};
+
+
+/// Parses every document in a JXC lines buffer (see LinesReader) on multiple threads, using a BatchParser that only lives for this call.
+/// Record boundaries are found up front with a StructuralIndex, then the records are parsed like jxc::parse_many().
+/// If any document fails to parse, returns an empty list, with the first error in the buffer in out_error (the same error LinesReader would stop at).
+std::vector<Value> parse_lines(std::string_view buffer, ErrorInfo& out_error, const ParseManySettings& settings = ParseManySettings{});
+
+
+JXC_BEGIN_NAMESPACE(conv)
+
+/// Parses batches of independent documents into C++ types on a WorkerPool, like jxc::BatchParser.
+/// Each worker reuses one conv::Parser for every document it handles. Only one thread may use a BatchParser at a time.
+class BatchParser
+{
+    WorkerPool pool;
+    std::vector<conv::Parser> parsers;
+
+    // per-worker copies of documents that aren't followed by a null byte
+    std::vector<std::string> scratch_buffers;
+
+public:
+    // Zero means std::thread::hardware_concurrency()
+    explicit BatchParser(size_t num_threads = 0)
+        : pool(num_threads)
+        , parsers(pool.get_num_workers())
+        , scratch_buffers(pool.get_num_workers())
+    {
+    }
+
+    BatchParser(const BatchParser&) = delete;
+    BatchParser& operator=(const BatchParser&) = delete;
+
+    inline size_t get_num_workers() const { return pool.get_num_workers(); }
+
+    /// Returns one result per document, in the same order. Documents that fail to parse are std::nullopt, with their error in out_errors.
+    /// Documents that aren't followed by a null byte (eg. views into a larger buffer) are copied before parsing.
+    template<typename T>
+    std::vector<std::optional<T>> parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors);
+
+    /// Parses every document in a JXC lines buffer into type T (see conv::parse_lines())
+    template<typename T>
+    std::vector<T> parse_lines(std::string_view buffer);
+};
+
+
+/// Parses many independent documents into type T on multiple threads, like jxc::parse_many().
+/// Returns one result per document, in the same order. Documents that fail to parse are std::nullopt, with their error in out_errors.
+template<typename T>
+std::vector<std::optional<T>> parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors, size_t num_threads = 0)
+{
+    BatchParser batch_parser(detail::get_num_worker_threads(num_threads, documents.size()));
+    return batch_parser.parse_many<T>(documents, out_errors);
+}
+
+
+template<typename T>
+std::vector<std::optional<T>> BatchParser::parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors)
+{
+    std::vector<std::optional<T>> results(documents.size());
+    out_errors.assign(documents.size(), ErrorInfo{});
+
+    // the parsers and scratch buffers are reused for every document on a thread
+    pool.run(documents.size(), [&](size_t worker_idx, size_t doc_idx)
+    {
+        conv::Parser& parser = parsers[worker_idx];
+        parser.reset(detail::get_null_terminated_buffer(documents[doc_idx], scratch_buffers[worker_idx]));
+        try
+        {
+            parser.require_next();
+            results[doc_idx] = parser.parse_value<T>();
+        }
+        catch (const parse_error& err)
+        {
+            ErrorInfo& out_error = out_errors[doc_idx];
+            out_error = err.has_error_info() ? err.get_error() : ErrorInfo(err.what());
+            out_error.get_line_and_col_from_buffer(parser.get_buffer());
+        }
+    });
+
+    return results;
+}
+
+
+/// Reads newline-delimited documents into type T one at a time, like jxc::LinesReader. Throws parse_error if a document fails to parse.
+/// The buffer must outlive the reader.
+template<typename T>
+class LinesReader
+{
+    conv::Parser parser;
+    size_t prev_document_end_idx = invalid_idx;
+    size_t num_documents = 0;
+
+public:
+    explicit LinesReader(std::string_view buffer)
+    {
+        parser.reset(buffer);
+    }
+
+    LinesReader(const LinesReader&) = delete;
+    LinesReader& operator=(const LinesReader&) = delete;
+
+    // Parses the next document into out_value. Returns false at the end of the buffer.
+    bool next(T& out_value)
+    {
+        if (!parser.next())
+        {
+            if (parser.has_error())
+            {
+                ErrorInfo err = parser.get_error();
+                err.get_line_and_col_from_buffer(parser.get_buffer());
+                throw parse_error("Parse error", err);
+            }
+            return false;
+        }
+
+        const Element& ele = parser.value();
+        const size_t start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+        ErrorInfo separator_error;
+        if (!detail::check_line_separator(parser.get_buffer(), prev_document_end_idx, start_idx, separator_error))
+        {
+            throw parse_error(separator_error);
+        }
+
+        out_value = parser.parse_value<T>();
+        if (!parser.is_document_end())
+        {
+            throw parse_error("Unexpected end of stream", start_idx, parser.get_buffer().size());
+        }
+
+        prev_document_end_idx = parser.value().token.end_idx;
+        ++num_documents;
+        return true;
+    }
+
+    inline size_t get_num_documents() const { return num_documents; }
+
+    class iterator
+    {
+        LinesReader* reader = nullptr;
+        T current{};
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        explicit iterator(LinesReader* in_reader) : reader(in_reader) { ++(*this); }
+
+        inline T& operator*() { return current; }
+        inline T* operator->() { return &current; }
+
+        inline iterator& operator++()
+        {
+            if (reader != nullptr && !reader->next(current))
+            {
+                reader = nullptr;
+            }
+            return *this;
+        }
+
+        inline bool operator==(const iterator& rhs) const { return reader == rhs.reader; }
+        inline bool operator!=(const iterator& rhs) const { return reader != rhs.reader; }
+    };
+
+    inline iterator begin() { return iterator(this); }
+    inline iterator end() { return iterator(); }
+};
+
+
+/// Parses every document in a JXC lines buffer into type T on multiple threads, like jxc::parse_lines().
+/// Throws parse_error for the first document in the buffer that fails to parse (the same error LinesReader would throw).
+template<typename T>
+std::vector<T> parse_lines(std::string_view buffer, size_t num_threads = 0)
+{
+    BatchParser batch_parser(num_threads);
+    return batch_parser.parse_lines<T>(buffer);
+}
+
+
+template<typename T>
+std::vector<T> BatchParser::parse_lines(std::string_view buffer)
+{
+    auto read_lines_serial = [buffer]()
+    {
+        std::vector<T> result;
+        T value{};
+        for (LinesReader<T> reader(buffer); reader.next(value);)
+        {
+            result.push_back(std::move(value));
+        }
+        return result;
+    };
+
+    // indexing the records is only worth it if they can be parsed in parallel
+    std::vector<std::pair<size_t, size_t>> records;
+    if (pool.get_num_workers() == 1 || !detail::find_line_records(buffer, records))
+    {
+        return read_lines_serial();
+    }
+
+    std::vector<std::optional<T>> record_values(records.size());
+    std::vector<ErrorInfo> record_errors(records.size());
+    pool.run(records.size(), [&](size_t worker_idx, size_t record_idx)
+    {
+        conv::Parser& parser = parsers[worker_idx];
+        const auto [start_idx, end_idx] = records[record_idx];
+        parser.reset(buffer.substr(start_idx, end_idx - start_idx));
+        try
+        {
+            if (parser.next())
+            {
+                record_values[record_idx] = parser.parse_value<T>();
+                const size_t value_end_idx = parser.value().token.end_idx;
+                if (parser.next())
+                {
+                    // records are split at every line break outside of a value, so this is always missing its line break
+                    const Element& ele = parser.value();
+                    const size_t next_start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+                    detail::check_line_separator(parser.get_buffer(), value_end_idx, next_start_idx, record_errors[record_idx]);
+                }
+            }
+            if (!record_errors[record_idx].is_err && parser.has_error())
+            {
+                record_errors[record_idx] = parser.get_error();
+            }
+        }
+        catch (const parse_error& err)
+        {
+            record_errors[record_idx] = err.has_error_info() ? err.get_error() : ErrorInfo(err.what());
+        }
+    });
+
+    std::vector<T> result;
+    result.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (record_errors[i].is_err)
+        {
+            return read_lines_serial();
+        }
+        else if (record_values[i].has_value())
+        {
+            result.push_back(std::move(*record_values[i]));
+        }
+    }
+    return result;
+}
+
+JXC_END_NAMESPACE(conv)
+
+JXC_END_NAMESPACE(jxc)
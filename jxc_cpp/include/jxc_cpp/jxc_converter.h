@@ -178,6 +178,9 @@ private:
     std::string source;
 
 public:
+    // Creates a parser with no buffer. Call reset() to parse a buffer without copying it.
+    Parser() = default;
+
     Parser(std::string_view jxc_source)
         : JumpParser()
         , source(std::string(jxc_source))
@@ -187,6 +190,12 @@ public:
         reset(source);
     }
 
+    // Parses directly from a memory-mapped file without copying it. The MappedBuffer must outlive the Parser.
+    explicit Parser(const MappedBuffer& jxc_source)
+        : JumpParser(jxc_source.get_view())
+    {
+    }
+
     template<typename T>
     inline T parse_value(TokenView generic_annotation = TokenView())
     {
@@ -202,6 +211,15 @@ public:
         }
     }
 
+    // skips over the current value (see JumpParser::skip_value), throwing a parse_error if that fails
+    inline void require_skip_value()
+    {
+        if (!skip_value())
+        {
+            throw parse_error("Failed skipping value", get_error());
+        }
+    }
+
     template<typename T, typename Lambda>
     inline int require(T actual, T expected, const char* type_desc, Lambda&& to_string_callback) const
     {
@@ -400,8 +418,8 @@ public:
         }
 
         T result = static_cast<T>(0);
-        std::string suffix;
-        if (!util::parse_number_simple<T>(token, result, error, &suffix))
+        std::string_view suffix;
+        if (!util::parse_number_simple<T, std::string_view>(token, result, error, &suffix))
         {
             throw parse_error("Failed parsing number", error);
         }
@@ -427,8 +445,8 @@ public:
         }
 
         T result = static_cast<T>(0);
-        std::string suffix;
-        if (!util::parse_number_simple<T>(token, result, error, &suffix))
+        std::string_view suffix;
+        if (!util::parse_number_simple<T, std::string_view>(token, result, error, &suffix))
         {
             throw parse_error("Failed parsing number", error);
         }
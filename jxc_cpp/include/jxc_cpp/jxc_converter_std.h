@@ -12,6 +12,7 @@
 #include <memory>
 #include <bitset>
 #include <filesystem>
+#include <chrono>
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -46,6 +47,28 @@ void parse_array(conv::Parser& parser, const char* array_type, TokenView value_a
     throw parse_error(jxc::format("Unexpected end of stream while parsing {}", array_type));
 }
 
+// Parses an array of numbers straight into a container, instead of going through Converter<T> for each item
+template<typename T, typename Container>
+void parse_number_array(conv::Parser& parser, const char* array_type, Container& out_items)
+{
+    parser.require(ElementType::BeginArray);
+    ErrorInfo err;
+    while (parser.next())
+    {
+        if (parser.value().type == ElementType::EndArray)
+        {
+            return;
+        }
+        parser.require(TokenType::Number);
+        T& item = out_items.emplace_back(static_cast<T>(0));
+        if (!util::parse_number_simple<T>(parser.value().token, item, err))
+        {
+            throw parse_error(jxc::format("Failed to parse number in {}", array_type), err);
+        }
+    }
+    throw parse_error(jxc::format("Unexpected end of stream while parsing {}", array_type));
+}
+
 template<typename T, typename KT, typename VT>
 void serialize_map(Serializer& doc, const T& value, const TokenList& annotation)
 {
@@ -236,9 +259,36 @@ struct Converter<std::vector<T>>
         return anno;
     }
 
+    // numbers don't use item annotations, so arrays of them can skip the per-item converter
+    static constexpr bool is_number_array = (std::integral<T> || std::floating_point<T>) && !std::same_as<T, bool>;
+
     static void serialize(Serializer& doc, const value_type& value)
     {
-        conv::serialize_array(doc, value, get_annotation());
+        if constexpr (is_number_array)
+        {
+            get_annotation().serialize(doc);
+            doc.array_begin();
+            for (T item : value)
+            {
+                if constexpr (std::floating_point<T>)
+                {
+                    doc.value_float(static_cast<double>(item));
+                }
+                else if constexpr (std::signed_integral<T>)
+                {
+                    doc.value_int(static_cast<int64_t>(item));
+                }
+                else
+                {
+                    doc.value_uint(static_cast<uint64_t>(item));
+                }
+            }
+            doc.array_end();
+        }
+        else
+        {
+            conv::serialize_array(doc, value, get_annotation());
+        }
     }
 
     static value_type parse(conv::Parser& parser, TokenView generic_anno)
@@ -261,11 +311,18 @@ struct Converter<std::vector<T>>
             anno_parser.done_required();
         }
 
-        conv::parse_array<T>(parser, "std::vector", TokenView(value_anno),
-            [&result](T&& item)
-            {
-                result.push_back(std::forward<T>(item));
-            });
+        if constexpr (is_number_array)
+        {
+            conv::parse_number_array<T>(parser, "std::vector", result);
+        }
+        else
+        {
+            conv::parse_array<T>(parser, "std::vector", TokenView(value_anno),
+                [&result](T&& item)
+                {
+                    result.push_back(std::forward<T>(item));
+                });
+        }
 
         return result;
     }
@@ -742,4 +799,41 @@ struct Converter<std::filesystem::path>
     }
 };
 
+
+// std::chrono::sys_time (any duration) is stored as a UTC datetime.
+// Datetimes in the common fixed layouts (see util::parse_datetime_token_to_epoch) are parsed straight to a Unix
+// timestamp without building a DateTime. Other layouts go through a DateTime.
+template<typename Duration>
+struct Converter<std::chrono::time_point<std::chrono::system_clock, Duration>>
+{
+    using value_type = std::chrono::time_point<std::chrono::system_clock, Duration>;
+
+    static const TokenList& get_annotation()
+    {
+        static const TokenList anno = TokenList::from_identifier("datetime");
+        return anno;
+    }
+
+    static void serialize(Serializer& doc, const value_type& value)
+    {
+        const auto seconds = std::chrono::floor<std::chrono::seconds>(value);
+        const auto nanosecond = std::chrono::duration_cast<std::chrono::nanoseconds>(value - seconds);
+        doc.value_datetime(epoch_seconds_to_datetime(seconds.time_since_epoch().count(), static_cast<uint32_t>(nanosecond.count())));
+    }
+
+    static value_type parse(conv::Parser& parser, TokenView /*generic_anno*/)
+    {
+        parser.require(TokenType::DateTime);
+        int64_t seconds = 0;
+        uint32_t nanosecond = 0;
+        ErrorInfo err;
+        if (!util::parse_datetime_token_to_epoch(parser.value().token, seconds, nanosecond, err))
+        {
+            throw parse_error("Failed to parse datetime", err);
+        }
+        return value_type(std::chrono::floor<Duration>(std::chrono::seconds(seconds))
+            + std::chrono::floor<Duration>(std::chrono::nanoseconds(nanosecond)));
+    }
+};
+
 JXC_END_NAMESPACE(jxc)
@@ -69,6 +69,9 @@ enum class StructFlags : uint8_t
 
     // Don't use line breaks when serializing the object
     SingleLine = 1 << 1,
+
+    // When parsing, skip over fields that aren't defined in the struct (and aren't handled by def_extra) instead of throwing a parse_error
+    IgnoreUnknownFields = 1 << 2,
 };
 
 JXC_BITMASK_ENUM(StructFlags);
@@ -135,7 +138,7 @@ FieldParseFunc<T> make_default_parse_func(FieldType T::* field_ptr)
 
     if constexpr (ConverterWithParse<FieldType>)
     {
-        return [field_ptr](conv::Parser& parser, const std::string& field_key, T& out_value)
+        return [field_ptr](conv::Parser& parser, const std::string&, T& out_value)
         {
             out_value.*field_ptr = parser.parse_value<FieldType>();
         };
@@ -488,6 +491,11 @@ public:
                 {
                     use_extra = true;
                 }
+                else if (is_set(flags, StructFlags::IgnoreUnknownFields))
+                {
+                    parser.require_skip_value();
+                    continue;
+                }
                 else
                 {
                     throw parse_error(jxc::format("Type {} has no such field {}", struct_annotation, key), parser.value());
@@ -2,8 +2,12 @@
 #include "jxc_cpp/jxc_map.h"
 #include "jxc_cpp/jxc_value.h"
 #include "jxc_cpp/jxc_document.h"
+#include "jxc_cpp/jxc_query.h"
 #include "jxc_cpp/jxc_converter.h"
 #include "jxc_cpp/jxc_converter_std.h"
 #include "jxc_cpp/jxc_converter_value.h"
+#include "jxc_cpp/jxc_batch.h"
+#include "jxc_cpp/jxc_record_index.h"
+#include "jxc_cpp/jxc_tape.h"
 #include "jxc_cpp/jxc_converter_enum.h"
 #include "jxc_cpp/jxc_converter_struct.h"
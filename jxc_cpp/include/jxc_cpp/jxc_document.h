@@ -5,6 +5,8 @@
 #include "jxc_cpp/jxc_map.h"
 #include "jxc_cpp/jxc_value.h"
 #include <vector>
+#include <memory>
+#include <functional>
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -53,14 +55,53 @@ struct ValueParser
     bool try_return_view = false;
     MakeValueFunc make_value_callback;
 
+    // The parser reuses its annotation buffer for every element, so annotations can only be stored as views if
+    // make_value_callback replaces them with ones that outlive the parser (like Document does)
+    bool annotations_as_view = false;
+
+    // Store arrays whose items are all floats, or all integers, with no number suffixes or annotations as packed buffers
+    // (see Value::is_packed_array()). Off by default, because reading items by reference expands the array, even through a const Value.
+    bool pack_numeric_arrays = false;
+
+    // Create strings and numbers as lazy values that point at their token in the parser's buffer, and only parse the token when
+    // the value is first read (see Value::is_lazy()). The buffer must outlive the returned values. Object keys, heredoc strings,
+    // and integers that might not fit in an int64 are always parsed.
+    bool lazy_scalars = false;
+
+    // Memory that arrays, objects, owned strings and bytes, and owned annotations are allocated from. Defaults to the heap.
+    // Lazy values are materialized to the heap.
+    ValueMemory memory;
+
+    // Optional statistics collection. Heap usage is recorded for every Value this parser creates.
+    // Set this on the JumpParser as well (see JumpParser::set_stats) to also collect element stats.
+    ParseStats* stats = nullptr;
+
 private:
+    // Array items and object keys/values are collected here until their container ends, so each container can be
+    // allocated once at its final size. Nested containers use the same stack above their parent's items.
+    std::vector<Value> item_stack;
+
+    // strings and bytes too long to store inline are allocated from memory
+    template<typename T>
+    static inline Value construct_value(const T& val, const ValueMemory& memory)
+    {
+        if constexpr (traits::StringContainer<T> || traits::Bytes<T>)
+        {
+            return Value(val, memory);
+        }
+        else
+        {
+            return Value(val);
+        }
+    }
+
     template<typename T>
     inline Value make_value_internal(const T& val, TokenView anno)
     {
-        Value result(val);
+        Value result = construct_value(val, memory);
         if (anno)
         {
-            result.set_annotation(anno, try_return_view);
+            result.set_annotation(anno, annotations_as_view, memory);
         }
         return result;
     }
@@ -71,16 +112,26 @@ private:
         Value result(val, number_suffix);
         if (anno)
         {
-            result.set_annotation(anno, try_return_view);
+            result.set_annotation(anno, annotations_as_view, memory);
         }
         return result;
     }
 
+    inline void record_value_stats(const Value& val)
+    {
+        if (stats != nullptr)
+        {
+            stats->value_heap_bytes += val.get_heap_usage(false, &stats->value_heap_allocations);
+        }
+    }
+
     inline Value parse_value_internal(const Element& ele)
     {
-        return make_value_callback
+        Value result = make_value_callback
             ? make_value_callback(*this, ele.type, ele.token, ele.annotation)
             : parse_value(ele.type, ele.token, ele.annotation);
+        record_value_stats(result);
+        return result;
     }
 
 public:
@@ -92,6 +143,10 @@ public:
     {
     }
 
+    // Converts a token to a Value without an annotation. Returns an invalid value on error.
+    static Value make_number(const Token& tok, ErrorInfo& out_error);
+    static Value make_string(const Token& tok, bool try_return_view, ErrorInfo& out_error, const ValueMemory& memory = ValueMemory());
+
     Value parse_number(const Token& tok, TokenView annotation);
     Value parse_bool(const Token& tok, TokenView annotation);
     Value parse_null(const Token& tok, TokenView annotation);
@@ -110,20 +165,68 @@ public:
 JXC_END_NAMESPACE(detail)
 
 
+/// A Value returned from Document::parse_with_keep_alive(), together with the Document storage it may point into (the
+/// buffer and annotation cache). The Value stays valid for as long as this object does, even after the Document is destroyed.
+/// Copies share the same storage.
+struct ParsedValue
+{
+    // declared before value so that it's destroyed after it
+    std::shared_ptr<const void> keep_alive;
+    Value value;
+
+    inline Value& operator*() { return value; }
+    inline const Value& operator*() const { return value; }
+    inline Value* operator->() { return &value; }
+    inline const Value* operator->() const { return &value; }
+};
+
+
 class Document
 {
     friend class Value;
 
 private:
-    std::string buffer;
+    // Everything that Values returned from parse() can point into. This is shared so that those Values can
+    // outlive the Document (see get_keep_alive()).
+    struct Storage
+    {
+        // owns the buffer, if the Document owns it at all (it doesn't when parsing from a MappedBuffer)
+        std::shared_ptr<const void> buffer_owner;
+        StringMap<std::vector<Token>> annotation_cache;
+    };
+
+    std::shared_ptr<Storage> storage;
+    std::string_view buffer;
     JumpParser parser;
     ErrorInfo err;
+    detail::ValueMemory memory;
+    bool lazy_scalars = false;
+    bool pack_numeric_arrays = false;
 
-    StringMap<std::vector<Token>> annotation_cache;
+    Document(std::shared_ptr<const void>&& in_buffer_owner, std::string_view in_buffer);
 
 public:
+    // Copies in_buffer into a buffer owned by the Document
     explicit Document(std::string_view in_buffer);
 
+    // Copies a null-terminated string into a buffer owned by the Document (without this, string literals would be
+    // ambiguous between the std::string_view and std::string&& constructors)
+    explicit Document(const char* in_buffer);
+
+    // Takes ownership of an existing string without copying it
+    explicit Document(std::string&& in_buffer);
+
+    // Shares ownership of an existing buffer without copying it
+    Document(std::shared_ptr<const char[]> in_buffer, size_t in_buffer_len);
+
+    // Takes ownership of an existing buffer without copying it. The deleter is called with in_buffer once the Document
+    // and all handles returned from get_keep_alive() have been destroyed.
+    Document(const char* in_buffer, size_t in_buffer_len, std::function<void(const char*)> deleter);
+
+    // Parses directly from a memory-mapped file without copying it. The MappedBuffer must outlive the Document
+    // and any Values parsed from it.
+    explicit Document(const MappedBuffer& in_buffer);
+
 private:
     // Makes a deduplicated copy of an annotation that's owned by this Document, then returns
     // a new TokenView pointing to our local copy.
@@ -137,11 +240,44 @@ private:
     bool advance();
 
 public:
+    // Strings, bytes, and annotations in the returned Value may be views into the Document's buffer and annotation cache,
+    // so the Value is only valid while the Document (or a handle from get_keep_alive()) exists.
     Value parse();
 
+    // Same as parse(), but returns the Value bundled with get_keep_alive(), so it can't outlive the storage it points into.
+    // When parsing from a MappedBuffer, the MappedBuffer itself must still outlive the Value.
+    ParsedValue parse_with_keep_alive();
+
     Value parse_to_owned();
 
-    const std::string& get_buffer() const { return buffer; }
+    // NB. This returns a view rather than `const std::string&` (as it did before), because the buffer isn't always a
+    // std::string - the Document can adopt a shared buffer, a buffer with a custom deleter, or a MappedBuffer.
+    // Callers that need a std::string must copy it, eg. `std::string(doc.get_buffer())`.
+    std::string_view get_buffer() const { return buffer; }
+
+    // Allocates values returned from parse() and parse_to_owned() from a memory resource (eg. ValueArena::get_resource())
+    // instead of the heap. The resource must outlive those values. nullptr uses the heap.
+    inline void set_memory_resource(std::pmr::memory_resource* resource) { memory = detail::ValueMemory::from_resource(resource); }
+    inline void set_memory_resource(ValueArena& arena) { memory = arena.get_memory(); }
+    inline std::pmr::memory_resource* get_memory_resource() const { return memory.resource; }
+
+    // Strings and numbers in values returned from parse() are left unparsed until they're first read (see Value::is_lazy()).
+    // Errors in strings are found when they're read instead of by parse() - use Value::materialize() to check for them.
+    // Reading a lazy value modifies it, so values from parse() must not be read from multiple threads at once until they've been
+    // materialized. Off by default. parse_to_owned() ignores this.
+    inline void set_lazy_scalars(bool enabled) { lazy_scalars = enabled; }
+    inline bool get_lazy_scalars() const { return lazy_scalars; }
+
+    // Arrays of plain floats or plain integers in values returned from parse() and parse_to_owned() are stored as packed
+    // buffers (see Value::is_packed_array()). Reading their items by reference expands them, even through a const Value, so values
+    // from parse() must not be read from multiple threads at once until their packed arrays have been expanded. Off by default.
+    inline void set_pack_numeric_arrays(bool enabled) { pack_numeric_arrays = enabled; }
+    inline bool get_pack_numeric_arrays() const { return pack_numeric_arrays; }
+
+    // Values returned from parse() may be views into the Document's buffer and annotation cache. Holding onto the
+    // returned handle keeps both alive after the Document is destroyed, so those Values stay valid as long as the handle does.
+    // parse_with_keep_alive() returns this handle along with the Value.
+    inline std::shared_ptr<const void> get_keep_alive() const { return storage; }
 
     inline bool has_error() const { return err.is_err; }
 
@@ -152,7 +288,8 @@ public:
 
 /// Standalone parsing function. If a parse error occurs, returns an invalid value.
 /// Returns the parse error (if any) in out_error.
-/// This function always returns a fully owned Value.
+/// Returns a fully owned Value, unless try_return_view is true - then strings and bytes that don't need unescaping may be
+/// views into jxc_string (which can be a MappedBuffer), so jxc_string must outlive the returned Value.
 Value parse(std::string_view jxc_string, ErrorInfo& out_error, bool try_return_view = false);
 
 
@@ -165,6 +302,32 @@ inline Value parse(std::string_view jxc_string, bool try_return_view = false)
 }
 
 
+/// Same as jxc::parse(), but every array, object, and owned string or bytes value in the result is allocated from an arena,
+/// so the whole tree is freed at once when the arena is released. The arena must outlive the returned Value.
+/// Copy the result (or any part of it) to get a heap-allocated Value that doesn't depend on the arena.
+Value parse(std::string_view jxc_string, ErrorInfo& out_error, ValueArena& arena, bool try_return_view = false);
+
+
+struct ParallelParseSettings
+{
+    // Number of threads to parse with, including the calling thread. Zero means std::thread::hardware_concurrency().
+    size_t num_threads = 0;
+
+    // Buffers smaller than this are always parsed on the calling thread, because starting threads would cost more than it saves.
+    size_t min_buffer_size = 1024 * 1024;
+
+    // Same as the try_return_view argument for jxc::parse()
+    bool try_return_view = false;
+};
+
+
+/// Parses a document using multiple threads. Returns the same value as jxc::parse().
+/// Large arrays and objects are split up into child values using the structural index, which are then parsed on separate threads
+/// and merged back together. Documents that can't be split (eg. a small document, or one that's mostly a single string) are parsed serially.
+/// If the document has any errors, it's parsed again serially so that errors are reported exactly the same as jxc::parse().
+Value parse_parallel(std::string_view jxc_string, ErrorInfo& out_error, const ParallelParseSettings& settings = ParallelParseSettings{});
+
+
 /// Standalone serialization function.
 /// Serializes a Value into a jxc string, using the specified serializer settings.
 std::string serialize(const Value& val, const SerializerSettings& settings = SerializerSettings{});
@@ -0,0 +1,80 @@
+#pragma once
+#include "jxc_cpp/jxc_document.h"
+#include <functional>
+#include <vector>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+
+// A compiled path for jxc::query(), eg. `servers[*].listen.port`.
+// Paths are a list of object keys separated by periods, and array indices in square brackets.
+// - Unquoted keys may contain `*`, which matches any run of characters (so `*` on its own matches every key).
+//   This is the same `*` syntax that identifier object keys allow, so a key like `a*` in a document is also matched by the path `a*`.
+// - Keys containing periods, brackets, or asterisks that should be matched literally can be quoted with single or double quotes.
+// - `[N]` matches the array element at index N, and `[*]` matches every array element.
+// - An empty path matches the document's root value.
+class QueryPath
+{
+public:
+    enum class SegmentType : uint8_t
+    {
+        Key = 0,
+        KeyPattern,
+        AnyKey,
+        Index,
+        AnyIndex,
+    };
+
+    struct Segment
+    {
+        SegmentType type = SegmentType::Key;
+        std::string key;
+        size_t index = 0;
+
+        inline bool is_key() const { return type == SegmentType::Key || type == SegmentType::KeyPattern || type == SegmentType::AnyKey; }
+        inline bool is_index() const { return type == SegmentType::Index || type == SegmentType::AnyIndex; }
+
+        bool matches_key(std::string_view object_key) const;
+
+        inline bool matches_index(size_t array_index) const { return type == SegmentType::AnyIndex || (type == SegmentType::Index && array_index == index); }
+    };
+
+private:
+    std::string source;
+    std::vector<Segment> segments;
+
+public:
+    QueryPath() = default;
+
+    // Compiles a path string. Returns false and sets out_error if the path is invalid.
+    static bool compile(std::string_view path, QueryPath& out_path, ErrorInfo& out_error);
+
+    inline const std::string& get_source() const { return source; }
+    inline size_t size() const { return segments.size(); }
+    inline const Segment& operator[](size_t idx) const { JXC_DEBUG_ASSERT(idx < segments.size()); return segments[idx]; }
+};
+
+
+/// Streams through a JXC buffer with JumpParser and calls on_match with each value that matches the path, in document order.
+/// Only matching values are converted to Values - everything else is skipped with JumpParser::skip_value().
+/// Return false from on_match to stop the query early.
+/// Returns false if a parse error occurs, with the error in out_error.
+bool query(std::string_view jxc_string, const QueryPath& path, const std::function<bool(Value&&)>& on_match, ErrorInfo& out_error);
+
+
+/// Returns all values in a JXC buffer that match the path (see QueryPath for the path syntax).
+/// If the path is invalid or a parse error occurs, returns an empty list. Returns the error (if any) in out_error.
+std::vector<Value> query(std::string_view jxc_string, std::string_view path, ErrorInfo& out_error);
+
+
+/// Returns all values in a JXC buffer that match the path (see QueryPath for the path syntax).
+/// If the path is invalid or a parse error occurs, returns an empty list.
+inline std::vector<Value> query(std::string_view jxc_string, std::string_view path)
+{
+    ErrorInfo err;
+    return jxc::query(jxc_string, path, err);
+}
+
+
+JXC_END_NAMESPACE(jxc)
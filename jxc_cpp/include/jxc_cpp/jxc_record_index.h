@@ -0,0 +1,181 @@
+#pragma once
+#include "jxc_cpp/jxc_document.h"
+#include "jxc_cpp/jxc_converter.h"
+#include <optional>
+#include <vector>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+
+// Which values in a buffer count as records
+enum class RecordLayout : uint8_t
+{
+    // each element of a top-level array, eg. `[ {...}, {...} ]`
+    ArrayElements = 0,
+
+    // each top-level value, eg. a JXC lines buffer (see LinesReader)
+    Documents,
+};
+
+
+// Byte offsets of every record in a large JXC buffer, so any one record can be parsed without parsing everything before it.
+// Indexes can be saved to a compact binary sidecar file next to the source file, and checked against the source later to detect
+// stale sidecars (see matches_file_stat() and matches_content()).
+//
+// If key_field is set, each record that is an object also stores a hash of that field's value, for looking up records by key.
+// String keys are hashed by their parsed value, and other scalar keys by their source text (eg. `42` or `true`).
+class RecordIndex
+{
+public:
+    struct Record
+    {
+        uint64_t start_idx = 0;
+        uint64_t end_idx = 0;
+        uint64_t key_hash = 0;
+
+        inline bool operator==(const Record& rhs) const { return start_idx == rhs.start_idx && end_idx == rhs.end_idx && key_hash == rhs.key_hash; }
+        inline bool operator!=(const Record& rhs) const { return !operator==(rhs); }
+    };
+
+    // Bumped whenever the sidecar file format changes. Sidecars with a different version fail to load.
+    static constexpr uint32_t file_format_version = 1;
+
+private:
+    RecordLayout layout = RecordLayout::ArrayElements;
+    std::string key_field;
+    uint64_t source_size = 0;
+    int64_t source_modified_time = 0;
+    uint64_t source_content_hash = 0;
+    std::vector<Record> records;
+
+    // record indices sorted by key_hash
+    std::vector<size_t> key_order;
+
+    void build_key_order();
+
+public:
+    RecordIndex() = default;
+
+    // Indexes every record in a buffer. Only record boundaries are parsed - the contents of each record are skipped with
+    // JumpParser::skip_value(), apart from the key field if there is one.
+    // Call set_source_file_stat() afterwards if the index will be checked with matches_file_stat().
+    static bool build(std::string_view buffer, RecordLayout layout, std::string_view key_field, RecordIndex& out_index, ErrorInfo& out_error);
+
+    // Hashes a key the same way build() does. Returns 0 for records with no key.
+    static uint64_t hash_key(std::string_view key);
+
+    // Reads the value of a top-level object key in a record. Returns false if the record isn't an object, if it has no such key,
+    // or if the key's value is not a scalar.
+    static bool get_record_key(std::string_view record_source, std::string_view key_field, std::string& out_key);
+
+    // Records the size and modified time of the file the index was built from, for matches_file_stat()
+    bool set_source_file_stat(const std::string& source_path, std::string* out_error = nullptr);
+
+    bool save(const std::string& index_path, std::string* out_error = nullptr) const;
+    bool load(const std::string& index_path, std::string* out_error = nullptr);
+
+    // Cheap staleness check - true if the source file still has the size and modified time it had when the index was built
+    bool matches_file_stat(const std::string& source_path) const;
+
+    // Thorough staleness check - true if the buffer has the same size and content hash as the one the index was built from
+    bool matches_content(std::string_view source_buffer) const;
+
+    inline RecordLayout get_layout() const { return layout; }
+    inline const std::string& get_key_field() const { return key_field; }
+    inline uint64_t get_source_size() const { return source_size; }
+    inline size_t size() const { return records.size(); }
+    inline const Record& operator[](size_t idx) const { JXC_DEBUG_ASSERT(idx < records.size()); return records[idx]; }
+
+    inline std::string_view get_record_source(std::string_view source_buffer, size_t idx) const
+    {
+        const Record& rec = records[idx];
+        JXC_ASSERTF(rec.end_idx <= source_buffer.size(), "Record {} is outside the source buffer (is the index stale?)", idx);
+        return source_buffer.substr(static_cast<size_t>(rec.start_idx), static_cast<size_t>(rec.end_idx - rec.start_idx));
+    }
+
+    // Returns the indices of all records whose key hash matches the key. Hashes can collide, so use get_record_key() to check each one.
+    std::vector<size_t> find_key_candidates(std::string_view key) const;
+};
+
+
+struct RecordFileSettings
+{
+    RecordLayout layout = RecordLayout::ArrayElements;
+    std::string key_field;
+
+    // Path to the sidecar index file. Defaults to the source path with `.jxcidx` appended.
+    std::string index_path;
+
+    // Check the sidecar against a hash of the whole file instead of its size and modified time
+    bool verify_content_hash = false;
+
+    // If the sidecar is missing, stale, or was built with different settings, rebuild it (and save it if save_rebuilt_index is set).
+    // Otherwise open() fails.
+    bool rebuild_if_stale = true;
+    bool save_rebuilt_index = true;
+};
+
+
+// A memory-mapped JXC record file with a sidecar RecordIndex, for parsing individual records without reading the whole file.
+// Records are parsed by resetting a single JumpParser to the record's slice of the mapped buffer.
+class RecordFile
+{
+    MappedBuffer file;
+    RecordIndex index;
+    JumpParser parser;
+    ErrorInfo parse_error;
+    detail::ValueParser value_parser;
+    bool index_was_rebuilt = false;
+
+    // Shifts the offsets of an error from parsing record idx so they're relative to the start of the file
+    void record_error_to_file_error(size_t idx, ErrorInfo& err) const;
+
+public:
+    RecordFile();
+
+    RecordFile(const RecordFile&) = delete;
+    RecordFile& operator=(const RecordFile&) = delete;
+
+    // Maps the source file and loads its sidecar index, rebuilding it if needed (see RecordFileSettings)
+    bool open(const std::string& source_path, const RecordFileSettings& settings, ErrorInfo& out_error);
+
+    void close();
+
+    inline bool is_open() const { return file.is_open(); }
+    inline bool was_index_rebuilt() const { return index_was_rebuilt; }
+    inline const RecordIndex& get_index() const { return index; }
+    inline std::string_view get_buffer() const { return file.get_view(); }
+    inline size_t size() const { return index.size(); }
+
+    inline std::string_view get_record_source(size_t idx) const { return index.get_record_source(file.get_view(), idx); }
+
+    // Parses a single record. Error offsets are relative to the start of the file.
+    bool read(size_t idx, Value& out_value, ErrorInfo& out_error);
+
+    // Parses a single record into type T. Throws parse_error if the record fails to parse. Error offsets are relative
+    // to the start of the file.
+    template<typename T>
+    T read(size_t idx)
+    {
+        conv::Parser record_parser;
+        record_parser.reset(get_record_source(idx));
+        try
+        {
+            record_parser.require_next();
+            return record_parser.parse_value<T>();
+        }
+        catch (const jxc::parse_error& e)
+        {
+            ErrorInfo err = e.get_error();
+            record_error_to_file_error(idx, err);
+            throw jxc::parse_error(err);
+        }
+    }
+
+    // Returns the index of the first record whose key field equals key, if there is one
+    std::optional<size_t> find(std::string_view key) const;
+};
+
+
+JXC_END_NAMESPACE(jxc)
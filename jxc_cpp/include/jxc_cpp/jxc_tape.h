@@ -0,0 +1,321 @@
+#pragma once
+#include "jxc_cpp/jxc_value.h"
+#include "jxc_cpp/jxc_document.h"
+#include <vector>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+
+enum class TapeType : uint8_t
+{
+    Invalid = 0,
+    Null,
+    Bool,
+    SignedInteger,
+    UnsignedInteger,
+    Float,
+    String,
+    Bytes,
+    DateTime,
+    Expression,
+    Annotation,
+    BeginArray,
+    EndArray,
+    BeginObject,
+    EndObject,
+};
+
+
+const char* tape_type_to_string(TapeType type);
+
+
+class TapeDocument;
+
+
+// Lightweight read-only handle to one value in a TapeDocument. Cursors are two words and cheap to copy.
+// A cursor is only valid while its TapeDocument is alive and hasn't been re-parsed.
+class TapeCursor
+{
+    friend class TapeDocument;
+
+    const TapeDocument* doc = nullptr;
+
+    // index of the value's first tape entry (its annotation, if it has one)
+    size_t start_idx = invalid_idx;
+
+    TapeCursor(const TapeDocument* doc, size_t start_idx) : doc(doc), start_idx(start_idx) {}
+
+    inline uint64_t entry(size_t offset = 0) const;
+    inline uint64_t payload(size_t offset = 0) const;
+    inline bool has_annotation() const;
+    inline size_t value_idx() const { return has_annotation() ? start_idx + 2 : start_idx; }
+    inline size_t end_idx() const;
+
+    std::string_view get_source_span(size_t idx) const;
+
+public:
+    TapeCursor() = default;
+
+    inline bool is_valid() const { return doc != nullptr && start_idx != invalid_idx; }
+    inline explicit operator bool() const { return is_valid(); }
+
+    TapeType get_type() const;
+
+    inline bool is_null() const { return get_type() == TapeType::Null; }
+    inline bool is_bool() const { return get_type() == TapeType::Bool; }
+    inline bool is_integer() const { const TapeType t = get_type(); return t == TapeType::SignedInteger || t == TapeType::UnsignedInteger; }
+    inline bool is_float() const { return get_type() == TapeType::Float; }
+    inline bool is_number() const { return is_integer() || is_float(); }
+    inline bool is_string() const { return get_type() == TapeType::String; }
+    inline bool is_bytes() const { return get_type() == TapeType::Bytes; }
+    inline bool is_datetime() const { return get_type() == TapeType::DateTime; }
+    inline bool is_expression() const { return get_type() == TapeType::Expression; }
+    inline bool is_array() const { return get_type() == TapeType::BeginArray; }
+    inline bool is_object() const { return get_type() == TapeType::BeginObject; }
+
+    bool as_bool() const;
+    int64_t as_signed_integer() const;
+    uint64_t as_unsigned_integer() const;
+    double as_float() const;
+
+    // Requires a String value. Returns a view into either the source buffer, or the document's buffer of unescaped strings.
+    std::string_view as_string() const;
+
+    BytesView as_bytes() const;
+
+    // Returns the source text of a DateTime value
+    std::string_view as_datetime_source() const;
+
+    // Returns the source text of an expression, including the parentheses
+    std::string_view as_expression_source() const;
+
+    // Returns the number suffix of a number value, or an empty string if it has none
+    std::string_view get_number_suffix() const;
+
+    // Returns the annotation's source text, or an empty string if the value has no annotation
+    std::string_view get_annotation_source() const;
+
+    // Number of items in an array, or key/value pairs in an object
+    size_t size() const;
+
+    // Returns the first item of an array, or the first key of an object. Invalid if the container is empty.
+    TapeCursor first_child() const;
+
+    // Returns the next value in the same container (for objects, keys and values alternate). Invalid after the last one.
+    TapeCursor next_sibling() const;
+
+    // Array lookup by index. Arrays are walked using the skip links, so this is linear in the index.
+    TapeCursor at(size_t idx) const;
+    inline TapeCursor operator[](size_t idx) const { return at(idx); }
+
+    // Object lookup by string key. Returns an invalid cursor if there is no such key.
+    // Keys are checked in order, so this is linear in the number of keys.
+    TapeCursor find(std::string_view key) const;
+    inline TapeCursor operator[](std::string_view key) const { return find(key); }
+
+    template<typename Callback>
+    void for_each_pair(Callback&& callback) const
+    {
+        JXC_ASSERT(is_object());
+        for (TapeCursor key = first_child(); key.is_valid(); )
+        {
+            TapeCursor val = key.next_sibling();
+            JXC_DEBUG_ASSERT(val.is_valid());
+            callback(key, val);
+            key = val.next_sibling();
+        }
+    }
+
+    class iterator;
+
+    // Iterates over the items in an array
+    inline iterator begin() const;
+    inline iterator end() const;
+
+    // Builds a Value from this value and all its children. The result is the same as jxc::parse() would return for it.
+    Value to_value() const;
+
+    inline bool operator==(const TapeCursor& rhs) const { return doc == rhs.doc && start_idx == rhs.start_idx; }
+    inline bool operator!=(const TapeCursor& rhs) const { return !operator==(rhs); }
+};
+
+
+class TapeCursor::iterator
+{
+    friend class TapeCursor;
+    TapeCursor cur;
+    explicit iterator(TapeCursor cur) : cur(cur) {}
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = TapeCursor;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const TapeCursor*;
+    using reference = const TapeCursor&;
+
+    iterator() = default;
+    inline reference operator*() const { return cur; }
+    inline pointer operator->() const { return &cur; }
+    inline iterator& operator++() { cur = cur.next_sibling(); return *this; }
+    inline iterator operator++(int) { iterator result = *this; ++(*this); return result; }
+    inline bool operator==(const iterator& rhs) const { return cur.start_idx == rhs.cur.start_idx; }
+    inline bool operator!=(const iterator& rhs) const { return !operator==(rhs); }
+};
+
+
+inline TapeCursor::iterator TapeCursor::begin() const
+{
+    JXC_ASSERT(is_array());
+    return iterator(first_child());
+}
+
+
+inline TapeCursor::iterator TapeCursor::end() const
+{
+    return iterator(TapeCursor(doc, invalid_idx));
+}
+
+
+// Read-only document stored as a flat tape of tagged 64-bit entries, as an alternative to a Value tree for read-mostly workloads.
+// Parsing makes two allocations that are reused across calls to parse(), instead of one per array, object, and long string.
+//
+// Each entry has a TapeType in the high 8 bits and a 56-bit payload:
+// - Null, Bool (payload is the value), EndArray and EndObject (payload is the index of the Begin entry) are one entry.
+// - Numbers are two entries. The payload is the suffix's length and offset in the source, and the next entry is the value's bits.
+// - String, Bytes, DateTime, Expression, and Annotation are two entries. The payload is an offset into the source buffer
+//   (or into the document's buffer of unescaped strings and decoded bytes), and the next entry is the length.
+// - BeginArray and BeginObject are two entries. The payload is the index of the matching End entry (so whole containers can be
+//   skipped in one step), and the next entry is the number of items.
+// - An annotated value is preceded by its Annotation entries. Object keys and values alternate inside objects.
+//
+// Strings that don't need unescaping, annotations, datetimes, and expressions point into the source buffer, so the buffer
+// must outlive the TapeDocument unless it was passed in as an std::string&&.
+class TapeDocument
+{
+    friend class TapeCursor;
+
+public:
+    static constexpr uint64_t type_shift = 56;
+    static constexpr uint64_t payload_mask = (uint64_t(1) << type_shift) - 1;
+
+    // String and Bytes payload flag for data in string_buffer instead of the source buffer
+    static constexpr uint64_t string_buffer_flag = uint64_t(1) << 55;
+    static constexpr uint64_t offset_mask = string_buffer_flag - 1;
+
+    // Number suffix lengths are stored above a 48-bit source offset
+    static constexpr uint64_t suffix_offset_bits = 48;
+    static constexpr uint64_t suffix_offset_mask = (uint64_t(1) << suffix_offset_bits) - 1;
+
+    static inline TapeType get_entry_type(uint64_t entry) { return static_cast<TapeType>(entry >> type_shift); }
+    static inline uint64_t make_entry(TapeType type, uint64_t payload) { return (static_cast<uint64_t>(type) << type_shift) | (payload & payload_mask); }
+
+private:
+    std::string owned_buffer;
+    std::string_view buffer;
+    std::vector<uint64_t> tape;
+    std::string string_buffer;
+    ErrorInfo parse_error;
+
+    bool parse_internal(std::string_view in_buffer);
+
+public:
+    TapeDocument() = default;
+
+    TapeDocument(const TapeDocument&) = delete;
+    TapeDocument& operator=(const TapeDocument&) = delete;
+
+    // Parses the first value in a buffer. The buffer must outlive the TapeDocument.
+    // Reuses the memory from any previous parse, which invalidates all cursors.
+    bool parse(std::string_view in_buffer);
+
+    // Parses the first value in a buffer, taking ownership of the buffer
+    bool parse(std::string&& in_buffer);
+
+    inline bool parse(const char* in_buffer) { return parse(std::string_view(in_buffer)); }
+
+    inline bool has_error() const { return parse_error.is_err; }
+    inline const ErrorInfo& get_error() const { return parse_error; }
+
+    inline std::string_view get_buffer() const { return buffer; }
+
+    // Returns the root value. Invalid if the document is empty or failed to parse.
+    inline TapeCursor root() const { return (tape.size() > 0 && !parse_error.is_err) ? TapeCursor(this, 0) : TapeCursor(); }
+
+    inline size_t get_num_entries() const { return tape.size(); }
+    inline const std::vector<uint64_t>& get_tape() const { return tape; }
+
+    // Heap bytes held by the tape and the unescaped string buffer (not counting the source buffer)
+    inline size_t get_memory_usage() const { return tape.capacity() * sizeof(uint64_t) + string_buffer.capacity(); }
+
+    // Returns the tape as a human-readable listing, one entry per line
+    std::string dump() const;
+};
+
+
+inline uint64_t TapeCursor::entry(size_t offset) const
+{
+    JXC_DEBUG_ASSERT(is_valid() && start_idx + offset < doc->tape.size());
+    return doc->tape[start_idx + offset];
+}
+
+
+inline uint64_t TapeCursor::payload(size_t offset) const
+{
+    return entry(offset) & TapeDocument::payload_mask;
+}
+
+
+inline bool TapeCursor::has_annotation() const
+{
+    return TapeDocument::get_entry_type(entry()) == TapeType::Annotation;
+}
+
+
+inline size_t TapeCursor::end_idx() const
+{
+    const size_t idx = value_idx();
+    const uint64_t value_entry = doc->tape[idx];
+    switch (TapeDocument::get_entry_type(value_entry))
+    {
+    case TapeType::Null:
+    case TapeType::Bool:
+        return idx + 1;
+    case TapeType::BeginArray:
+    case TapeType::BeginObject:
+        return static_cast<size_t>(value_entry & TapeDocument::payload_mask) + 1;
+    default:
+        return idx + 2;
+    }
+}
+
+
+inline TapeType TapeCursor::get_type() const
+{
+    return is_valid() ? TapeDocument::get_entry_type(doc->tape[value_idx()]) : TapeType::Invalid;
+}
+
+
+inline TapeCursor TapeCursor::first_child() const
+{
+    JXC_ASSERT(is_array() || is_object());
+    const size_t child_idx = value_idx() + 2;
+    const TapeType child_type = TapeDocument::get_entry_type(doc->tape[child_idx]);
+    return (child_type == TapeType::EndArray || child_type == TapeType::EndObject) ? TapeCursor(doc, invalid_idx) : TapeCursor(doc, child_idx);
+}
+
+
+inline TapeCursor TapeCursor::next_sibling() const
+{
+    JXC_DEBUG_ASSERT(is_valid());
+    const size_t next_idx = end_idx();
+    if (next_idx >= doc->tape.size())
+    {
+        return TapeCursor(doc, invalid_idx);
+    }
+    const TapeType next_type = TapeDocument::get_entry_type(doc->tape[next_idx]);
+    return (next_type == TapeType::EndArray || next_type == TapeType::EndObject) ? TapeCursor(doc, invalid_idx) : TapeCursor(doc, next_idx);
+}
+
+
+JXC_END_NAMESPACE(jxc)
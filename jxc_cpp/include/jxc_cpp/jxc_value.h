@@ -1,14 +1,110 @@
 #pragma once
 #include "jxc/jxc.h"
 #include "jxc/jxc_type_traits.h"
+#include <atomic>
+#include <bit>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
 #include "ankerl/unordered_dense.h"
 
 
 JXC_BEGIN_NAMESPACE(jxc)
 
+class Value;
+
 JXC_BEGIN_NAMESPACE(detail)
 
+// Allocator for Value storage. Each allocator remembers the memory resource it allocates from (nullptr for the heap allocator,
+// JXC_ALLOCATOR), so containers and buffers are always freed to the resource they came from.
+// Copying a container gives a heap-allocated copy, which is how arena-allocated values are copied back to the heap.
+template<typename T>
+class ValueAllocator
+{
+    template<typename U>
+    friend class ValueAllocator;
+
+    std::pmr::memory_resource* resource = nullptr;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    ValueAllocator() noexcept = default;
+
+    explicit ValueAllocator(std::pmr::memory_resource* resource) noexcept
+        : resource(resource)
+    {
+    }
+
+    template<typename U>
+    ValueAllocator(const ValueAllocator<U>& rhs) noexcept
+        : resource(rhs.resource)
+    {
+    }
+
+    inline T* allocate(size_t count)
+    {
+        return (resource != nullptr)
+            ? static_cast<T*>(resource->allocate(count * sizeof(T), alignof(T)))
+            : JXC_ALLOCATOR<T>().allocate(count);
+    }
+
+    inline void deallocate(T* ptr, size_t count)
+    {
+        if (resource != nullptr)
+        {
+            resource->deallocate(ptr, count * sizeof(T), alignof(T));
+        }
+        else
+        {
+            JXC_ALLOCATOR<T>().deallocate(ptr, count);
+        }
+    }
+
+    inline ValueAllocator select_on_container_copy_construction() const { return ValueAllocator(); }
+
+    inline std::pmr::memory_resource* get_resource() const { return resource; }
+
+    template<typename U>
+    inline bool operator==(const ValueAllocator<U>& rhs) const { return resource == rhs.resource; }
+    template<typename U>
+    inline bool operator!=(const ValueAllocator<U>& rhs) const { return resource != rhs.resource; }
+};
+
+
+// Memory resource behind ValueArena. Freeing individual allocations does nothing, so arrays and objects allocated from it
+// don't need to run destructors for items that only use memory from the same arena.
+class ValueArenaResource final : public std::pmr::monotonic_buffer_resource
+{
+public:
+    using std::pmr::monotonic_buffer_resource::monotonic_buffer_resource;
+};
+
+
+// Where new Value storage is allocated from. This is passed explicitly to everything that allocates (see ValueParser::memory).
+// A null resource means the heap allocator, JXC_ALLOCATOR. in_arena is set for ValueArena resources, and arrays and objects
+// store it so that freeing them can check it without looking at the resource's type.
+struct ValueMemory
+{
+    std::pmr::memory_resource* resource = nullptr;
+    bool in_arena = false;
+
+    ValueMemory() = default;
+    ValueMemory(std::pmr::memory_resource* resource, bool in_arena) : resource(resource), in_arena(in_arena) {}
+
+    // Checks the resource's type once, for callers that don't know if it's an arena
+    static ValueMemory from_resource(std::pmr::memory_resource* resource)
+    {
+        return ValueMemory(resource, resource != nullptr && dynamic_cast<const ValueArenaResource*>(resource) != nullptr);
+    }
+};
+
+
 enum class AnnotationDataType : uint8_t
 {
     Empty = 0,
@@ -24,7 +120,7 @@ enum class AnnotationDataType : uint8_t
 struct AnnotationData
 {
     static constexpr size_t max_inline_annotation_source_len = (sizeof(void*) * 2) - 1;
-    using token_span_allocator_t = JXC_ALLOCATOR<TokenList>;
+    using token_span_allocator_t = ValueAllocator<TokenList>;
 
     union
     {
@@ -34,8 +130,11 @@ struct AnnotationData
         // TokenView storage
         struct { Token* ptr; size_t len; } tokens_view;
 
-        // owned token storage
-        TokenList* tokens_owned;
+        // Owned token storage, allocated from the memory resource passed in when it was assigned (nullptr for the heap).
+        // Token lists from a memory resource are a single allocation holding the TokenList, the allocation size, and the text of
+        // any strings too long to store inline, with the tokens in the TokenList's inline storage. That way they don't use the
+        // heap at all, and an arena can drop them without running the destructor. Longer token lists always use the heap.
+        struct { TokenList* list; std::pmr::memory_resource* resource; } tokens_owned;
     };
 
     AnnotationData()
@@ -52,11 +151,20 @@ struct AnnotationData
     {
         if (type != AnnotationDataType::Empty)
         {
-            if (type == AnnotationDataType::TokensOwned && tokens_owned != nullptr)
+            if (type == AnnotationDataType::TokensOwned && tokens_owned.list != nullptr)
             {
-                token_span_allocator_t allocator{};
-                std::allocator_traits<token_span_allocator_t>::destroy(allocator, tokens_owned);
-                allocator.deallocate(tokens_owned, 1);
+                if (tokens_owned.resource != nullptr)
+                {
+                    const size_t alloc_size = get_resource_token_list_alloc_size(tokens_owned.list);
+                    tokens_owned.list->~TokenList();
+                    tokens_owned.resource->deallocate(tokens_owned.list, alloc_size, alignof(TokenList));
+                }
+                else
+                {
+                    token_span_allocator_t allocator{ nullptr };
+                    std::allocator_traits<token_span_allocator_t>::destroy(allocator, tokens_owned.list);
+                    allocator.deallocate(tokens_owned.list, 1);
+                }
             }
             clear_internal();
         }
@@ -68,7 +176,7 @@ struct AnnotationData
         return type == AnnotationDataType::Empty
             || (type == AnnotationDataType::SourceInline && source_inline.len == 0)
             || (type == AnnotationDataType::TokensView && tokens_view.len == 0)
-            || (type == AnnotationDataType::TokensOwned && (tokens_owned == nullptr || tokens_owned->size() == 0));
+            || (type == AnnotationDataType::TokensOwned && (tokens_owned.list == nullptr || tokens_owned.list->size() == 0));
     }
 
     inline std::string_view as_source_inline_view_unchecked() const
@@ -81,9 +189,9 @@ struct AnnotationData
         return TokenView{ *tokens_view.ptr, tokens_view.len };
     }
 
-    inline TokenList& as_owned_token_span_unchecked() { return *tokens_owned; }
-    inline const TokenList& as_owned_token_span_unchecked() const { return *tokens_owned; }
-    inline TokenView as_owned_token_span_view_unchecked() const { return (tokens_owned != nullptr) ? TokenView(*tokens_owned) : TokenView(); }
+    inline TokenList& as_owned_token_span_unchecked() { return *tokens_owned.list; }
+    inline const TokenList& as_owned_token_span_unchecked() const { return *tokens_owned.list; }
+    inline TokenView as_owned_token_span_view_unchecked() const { return (tokens_owned.list != nullptr) ? TokenView(*tokens_owned.list) : TokenView(); }
 
     inline bool have_unowned_data(AnnotationDataType type) const
     {
@@ -92,7 +200,13 @@ struct AnnotationData
 
     inline bool have_owned_data(AnnotationDataType type) const
     {
-        return type == AnnotationDataType::TokensOwned && tokens_owned != nullptr;
+        return type == AnnotationDataType::TokensOwned && tokens_owned.list != nullptr;
+    }
+
+    // True if this annotation doesn't own any memory, or only owns memory from the given memory resource
+    inline bool only_uses_memory_from(AnnotationDataType type, const std::pmr::memory_resource* resource) const
+    {
+        return type != AnnotationDataType::TokensOwned || tokens_owned.list == nullptr || tokens_owned.resource == resource;
     }
 
     AnnotationDataType convert_view_to_owned(AnnotationDataType orig_type)
@@ -116,7 +230,7 @@ struct AnnotationData
         case AnnotationDataType::TokensView:
             return assign_tokens_view(prev_type, rhs.as_token_span_unchecked());
         case AnnotationDataType::TokensOwned:
-            return (rhs.tokens_owned != nullptr) ? assign_tokens_owned_copy(prev_type, rhs.as_owned_token_span_unchecked()) : clear(prev_type);
+            return (rhs.tokens_owned.list != nullptr) ? assign_tokens_owned_copy(prev_type, rhs.as_owned_token_span_unchecked()) : clear(prev_type);
         default:
             break;
         }
@@ -163,36 +277,95 @@ struct AnnotationData
         return AnnotationDataType::TokensView;
     }
 
-    AnnotationDataType assign_tokens_owned_copy_from_view(AnnotationDataType prev_type, TokenView token_span)
+    static inline size_t& get_resource_token_list_alloc_size(TokenList* list)
+    {
+        static_assert(sizeof(TokenList) % alignof(size_t) == 0, "Allocation size must be aligned after the TokenList");
+        return *reinterpret_cast<size_t*>(reinterpret_cast<uint8_t*>(list) + sizeof(TokenList));
+    }
+
+    // Copies a token span into a single allocation from a memory resource (see tokens_owned).
+    // Returns false if the resource is nullptr (the heap), or the span has too many tokens to store inline.
+    bool try_assign_tokens_owned_from_resource(TokenView token_span, std::pmr::memory_resource* resource)
+    {
+        if (resource == nullptr || token_span.size() > decltype(TokenList::tokens)::buffer_size)
+        {
+            return false;
+        }
+
+        auto get_text_len = [](const FlexString& str) { return (str.size() > FlexString::max_inline_len) ? str.size() : 0; };
+        const FlexString src = token_span.source();
+        size_t text_len = get_text_len(src);
+        for (size_t i = 0; i < token_span.size(); i++)
+        {
+            text_len += get_text_len(token_span[i].value) + get_text_len(token_span[i].tag);
+        }
+
+        const size_t alloc_size = sizeof(TokenList) + sizeof(size_t) + text_len;
+        TokenList* list = new (resource->allocate(alloc_size, alignof(TokenList))) TokenList();
+        get_resource_token_list_alloc_size(list) = alloc_size;
+
+        char* text = reinterpret_cast<char*>(&get_resource_token_list_alloc_size(list) + 1);
+        auto copy_text = [&text](const FlexString& str) -> FlexString
+        {
+            if (str.size() == 0)
+            {
+                return FlexString();
+            }
+            else if (str.size() <= FlexString::max_inline_len)
+            {
+                return FlexString::make_inline(str.as_view());
+            }
+            JXC_MEMCPY(text, str.size(), str.data(), str.size());
+            const FlexString result = FlexString::make_view(std::string_view{ text, str.size() });
+            text += str.size();
+            return result;
+        };
+
+        for (size_t i = 0; i < token_span.size(); i++)
+        {
+            const Token& tok = token_span[i];
+            list->tokens.emplace_back(tok.type, tok.start_idx, tok.end_idx, copy_text(tok.value), copy_text(tok.tag));
+        }
+        list->src = copy_text(src);
+
+        tokens_owned.list = list;
+        tokens_owned.resource = resource;
+        return true;
+    }
+
+    AnnotationDataType assign_tokens_owned_copy_from_view(AnnotationDataType prev_type, TokenView token_span, std::pmr::memory_resource* resource = nullptr)
     {
         clear(prev_type);
-        token_span_allocator_t allocator{};
         JXC_DEBUG_ASSERT(token_span.start != nullptr || token_span.num_tokens == 0);
-        tokens_owned = allocator.allocate(1);
-        memset((void*)tokens_owned, 0, sizeof(TokenList)); // zero out memory first
-        std::allocator_traits<decltype(allocator)>::construct(allocator, tokens_owned, token_span);
+        if (!try_assign_tokens_owned_from_resource(token_span, resource))
+        {
+            token_span_allocator_t allocator{ nullptr };
+            tokens_owned.resource = nullptr;
+            tokens_owned.list = allocator.allocate(1);
+            memset((void*)tokens_owned.list, 0, sizeof(TokenList)); // zero out memory first
+            std::allocator_traits<decltype(allocator)>::construct(allocator, tokens_owned.list, token_span);
+        }
         return AnnotationDataType::TokensOwned;
     }
 
     AnnotationDataType assign_tokens_owned_copy(AnnotationDataType prev_type, const TokenList& token_span)
     {
-        clear(prev_type);
-        token_span_allocator_t allocator{};
         JXC_DEBUG_ASSERT(token_span.size() > 0);
-        tokens_owned = allocator.allocate(1);
-        memset((void*)tokens_owned, 0, sizeof(TokenList)); // zero out memory first
-        std::allocator_traits<decltype(allocator)>::construct(allocator, tokens_owned, token_span);
-        return AnnotationDataType::TokensOwned;
+        return assign_tokens_owned_copy_from_view(prev_type, TokenView(token_span));
     }
 
-    AnnotationDataType assign_tokens_owned_move(AnnotationDataType prev_type, TokenList&& token_span)
+    AnnotationDataType assign_tokens_owned_move(AnnotationDataType prev_type, TokenList&& token_span, std::pmr::memory_resource* resource = nullptr)
     {
         clear(prev_type);
-        token_span_allocator_t allocator{};
         JXC_DEBUG_ASSERT(token_span.size() > 0);
-        tokens_owned = allocator.allocate(1);
-        memset((void*)tokens_owned, 0, sizeof(TokenList)); // zero out memory first
-        std::allocator_traits<decltype(allocator)>::construct(allocator, tokens_owned, std::move(token_span));
+        if (!try_assign_tokens_owned_from_resource(TokenView(token_span), resource))
+        {
+            token_span_allocator_t allocator{ nullptr };
+            tokens_owned.resource = nullptr;
+            tokens_owned.list = allocator.allocate(1);
+            memset((void*)tokens_owned.list, 0, sizeof(TokenList)); // zero out memory first
+            std::allocator_traits<decltype(allocator)>::construct(allocator, tokens_owned.list, std::move(token_span));
+        }
         return AnnotationDataType::TokensOwned;
     }
 
@@ -246,7 +419,7 @@ struct AnnotationData
             switch (rhs_type)
             {
             case AnnotationDataType::Empty:
-                return tokens_owned == nullptr || tokens_owned->size() == 0;
+                return tokens_owned.list == nullptr || tokens_owned.list->size() == 0;
             case AnnotationDataType::SourceInline:
                 return token_value_equals_token_span(rhs.as_source_inline_view_unchecked(), as_owned_token_span_view_unchecked());
             case AnnotationDataType::TokensView:
@@ -272,7 +445,7 @@ struct AnnotationData
         case AnnotationDataType::TokensView:
             return as_token_span_unchecked();
         case AnnotationDataType::TokensOwned:
-            return (tokens_owned != nullptr) ? TokenView(*tokens_owned) : TokenView{};
+            return (tokens_owned.list != nullptr) ? TokenView(*tokens_owned.list) : TokenView{};
         default:
             break;
         }
@@ -293,9 +466,9 @@ struct AnnotationData
         case AnnotationDataType::TokensView:
             return as_token_span_unchecked().source();
         case AnnotationDataType::TokensOwned:
-            if (tokens_owned != nullptr)
+            if (tokens_owned.list != nullptr)
             {
-                return tokens_owned->src;
+                return tokens_owned.list->src;
             }
             break;
         default:
@@ -453,57 +626,717 @@ struct TaggedNum
             }
             else
             {
-                number_str = jxc::format("{}", FloatPrecision(value, float_precision));
-                if (!fixed_precision)
-                {
-                    // remove trailing zeros as long as there are multiple zeroes in a row
-                    std::string_view view = number_str;
-                    while (view.size() >= 2 && view[view.size() - 2] != '.' && view[view.size() - 1] == '0')
-                    {
-                        view = view.substr(0, view.size() - 1);
-                    }
-                    number_str = std::string(view);
-                }
+                number_str = jxc::format("{}", FloatPrecision(value, float_precision));
+                if (!fixed_precision)
+                {
+                    // remove trailing zeros as long as there are multiple zeroes in a row
+                    std::string_view view = number_str;
+                    while (view.size() >= 2 && view[view.size() - 2] != '.' && view[view.size() - 1] == '0')
+                    {
+                        view = view.substr(0, view.size() - 1);
+                    }
+                    number_str = std::string(view);
+                }
+            }
+        }
+        else
+        {
+            number_str = jxc::format("{}", value);
+        }
+
+        JXC_ASSERT(number_str.size() <= buffer_len);
+        JXC_STRNCPY(buffer, buffer_len, number_str.data(), number_str.size());
+
+        if (include_tag && tag_len > 0)
+        {
+            const size_t buffer_num_str_len = number_str.size();
+            const size_t tag_size = static_cast<size_t>(tag_len);
+            JXC_ASSERT(buffer_num_str_len + tag_size <= buffer_len);
+            for (size_t i = 0; i < tag_size; i++)
+            {
+                buffer[buffer_num_str_len + i] = tag[i];
+            }
+            return buffer_num_str_len + tag_size;
+        }
+
+        return number_str.size();
+    }
+
+    std::string to_string(int float_precision, bool fixed_precision, bool include_tag) const
+    {
+        static constexpr size_t buf_len = 64;
+        char buf[buf_len];
+        const size_t result_len = to_string_in_buffer(buf, buf_len, float_precision, fixed_precision, include_tag);
+        return std::string(buf, result_len);
+    }
+};
+
+static_assert(std::is_trivially_constructible_v<TaggedNum<int64_t, 15>>, "TaggedNum should be trivially constructible");
+static_assert(std::is_trivially_copyable_v<TaggedNum<int64_t, 15>>, "TaggedNum should be trivially copyable");
+
+
+// Storage for Value arrays, and for packed arrays of numbers. The header and the items share a single allocation (the header
+// fills the first item slots, which keeps the items aligned), so an array is one allocation and one pointer hop away from its Value.
+// Adding items can reallocate the array, so everything that does that is static and updates the caller's pointer.
+template<typename T>
+class ValueArrayStorage
+{
+    size_t num_items = 0;
+    size_t item_capacity = 0;
+    ValueMemory memory;
+
+    // Packed arrays keep the Values that const access reads their items through here (see Value::is_packed_array()).
+    // It's set once by the first const access and then only read, so it's atomic. The owning Value frees it.
+    mutable std::atomic<ValueArrayStorage<Value>*> expanded_items = nullptr;
+
+    ValueArrayStorage(size_t capacity, const ValueMemory& memory) : item_capacity(capacity), memory(memory) {}
+
+    // number of item slots taken up by the header
+    static constexpr size_t get_header_slots()
+    {
+        static_assert(alignof(T) >= alignof(ValueArrayStorage), "ValueArrayStorage items must be aligned at least as strictly as the header");
+        return (sizeof(ValueArrayStorage) + sizeof(T) - 1) / sizeof(T);
+    }
+
+    static ValueArrayStorage* allocate(size_t capacity, const ValueMemory& memory)
+    {
+        T* mem = ValueAllocator<T>(memory.resource).allocate(capacity + get_header_slots());
+        return new (mem) ValueArrayStorage(capacity, memory);
+    }
+
+    static void deallocate(ValueArrayStorage* arr)
+    {
+        ValueAllocator<T>(arr->memory.resource).deallocate(reinterpret_cast<T*>(arr), arr->item_capacity + get_header_slots());
+    }
+
+    // Moves the items into a new allocation and frees the old one
+    static void move_to(ValueArrayStorage*& arr, ValueArrayStorage* new_arr)
+    {
+        JXC_DEBUG_ASSERT(new_arr->item_capacity >= arr->num_items);
+        T* src = arr->data();
+        T* dst = new_arr->data();
+        for (size_t i = 0; i < arr->num_items; i++)
+        {
+            new (&dst[i]) T(std::move(src[i]));
+            src[i].~T();
+        }
+        new_arr->num_items = arr->num_items;
+        new_arr->expanded_items.store(arr->expanded_items.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        deallocate(arr);
+        arr = new_arr;
+    }
+
+    static inline size_t get_grown_capacity(size_t capacity, size_t min_capacity)
+    {
+        return std::max<size_t>({ capacity * 2, min_capacity, default_capacity });
+    }
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t default_capacity = 4;
+
+    ValueArrayStorage(const ValueArrayStorage&) = delete;
+    ValueArrayStorage& operator=(const ValueArrayStorage&) = delete;
+
+    // Shared empty array, for returning a reference to arrays that have no storage
+    static const ValueArrayStorage& get_empty()
+    {
+        static const ValueArrayStorage empty_array(0, ValueMemory());
+        return empty_array;
+    }
+
+    static ValueArrayStorage* create(size_t capacity, const ValueMemory& memory)
+    {
+        return allocate(std::max<size_t>(capacity, 1), memory);
+    }
+
+    static ValueArrayStorage* create_copy(const ValueArrayStorage& rhs, const ValueMemory& memory)
+    {
+        ValueArrayStorage* arr = create(rhs.num_items, memory);
+        const T* src = rhs.data();
+        T* dst = arr->data();
+        for (size_t i = 0; i < rhs.num_items; i++)
+        {
+            new (&dst[i]) T(src[i]);
+        }
+        arr->num_items = rhs.num_items;
+        return arr;
+    }
+
+    // Items that don't own any memory outside an arena can skip their destructors (see ValueArena)
+    static void destroy(ValueArrayStorage* arr, bool destroy_items = true)
+    {
+        JXC_DEBUG_ASSERT(arr != nullptr);
+        if (destroy_items)
+        {
+            T* items = arr->data();
+            for (size_t i = 0; i < arr->num_items; i++)
+            {
+                items[i].~T();
+            }
+        }
+        deallocate(arr);
+    }
+
+    // Allocates the array from memory if it doesn't exist yet. Otherwise it stays in the memory it was allocated from.
+    static void reserve(ValueArrayStorage*& arr, size_t capacity, const ValueMemory& memory = ValueMemory())
+    {
+        if (arr == nullptr)
+        {
+            arr = create(capacity, memory);
+        }
+        else if (capacity > arr->item_capacity)
+        {
+            move_to(arr, allocate(capacity, arr->memory));
+        }
+    }
+
+    template<typename... TArgs>
+    static T& emplace_back(ValueArrayStorage*& arr, TArgs&&... args)
+    {
+        if (arr == nullptr)
+        {
+            arr = create(default_capacity, ValueMemory());
+        }
+        else if (arr->num_items == arr->item_capacity)
+        {
+            // construct the new item before moving the old ones, in case the arguments refer to an item in this array
+            ValueArrayStorage* new_arr = allocate(get_grown_capacity(arr->item_capacity, arr->num_items + 1), arr->memory);
+            new (&new_arr->data()[arr->num_items]) T(std::forward<TArgs>(args)...);
+            move_to(arr, new_arr);
+            return arr->data()[arr->num_items++];
+        }
+
+        T* item = new (&arr->data()[arr->num_items]) T(std::forward<TArgs>(args)...);
+        ++arr->num_items;
+        return *item;
+    }
+
+    static void resize(ValueArrayStorage*& arr, size_t new_size)
+    {
+        if (arr == nullptr && new_size == 0)
+        {
+            return;
+        }
+        reserve(arr, new_size);
+        T* items = arr->data();
+        for (size_t i = new_size; i < arr->num_items; i++)
+        {
+            items[i].~T();
+        }
+        for (size_t i = arr->num_items; i < new_size; i++)
+        {
+            new (&items[i]) T();
+        }
+        arr->num_items = new_size;
+    }
+
+    inline T* data() { return std::launder(reinterpret_cast<T*>(this) + get_header_slots()); }
+    inline const T* data() const { return std::launder(reinterpret_cast<const T*>(this) + get_header_slots()); }
+
+    inline size_t size() const { return num_items; }
+    inline size_t capacity() const { return item_capacity; }
+    inline bool empty() const { return num_items == 0; }
+    inline std::pmr::memory_resource* get_resource() const { return memory.resource; }
+    inline const ValueMemory& get_memory() const { return memory; }
+    inline bool is_in_arena() const { return memory.in_arena; }
+
+    // Heap bytes used by this array's allocation (not counting anything owned by its items)
+    inline size_t get_allocation_size() const { return (item_capacity + get_header_slots()) * sizeof(T); }
+
+    inline ValueArrayStorage<Value>* get_expanded_items() const { return expanded_items.load(std::memory_order_acquire); }
+    inline void set_expanded_items(ValueArrayStorage<Value>* items) const { expanded_items.store(items, std::memory_order_release); }
+
+    inline T& operator[](size_t idx) { JXC_DEBUG_ASSERT(idx < num_items); return data()[idx]; }
+    inline const T& operator[](size_t idx) const { JXC_DEBUG_ASSERT(idx < num_items); return data()[idx]; }
+
+    inline T& front() { JXC_DEBUG_ASSERT(num_items > 0); return data()[0]; }
+    inline const T& front() const { JXC_DEBUG_ASSERT(num_items > 0); return data()[0]; }
+    inline T& back() { JXC_DEBUG_ASSERT(num_items > 0); return data()[num_items - 1]; }
+    inline const T& back() const { JXC_DEBUG_ASSERT(num_items > 0); return data()[num_items - 1]; }
+
+    inline iterator begin() { return data(); }
+    inline iterator end() { return data() + num_items; }
+    inline const_iterator begin() const { return data(); }
+    inline const_iterator end() const { return data() + num_items; }
+
+    bool operator==(const ValueArrayStorage& rhs) const
+    {
+        if (num_items != rhs.num_items)
+        {
+            return false;
+        }
+        const T* lhs_items = data();
+        const T* rhs_items = rhs.data();
+        for (size_t i = 0; i < num_items; i++)
+        {
+            if (lhs_items[i] != rhs_items[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    inline bool operator!=(const ValueArrayStorage& rhs) const { return !operator==(rhs); }
+};
+
+
+// Storage for Value objects. Key/value pairs are kept in insertion order in a single allocation, after a header that fills the
+// first key slot. Small objects are searched with a linear scan, which for a handful of keys is faster than hashing the key.
+// Objects with room for more than max_linear_scan_size pairs also get an open-addressing hash index (linear probing, at most
+// half full) in the same allocation, after the pairs. Like ankerl::unordered_dense::map, erasing a pair moves the last pair
+// into its place.
+template<typename K, typename V>
+class ValueObjectStorage
+{
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+    static constexpr size_t default_capacity = 4;
+    static constexpr size_t max_linear_scan_size = 8;
+
+private:
+    size_t num_items = 0;
+    size_t item_capacity = 0;
+    ValueMemory memory;
+    size_t num_index_slots = 0;
+
+    // Index slots hold the high 32 bits of the key's hash (which also pick the slot) and the pair's index plus one. Zero is empty.
+    static constexpr uint64_t slot_item_mask = 0xFFFFFFFF;
+
+    ValueObjectStorage(size_t capacity, size_t num_slots, const ValueMemory& memory)
+        : item_capacity(capacity), memory(memory), num_index_slots(num_slots) {}
+
+    static inline size_t get_num_index_slots(size_t capacity)
+    {
+        return (capacity > max_linear_scan_size) ? std::bit_ceil(capacity * 2) : 0;
+    }
+
+    // allocation size in units of K (one for the header, two per pair, and enough for the index)
+    static inline size_t get_num_alloc_units(size_t capacity, size_t num_slots)
+    {
+        return 1 + capacity * 2 + (num_slots * sizeof(uint64_t) + sizeof(K) - 1) / sizeof(K);
+    }
+
+    static ValueObjectStorage* allocate(size_t capacity, const ValueMemory& memory)
+    {
+        static_assert(sizeof(ValueObjectStorage) <= sizeof(K), "ValueObjectStorage header must fit in one key slot");
+        static_assert(sizeof(value_type) == sizeof(K) * 2 && alignof(value_type) == alignof(K), "Pairs must be laid out as two keys");
+        JXC_ASSERTF(capacity <= slot_item_mask, "Object capacity {} is too large", capacity);
+        const size_t num_slots = get_num_index_slots(capacity);
+        K* mem = ValueAllocator<K>(memory.resource).allocate(get_num_alloc_units(capacity, num_slots));
+        ValueObjectStorage* obj = new (mem) ValueObjectStorage(capacity, num_slots, memory);
+        if (num_slots > 0)
+        {
+            memset(obj->index_slots(), 0, num_slots * sizeof(uint64_t));
+        }
+        return obj;
+    }
+
+    static void deallocate(ValueObjectStorage* obj)
+    {
+        ValueAllocator<K>(obj->memory.resource).deallocate(reinterpret_cast<K*>(obj), get_num_alloc_units(obj->item_capacity, obj->num_index_slots));
+    }
+
+    static inline uint64_t hash_key(const K& key)
+    {
+        return ankerl::unordered_dense::detail::wyhash::hash(static_cast<uint64_t>(key.hash()));
+    }
+
+    static inline uint64_t make_slot(uint64_t hash, size_t item_idx)
+    {
+        return (hash & ~slot_item_mask) | static_cast<uint64_t>(item_idx + 1);
+    }
+
+    inline uint64_t* index_slots() { return reinterpret_cast<uint64_t*>(items() + item_capacity); }
+    inline const uint64_t* index_slots() const { return reinterpret_cast<const uint64_t*>(items() + item_capacity); }
+
+    inline size_t get_home_slot(uint64_t slot_or_hash) const { return static_cast<size_t>(slot_or_hash >> 32) & (num_index_slots - 1); }
+
+    void index_insert(uint64_t hash, size_t item_idx)
+    {
+        uint64_t* slots = index_slots();
+        const size_t mask = num_index_slots - 1;
+        size_t slot_idx = get_home_slot(hash);
+        while (slots[slot_idx] != 0)
+        {
+            slot_idx = (slot_idx + 1) & mask;
+        }
+        slots[slot_idx] = make_slot(hash, item_idx);
+    }
+
+    // Returns the index slot that refers to a pair, given the hash of the pair's key
+    size_t index_find_slot(uint64_t hash, size_t item_idx) const
+    {
+        const uint64_t* slots = index_slots();
+        const size_t mask = num_index_slots - 1;
+        const uint64_t expected = make_slot(hash, item_idx);
+        size_t slot_idx = get_home_slot(hash);
+        while (slots[slot_idx] != expected)
+        {
+            JXC_DEBUG_ASSERT(slots[slot_idx] != 0);
+            slot_idx = (slot_idx + 1) & mask;
+        }
+        return slot_idx;
+    }
+
+    // Clears an index slot, shifting later slots in the same probe sequence back so lookups don't need tombstones
+    void index_erase_slot(size_t slot_idx)
+    {
+        uint64_t* slots = index_slots();
+        const size_t mask = num_index_slots - 1;
+        size_t hole_idx = slot_idx;
+        size_t next_idx = (hole_idx + 1) & mask;
+        while (slots[next_idx] != 0)
+        {
+            const size_t home_idx = get_home_slot(slots[next_idx]);
+            if (((next_idx - home_idx) & mask) >= ((next_idx - hole_idx) & mask))
+            {
+                slots[hole_idx] = slots[next_idx];
+                hole_idx = next_idx;
+            }
+            next_idx = (next_idx + 1) & mask;
+        }
+        slots[hole_idx] = 0;
+    }
+
+    // Fills in the index of a new allocation from the index of the old one, or by hashing every key if the old one had no index
+    void index_rebuild_from(const ValueObjectStorage& old_obj)
+    {
+        if (num_index_slots == 0)
+        {
+            return;
+        }
+
+        if (old_obj.num_index_slots > 0)
+        {
+            const uint64_t* old_slots = old_obj.index_slots();
+            for (size_t i = 0; i < old_obj.num_index_slots; i++)
+            {
+                if (old_slots[i] != 0)
+                {
+                    index_insert(old_slots[i], static_cast<size_t>(old_slots[i] & slot_item_mask) - 1);
+                }
+            }
+        }
+        else
+        {
+            const value_type* pairs = items();
+            for (size_t i = 0; i < num_items; i++)
+            {
+                index_insert(hash_key(pairs[i].first), i);
+            }
+        }
+    }
+
+    // Moves the pairs into a new allocation, builds its index, and frees the old one
+    static void move_to(ValueObjectStorage*& obj, ValueObjectStorage* new_obj)
+    {
+        JXC_DEBUG_ASSERT(new_obj->item_capacity >= obj->num_items);
+        value_type* src = obj->items();
+        value_type* dst = new_obj->items();
+        for (size_t i = 0; i < obj->num_items; i++)
+        {
+            new (&dst[i]) value_type(std::move(src[i]));
+            src[i].~value_type();
+        }
+        new_obj->num_items = obj->num_items;
+        new_obj->index_rebuild_from(*obj);
+        deallocate(obj);
+        obj = new_obj;
+    }
+
+    template<typename KeyT, typename... TArgs>
+    static value_type& append_new_pair(ValueObjectStorage*& obj, uint64_t hash, KeyT&& key, TArgs&&... args)
+    {
+        if (obj == nullptr)
+        {
+            obj = allocate(default_capacity, ValueMemory());
+        }
+        else if (obj->num_items == obj->item_capacity)
+        {
+            // construct the new pair before moving the old ones, in case the arguments refer to a pair in this object
+            const size_t new_item_idx = obj->num_items;
+            ValueObjectStorage* new_obj = allocate(std::max<size_t>(obj->item_capacity * 2, default_capacity), obj->memory);
+            new (&new_obj->items()[new_item_idx]) value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<KeyT>(key)), std::forward_as_tuple(std::forward<TArgs>(args)...));
+            move_to(obj, new_obj);
+            return obj->finish_append(hash, new_item_idx);
+        }
+
+        const size_t new_item_idx = obj->num_items;
+        new (&obj->items()[new_item_idx]) value_type(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<KeyT>(key)), std::forward_as_tuple(std::forward<TArgs>(args)...));
+        return obj->finish_append(hash, new_item_idx);
+    }
+
+    inline value_type& finish_append(uint64_t hash, size_t new_item_idx)
+    {
+        JXC_DEBUG_ASSERT(new_item_idx == num_items);
+        ++num_items;
+        if (num_index_slots > 0)
+        {
+            // the hash is only computed up front if there was already an index
+            index_insert((hash != 0) ? hash : hash_key(items()[new_item_idx].first), new_item_idx);
+        }
+        return items()[new_item_idx];
+    }
+
+    // Key equality for both lookup paths. Value::operator== compares numbers across types, but keys like `1`, `1u`, and `1.0`
+    // hash differently, so they have to stay distinct keys no matter how many keys the object has.
+    // Hashes are only compared once the keys are otherwise equal, so small objects only hash keys on a match.
+    static inline bool keys_equal(const K& stored_key, const K& key, uint64_t key_hash)
+    {
+        return stored_key.get_type() == key.get_type()
+            && stored_key == key
+            && hash_key(stored_key) == ((key_hash != 0) ? key_hash : hash_key(key));
+    }
+
+    // Finds a key, and also returns its hash if the object has an index (or zero if it doesn't, so small objects never hash keys)
+    const value_type* find_internal(const K& key, uint64_t& out_hash) const
+    {
+        const value_type* pairs = items();
+        if (num_index_slots == 0)
+        {
+            out_hash = 0;
+            for (size_t i = 0; i < num_items; i++)
+            {
+                if (keys_equal(pairs[i].first, key, 0))
+                {
+                    return &pairs[i];
+                }
+            }
+            return nullptr;
+        }
+
+        out_hash = hash_key(key);
+        const uint64_t* slots = index_slots();
+        const size_t mask = num_index_slots - 1;
+        const uint64_t hash_bits = out_hash & ~slot_item_mask;
+        for (size_t slot_idx = get_home_slot(out_hash); slots[slot_idx] != 0; slot_idx = (slot_idx + 1) & mask)
+        {
+            if ((slots[slot_idx] & ~slot_item_mask) == hash_bits)
+            {
+                const value_type& pair = pairs[(slots[slot_idx] & slot_item_mask) - 1];
+                if (keys_equal(pair.first, key, out_hash))
+                {
+                    return &pair;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename KeyT>
+    static inline decltype(auto) as_key(KeyT&& key)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<KeyT>, K>)
+        {
+            return std::forward<KeyT>(key);
+        }
+        else
+        {
+            return K(std::forward<KeyT>(key));
+        }
+    }
+
+public:
+    ValueObjectStorage(const ValueObjectStorage&) = delete;
+    ValueObjectStorage& operator=(const ValueObjectStorage&) = delete;
+
+    // Shared empty object, for returning a reference to objects that have no storage
+    static const ValueObjectStorage& get_empty()
+    {
+        static const ValueObjectStorage empty_object(0, 0, ValueMemory());
+        return empty_object;
+    }
+
+    static ValueObjectStorage* create(size_t capacity, const ValueMemory& memory)
+    {
+        return allocate(std::max<size_t>(capacity, 1), memory);
+    }
+
+    static ValueObjectStorage* create_copy(const ValueObjectStorage& rhs, const ValueMemory& memory)
+    {
+        ValueObjectStorage* obj = create(rhs.num_items, memory);
+        const value_type* src = rhs.items();
+        value_type* dst = obj->items();
+        for (size_t i = 0; i < rhs.num_items; i++)
+        {
+            new (&dst[i]) value_type(src[i]);
+        }
+        obj->num_items = rhs.num_items;
+        obj->index_rebuild_from(rhs);
+        return obj;
+    }
+
+    // Pairs that don't own any memory outside an arena can skip their destructors (see ValueArena)
+    static void destroy(ValueObjectStorage* obj, bool destroy_items = true)
+    {
+        JXC_DEBUG_ASSERT(obj != nullptr);
+        if (destroy_items)
+        {
+            value_type* pairs = obj->items();
+            for (size_t i = 0; i < obj->num_items; i++)
+            {
+                pairs[i].~value_type();
+            }
+        }
+        deallocate(obj);
+    }
+
+    // Allocates the object from memory if it doesn't exist yet. Otherwise it stays in the memory it was allocated from.
+    static void reserve(ValueObjectStorage*& obj, size_t capacity, const ValueMemory& memory = ValueMemory())
+    {
+        if (obj == nullptr)
+        {
+            obj = create(capacity, memory);
+        }
+        else if (capacity > obj->item_capacity)
+        {
+            move_to(obj, allocate(capacity, obj->memory));
+        }
+    }
+
+    // Returns the pair for a key, inserting it with a value constructed from args if the key isn't in the object.
+    // The bool is true if the pair was inserted.
+    template<typename KeyT, typename... TArgs>
+    static std::pair<value_type*, bool> try_emplace(ValueObjectStorage*& obj, KeyT&& key, TArgs&&... args)
+    {
+        decltype(auto) key_value = as_key(std::forward<KeyT>(key));
+        uint64_t hash = 0;
+        if (obj != nullptr)
+        {
+            if (const value_type* existing = obj->find_internal(key_value, hash))
+            {
+                return { const_cast<value_type*>(existing), false };
+            }
+        }
+        return { &append_new_pair(obj, hash, std::forward<decltype(key_value)>(key_value), std::forward<TArgs>(args)...), true };
+    }
+
+    template<typename KeyT, typename ValT>
+    static std::pair<value_type*, bool> insert_or_assign(ValueObjectStorage*& obj, KeyT&& key, ValT&& value)
+    {
+        decltype(auto) key_value = as_key(std::forward<KeyT>(key));
+        uint64_t hash = 0;
+        if (obj != nullptr)
+        {
+            if (const value_type* existing = obj->find_internal(key_value, hash))
+            {
+                value_type* pair = const_cast<value_type*>(existing);
+                pair->second = std::forward<ValT>(value);
+                return { pair, false };
+            }
+        }
+        return { &append_new_pair(obj, hash, std::forward<decltype(key_value)>(key_value), std::forward<ValT>(value)), true };
+    }
+
+    // Removes a pair. The last pair is moved into its place.
+    void erase(value_type* pair)
+    {
+        value_type* pairs = items();
+        JXC_DEBUG_ASSERT(pair >= pairs && pair < pairs + num_items);
+        const size_t item_idx = static_cast<size_t>(pair - pairs);
+        const size_t last_idx = num_items - 1;
+        if (num_index_slots > 0)
+        {
+            index_erase_slot(index_find_slot(hash_key(pair->first), item_idx));
+            if (item_idx != last_idx)
+            {
+                const uint64_t last_hash = hash_key(pairs[last_idx].first);
+                index_slots()[index_find_slot(last_hash, last_idx)] = make_slot(last_hash, item_idx);
             }
         }
-        else
+        if (item_idx != last_idx)
         {
-            number_str = jxc::format("{}", value);
+            *pair = std::move(pairs[last_idx]);
         }
+        pairs[last_idx].~value_type();
+        --num_items;
+    }
 
-        JXC_ASSERT(number_str.size() <= buffer_len);
-        JXC_STRNCPY(buffer, buffer_len, number_str.data(), number_str.size());
+    inline value_type* find(const K& key) { uint64_t hash = 0; return const_cast<value_type*>(find_internal(key, hash)); }
+    inline const value_type* find(const K& key) const { uint64_t hash = 0; return find_internal(key, hash); }
+    inline bool contains(const K& key) const { return find(key) != nullptr; }
 
-        if (include_tag && tag_len > 0)
+    inline value_type* items() { return std::launder(reinterpret_cast<value_type*>(reinterpret_cast<K*>(this) + 1)); }
+    inline const value_type* items() const { return std::launder(reinterpret_cast<const value_type*>(reinterpret_cast<const K*>(this) + 1)); }
+
+    inline size_t size() const { return num_items; }
+    inline size_t capacity() const { return item_capacity; }
+    inline bool empty() const { return num_items == 0; }
+    inline bool has_index() const { return num_index_slots > 0; }
+    inline std::pmr::memory_resource* get_resource() const { return memory.resource; }
+    inline const ValueMemory& get_memory() const { return memory; }
+    inline bool is_in_arena() const { return memory.in_arena; }
+
+    // Heap bytes used by this object's allocation (not counting anything owned by its keys and values)
+    inline size_t get_allocation_size() const { return get_num_alloc_units(item_capacity, num_index_slots) * sizeof(K); }
+
+    inline iterator begin() { return items(); }
+    inline iterator end() { return items() + num_items; }
+    inline const_iterator begin() const { return items(); }
+    inline const_iterator end() const { return items() + num_items; }
+
+    // Objects are equal if they have the same pairs, in any order
+    bool operator==(const ValueObjectStorage& rhs) const
+    {
+        if (num_items != rhs.num_items)
         {
-            const size_t buffer_num_str_len = number_str.size();
-            const size_t tag_size = static_cast<size_t>(tag_len);
-            JXC_ASSERT(buffer_num_str_len + tag_size <= buffer_len);
-            for (size_t i = 0; i < tag_size; i++)
+            return false;
+        }
+        for (const value_type& pair : *this)
+        {
+            const value_type* rhs_pair = rhs.find(pair.first);
+            if (rhs_pair == nullptr || rhs_pair->second != pair.second)
             {
-                buffer[buffer_num_str_len + i] = tag[i];
+                return false;
             }
-            return buffer_num_str_len + tag_size;
         }
-
-        return number_str.size();
+        return true;
     }
 
-    std::string to_string(int float_precision, bool fixed_precision, bool include_tag) const
+    inline bool operator!=(const ValueObjectStorage& rhs) const { return !operator==(rhs); }
+};
+
+JXC_END_NAMESPACE(detail)
+
+
+// Monotonic arena for building Value trees. Allocations are bump-allocated from large blocks and individual frees do nothing,
+// and the memory is returned all at once when the arena is destroyed. Destroying an arena-allocated array or object skips the
+// destructors of its items, as long as they only use memory from the same arena - an item added from somewhere else, or a
+// mutable reference to an item, makes that container destroy its items normally.
+// Not thread-safe - only build values from one thread at a time.
+class ValueArena
+{
+    detail::ValueArenaResource resource;
+
+public:
+    explicit ValueArena(size_t initial_block_size = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : resource(initial_block_size, upstream)
     {
-        static constexpr size_t buf_len = 64;
-        char buf[buf_len];
-        const size_t result_len = to_string_in_buffer(buf, buf_len, float_precision, fixed_precision, include_tag);
-        return std::string(buf, result_len);
     }
-};
 
-static_assert(std::is_trivially_constructible_v<TaggedNum<int64_t, 15>>, "TaggedNum should be trivially constructible");
-static_assert(std::is_trivially_copyable_v<TaggedNum<int64_t, 15>>, "TaggedNum should be trivially copyable");
+    ValueArena(const ValueArena&) = delete;
+    ValueArena& operator=(const ValueArena&) = delete;
 
-JXC_END_NAMESPACE(detail)
+    inline std::pmr::memory_resource* get_resource() { return &resource; }
+    inline detail::ValueMemory get_memory() { return detail::ValueMemory(&resource, true); }
 
-class Value;
+    // Frees everything allocated from the arena. Every value using the arena must have been destroyed first.
+    inline void release() { resource.release(); }
+};
 
 JXC_END_NAMESPACE(jxc)
 
@@ -556,23 +1389,24 @@ public:
     static constexpr size_t byte_buffer_len = 23;
     using size_type = size_t;
 
-    using byte_allocator_t = JXC_ALLOCATOR<uint8_t>;
-    using value_allocator_t = JXC_ALLOCATOR<Value>;
-    using pair_allocator_t = JXC_ALLOCATOR<std::pair<Value, Value>>;
+    using byte_allocator_t = detail::ValueAllocator<uint8_t>;
 
-    using array_vt = std::vector<Value, value_allocator_t>;
+    // Arrays and objects are each a single allocation (see ValueArrayStorage and ValueObjectStorage)
+    using array_vt = detail::ValueArrayStorage<Value>;
+    using object_vt = detail::ValueObjectStorage<Value, Value>;
 
-    struct object_hash_t { auto operator()(const Value& val) const -> uint64_t { return val.hash(); } };
-    using object_vt = ankerl::unordered_dense::map<Value, Value, object_hash_t, std::equal_to<Value>, pair_allocator_t>;
-
-    using array_allocator_t = JXC_ALLOCATOR<array_vt>;
-    using object_allocator_t = JXC_ALLOCATOR<object_vt>;
+    // Arrays of plain numbers can be stored as packed buffers instead of Values (see is_packed_array())
+    using packed_float_array_vt = detail::ValueArrayStorage<float_vt>;
+    using packed_signed_integer_array_vt = detail::ValueArrayStorage<signed_integer_vt>;
 
     // tags for explicit string/bytes storage mechanism
     struct AsView {};
     struct AsInline {};
     struct AsOwned {};
 
+    // tag for lazy strings and numbers (see is_lazy())
+    struct AsLazy {};
+
     static constexpr size_t max_inline_string_len = byte_buffer_len;
     static constexpr size_t max_inline_bytes_len = byte_buffer_len;
     static constexpr size_t max_number_tag_len = byte_buffer_len - sizeof(uint64_t);
@@ -584,8 +1418,8 @@ public:
     using tagged_float_vt = detail::TaggedNum<float_vt, max_number_tag_len>;
 
 private:
-    static uint8_t* create_buffer(size_t buf_len);
-    static void destroy_buffer(uint8_t* buf, size_t buf_len);
+    static uint8_t* create_buffer(size_t buf_len, std::pmr::memory_resource* resource);
+    static void destroy_buffer(uint8_t* buf, size_t buf_len, std::pmr::memory_resource* resource);
 
 private:
     using AnnotationDataType = detail::AnnotationDataType;
@@ -595,7 +1429,20 @@ private:
         Inline = 0,
         View,
         Owned,
-        LAST = Owned,
+
+        // Strings and numbers that haven't been parsed yet (see is_lazy()). Numbers don't use the buffer type otherwise.
+        Lazy,
+
+        LAST = Lazy,
+    };
+
+    // Array storage type. Arrays don't use the byte buffer type, so this is stored in the same bits.
+    enum class ArrayStorageType : uint8_t
+    {
+        Values = 0,
+        PackedFloat,
+        PackedSignedInteger,
+        LAST = PackedSignedInteger,
     };
 
     static_assert(static_cast<size_t>(ValueType::COUNT) - 1 <= 0b1111, "ValueType needs to fit in 4 bits");
@@ -603,6 +1450,9 @@ private:
     // Ideally we could just use COUNT members for these two for consistency, but then GCC complains that all enum values don't fit in the bitfield.
     static_assert(static_cast<size_t>(AnnotationDataType::LAST) <= 0b11, "AnnotationDataType needs to fit in 2 bits");
     static_assert(static_cast<size_t>(ByteBufferType::LAST) <= 0b11, "ByteBufferType needs to fit in 2 bits.");
+    static_assert(static_cast<size_t>(ArrayStorageType::LAST) <= 0b11, "ArrayStorageType needs to fit in 2 bits.");
+    static_assert(static_cast<size_t>(ArrayStorageType::LAST) < static_cast<size_t>(ByteBufferType::Lazy),
+        "Lazy must not be a valid ArrayStorageType, so that checking the buffer type alone is enough to find lazy values");
 
     // 8 bits of storage for value type and related metadata
     struct Metadata
@@ -623,15 +1473,27 @@ private:
             return result;
         }
 
+        inline ArrayStorageType get_array_storage() const { return static_cast<ArrayStorageType>(buffer); }
+        inline void set_array_storage(ArrayStorageType storage) { buffer = static_cast<ByteBufferType>(storage); }
+
         inline void reset(ValueType type_data = ValueType::Invalid, ByteBufferType type_buffer = ByteBufferType::Inline)
         {
             data = type_data;
             buffer = type_buffer;
         }
-    } type;
+    };
+
+    // The type and data of a lazy value are replaced by the parsed value the first time it's read, including through a const
+    // reference (see is_lazy()), so both are mutable. Nothing else changes them through const access.
+    mutable Metadata type;
 
     static_assert(sizeof(Metadata) == sizeof(uint8_t), "Metadata struct should be 8 bits");
 
+    // Set once an array or object hands out a mutable reference to one of its items, or gets an item that uses memory from
+    // somewhere other than the container's memory resource. Until then, destroying an arena-allocated container can skip the
+    // destructors of its items (see ValueArena). This fits in the padding after the metadata byte.
+    bool items_modified = false;
+
     detail::AnnotationData annotation;
 
     // variant value storage
@@ -641,9 +1503,14 @@ private:
         tagged_signed_integer_vt value_signed_integer;
         tagged_unsigned_integer_vt value_unsigned_integer;
         tagged_float_vt value_float;
-        struct { uint8_t* ptr; size_t len; } buffer_ptr; // string view, bytes view, owned string ptr, or owned bytes ptr
+        // string view, bytes view, owned string ptr, or owned bytes ptr (resource is the memory resource owned buffers came from)
+        struct { uint8_t* ptr; size_t len; std::pmr::memory_resource* resource; } buffer_ptr;
         struct { uint8_t bytes[byte_buffer_len]; uint8_t len; } buffer_inline; // inline string or inline bytes
+        // source text of a lazy string or number token, and its offset in the source buffer for error reporting
+        struct { const char* ptr; size_t len; size_t start_idx; } lazy_token;
         array_vt* value_array;
+        packed_float_array_vt* value_packed_float_array;
+        packed_signed_integer_array_vt* value_packed_signed_integer_array;
         object_vt* value_object;
 
         DataStore() { clear(); }
@@ -673,21 +1540,39 @@ private:
             JXC_MEMCPY(&buffer_inline.bytes[0], byte_buffer_len, val.data(), val.size());
             buffer_inline.len = static_cast<uint8_t>(val.size());
         }
-    } data;
+    };
 
-    void alloc_buffer_from(string_view_vt val);
-    void alloc_buffer_from(bytes_view_vt val);
+    mutable DataStore data;
+
+    static_assert(sizeof(DataStore) == byte_buffer_len + 1, "Owned buffer pointers should fit in the inline buffer space");
+
+    void alloc_buffer(size_t buf_len, std::pmr::memory_resource* resource = nullptr);
+    void alloc_buffer_from(string_view_vt val, std::pmr::memory_resource* resource = nullptr);
+    void alloc_buffer_from(bytes_view_vt val, std::pmr::memory_resource* resource = nullptr);
     void free_buffer();
 
-    array_vt& alloc_array();
+    array_vt& alloc_array(size_t capacity = array_vt::default_capacity);
     void free_array();
 
-    object_vt& alloc_object();
+    object_vt& alloc_object(size_t capacity = object_vt::default_capacity);
     void free_object();
 
     void copy_from_internal(const Value& rhs);
     void move_from_internal(Value&& rhs);
 
+    // True if this value (including its annotation and any array items or object pairs) doesn't own any memory, or only owns
+    // memory from the given memory resource
+    bool only_uses_memory_from(const std::pmr::memory_resource* resource) const;
+
+    // Sets items_modified if an item just added to this array or object uses memory from outside the container's memory resource
+    inline void note_item_added(const Value& item)
+    {
+        items_modified = items_modified || !item.only_uses_memory_from(get_memory_resource());
+    }
+
+    // Recomputes items_modified for an array or object that was filled in by copying items into it
+    void update_items_modified();
+
     // Sets the value to a string, auto-selecting inline or owned depending on length.
     // Intended to be used from assignment operators.
     void assign_from_view(string_view_vt view);
@@ -707,27 +1592,27 @@ private:
             const size_t num_items = value.size();
             if (num_items > 0)
             {
-                array_vt& arr = alloc_array();
                 if constexpr (std::same_as<T, array_vt>)
                 {
-                    arr = value;
+                    data.value_array = array_vt::create_copy(value, detail::ValueMemory());
                 }
                 else if constexpr (std::same_as<T, std::initializer_list<Value>>)
                 {
-                    arr.reserve(num_items);
+                    alloc_array(num_items);
                     for (const auto& val : value)
                     {
-                        arr.push_back(val);
+                        array_vt::emplace_back(data.value_array, val);
                     }
                 }
                 else
                 {
-                    arr.reserve(num_items);
+                    alloc_array(num_items);
                     for (size_t i = 0; i < num_items; i++)
                     {
-                        arr.push_back(value[i]);
+                        array_vt::emplace_back(data.value_array, value[i]);
                     }
                 }
+                update_items_modified();
             }
         }
     }
@@ -742,19 +1627,19 @@ private:
             const size_t num_items = value.size();
             if (num_items > 0)
             {
-                object_vt& obj = alloc_object();
                 if constexpr (std::same_as<T, object_vt>)
                 {
-                    obj = value;
+                    data.value_object = object_vt::create_copy(value, detail::ValueMemory());
                 }
                 else
                 {
-                    obj.reserve(num_items);
+                    alloc_object(num_items);
                     for (const auto& pair : value)
                     {
-                        obj.insert_or_assign(pair.first, pair.second);
+                        object_vt::insert_or_assign(data.value_object, pair.first, pair.second);
                     }
                 }
+                update_items_modified();
             }
         }
     }
@@ -765,12 +1650,12 @@ private:
         const size_t num_items = value.size();
         if (num_items > 0)
         {
-            object_vt& obj = alloc_object();
-            obj.reserve(num_items);
+            alloc_object(num_items);
             for (const auto& pair : value)
             {
-                obj.insert_or_assign(pair.first, pair.second);
+                object_vt::insert_or_assign(data.value_object, pair.first, pair.second);
             }
+            update_items_modified();
         }
         else
         {
@@ -795,15 +1680,44 @@ private:
 
     inline array_vt& as_array_unchecked() { return *data.value_array; }
     inline const array_vt& as_array_unchecked() const { return *data.value_array; }
-    inline array_vt& as_array_unchecked_auto_init() { return (data.value_array != nullptr) ? *data.value_array : alloc_array(); }
 
     inline object_vt& as_object_unchecked() { return *data.value_object; }
     inline const object_vt& as_object_unchecked() const { return *data.value_object; }
-    inline object_vt& as_object_unchecked_auto_init() { return (data.value_object != nullptr) ? *data.value_object : alloc_object(); }
+
+    // lazy value helpers (see is_lazy())
+    inline void materialize_lazy() const
+    {
+        if (type.buffer == ByteBufferType::Lazy) [[unlikely]]
+        {
+            materialize_lazy_or_invalidate();
+        }
+    }
+    void materialize_lazy_or_invalidate() const;
+    bool materialize_lazy_internal(ErrorInfo& out_error) const;
+
+    // packed array helpers (see is_packed_array())
+    void expand_packed_array_internal();
+    bool try_push_back_packed(const Value& rhs);
+    Value get_packed_array_item(size_t idx) const;
+
+    void free_packed_array_expanded_items();
+    array_vt* get_packed_array_expanded_items() const;
+
+    // Packed arrays have no Values to return references to, so const element access reads a Value copy of their items that's
+    // made on first use and kept with the packed storage. The array itself is left as it is.
+    inline const array_vt* get_array_for_const_access() const
+    {
+        if (is_packed_array()) [[unlikely]]
+        {
+            return get_packed_array_expanded_items();
+        }
+        return data.value_array;
+    }
+    bool array_eq_internal(const Value& rhs) const;
 
     // to_repr() helpers
     static std::string value_to_string_internal(const Value& val, bool repr_mode, int float_precision, bool fixed_precision);
-    static std::string array_to_string_internal(const Value::array_vt& val, bool repr_mode, int float_precision, bool fixed_precision);
+    static std::string array_to_string_internal(const Value& val, bool repr_mode, int float_precision, bool fixed_precision);
     static std::string object_to_string_internal(const Value::object_vt& val, bool repr_mode, int float_precision, bool fixed_precision);
 
 public:
@@ -923,8 +1837,9 @@ public:
         return *this;
     }
 
+    // Strings too long to store inline are allocated from memory
     template<traits::StringContainer T>
-    Value(const T& value)
+    Value(const T& value, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         auto view = traits::cast_string_to_view(value);
         if (view.size() <= max_inline_string_len)
@@ -942,7 +1857,7 @@ public:
         else
         {
             type = Metadata::init(ValueType::String, ByteBufferType::Owned);
-            alloc_buffer_from(view);
+            alloc_buffer_from(view, memory.resource);
         }
     }
 
@@ -963,13 +1878,13 @@ public:
     }
 
     template<traits::StringContainer T>
-    Value(const T& value, AsOwned)
+    Value(const T& value, AsOwned, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         auto view = traits::cast_string_to_view(value);
         if (view.size() > 0)
         {
             type = Metadata::init(ValueType::String, ByteBufferType::Owned);
-            alloc_buffer_from(view);
+            alloc_buffer_from(view, memory.resource);
         }
         else
         {
@@ -1000,8 +1915,9 @@ public:
 
     Value& operator=(const char* value) { assign_from_view(traits::cast_string_to_view(value)); return *this; }
 
+    // Byte arrays too long to store inline are allocated from memory
     template<traits::Bytes T>
-    Value(const T& value)
+    Value(const T& value, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         auto view = traits::cast_bytes_to_view(value);
         if (view.size() <= max_inline_bytes_len)
@@ -1019,7 +1935,7 @@ public:
         else
         {
             type = Metadata::init(ValueType::Bytes, ByteBufferType::Owned);
-            alloc_buffer_from(view);
+            alloc_buffer_from(view, memory.resource);
         }
     }
 
@@ -1040,13 +1956,13 @@ public:
     }
 
     template<traits::Bytes T>
-    Value(const T& value, AsOwned)
+    Value(const T& value, AsOwned, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         auto view = traits::cast_bytes_to_view(value);
         if (view.size() > 0)
         {
             type = Metadata::init(ValueType::Bytes, ByteBufferType::Owned);
-            alloc_buffer_from(view);
+            alloc_buffer_from(view, memory.resource);
         }
         else
         {
@@ -1089,6 +2005,17 @@ public:
         return *this;
     }
 
+    // Lazy string or number. token_source is the token's source text, which must outlive this value, and token_start_idx
+    // is its offset in the source buffer. The token is parsed the first time the value is read.
+    Value(ValueType lazy_type, std::string_view token_source, size_t token_start_idx, AsLazy)
+        : type(Metadata::init(lazy_type, ByteBufferType::Lazy))
+    {
+        JXC_DEBUG_ASSERT(lazy_type == ValueType::String || lazy_type == ValueType::SignedInteger || lazy_type == ValueType::Float);
+        data.lazy_token.ptr = token_source.data();
+        data.lazy_token.len = token_source.size();
+        data.lazy_token.start_idx = token_start_idx;
+    }
+
     Value(std::initializer_list<Value> values)
         : type(Metadata::init(ValueType::Array))
     {
@@ -1166,17 +2093,24 @@ public:
     inline bool is_object() const { return type.data == ValueType::Object; }
 
     inline bool_vt as_bool() const { JXC_ASSERT(type.data == ValueType::Bool); return data.value_bool; }
-    inline signed_integer_vt as_signed_integer() const { JXC_ASSERT(type.data == ValueType::SignedInteger); return data.value_signed_integer.value; }
+    inline signed_integer_vt as_signed_integer() const { JXC_ASSERT(type.data == ValueType::SignedInteger); materialize_lazy(); return data.value_signed_integer.value; }
     inline unsigned_integer_vt as_unsigned_integer() const { JXC_ASSERT(type.data == ValueType::UnsignedInteger); return data.value_unsigned_integer.value; }
-    inline float_vt as_float() const { JXC_ASSERT(type.data == ValueType::Float); return data.value_float.value; }
-    inline string_view_vt as_string() const { JXC_ASSERT(type.data == ValueType::String); return as_string_view_unchecked(); }
+    inline float_vt as_float() const { JXC_ASSERT(type.data == ValueType::Float); materialize_lazy(); return data.value_float.value; }
+    inline string_view_vt as_string() const { JXC_ASSERT(type.data == ValueType::String); materialize_lazy(); return as_string_view_unchecked(); }
     inline bytes_view_vt as_bytes() const { JXC_ASSERT(type.data == ValueType::Bytes); return as_bytes_view_unchecked(); }
-    inline const array_vt& as_array() const { JXC_ASSERT(type.data == ValueType::Array); static const array_vt empty_arr; return data.value_array ? *data.value_array : empty_arr; }
-    inline const object_vt& as_object() const { JXC_ASSERT(type.data == ValueType::Object); static const object_vt empty_obj; return data.value_object ? *data.value_object : empty_obj; }
+    // Packed arrays return a Value copy of their items (see is_packed_array())
+    inline const array_vt& as_array() const
+    {
+        JXC_ASSERT(type.data == ValueType::Array);
+        const array_vt* arr = get_array_for_const_access();
+        return arr ? *arr : array_vt::get_empty();
+    }
+    inline const object_vt& as_object() const { JXC_ASSERT(type.data == ValueType::Object); return data.value_object ? *data.value_object : object_vt::get_empty(); }
 
     template<traits::Integer T = int64_t>
     inline T as_integer() const
     {
+        materialize_lazy();
         if (type.data == ValueType::SignedInteger)
         {
             return traits::cast_integer_clamped<T>(data.value_signed_integer.value);
@@ -1190,15 +2124,16 @@ public:
     }
 
     inline std::optional<bool_vt> try_get_bool() const { if (type.data == ValueType::Bool) { return data.value_bool; } return std::nullopt; }
-    inline std::optional<signed_integer_vt> try_get_signed_integer() const { if (type.data == ValueType::SignedInteger) { return data.value_signed_integer.value; } return std::nullopt; }
+    inline std::optional<signed_integer_vt> try_get_signed_integer() const { if (type.data == ValueType::SignedInteger) { materialize_lazy(); return data.value_signed_integer.value; } return std::nullopt; }
     inline std::optional<unsigned_integer_vt> try_get_unsigned_integer() const { if (type.data == ValueType::UnsignedInteger) { return data.value_unsigned_integer.value; } return std::nullopt; }
-    inline std::optional<float_vt> try_get_float() const { if (type.data == ValueType::Float) { return data.value_float.value; } return std::nullopt; }
-    inline std::optional<string_view_vt> try_get_string() const { if (type.data == ValueType::String) { return as_string_view_unchecked(); } return std::nullopt; }
+    inline std::optional<float_vt> try_get_float() const { if (type.data == ValueType::Float) { materialize_lazy(); return data.value_float.value; } return std::nullopt; }
+    inline std::optional<string_view_vt> try_get_string() const { if (type.data == ValueType::String) { materialize_lazy(); return as_string_view_unchecked(); } return std::nullopt; }
     inline std::optional<bytes_view_vt> try_get_bytes() const { if (type.data == ValueType::Bytes) { return as_bytes_view_unchecked(); } return std::nullopt; }
 
     inline void clear_annotation() { type.anno = annotation.clear(type.anno); }
+    inline bool has_annotation() const { return !annotation.is_empty(type.anno); }
     bool set_annotation(std::string_view new_anno, std::string* out_anno_parse_error = nullptr);
-    bool set_annotation(TokenView new_anno_tokens, bool as_view = false);
+    bool set_annotation(TokenView new_anno_tokens, bool as_view = false, const detail::ValueMemory& memory = detail::ValueMemory());
     bool set_annotation(const TokenList& new_anno_tokens);
     bool set_annotation(TokenList&& new_anno_tokens);
     inline FlexString get_annotation_source() const { return annotation.as_source(type.anno); }
@@ -1208,10 +2143,110 @@ public:
     /// Checks if we fully own our annotation's data
     inline bool is_owned_annotation() const { return type.anno == AnnotationDataType::SourceInline || annotation.is_empty(type.anno) || annotation.have_owned_data(type.anno); }
 
-    /// Checks if we fully own our value's data (only string and bytes types can be unowned)
+    /// Checks if this is an array of numbers stored as a packed buffer of doubles or int64s, instead of as Values.
+    /// Parsed arrays are packed when all their items are floats, or all are integers, with no number suffixes or annotations.
+    /// Packing is opt-in (see Document::set_pack_numeric_arrays()), and arrays can also be packed with convert_to_packed_array().
+    /// Packed arrays are expanded to Values the first time an item is accessed by non-const reference (eg. by operator[], at(), or
+    /// emplace_back()), or when an item that can't be packed is added. Like any other change to the array, that invalidates spans
+    /// from as_span().
+    /// Const access (eg. as_array() const, or at() const) leaves the array packed. The first one makes a Value copy of the items,
+    /// which later const accesses share until the array is changed. Making that copy is synchronized, so const accessors are safe to
+    /// call from multiple threads at once. as_span(), get_item(), and for_each_item() read the packed items without making a copy.
+    inline bool is_packed_array() const { return type.data == ValueType::Array && type.get_array_storage() != ArrayStorageType::Values; }
+    inline bool is_packed_float_array() const { return type.data == ValueType::Array && type.get_array_storage() == ArrayStorageType::PackedFloat; }
+    inline bool is_packed_signed_integer_array() const { return type.data == ValueType::Array && type.get_array_storage() == ArrayStorageType::PackedSignedInteger; }
+
+    /// Requires a packed array of T, or an empty array. Returns the items without expanding the array.
+    template<typename T>
+        requires std::same_as<T, float_vt> || std::same_as<T, signed_integer_vt>
+    std::span<const T> as_span() const
+    {
+        JXC_ASSERT(type.data == ValueType::Array);
+        if (data.value_array == nullptr)
+        {
+            return std::span<const T>();
+        }
+
+        if constexpr (std::same_as<T, float_vt>)
+        {
+            if (type.get_array_storage() == ArrayStorageType::PackedFloat)
+            {
+                return std::span<const T>(data.value_packed_float_array->data(), data.value_packed_float_array->size());
+            }
+        }
+        else
+        {
+            if (type.get_array_storage() == ArrayStorageType::PackedSignedInteger)
+            {
+                return std::span<const T>(data.value_packed_signed_integer_array->data(), data.value_packed_signed_integer_array->size());
+            }
+        }
+
+        JXC_ASSERTF(size() == 0, "as_span<{}>() requires a packed array of that type", (std::same_as<T, float_vt> ? "double" : "int64_t"));
+        return std::span<const T>();
+    }
+
+    /// Stores an array as a packed buffer if all its items are floats, or all are signed integers, with no number suffixes or annotations.
+    /// Returns true if the array is packed.
+    bool convert_to_packed_array();
+
+    /// Requires an empty array. Makes it a packed array of T and reserves space for capacity items, allocated from memory.
+    template<typename T>
+        requires std::same_as<T, float_vt> || std::same_as<T, signed_integer_vt>
+    void init_packed_array(size_t capacity, const detail::ValueMemory& memory = detail::ValueMemory())
+    {
+        JXC_ASSERT(type.data == ValueType::Array && size() == 0);
+        if (data.value_array != nullptr)
+        {
+            free_array();
+        }
+
+        if constexpr (std::same_as<T, float_vt>)
+        {
+            type.set_array_storage(ArrayStorageType::PackedFloat);
+            packed_float_array_vt::reserve(data.value_packed_float_array, capacity, memory);
+        }
+        else
+        {
+            type.set_array_storage(ArrayStorageType::PackedSignedInteger);
+            packed_signed_integer_array_vt::reserve(data.value_packed_signed_integer_array, capacity, memory);
+        }
+    }
+
+    /// Stores a packed array's items as Values. Does nothing if this value isn't a packed array.
+    inline Value& expand_packed_array()
+    {
+        if (is_packed_array())
+        {
+            expand_packed_array_internal();
+        }
+        return *this;
+    }
+
+    /// Checks if this is a string or number that hasn't been parsed yet. Lazy values are only created by parsers with lazy
+    /// scalars turned on (see Document::set_lazy_scalars()), and keep a reference to their token in the source buffer until
+    /// they're first read, when the token is parsed and the result replaces it.
+    /// That modifies the value even through a const reference, so a tree with lazy values must not be read from multiple threads
+    /// at once. Call materialize() with recursive=true before sharing one.
+    /// The parser only creates lazy values that will parse successfully: numbers that could fail (eg. integers too large for int64)
+    /// are never lazy, and strings have their escapes checked up front, so those errors are reported by the parse as usual.
+    /// A lazy value built by hand that fails to parse becomes invalid when it's read (reading a string returns an empty string).
+    /// Use materialize() to get the error.
+    inline bool is_lazy() const { return type.buffer == ByteBufferType::Lazy; }
+
+    /// Parses this value's token if it's lazy. If recursive is true, this also applies to all array or object values, recursively.
+    /// Returns false if a token fails to parse, with the token's offsets in the source buffer in out_error. The value that failed
+    /// to parse becomes invalid.
+    bool materialize(ErrorInfo& out_error, bool recursive = false);
+
+    /// Checks if we fully own our value's data (only string and bytes types, and lazy values, can be unowned)
     inline bool is_owned_value() const
     {
-        if (type.data == ValueType::String || type.data == ValueType::Bytes)
+        if (type.buffer == ByteBufferType::Lazy)
+        {
+            return false;
+        }
+        else if (type.data == ValueType::String || type.data == ValueType::Bytes)
         {
             return type.buffer == ByteBufferType::Inline || type.buffer == ByteBufferType::Owned;
         }
@@ -1221,6 +2256,42 @@ public:
     /// Checks if this value owns all its data (both the annotation and the value)
     bool is_owned(bool recursive = false) const;
 
+    /// Returns the number of heap bytes owned by this value (owned strings and bytes, array and object storage, and owned annotations).
+    /// If out_num_allocations is set, the number of separate heap allocations is added to it.
+    /// If recursive is true, this includes everything owned by array or object values, recursively.
+    size_t get_heap_usage(bool recursive = false, size_t* out_num_allocations = nullptr) const;
+
+    /// Returns the memory resource this value's array, object, or owned string or bytes storage was allocated from
+    /// (see Document::set_memory_resource()). Returns nullptr for heap-allocated values, and values with no allocated storage.
+    inline std::pmr::memory_resource* get_memory_resource() const
+    {
+        switch (type.data)
+        {
+        case ValueType::String:
+        case ValueType::Bytes:
+            return (type.buffer == ByteBufferType::Owned) ? data.buffer_ptr.resource : nullptr;
+        case ValueType::Array:
+            if (data.value_array == nullptr)
+            {
+                return nullptr;
+            }
+            switch (type.get_array_storage())
+            {
+            case ArrayStorageType::PackedFloat:
+                return data.value_packed_float_array->get_resource();
+            case ArrayStorageType::PackedSignedInteger:
+                return data.value_packed_signed_integer_array->get_resource();
+            default:
+                return data.value_array->get_resource();
+            }
+        case ValueType::Object:
+            return data.value_object ? data.value_object->get_resource() : nullptr;
+        default:
+            break;
+        }
+        return nullptr;
+    }
+
     /// Converts any unowned data in this value to owned data. This copies any annotation, string, or byte views into memory owned by this Value.
     /// If recursive is true, this also applies to all array or object values, recursively.
     Value& convert_to_owned(bool recursive = false);
@@ -1241,24 +2312,27 @@ public:
     Value substr_view(size_t start, size_t count = invalid_idx) const;
 
 private:
-    void resize_buffer(size_t new_size, size_t max_inline_size);
+    void resize_buffer(size_t new_size, size_t max_inline_size, std::pmr::memory_resource* resource);
 
 public:
-    inline void resize_string_buffer(size_t new_size)
+    /// If this needs a new allocation for an inline string, it's allocated from memory. Owned strings stay in the memory they were
+    /// allocated from.
+    inline void resize_string_buffer(size_t new_size, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         JXC_ASSERT(type.data == ValueType::String && type.buffer != ByteBufferType::View);
-        resize_buffer(new_size, max_inline_string_len);
+        resize_buffer(new_size, max_inline_string_len, memory.resource);
     }
 
-    inline void resize_bytes_buffer(size_t new_size)
+    inline void resize_bytes_buffer(size_t new_size, const detail::ValueMemory& memory = detail::ValueMemory())
     {
         JXC_ASSERT(type.data == ValueType::Bytes && type.buffer != ByteBufferType::View);
-        resize_buffer(new_size, max_inline_bytes_len);
+        resize_buffer(new_size, max_inline_bytes_len, memory.resource);
     }
 
     template<typename T>
     std::optional<T> cast() const
     {
+        materialize_lazy();
         if constexpr (traits::Invalid<T>)
         {
             if (type.data == ValueType::Invalid)
@@ -1291,7 +2365,7 @@ public:
             case ValueType::Bytes:
                 return static_cast<T>(bytes_or_string_len_unchecked() > 0);
             case ValueType::Array:
-                return static_cast<T>(data.value_array && data.value_array->size() > 0);
+                return static_cast<T>(size() > 0);
             case ValueType::Object:
                 return static_cast<T>(data.value_object && data.value_object->size() > 0);
             default:
@@ -1462,16 +2536,17 @@ public:
     template<traits::Number T>
     inline bool operator==(T rhs) const
     {
+        materialize_lazy();
         return (type.data == ValueType::SignedInteger && data.value_signed_integer.value == rhs)
             || (type.data == ValueType::UnsignedInteger && data.value_unsigned_integer.value == rhs)
             || (type.data == ValueType::Float && data.value_float.value == rhs);
     }
     template<traits::Number T> inline bool operator!=(T value) const { return !operator==(value); }
 
-    template<traits::StringContainer T> inline bool operator==(const T& value) const { return type.data == ValueType::String && as_string_view_unchecked() == traits::cast_string_to_view(value); }
+    template<traits::StringContainer T> inline bool operator==(const T& value) const { return type.data == ValueType::String && as_string() == traits::cast_string_to_view(value); }
     template<traits::StringContainer T> inline bool operator!=(const T& value) const { return !operator==(value); }
 
-    inline bool operator==(const char* value) const { return type.data == ValueType::String && as_string_view_unchecked() == traits::cast_string_to_view(value); }
+    inline bool operator==(const char* value) const { return type.data == ValueType::String && as_string() == traits::cast_string_to_view(value); }
     inline bool operator!=(const char* value) const { return !operator==(value); }
 
     template<traits::Bytes T> inline bool operator==(const T& value) const { return type.data == ValueType::Bytes && as_bytes_view_unchecked() == traits::cast_bytes_to_view(value); }
@@ -1485,11 +2560,24 @@ public:
             return false;
         }
 
-        const size_t num_items = data.value_array ? data.value_array->size() : 0;
+        const size_t num_items = size();
         if (num_items != value.size())
         {
             return false;
         }
+
+        if (is_packed_array())
+        {
+            for (size_t i = 0; i < num_items; i++)
+            {
+                if (get_packed_array_item(i) != value[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         const array_vt& arr = as_array_unchecked();
         for (size_t i = 0; i < num_items; i++)
         {
@@ -1509,45 +2597,53 @@ public:
     // In this case, if the value is too large, it will be clamped with no overflow behavior.
     Value operator-() const;
 
-    template<traits::ObjectKey T>
-    Value& operator[](T key)
+private:
+    // Converts an integer key to an index into an array of arr_size items. Signed keys can be python-style negative indexes.
+    template<traits::Integer T>
+    static size_t get_array_index(T key, size_t arr_size)
     {
-        if constexpr (traits::UnsignedInteger<T>)
+        if constexpr (traits::SignedInteger<T>)
         {
-            if (type.data == ValueType::Array)
+            JXC_ASSERTF(arr_size > 0, "Index {} out of range for array with size 0", key);
+            size_t idx = invalid_idx;
+            if (key < 0)
+            {
+                // python-style negative index (-1 means the last array element, -2 is second-to-last, etc.)
+                const T reverse_idx = key + static_cast<T>(arr_size);
+                JXC_ASSERTF(reverse_idx >= 0 && static_cast<size_t>(reverse_idx) < arr_size, "Index {} out of range for array with size {}", key, arr_size);
+                idx = static_cast<size_t>(reverse_idx);
+            }
+            else
             {
-                JXC_ASSERTF(data.value_array && static_cast<size_t>(key) < data.value_array->size(),
-                    "Invalid index {} for array of size {}", key, data.value_array ? data.value_array->size() : 0);
-                return as_array_unchecked()[static_cast<size_t>(key)];
+                idx = static_cast<size_t>(key);
+                JXC_ASSERTF(idx < arr_size, "Index {} out of range for array with size {}", key, arr_size);
             }
+            JXC_DEBUG_ASSERT(idx != invalid_idx);
+            return idx;
+        }
+        else
+        {
+            JXC_ASSERTF(static_cast<size_t>(key) < arr_size, "Invalid index {} for array of size {}", key, arr_size);
+            return static_cast<size_t>(key);
         }
-        else if constexpr (traits::SignedInteger<T>)
+    }
+
+    template<traits::ObjectKey T>
+    Value& index_internal(T key)
+    {
+        if constexpr (traits::Integer<T>)
         {
             if (type.data == ValueType::Array)
             {
-                JXC_ASSERTF(data.value_array != nullptr && data.value_array->size() > 0, "Index {} out of range for array with size 0", key);
-                const size_t arr_size = data.value_array->size();
-                size_t idx = invalid_idx;
-                if (key < 0)
-                {
-                    // python-style negative index (-1 means the last array element, -2 is second-to-last, etc.)
-                    const T reverse_idx = key + static_cast<T>(arr_size);
-                    JXC_ASSERTF(reverse_idx >= 0 && reverse_idx < arr_size, "Index {} out of range for array with size {}", key, arr_size);
-                    idx = static_cast<size_t>(reverse_idx);
-                }
-                else
-                {
-                    idx = static_cast<size_t>(key);
-                    JXC_ASSERTF(idx < arr_size, "Index {} out of range for array with size {}", key, arr_size);
-                }
-                JXC_DEBUG_ASSERT(idx != invalid_idx);
+                expand_packed_array();
+                const size_t idx = get_array_index(key, data.value_array ? data.value_array->size() : 0);
                 return as_array_unchecked()[idx];
             }
         }
 
         if (type.data == ValueType::Object)
         {
-            return as_object_unchecked_auto_init()[std::forward<T>(key)];
+            return object_vt::try_emplace(data.value_object, std::forward<T>(key)).first->second;
         }
 
         JXC_ASSERTF(type.data == ValueType::Array || type.data == ValueType::Object,
@@ -1555,25 +2651,70 @@ public:
         return *this;
     }
 
+    Value& at_internal(size_type idx)
+    {
+        if (type.data == ValueType::Array)
+        {
+            expand_packed_array();
+            JXC_ASSERTF(data.value_array && idx < data.value_array->size(),
+                "Invalid index {} for array of size {}", idx, data.value_array ? data.value_array->size() : 0);
+            return as_array_unchecked()[idx];
+        }
+        JXC_ASSERTF(type.data == ValueType::Array, "Cannot use at() on {} type (requires Array)", value_type_to_string(type.data));
+        return *this;
+    }
+
+public:
+    template<traits::ObjectKey T>
+    inline Value& operator[](T key)
+    {
+        items_modified = true;
+        return index_internal(std::forward<T>(key));
+    }
+
     template<traits::ObjectKey T>
     inline const Value& operator[](T key) const
     {
-        return const_cast<Value*>(this)->operator[](std::forward<T>(key));
+        if constexpr (traits::Integer<T>)
+        {
+            if (type.data == ValueType::Array)
+            {
+                const array_vt* arr = get_array_for_const_access();
+                const size_t idx = get_array_index(key, arr ? arr->size() : 0);
+                return (*arr)[idx];
+            }
+        }
+        return const_cast<Value*>(this)->index_internal(std::forward<T>(key));
+    }
+
+    inline Value& at(size_type idx)
+    {
+        items_modified = true;
+        return at_internal(idx);
     }
 
-    Value& at(size_type idx)
+    inline const Value& at(size_type idx) const
     {
         if (type.data == ValueType::Array)
         {
-            JXC_ASSERTF(data.value_array && idx < data.value_array->size(),
-                "Invalid index {} for array of size {}", idx, data.value_array ? data.value_array->size() : 0);
-            return as_array_unchecked()[idx];
+            const array_vt* arr = get_array_for_const_access();
+            JXC_ASSERTF(arr && idx < arr->size(), "Invalid index {} for array of size {}", idx, arr ? arr->size() : 0);
+            return (*arr)[idx];
         }
         JXC_ASSERTF(type.data == ValueType::Array, "Cannot use at() on {} type (requires Array)", value_type_to_string(type.data));
         return *this;
     }
 
-    inline const Value& at(size_type idx) const { return const_cast<Value*>(this)->at(idx); }
+    /// Returns an array item by value. Unlike at(), this also works with const packed arrays.
+    inline Value get_item(size_type idx) const
+    {
+        if (is_packed_array())
+        {
+            JXC_ASSERTF(idx < size(), "Invalid index {} for array of size {}", idx, size());
+            return get_packed_array_item(idx);
+        }
+        return at(idx);
+    }
 
 private:
     template<typename KeyT, typename ValT>
@@ -1581,10 +2722,10 @@ private:
     {
         if (type.data == ValueType::Object)
         {
-            if (!data.value_object) { alloc_object(); }
-            // result is std::pair<iterator, bool>, where the bool indicates if a new value was inserted
-            auto result = data.value_object->insert_or_assign(std::forward<KeyT>(key), std::forward<ValT>(value));
+            // result is std::pair<value_type*, bool>, where the bool indicates if a new value was inserted
+            auto result = object_vt::insert_or_assign(data.value_object, std::forward<KeyT>(key), std::forward<ValT>(value));
             // return a reference to the inserted value
+            items_modified = true;
             return result.first->second;
         }
         JXC_ASSERTF(type.data == ValueType::Object, "Cannot use operator[]() on {} type (requires Object)", value_type_to_string(type.data));
@@ -1603,6 +2744,16 @@ public:
     Value& insert_or_assign(const Value& key, const Value& value) { return insert_or_assign_internal(key, value); }
     Value& insert_or_assign(const Value& key, Value&& value) { return insert_or_assign_internal(key, std::move(value)); }
 
+    /// Same as insert_or_assign(), but doesn't return a reference to the value, so an arena-allocated object can keep skipping
+    /// destructors for its keys and values (see ValueArena)
+    inline void set_key(Value&& key, Value&& value)
+    {
+        JXC_ASSERTF(type.data == ValueType::Object, "Cannot use set_key() on {} type (requires Object)", value_type_to_string(type.data));
+        auto result = object_vt::insert_or_assign(data.value_object, std::move(key), std::move(value));
+        note_item_added(result.first->first);
+        note_item_added(result.first->second);
+    }
+
     template<typename Lambda>
     void for_each_key(Lambda&& callback) const
     {
@@ -1631,7 +2782,7 @@ public:
 
     inline bool is_valid_index(int64_t idx) const
     {
-        return type.data == ValueType::Array && data.value_array != nullptr && idx >= 0 && static_cast<size_t>(idx) < data.value_array->size();
+        return type.data == ValueType::Array && idx >= 0 && static_cast<size_t>(idx) < size();
     }
 
     inline bool contains(const Value& key) const
@@ -1647,62 +2798,135 @@ public:
         {
             return false;
         }
-        auto iter = data.value_object->find(std::forward<T>(key));
-        if (iter != data.value_object->end())
+        if (object_vt::value_type* pair = data.value_object->find(std::forward<T>(key)))
         {
-            data.value_object->erase(iter);
+            data.value_object->erase(pair);
             return true;
         }
         return false;
     }
 
+    // Calls callback(const Value&) for each array item. Items of packed arrays are passed as temporary Values, so this doesn't expand them.
+    template<typename Lambda>
+    void for_each_item(Lambda&& callback) const
+    {
+        JXC_ASSERT(type.data == ValueType::Array);
+        if (data.value_array == nullptr)
+        {
+            return;
+        }
+
+        switch (type.get_array_storage())
+        {
+        case ArrayStorageType::PackedFloat:
+            for (float_vt item : *data.value_packed_float_array)
+            {
+                callback(Value(item));
+            }
+            break;
+        case ArrayStorageType::PackedSignedInteger:
+            for (signed_integer_vt item : *data.value_packed_signed_integer_array)
+            {
+                callback(Value(item));
+            }
+            break;
+        default:
+            for (const Value& item : *data.value_array)
+            {
+                callback(item);
+            }
+            break;
+        }
+    }
+
+    // Numbers that match a packed array's type are added without expanding it
     inline void push_back(const Value& rhs)
     {
         JXC_ASSERT(type.data == ValueType::Array);
-        as_array_unchecked_auto_init().push_back(rhs);
+        if (!is_packed_array() || !try_push_back_packed(rhs))
+        {
+            expand_packed_array();
+            note_item_added(array_vt::emplace_back(data.value_array, rhs));
+        }
     }
 
     inline void push_back(Value&& rhs)
     {
         JXC_ASSERT(type.data == ValueType::Array);
-        as_array_unchecked_auto_init().push_back(std::move(rhs));
+        if (!is_packed_array() || !try_push_back_packed(rhs))
+        {
+            expand_packed_array();
+            note_item_added(array_vt::emplace_back(data.value_array, std::move(rhs)));
+        }
     }
 
     template<typename... TArgs>
     inline Value& emplace_back(const TArgs&... args)
     {
         JXC_ASSERT(type.data == ValueType::Array);
-        return as_array_unchecked_auto_init().emplace_back(args...);
+        expand_packed_array();
+        items_modified = true;
+        return array_vt::emplace_back(data.value_array, args...);
     }
 
     inline Value& front()
     {
-        JXC_ASSERT(type.data == ValueType::Array && data.value_array != nullptr && data.value_array->size() > 0);
+        JXC_ASSERT(type.data == ValueType::Array && size() > 0);
+        expand_packed_array();
+        items_modified = true;
         return data.value_array->front();
     }
 
     inline const Value& front() const
     {
-        JXC_ASSERT(type.data == ValueType::Array && data.value_array != nullptr && data.value_array->size() > 0);
-        return data.value_array->front();
+        JXC_ASSERT(type.data == ValueType::Array && size() > 0);
+        return get_array_for_const_access()->front();
     }
 
     inline Value& back()
     {
-        JXC_ASSERT(type.data == ValueType::Array && data.value_array != nullptr && data.value_array->size() > 0);
+        JXC_ASSERT(type.data == ValueType::Array && size() > 0);
+        expand_packed_array();
+        items_modified = true;
         return data.value_array->back();
     }
 
     inline const Value& back() const
     {
-        JXC_ASSERT(type.data == ValueType::Array && data.value_array != nullptr && data.value_array->size() > 0);
-        return data.value_array->back();
+        JXC_ASSERT(type.data == ValueType::Array && size() > 0);
+        return get_array_for_const_access()->back();
     }
 
     inline void resize(size_t new_array_size)
     {
         JXC_ASSERT(type.data == ValueType::Array);
-        as_array_unchecked_auto_init().resize(new_array_size);
+        expand_packed_array();
+        array_vt::resize(data.value_array, new_array_size);
+    }
+
+    // Reserves space for array items or object key/value pairs. If the array or object has no storage yet, it's allocated from memory.
+    inline void reserve(size_t capacity, const detail::ValueMemory& memory = detail::ValueMemory())
+    {
+        if (type.data == ValueType::Array)
+        {
+            switch (type.get_array_storage())
+            {
+            case ArrayStorageType::PackedFloat:
+                packed_float_array_vt::reserve(data.value_packed_float_array, capacity, memory);
+                break;
+            case ArrayStorageType::PackedSignedInteger:
+                packed_signed_integer_array_vt::reserve(data.value_packed_signed_integer_array, capacity, memory);
+                break;
+            default:
+                array_vt::reserve(data.value_array, capacity, memory);
+                break;
+            }
+        }
+        else
+        {
+            JXC_ASSERTF(type.data == ValueType::Object, "Cannot use reserve() on {} type (requires Array or Object)", value_type_to_string(type.data));
+            object_vt::reserve(data.value_object, capacity, memory);
+        }
     }
 
     uint64_t hash() const;
@@ -0,0 +1,528 @@
+#include "jxc_cpp/jxc_batch.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+
+size_t detail::get_num_worker_threads(size_t requested_num_threads, size_t num_items)
+{
+    const size_t num_threads = (requested_num_threads > 0) ? requested_num_threads : static_cast<size_t>(std::thread::hardware_concurrency());
+    return std::clamp<size_t>(num_threads, 1, std::max<size_t>(num_items, 1));
+}
+
+
+namespace
+{
+
+// The range of items a worker hasn't started yet. Both the owner and other workers take items from the front with fetch_add,
+// so no locks are needed, and taking an item past the end just means the range is empty.
+struct alignas(64) WorkerRange
+{
+    std::atomic<size_t> next_item = 0;
+    size_t end_item = 0;
+
+    inline bool take(size_t& out_item)
+    {
+        if (next_item.load(std::memory_order_relaxed) >= end_item)
+        {
+            return false;
+        }
+        out_item = next_item.fetch_add(1, std::memory_order_relaxed);
+        return out_item < end_item;
+    }
+};
+
+} // namespace
+
+
+struct WorkerPool::State
+{
+    size_t num_workers = 1;
+    std::vector<std::thread> threads;
+
+    // the current job, published under the mutex
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    uint64_t job_id = 0;
+    size_t num_threads_running = 0;
+    bool shutting_down = false;
+    const std::function<void(size_t worker_idx, size_t item_idx)>* func = nullptr;
+    size_t num_active_workers = 0;
+    std::vector<WorkerRange> ranges;
+
+    std::atomic<bool> stopped = false;
+    std::exception_ptr first_exception;
+    std::mutex exception_mutex;
+
+    explicit State(size_t num_workers)
+        : num_workers(num_workers)
+        , ranges(num_workers)
+    {
+    }
+
+    void run_worker(size_t worker_idx)
+    {
+        try
+        {
+            size_t item_idx = 0;
+            // own items first, then steal from the other workers in order, starting with the next one
+            for (size_t i = 0; i < num_active_workers && !stopped.load(std::memory_order_relaxed); i++)
+            {
+                WorkerRange& range = ranges[(worker_idx + i) % num_active_workers];
+                while (!stopped.load(std::memory_order_relaxed) && range.take(item_idx))
+                {
+                    (*func)(worker_idx, item_idx);
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(exception_mutex);
+            if (!first_exception)
+            {
+                first_exception = std::current_exception();
+            }
+            stopped = true;
+        }
+    }
+
+    void thread_main(size_t worker_idx)
+    {
+        uint64_t last_job_id = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            job_ready.wait(lock, [&]() { return shutting_down || job_id != last_job_id; });
+            if (shutting_down)
+            {
+                return;
+            }
+            last_job_id = job_id;
+
+            lock.unlock();
+            if (worker_idx < num_active_workers)
+            {
+                run_worker(worker_idx);
+            }
+            lock.lock();
+
+            if (--num_threads_running == 0)
+            {
+                job_done.notify_one();
+            }
+        }
+    }
+};
+
+
+WorkerPool::WorkerPool(size_t num_workers)
+    : state(std::make_unique<State>(detail::get_num_worker_threads(num_workers, std::numeric_limits<size_t>::max())))
+{
+    // the calling thread is worker zero
+    state->threads.reserve(state->num_workers - 1);
+    for (size_t i = 1; i < state->num_workers; i++)
+    {
+        state->threads.emplace_back([this, i]() { state->thread_main(i); });
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->shutting_down = true;
+    }
+    state->job_ready.notify_all();
+    for (auto& thread : state->threads)
+    {
+        thread.join();
+    }
+}
+
+
+size_t WorkerPool::get_num_workers() const
+{
+    return state->num_workers;
+}
+
+
+void WorkerPool::run(size_t num_items, const std::function<void(size_t worker_idx, size_t item_idx)>& func)
+{
+    const size_t num_active_workers = std::clamp<size_t>(state->num_workers, 1, std::max<size_t>(num_items, 1));
+    if (num_active_workers == 1)
+    {
+        for (size_t i = 0; i < num_items; i++)
+        {
+            func(0, i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->func = &func;
+        state->num_active_workers = num_active_workers;
+        for (size_t i = 0; i < num_active_workers; i++)
+        {
+            state->ranges[i].next_item = num_items * i / num_active_workers;
+            state->ranges[i].end_item = num_items * (i + 1) / num_active_workers;
+        }
+        state->stopped = false;
+        state->first_exception = nullptr;
+        state->num_threads_running = state->threads.size();
+        ++state->job_id;
+    }
+    state->job_ready.notify_all();
+
+    state->run_worker(0);
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->job_done.wait(lock, [this]() { return state->num_threads_running == 0; });
+        state->func = nullptr;
+    }
+
+    if (state->first_exception)
+    {
+        std::rethrow_exception(std::exchange(state->first_exception, nullptr));
+    }
+}
+
+
+// Parser state that's reused for every document a worker parses
+struct BatchParser::Worker
+{
+    JumpParser parser;
+    ErrorInfo parse_error;
+    detail::ValueParser value_parser;
+    bool try_return_view = false;
+
+    // copy of the current document, if it isn't followed by a null byte
+    std::string scratch;
+
+    explicit Worker(bool try_return_view)
+        : value_parser(parser, parse_error, try_return_view)
+        , try_return_view(try_return_view)
+    {
+    }
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+
+    Value parse(std::string_view document, ErrorInfo& out_error)
+    {
+        // the scratch copy gets overwritten by the next document, so Values parsed from it can't keep views into it
+        const std::string_view parse_buffer = detail::get_null_terminated_buffer(document, scratch);
+        value_parser.try_return_view = try_return_view && parse_buffer.data() == document.data();
+        parser.reset(parse_buffer);
+        parse_error = ErrorInfo{};
+
+        Value result = parser.next() ? value_parser.parse(parser.value()) : Value(default_invalid);
+
+        // unlike jxc::parse, report errors from the parser as well
+        if (!parse_error.is_err && parser.has_error())
+        {
+            parse_error = parser.get_error();
+        }
+
+        if (parse_error.is_err)
+        {
+            out_error = std::move(parse_error);
+            out_error.get_line_and_col_from_buffer(document);
+            return default_invalid;
+        }
+        return result;
+    }
+
+    // Parses a record found by find_line_records(). Blank and comment-only records leave out_value empty.
+    // Records are always followed by a line break or the end of the buffer, so they're parsed in place.
+    bool parse_record(std::string_view record, std::optional<Value>& out_value)
+    {
+        value_parser.try_return_view = try_return_view;
+        parser.reset(record);
+        parse_error = ErrorInfo{};
+
+        if (parser.next())
+        {
+            out_value = value_parser.parse(parser.value());
+            const size_t value_end_idx = parser.value().token.end_idx;
+            if (!parse_error.is_err && !parser.has_error() && parser.next())
+            {
+                // records are split at every line break outside of a value, so this is always missing its line break
+                const Element& ele = parser.value();
+                const size_t next_start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+                detail::check_line_separator(record, value_end_idx, next_start_idx, parse_error);
+            }
+        }
+        else if (!parser.has_error())
+        {
+            // The parser ignores an annotation at the end of the buffer, but here that means the value is on the next line.
+            // Blank records can only be one line long, so anything other than a comment fails the record.
+            const size_t content_idx = record.find_first_not_of(" \t\r\n");
+            if (content_idx != std::string_view::npos && record[content_idx] != '#')
+            {
+                return false;
+            }
+        }
+
+        if (!parse_error.is_err && parser.has_error())
+        {
+            parse_error = parser.get_error();
+        }
+
+        return !parse_error.is_err;
+    }
+};
+
+
+BatchParser::BatchParser(const ParseManySettings& settings)
+    : pool(settings.num_threads)
+    , try_return_view(settings.try_return_view)
+{
+    workers.reserve(pool.get_num_workers());
+    for (size_t i = 0; i < pool.get_num_workers(); i++)
+    {
+        workers.push_back(std::make_unique<Worker>(settings.try_return_view));
+    }
+}
+
+
+BatchParser::~BatchParser()
+{
+}
+
+
+std::vector<Value> BatchParser::parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors)
+{
+    std::vector<Value> results(documents.size());
+    out_errors.assign(documents.size(), ErrorInfo{});
+
+    pool.run(documents.size(), [&](size_t worker_idx, size_t doc_idx)
+    {
+        results[doc_idx] = workers[worker_idx]->parse(documents[doc_idx], out_errors[doc_idx]);
+    });
+
+    return results;
+}
+
+
+std::vector<Value> parse_many(std::span<const std::string_view> documents, std::vector<ErrorInfo>& out_errors, const ParseManySettings& settings)
+{
+    ParseManySettings batch_settings = settings;
+    batch_settings.num_threads = detail::get_num_worker_threads(settings.num_threads, documents.size());
+    return BatchParser(batch_settings).parse_many(documents, out_errors);
+}
+
+
+bool detail::check_line_separator(std::string_view buffer, size_t prev_document_end_idx, size_t document_start_idx, ErrorInfo& out_error)
+{
+    if (prev_document_end_idx == invalid_idx || prev_document_end_idx >= document_start_idx
+        || buffer.substr(prev_document_end_idx, document_start_idx - prev_document_end_idx).find('\n') != std::string_view::npos)
+    {
+        return true;
+    }
+    out_error = ErrorInfo("Expected a line break between documents", prev_document_end_idx, document_start_idx);
+    return false;
+}
+
+
+bool detail::find_line_records(std::string_view buffer, std::vector<std::pair<size_t, size_t>>& out_records)
+{
+    out_records.clear();
+
+    StructuralIndex index;
+    if (!index.build(buffer) || !index.is_complete())
+    {
+        return false;
+    }
+
+    const uint32_t* tape = index.data();
+    const size_t tape_size = index.size();
+    size_t depth = 0;
+    size_t record_start_idx = 0;
+    for (size_t i = 0; i < tape_size; i++)
+    {
+        if (StructuralIndex::entry_is_region_start(tape[i]))
+        {
+            // skip to the region's end, which is the line break that ends a comment
+            ++i;
+            JXC_DEBUG_ASSERT(i < tape_size);
+        }
+
+        const size_t offset = static_cast<size_t>(StructuralIndex::entry_offset(tape[i]));
+        if (offset >= buffer.size())
+        {
+            continue;
+        }
+
+        switch (buffer[offset])
+        {
+        case '[':
+        case '{':
+        case '(':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+        case ')':
+            if (depth == 0)
+            {
+                return false;
+            }
+            --depth;
+            break;
+        case '\n':
+            if (depth == 0)
+            {
+                out_records.push_back(std::make_pair(record_start_idx, offset));
+                record_start_idx = offset + 1;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (depth != 0)
+    {
+        return false;
+    }
+
+    if (record_start_idx < buffer.size())
+    {
+        out_records.push_back(std::make_pair(record_start_idx, buffer.size()));
+    }
+    return true;
+}
+
+
+LinesReader::LinesReader(std::string_view buffer, bool try_return_view)
+    : buffer(buffer)
+    , parser(buffer)
+    , value_parser(parser, error, try_return_view)
+{
+}
+
+
+bool LinesReader::next(Value& out_value)
+{
+    if (error.is_err || !parser.next())
+    {
+        if (!error.is_err && parser.has_error())
+        {
+            error = parser.get_error();
+            error.get_line_and_col_from_buffer(buffer);
+        }
+        return false;
+    }
+
+    auto set_error = [this](ErrorInfo&& err)
+    {
+        error = std::move(err);
+        error.get_line_and_col_from_buffer(buffer);
+        return false;
+    };
+
+    const Element& ele = parser.value();
+    const size_t start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+    ErrorInfo separator_error;
+    if (!detail::check_line_separator(buffer, prev_document_end_idx, start_idx, separator_error))
+    {
+        return set_error(std::move(separator_error));
+    }
+
+    out_value = value_parser.parse(ele);
+    if (error.is_err)
+    {
+        return set_error(std::move(error));
+    }
+    else if (parser.has_error())
+    {
+        return set_error(ErrorInfo(parser.get_error()));
+    }
+    else if (!parser.is_document_end())
+    {
+        return set_error(ErrorInfo("Unexpected end of stream", start_idx, buffer.size()));
+    }
+
+    prev_document_end_idx = parser.value().token.end_idx;
+    ++num_documents;
+    return true;
+}
+
+
+std::vector<Value> BatchParser::parse_lines(std::string_view buffer, ErrorInfo& out_error)
+{
+    auto read_lines_serial = [&]()
+    {
+        std::vector<Value> result;
+        LinesReader reader(buffer, try_return_view);
+        Value value;
+        while (reader.next(value))
+        {
+            result.push_back(std::move(value));
+        }
+        if (reader.has_error())
+        {
+            out_error = reader.get_error();
+            result.clear();
+        }
+        return result;
+    };
+
+    // indexing the records is only worth it if they can be parsed in parallel
+    std::vector<std::pair<size_t, size_t>> records;
+    if (pool.get_num_workers() == 1 || !detail::find_line_records(buffer, records))
+    {
+        return read_lines_serial();
+    }
+
+    std::vector<std::optional<Value>> record_values(records.size());
+    std::vector<uint8_t> record_failed(records.size(), 0);
+
+    pool.run(records.size(), [&](size_t worker_idx, size_t record_idx)
+    {
+        const auto [start_idx, end_idx] = records[record_idx];
+        Worker& worker = *workers[worker_idx];
+        if (!worker.parse_record(buffer.substr(start_idx, end_idx - start_idx), record_values[record_idx]))
+        {
+            record_failed[record_idx] = 1;
+        }
+    });
+
+    std::vector<Value> result;
+    result.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (record_failed[i])
+        {
+            // get the error from the serial reader, because a record that fails might just be a value split in the wrong place
+            return read_lines_serial();
+        }
+        else if (record_values[i].has_value())
+        {
+            result.push_back(std::move(*record_values[i]));
+        }
+    }
+    return result;
+}
+
+
+std::vector<Value> parse_lines(std::string_view buffer, ErrorInfo& out_error, const ParseManySettings& settings)
+{
+    // the number of records isn't known until the buffer is indexed, so WorkerPool::run clamps the worker count to it
+    return BatchParser(settings).parse_lines(buffer, out_error);
+}
+
+
+JXC_END_NAMESPACE(jxc)
@@ -1,4 +1,7 @@
 #include "jxc_cpp/jxc_document.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -65,10 +68,27 @@ void DocumentSerializer::serialize_bytes(Serializer& doc, const Value& val)
 void DocumentSerializer::serialize_array(Serializer& doc, const Value& val)
 {
     doc.annotation(val.get_annotation_source()).array_begin();
-    const size_t array_sz = val.size();
-    for (size_t i = 0; i < array_sz; i++)
+    if (val.is_packed_float_array())
     {
-        serialize_value(doc, val.at(i));
+        for (double item : val.as_span<double>())
+        {
+            doc.value_float(item);
+        }
+    }
+    else if (val.is_packed_signed_integer_array())
+    {
+        for (int64_t item : val.as_span<int64_t>())
+        {
+            doc.value_int(item);
+        }
+    }
+    else
+    {
+        const size_t array_sz = val.size();
+        for (size_t i = 0; i < array_sz; i++)
+        {
+            serialize_value(doc, val.at(i));
+        }
     }
     doc.array_end();
 }
@@ -134,11 +154,11 @@ void DocumentSerializer::serialize_value(Serializer& doc, const Value& val)
 
 
 
-Value detail::ValueParser::parse_number(const Token& tok, TokenView annotation)
+Value detail::ValueParser::make_number(const Token& tok, ErrorInfo& out_error)
 {
     JXC_DEBUG_ASSERT(tok.type == TokenType::Number);
     util::NumberTokenSplitResult number;
-    if (!util::split_number_token_value(tok, number, parse_error))
+    if (!util::split_number_token_value(tok, number, out_error))
     {
         return default_invalid;
     }
@@ -147,25 +167,85 @@ Value detail::ValueParser::parse_number(const Token& tok, TokenView annotation)
     {
         // float
         double number_value = 0.0;
-        if (!util::parse_number(tok, number_value, number, parse_error))
+        if (!util::parse_number(tok, number_value, number, out_error))
         {
             return default_invalid;
         }
-        return make_value_internal(number_value, number.suffix, annotation);
+        return Value(number_value, number.suffix);
     }
     else
     {
         // int
         int64_t number_value = 0;
-        if (!util::parse_number(tok, number_value, number, parse_error))
+        if (!util::parse_number(tok, number_value, number, out_error))
         {
             return default_invalid;
         }
-        return make_value_internal(number_value, number.suffix, annotation);
+        return Value(number_value, number.suffix);
+    }
+}
+
+
+// Lazy numbers are parsed when they're read, where errors can't be reported, so they must always parse successfully.
+// Floats always do. Integers with an exponent, or with too many digits to be sure they fit in an int64, are parsed eagerly.
+static bool can_parse_number_lazily(const util::NumberTokenSplitResult& number)
+{
+    if (number.is_floating_point())
+    {
+        return true;
+    }
+    else if (number.exponent != 0)
+    {
+        return false;
+    }
+
+    const size_t num_digits = number.value.size();
+    const char prefix_char = (number.prefix.size() == 2) ? number.prefix[1] : '\0';
+    switch (prefix_char)
+    {
+    case 'x':
+    case 'X':
+        return num_digits * 4 <= 63;
+    case 'o':
+    case 'O':
+        return num_digits * 3 <= 63;
+    case 'b':
+    case 'B':
+        return num_digits <= 63;
+    default:
+        // 18 decimal digits always fit
+        return num_digits <= 18;
     }
 }
 
 
+Value detail::ValueParser::parse_number(const Token& tok, TokenView annotation)
+{
+    Value result = default_invalid;
+    util::NumberTokenSplitResult number;
+    if (lazy_scalars && tok.value.is_view() && util::split_number_token_value(tok, number, parse_error) && can_parse_number_lazily(number))
+    {
+        // splitting the token gives us the number's type without parsing its digits
+        const ValueType number_type = number.is_integer() ? ValueType::SignedInteger : ValueType::Float;
+        result = Value(number_type, tok.value.as_view(), tok.start_idx, Value::AsLazy{});
+    }
+    else
+    {
+        result = make_number(tok, parse_error);
+        if (result.is_invalid())
+        {
+            return result;
+        }
+    }
+
+    if (annotation)
+    {
+        result.set_annotation(annotation, annotations_as_view, memory);
+    }
+    return result;
+}
+
+
 Value detail::ValueParser::parse_bool(const Token& tok, TokenView annotation)
 {
     switch (tok.type)
@@ -189,12 +269,12 @@ Value detail::ValueParser::parse_null(const Token& tok, TokenView annotation)
 }
 
 
-Value detail::ValueParser::parse_string(const Token& tok, TokenView annotation)
+Value detail::ValueParser::make_string(const Token& tok, bool try_return_view, ErrorInfo& out_error, const ValueMemory& memory)
 {
     JXC_DEBUG_ASSERT(tok.type == TokenType::String);
     std::string_view string_value;
     bool is_raw_string = false;
-    if (!util::string_token_to_value(tok, string_value, is_raw_string, parse_error))
+    if (!util::string_token_to_value(tok, string_value, is_raw_string, out_error))
     {
         return default_invalid;
     }
@@ -204,33 +284,21 @@ Value detail::ValueParser::parse_string(const Token& tok, TokenView annotation)
     {
         static constexpr size_t inline_size_instead_of_view = 8;
         static_assert(inline_size_instead_of_view <= Value::max_inline_string_len, "inline_size must fit into the inline buffer");
-        Value result = default_invalid;
         if (string_value.size() <= inline_size_instead_of_view)
         {
-            result = Value(string_value, Value::AsInline{});
+            return Value(string_value, Value::AsInline{});
         }
         else if (try_return_view)
         {
-            result = Value(string_value, Value::AsView{});
+            return Value(string_value, Value::AsView{});
         }
         else
         {
-            result = Value(string_value, Value::AsOwned{});
-        }
-
-        if (annotation)
-        {
-            result.set_annotation(annotation, try_return_view);
+            return Value(string_value, Value::AsOwned{}, memory);
         }
-
-        return result;
     }
 
     Value result(ValueType::String);
-    if (annotation)
-    {
-        result.set_annotation(annotation, try_return_view);
-    }
 
     const size_t req_buf_size = util::get_string_required_buffer_size(string_value, is_raw_string);
     if (req_buf_size == 0)
@@ -238,13 +306,13 @@ Value detail::ValueParser::parse_string(const Token& tok, TokenView annotation)
         return result;
     }
 
-    result.resize_string_buffer(req_buf_size);
+    result.resize_string_buffer(req_buf_size, memory);
     char* buf_ptr = const_cast<char*>(result.as_string().data());
 
     // string is not raw and has escape chars, so we need to parse the escape characters
     JXC_DEBUG_ASSERT(!is_raw_string || util::string_has_escape_chars(string_value));
     size_t num_chars_written = 0;
-    if (!util::parse_string_escapes_to_buffer(string_value, tok.start_idx, tok.end_idx, buf_ptr, req_buf_size, num_chars_written, parse_error))
+    if (!util::parse_string_escapes_to_buffer(string_value, tok.start_idx, tok.end_idx, buf_ptr, req_buf_size, num_chars_written, out_error))
     {
         return default_invalid;
     }
@@ -260,6 +328,39 @@ Value detail::ValueParser::parse_string(const Token& tok, TokenView annotation)
 }
 
 
+Value detail::ValueParser::parse_string(const Token& tok, TokenView annotation)
+{
+    Value result = default_invalid;
+    if (lazy_scalars && tok.value.is_view() && tok.tag.size() == 0)
+    {
+        // Heredoc strings need their tag to parse, so those are never lazy.
+        // Lazy strings are parsed when they're read, where errors can't be reported, so their escapes are checked now.
+        std::string_view string_value;
+        bool is_raw_string = false;
+        if (!util::string_token_to_value(tok, string_value, is_raw_string, parse_error)
+            || (!is_raw_string && !util::validate_string_escapes(string_value, tok.start_idx, tok.end_idx, parse_error)))
+        {
+            return default_invalid;
+        }
+        result = Value(ValueType::String, tok.value.as_view(), tok.start_idx, Value::AsLazy{});
+    }
+    else
+    {
+        result = make_string(tok, try_return_view, parse_error, memory);
+        if (result.is_invalid())
+        {
+            return result;
+        }
+    }
+
+    if (annotation)
+    {
+        result.set_annotation(annotation, annotations_as_view, memory);
+    }
+    return result;
+}
+
+
 Value detail::ValueParser::parse_bytes(const Token& tok, TokenView annotation)
 {
     JXC_DEBUG_ASSERT(tok.type == TokenType::ByteString);
@@ -276,6 +377,7 @@ Value detail::ValueParser::parse_array(TokenView annotation)
 {
     JXC_DEBUG_ASSERT(parser.value().type == ElementType::BeginArray);
     Value result = make_value_internal(default_array, annotation);
+    const size_t first_item_idx = item_stack.size();
     while (parser.next())
     {
         const Element& ele = parser.value();
@@ -285,9 +387,45 @@ Value detail::ValueParser::parse_array(TokenView annotation)
         }
         else
         {
-            result.push_back(parse_value_internal(parser.value()));
+            item_stack.push_back(parse_value_internal(parser.value()));
         }
     }
+
+    const size_t num_items = item_stack.size() - first_item_idx;
+    if (num_items > 0)
+    {
+        // lazy numbers would have to be parsed to pack them
+        if (pack_numeric_arrays && !lazy_scalars)
+        {
+            // pack arrays of plain floats or plain integers
+            const ValueType item_type = item_stack[first_item_idx].get_type();
+            bool can_pack = item_type == ValueType::Float || item_type == ValueType::SignedInteger;
+            for (size_t i = first_item_idx; can_pack && i < item_stack.size(); i++)
+            {
+                const Value& item = item_stack[i];
+                can_pack = item.get_type() == item_type && !item.has_annotation() && item.get_number_suffix().size() == 0;
+            }
+
+            if (can_pack)
+            {
+                if (item_type == ValueType::Float)
+                {
+                    result.init_packed_array<double>(num_items, memory);
+                }
+                else
+                {
+                    result.init_packed_array<int64_t>(num_items, memory);
+                }
+            }
+        }
+
+        result.reserve(num_items, memory);
+        for (size_t i = first_item_idx; i < item_stack.size(); i++)
+        {
+            result.push_back(std::move(item_stack[i]));
+        }
+        item_stack.resize(first_item_idx);
+    }
     return result;
 }
 
@@ -339,6 +477,7 @@ Value detail::ValueParser::parse_expression_as_array(TokenView annotation)
 {
     JXC_DEBUG_ASSERT(parser.value().type == ElementType::BeginExpression);
     Value result = make_value_internal(default_array, annotation);
+    const size_t first_item_idx = item_stack.size();
 
     while (parser.next())
     {
@@ -351,23 +490,23 @@ Value detail::ValueParser::parse_expression_as_array(TokenView annotation)
         switch (ele.type)
         {
         case ElementType::Null:
-            result.push_back(default_null);
+            item_stack.push_back(default_null);
             break;
         case ElementType::Bool:
             JXC_DEBUG_ASSERT(ele.token.type == TokenType::True || ele.token.type == TokenType::False);
-            result.push_back((ele.token.type == TokenType::True) ? Value(true) : Value(false));
+            item_stack.push_back((ele.token.type == TokenType::True) ? Value(true) : Value(false));
             break;
         case ElementType::Number:
-            result.push_back(parse_number(ele.token, TokenView{}));
+            item_stack.push_back(parse_number(ele.token, TokenView{}));
             break;
         case ElementType::String:
-            result.push_back(parse_string(ele.token, TokenView{}));
+            item_stack.push_back(parse_string(ele.token, TokenView{}));
             break;
         case ElementType::Bytes:
-            result.push_back(parse_bytes(ele.token, TokenView{}));
+            item_stack.push_back(parse_bytes(ele.token, TokenView{}));
             break;
         case ElementType::ExpressionToken:
-            result.push_back(ele.token.value.as_view());
+            item_stack.push_back(Value(ele.token.value.as_view(), memory));
             break;
         case ElementType::Comment:
             // ignore comments for this mode
@@ -375,10 +514,24 @@ Value detail::ValueParser::parse_expression_as_array(TokenView annotation)
         default:
             parse_error = ErrorInfo(jxc::format("Invalid element for expression value {}", element_type_to_string(ele.type)),
                 ele.token.start_idx, ele.token.end_idx);
+            item_stack.resize(first_item_idx);
             return default_invalid;
         }
     }
 
+    const size_t num_items = item_stack.size() - first_item_idx;
+    if (num_items > 0)
+    {
+        result.reserve(num_items, memory);
+        for (size_t i = first_item_idx; i < item_stack.size(); i++)
+        {
+            // expression items don't go through parse_value_internal, so record them here
+            record_value_stats(item_stack[i]);
+            result.push_back(std::move(item_stack[i]));
+        }
+        item_stack.resize(first_item_idx);
+    }
+
     return result;
 }
 
@@ -388,7 +541,7 @@ Value detail::ValueParser::parse_key(const Token& tok)
     switch (tok.type)
     {
     case TokenType::Identifier:
-        return try_return_view ? Value(tok.value, Value::AsView{}) : Value(tok.value);
+        return try_return_view ? Value(tok.value, Value::AsView{}) : Value(tok.value, memory);
     case TokenType::True:
         return Value(true);
     case TokenType::False:
@@ -432,7 +585,7 @@ Value detail::ValueParser::parse_key(const Token& tok)
         {
             return default_invalid;
         }
-        return Value(bytes_key_value);
+        return Value(bytes_key_value, memory);
     }
     default:
         break;
@@ -447,10 +600,12 @@ Value detail::ValueParser::parse_object(TokenView annotation)
 {
     JXC_DEBUG_ASSERT(parser.value().type == ElementType::BeginObject);
     Value result = make_value_internal(default_object, annotation);
+    const size_t first_item_idx = item_stack.size();
     while (true)
     {
         if (!parser.next())
         {
+            item_stack.resize(first_item_idx);
             return default_invalid;
         }
         const Element& key_ele = parser.value();
@@ -464,15 +619,31 @@ Value detail::ValueParser::parse_object(TokenView annotation)
         if (key.is_invalid())
         {
             JXC_DEBUG_ASSERT(parse_error.is_err);
+            item_stack.resize(first_item_idx);
             return default_invalid;
         }
+        record_value_stats(key);
 
         if (!parser.next())
         {
+            item_stack.resize(first_item_idx);
             return default_invalid;
         }
 
-        result.insert_or_assign(std::move(key), parse_value_internal(parser.value()));
+        // keys and values alternate on the stack
+        item_stack.push_back(std::move(key));
+        item_stack.push_back(parse_value_internal(parser.value()));
+    }
+
+    const size_t num_pairs = (item_stack.size() - first_item_idx) / 2;
+    if (num_pairs > 0)
+    {
+        result.reserve(num_pairs, memory);
+        for (size_t i = first_item_idx; i < item_stack.size(); i += 2)
+        {
+            result.set_key(std::move(item_stack[i]), std::move(item_stack[i + 1]));
+        }
+        item_stack.resize(first_item_idx);
     }
     return result;
 }
@@ -504,11 +675,56 @@ Value detail::ValueParser::parse(const Element& ele)
 
 
 
-Document::Document(std::string_view in_buffer)
-    : buffer(std::string(in_buffer))
+Document::Document(std::shared_ptr<const void>&& in_buffer_owner, std::string_view in_buffer)
+    : storage(std::make_shared<Storage>())
+    , buffer(in_buffer)
     , parser(buffer)
 {
-    annotation_cache.emplace(std::string(), std::vector<Token>());
+    storage->buffer_owner = std::move(in_buffer_owner);
+    storage->annotation_cache.emplace(std::string(), std::vector<Token>());
+}
+
+
+Document::Document(std::string_view in_buffer)
+    : Document(std::string(in_buffer))
+{
+}
+
+
+Document::Document(const char* in_buffer)
+    : Document(std::string_view(in_buffer))
+{
+}
+
+
+Document::Document(std::string&& in_buffer)
+    : Document(nullptr, std::string_view{})
+{
+    // Moving the string into a shared_ptr keeps its heap allocation, so the buffer isn't copied
+    // (except for short strings that fit in the small string buffer).
+    auto owned_str = std::make_shared<std::string>(std::move(in_buffer));
+    buffer = *owned_str;
+    parser.reset(buffer);
+    storage->buffer_owner = std::move(owned_str);
+}
+
+
+Document::Document(std::shared_ptr<const char[]> in_buffer, size_t in_buffer_len)
+    : Document(nullptr, std::string_view{ in_buffer.get(), in_buffer_len })
+{
+    storage->buffer_owner = std::move(in_buffer);
+}
+
+
+Document::Document(const char* in_buffer, size_t in_buffer_len, std::function<void(const char*)> deleter)
+    : Document(std::shared_ptr<const char>(in_buffer, std::move(deleter)), std::string_view{ in_buffer, in_buffer_len })
+{
+}
+
+
+Document::Document(const MappedBuffer& in_buffer)
+    : Document(nullptr, in_buffer.get_view())
+{
 }
 
 
@@ -533,6 +749,7 @@ TokenView Document::copy_annotation(TokenView anno)
     FlexString key = anno.source();
     if (key.size() > 0)
     {
+        StringMap<std::vector<Token>>& annotation_cache = storage->annotation_cache;
         auto iter = annotation_cache.find(key);
         if (iter != annotation_cache.end())
         {
@@ -580,11 +797,24 @@ Value Document::parse()
             // then store a view into that owned copy in the value itself.
             return p.parse_value(ele_type, tok, copy_annotation(anno));
         });
+    value_parser.annotations_as_view = true;
+    value_parser.lazy_scalars = lazy_scalars;
+    value_parser.pack_numeric_arrays = pack_numeric_arrays;
+    value_parser.memory = memory;
 
     return value_parser.parse(parser.value());
 }
 
 
+ParsedValue Document::parse_with_keep_alive()
+{
+    ParsedValue result;
+    result.keep_alive = storage;
+    result.value = parse();
+    return result;
+}
+
+
 Value Document::parse_to_owned()
 {
     if (!advance())
@@ -597,13 +827,15 @@ Value Document::parse_to_owned()
         {
             return p.parse_value(ele_type, tok, anno);
         });
+    value_parser.pack_numeric_arrays = pack_numeric_arrays;
+    value_parser.memory = memory;
 
     return value_parser.parse(parser.value());
 }
 
 
 
-Value parse(std::string_view jxc_string, ErrorInfo& out_error, bool try_return_view)
+static Value parse_internal(std::string_view jxc_string, ErrorInfo& out_error, bool try_return_view, const detail::ValueMemory& memory)
 {
     JumpParser parser(jxc_string);
     if (!parser.next())
@@ -616,11 +848,365 @@ Value parse(std::string_view jxc_string, ErrorInfo& out_error, bool try_return_v
         {
             return p.parse_value(ele_type, tok, anno);
         });
-    
+    value_parser.memory = memory;
+
     return value_parser.parse(parser.value());
 }
 
 
+Value parse(std::string_view jxc_string, ErrorInfo& out_error, bool try_return_view)
+{
+    return parse_internal(jxc_string, out_error, try_return_view, detail::ValueMemory());
+}
+
+
+Value parse(std::string_view jxc_string, ErrorInfo& out_error, ValueArena& arena, bool try_return_view)
+{
+    return parse_internal(jxc_string, out_error, try_return_view, arena.get_memory());
+}
+
+
+namespace
+{
+
+// Splits a document into child values that can be parsed independently, parses them on multiple threads, then merges the results.
+class ParallelParser
+{
+    // An array or object that was split up. Each child is either a leaf span (an index into leaves), or another split container
+    // (an index into nodes, with node_flag set).
+    struct SplitNode
+    {
+        Value container;
+        std::vector<Value> keys;
+        std::vector<size_t> children;
+    };
+
+    // The span of a single value (including its annotation) in the buffer
+    struct Leaf
+    {
+        size_t start_idx = 0;
+        size_t end_idx = 0;
+    };
+
+    // A range of consecutive leaves that's parsed by a single thread
+    struct Batch
+    {
+        size_t start_leaf = 0;
+        size_t end_leaf = 0;
+    };
+
+    static constexpr size_t node_flag = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+
+    // don't split containers nested deeper than this, to limit recursion
+    static constexpr size_t max_split_depth = 64;
+
+    std::string_view buffer;
+    size_t num_threads = 0;
+    bool try_return_view = false;
+
+    // containers at least this large are split into their children
+    size_t split_size = 0;
+
+    // leaves are grouped into batches of about this size, so that threads don't need to sync for every tiny value
+    size_t batch_size = 0;
+
+    StructuralIndex index;
+
+    // sorted offsets of the open brackets of all containers that are at least split_size bytes
+    std::vector<size_t> large_containers;
+
+    std::vector<SplitNode> nodes;
+    std::vector<Leaf> leaves;
+    std::vector<Batch> batches;
+    std::vector<Value> leaf_values;
+
+    std::atomic<size_t> next_batch = 0;
+    std::atomic<bool> failed = false;
+
+public:
+    ParallelParser(std::string_view buffer, size_t num_threads, bool try_return_view)
+        : buffer(buffer)
+        , num_threads(num_threads)
+        , try_return_view(try_return_view)
+        , split_size(std::max<size_t>(buffer.size() / (num_threads * 4), 16 * 1024))
+        , batch_size(std::max<size_t>(buffer.size() / (num_threads * 32), 4 * 1024))
+    {
+    }
+
+private:
+    // Matches up brackets using the structural index, which already skips over strings, comments, and raw strings
+    bool find_large_containers()
+    {
+        const uint32_t* tape = index.data();
+        const size_t tape_size = index.size();
+        std::vector<uint32_t> open_stack;
+        for (size_t i = 0; i < tape_size; i++)
+        {
+            if (StructuralIndex::entry_is_region_start(tape[i]))
+            {
+                // skip the region's end offset too
+                ++i;
+                continue;
+            }
+
+            const size_t offset = static_cast<size_t>(StructuralIndex::entry_offset(tape[i]));
+            switch (buffer[offset])
+            {
+            case '[':
+            case '{':
+            case '(':
+                open_stack.push_back(static_cast<uint32_t>(offset));
+                break;
+            case ']':
+            case '}':
+            case ')':
+                if (open_stack.size() == 0)
+                {
+                    return false;
+                }
+                if (offset - open_stack.back() >= split_size)
+                {
+                    large_containers.push_back(open_stack.back());
+                }
+                open_stack.pop_back();
+                break;
+            default:
+                break;
+            }
+        }
+
+        // containers are found in the order they're closed, not opened
+        std::sort(large_containers.begin(), large_containers.end());
+        return open_stack.size() == 0;
+    }
+
+    inline bool is_large_container(size_t open_bracket_idx) const
+    {
+        return std::binary_search(large_containers.begin(), large_containers.end(), open_bracket_idx);
+    }
+
+    // Called with the parser on a BeginArray or BeginObject element. Adds a node for the container, and leaves or nested nodes
+    // for all of its children. Leaves the parser on the container's End element.
+    bool plan_container(JumpParser& parser, detail::ValueParser& key_parser, size_t depth)
+    {
+        const Element& ele = parser.value();
+        const bool is_object = ele.type == ElementType::BeginObject;
+        const size_t node_idx = nodes.size();
+        nodes.emplace_back();
+
+        // always copy the annotation, because the parser's annotation buffer is reused for the next element
+        nodes[node_idx].container = is_object ? Value(default_object) : Value(default_array);
+        if (ele.annotation)
+        {
+            nodes[node_idx].container.set_annotation(ele.annotation, false);
+        }
+
+        while (parser.next())
+        {
+            const Element& child = parser.value();
+            if (child.type == ElementType::EndArray || child.type == ElementType::EndObject)
+            {
+                return true;
+            }
+            else if (child.type == ElementType::Comment)
+            {
+                continue;
+            }
+
+            if (is_object)
+            {
+                Value key = key_parser.parse_key(child.token);
+                if (key.is_invalid() || !parser.next())
+                {
+                    return false;
+                }
+                nodes[node_idx].keys.push_back(std::move(key));
+            }
+
+            const Element& value_ele = parser.value();
+            const size_t value_start_idx = value_ele.annotation ? value_ele.annotation[0].start_idx : value_ele.token.start_idx;
+            switch (value_ele.type)
+            {
+            case ElementType::BeginArray:
+            case ElementType::BeginObject:
+                if (depth < max_split_depth && is_large_container(value_ele.token.start_idx))
+                {
+                    const size_t child_node_idx = nodes.size();
+                    if (!plan_container(parser, key_parser, depth + 1))
+                    {
+                        return false;
+                    }
+                    nodes[node_idx].children.push_back(child_node_idx | node_flag);
+                    continue;
+                }
+                [[fallthrough]];
+            case ElementType::BeginExpression:
+                if (!parser.skip_value())
+                {
+                    return false;
+                }
+                break;
+            default:
+                break;
+            }
+
+            nodes[node_idx].children.push_back(leaves.size());
+            leaves.push_back(Leaf{ value_start_idx, parser.value().token.end_idx });
+        }
+        return false;
+    }
+
+    bool plan()
+    {
+        if (!index.build(buffer) || !index.is_complete() || !find_large_containers())
+        {
+            return false;
+        }
+
+        JumpParser parser(buffer, index);
+        ErrorInfo key_error;
+        detail::ValueParser key_parser(parser, key_error, try_return_view);
+        if (!parser.next())
+        {
+            return false;
+        }
+
+        const Element& root = parser.value();
+        if ((root.type != ElementType::BeginArray && root.type != ElementType::BeginObject) || !is_large_container(root.token.start_idx))
+        {
+            return false;
+        }
+
+        if (!plan_container(parser, key_parser, 0) || parser.has_error())
+        {
+            return false;
+        }
+
+        size_t batch_start = 0;
+        size_t batch_bytes = 0;
+        for (size_t i = 0; i < leaves.size(); i++)
+        {
+            batch_bytes += leaves[i].end_idx - leaves[i].start_idx;
+            if (batch_bytes >= batch_size || i + 1 == leaves.size())
+            {
+                batches.push_back(Batch{ batch_start, i + 1 });
+                batch_start = i + 1;
+                batch_bytes = 0;
+            }
+        }
+        return true;
+    }
+
+    void run_worker()
+    {
+        JumpParser parser;
+        ErrorInfo parse_error;
+        detail::ValueParser value_parser(parser, parse_error, try_return_view);
+        while (!failed.load(std::memory_order_relaxed))
+        {
+            const size_t batch_idx = next_batch.fetch_add(1, std::memory_order_relaxed);
+            if (batch_idx >= batches.size())
+            {
+                break;
+            }
+
+            const Batch& batch = batches[batch_idx];
+            for (size_t i = batch.start_leaf; i < batch.end_leaf; i++)
+            {
+                const Leaf& leaf = leaves[i];
+                parser.reset(buffer.substr(leaf.start_idx, leaf.end_idx - leaf.start_idx));
+                if (!parser.next())
+                {
+                    failed = true;
+                    return;
+                }
+
+                leaf_values[i] = value_parser.parse(parser.value());
+                if (parse_error.is_err || parser.has_error())
+                {
+                    failed = true;
+                    return;
+                }
+            }
+        }
+    }
+
+    Value merge(size_t node_idx)
+    {
+        SplitNode& node = nodes[node_idx];
+        Value result = std::move(node.container);
+        const bool is_object = result.is_object();
+        for (size_t i = 0; i < node.children.size(); i++)
+        {
+            const size_t child = node.children[i];
+            Value child_value = ((child & node_flag) != 0) ? merge(child & ~node_flag) : std::move(leaf_values[child]);
+            if (is_object)
+            {
+                result.set_key(std::move(node.keys[i]), std::move(child_value));
+            }
+            else
+            {
+                result.push_back(std::move(child_value));
+            }
+        }
+        return result;
+    }
+
+public:
+    // Returns false if the buffer has any errors, or if it can't be split up
+    bool parse(Value& out_value)
+    {
+        if (!plan())
+        {
+            return false;
+        }
+
+        leaf_values.resize(leaves.size());
+
+        std::vector<std::thread> threads;
+        const size_t num_extra_threads = std::min(num_threads, batches.size()) - ((batches.size() > 0) ? 1 : 0);
+        threads.reserve(num_extra_threads);
+        for (size_t i = 0; i < num_extra_threads; i++)
+        {
+            threads.emplace_back([this]() { run_worker(); });
+        }
+        run_worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        if (failed)
+        {
+            return false;
+        }
+
+        out_value = merge(0);
+        return true;
+    }
+};
+
+} // namespace
+
+
+Value parse_parallel(std::string_view jxc_string, ErrorInfo& out_error, const ParallelParseSettings& settings)
+{
+    const size_t num_threads = (settings.num_threads > 0) ? settings.num_threads : static_cast<size_t>(std::thread::hardware_concurrency());
+    if (num_threads > 1 && jxc_string.size() >= settings.min_buffer_size)
+    {
+        ParallelParser parallel_parser(jxc_string, num_threads, settings.try_return_view);
+        Value result;
+        if (parallel_parser.parse(result))
+        {
+            return result;
+        }
+    }
+
+    // errors always go through the serial parser, so that they're reported the same way
+    return jxc::parse(jxc_string, out_error, settings.try_return_view);
+}
+
+
 std::string serialize(const Value& val, const SerializerSettings& settings)
 {
     DocumentSerializer ar(settings);
@@ -0,0 +1,413 @@
+#include "jxc_cpp/jxc_query.h"
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+namespace
+{
+
+// Glob-style match where `*` matches any run of chars (including none)
+bool key_pattern_match(std::string_view pattern, std::string_view key)
+{
+    size_t pattern_idx = 0;
+    size_t key_idx = 0;
+    size_t star_idx = std::string_view::npos;
+    size_t star_key_idx = 0;
+    while (key_idx < key.size())
+    {
+        if (pattern_idx < pattern.size() && pattern[pattern_idx] == '*')
+        {
+            star_idx = pattern_idx++;
+            star_key_idx = key_idx;
+        }
+        else if (pattern_idx < pattern.size() && pattern[pattern_idx] == key[key_idx])
+        {
+            ++pattern_idx;
+            ++key_idx;
+        }
+        else if (star_idx != std::string_view::npos)
+        {
+            // backtrack - let the last star consume one more char
+            pattern_idx = star_idx + 1;
+            key_idx = ++star_key_idx;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (pattern_idx < pattern.size() && pattern[pattern_idx] == '*')
+    {
+        ++pattern_idx;
+    }
+    return pattern_idx == pattern.size();
+}
+
+
+class QueryRunner
+{
+    JumpParser& parser;
+    const QueryPath& path;
+    const std::function<bool(Value&&)>& on_match;
+    ErrorInfo& error;
+    detail::ValueParser value_parser;
+    std::string key_buffer;
+
+public:
+    bool stopped = false;
+
+    QueryRunner(JumpParser& parser, const QueryPath& path, const std::function<bool(Value&&)>& on_match, ErrorInfo& out_error)
+        : parser(parser)
+        , path(path)
+        , on_match(on_match)
+        , error(out_error)
+        , value_parser(parser, out_error)
+    {
+    }
+
+private:
+    // Gets the string value of an object key token. String keys are only unescaped if needed.
+    bool get_object_key(const Token& tok, std::string_view& out_key)
+    {
+        switch (tok.type)
+        {
+        case TokenType::Identifier:
+        case TokenType::Number:
+        case TokenType::True:
+        case TokenType::False:
+        case TokenType::Null:
+            out_key = tok.value.as_view();
+            return true;
+        case TokenType::String:
+        {
+            bool is_raw = false;
+            if (!util::string_token_to_value(tok, out_key, is_raw, error))
+            {
+                return false;
+            }
+            if (!is_raw && util::string_has_escape_chars(out_key))
+            {
+                if (!util::parse_string_token(tok, key_buffer, error))
+                {
+                    return false;
+                }
+                out_key = key_buffer;
+            }
+            return true;
+        }
+        default:
+            // bytes keys can never match a path
+            out_key = std::string_view{};
+            return true;
+        }
+    }
+
+public:
+    // Called with the parser on the first element of a value that matches the first seg_idx path segments.
+    // Returns false if there was an error, or if on_match stopped the query.
+    bool visit(size_t seg_idx)
+    {
+        const Element& ele = parser.value();
+        if (seg_idx >= path.size())
+        {
+            Value val = value_parser.parse(ele);
+            if (error.is_err || parser.has_error())
+            {
+                return false;
+            }
+            if (!on_match(std::move(val)))
+            {
+                stopped = true;
+                return false;
+            }
+            return true;
+        }
+
+        const QueryPath::Segment& seg = path[seg_idx];
+        switch (ele.type)
+        {
+        case ElementType::BeginObject:
+            if (!seg.is_key())
+            {
+                return parser.skip_value();
+            }
+            while (parser.next())
+            {
+                const Element& key_ele = parser.value();
+                if (key_ele.type == ElementType::EndObject)
+                {
+                    return true;
+                }
+                else if (key_ele.type == ElementType::Comment)
+                {
+                    continue;
+                }
+
+                std::string_view key;
+                if (!get_object_key(key_ele.token, key))
+                {
+                    return false;
+                }
+
+                if (!seg.matches_key(key))
+                {
+                    if (!parser.skip_value())
+                    {
+                        return false;
+                    }
+                }
+                else if (!parser.next() || !visit(seg_idx + 1))
+                {
+                    return false;
+                }
+            }
+            return false;
+
+        case ElementType::BeginArray:
+        {
+            if (!seg.is_index())
+            {
+                return parser.skip_value();
+            }
+            size_t array_index = 0;
+            while (parser.next())
+            {
+                if (parser.value().type == ElementType::EndArray)
+                {
+                    return true;
+                }
+
+                if (seg.matches_index(array_index))
+                {
+                    if (!visit(seg_idx + 1))
+                    {
+                        return false;
+                    }
+                    // an exact index can only match once, so there's no need to look at the rest of the array
+                    if (seg.type == QueryPath::SegmentType::Index)
+                    {
+                        return parser.skip_to_end_of_container();
+                    }
+                }
+                else if (!parser.skip_value())
+                {
+                    return false;
+                }
+                ++array_index;
+            }
+            return false;
+        }
+
+        case ElementType::BeginExpression:
+            return parser.skip_value();
+
+        default:
+            // scalar values have no children to match
+            return true;
+        }
+    }
+};
+
+} // namespace
+
+
+bool QueryPath::Segment::matches_key(std::string_view object_key) const
+{
+    switch (type)
+    {
+    case SegmentType::Key:
+        return object_key == key;
+    case SegmentType::KeyPattern:
+        return key_pattern_match(key, object_key);
+    case SegmentType::AnyKey:
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+
+// static
+bool QueryPath::compile(std::string_view path, QueryPath& out_path, ErrorInfo& out_error)
+{
+    out_path.source = std::string(path);
+    out_path.segments.clear();
+
+    auto set_error = [&](std::string&& msg, size_t start_idx, size_t end_idx)
+    {
+        out_error = ErrorInfo(jxc::format("Invalid query path {}: {}", detail::debug_string_repr(path), msg), start_idx, end_idx);
+        out_path.segments.clear();
+        return false;
+    };
+
+    size_t idx = 0;
+    bool need_key = false;
+    while (idx < path.size())
+    {
+        const char ch = path[idx];
+        if (ch == '[')
+        {
+            if (need_key)
+            {
+                return set_error("expected key after `.`", idx, idx + 1);
+            }
+
+            const size_t close_idx = path.find(']', idx + 1);
+            if (close_idx == std::string_view::npos)
+            {
+                return set_error("missing `]`", idx, path.size());
+            }
+
+            const std::string_view index_str = path.substr(idx + 1, close_idx - idx - 1);
+            Segment seg;
+            if (index_str == "*")
+            {
+                seg.type = SegmentType::AnyIndex;
+            }
+            else
+            {
+                uint64_t index_value = 0;
+                if (index_str.size() == 0 || !util::string_is_number_base_10(index_str)
+                    || !util::string_to_number_decimal<uint64_t>('+', index_str, index_value))
+                {
+                    return set_error(jxc::format("array index must be `*` or a non-negative integer, got {}", detail::debug_string_repr(index_str)),
+                        idx, close_idx + 1);
+                }
+                seg.type = SegmentType::Index;
+                seg.index = static_cast<size_t>(index_value);
+            }
+            out_path.segments.push_back(std::move(seg));
+            idx = close_idx + 1;
+        }
+        else if (ch == '.')
+        {
+            if (need_key || out_path.segments.size() == 0)
+            {
+                return set_error("empty key", idx, idx + 1);
+            }
+            need_key = true;
+            ++idx;
+            continue;
+        }
+        else if (ch == '\'' || ch == '"')
+        {
+            if (!need_key && out_path.segments.size() > 0)
+            {
+                return set_error("expected `.` before key", idx, idx + 1);
+            }
+
+            const size_t close_idx = path.find(ch, idx + 1);
+            if (close_idx == std::string_view::npos)
+            {
+                return set_error("missing end quote", idx, path.size());
+            }
+
+            Segment seg;
+            seg.type = SegmentType::Key;
+            seg.key = std::string(path.substr(idx + 1, close_idx - idx - 1));
+            out_path.segments.push_back(std::move(seg));
+            idx = close_idx + 1;
+        }
+        else
+        {
+            if (!need_key && out_path.segments.size() > 0)
+            {
+                return set_error("expected `.` before key", idx, idx + 1);
+            }
+
+            size_t end_idx = idx;
+            while (end_idx < path.size() && path[end_idx] != '.' && path[end_idx] != '[' && path[end_idx] != ']'
+                && path[end_idx] != '\'' && path[end_idx] != '"')
+            {
+                ++end_idx;
+            }
+            if (end_idx == idx)
+            {
+                return set_error(jxc::format("unexpected char {}", detail::debug_char_repr(static_cast<uint32_t>(ch))), idx, idx + 1);
+            }
+
+            Segment seg;
+            seg.key = std::string(path.substr(idx, end_idx - idx));
+            if (seg.key == "*")
+            {
+                seg.type = SegmentType::AnyKey;
+            }
+            else if (seg.key.find('*') != std::string::npos)
+            {
+                seg.type = SegmentType::KeyPattern;
+            }
+            else
+            {
+                seg.type = SegmentType::Key;
+            }
+            out_path.segments.push_back(std::move(seg));
+            idx = end_idx;
+        }
+        need_key = false;
+    }
+
+    if (need_key)
+    {
+        return set_error("path may not end with a period", path.size() - 1, path.size());
+    }
+
+    return true;
+}
+
+
+bool query(std::string_view jxc_string, const QueryPath& path, const std::function<bool(Value&&)>& on_match, ErrorInfo& out_error)
+{
+    // Most of a document is usually skipped, and skipping with a structural index doesn't need to lex anything in the skipped values
+    StructuralIndex index;
+    JumpParser parser = index.build(jxc_string) ? JumpParser(jxc_string, index) : JumpParser(jxc_string);
+    if (!parser.next())
+    {
+        if (parser.has_error())
+        {
+            out_error = parser.get_error();
+            return false;
+        }
+        // empty document
+        return true;
+    }
+
+    QueryRunner runner(parser, path, on_match, out_error);
+    if (!runner.visit(0) && !runner.stopped)
+    {
+        if (parser.has_error())
+        {
+            out_error = parser.get_error();
+        }
+        JXC_DEBUG_ASSERT(out_error.is_err);
+        return false;
+    }
+    return true;
+}
+
+
+std::vector<Value> query(std::string_view jxc_string, std::string_view path, ErrorInfo& out_error)
+{
+    QueryPath compiled_path;
+    if (!QueryPath::compile(path, compiled_path, out_error))
+    {
+        return {};
+    }
+
+    std::vector<Value> result;
+    const bool success = jxc::query(jxc_string, compiled_path, [&result](Value&& val)
+    {
+        result.push_back(std::move(val));
+        return true;
+    }, out_error);
+
+    if (!success)
+    {
+        result.clear();
+    }
+    return result;
+}
+
+
+JXC_END_NAMESPACE(jxc)
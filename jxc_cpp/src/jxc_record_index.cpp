@@ -0,0 +1,593 @@
+#include "jxc_cpp/jxc_record_index.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+namespace
+{
+
+constexpr char index_file_magic[8] = { 'J', 'X', 'C', 'I', 'N', 'D', 'E', 'X' };
+
+// Sidecar files are always little-endian, regardless of the platform that wrote them
+template<typename T>
+void write_int(std::string& out, T value)
+{
+    static_assert(std::is_integral_v<T>, "write_int requires an int type");
+    using unsigned_type = std::make_unsigned_t<T>;
+    const unsigned_type bits = static_cast<unsigned_type>(value);
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        out.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+    }
+}
+
+
+// Reads values back out of a sidecar file, with bounds checks so that truncated files fail to load instead of crashing
+struct IndexFileReader
+{
+    std::string_view data;
+    size_t pos = 0;
+
+    template<typename T>
+    bool read_int(T& out_value)
+    {
+        static_assert(std::is_integral_v<T>, "read_int requires an int type");
+        if (data.size() - pos < sizeof(T))
+        {
+            return false;
+        }
+        using unsigned_type = std::make_unsigned_t<T>;
+        unsigned_type bits = 0;
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            bits |= static_cast<unsigned_type>(static_cast<uint8_t>(data[pos + i])) << (i * 8);
+        }
+        out_value = static_cast<T>(bits);
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool read_bytes(size_t num_bytes, std::string_view& out_bytes)
+    {
+        if (data.size() - pos < num_bytes)
+        {
+            return false;
+        }
+        out_bytes = data.substr(pos, num_bytes);
+        pos += num_bytes;
+        return true;
+    }
+};
+
+
+uint64_t hash_buffer(std::string_view buffer)
+{
+    return ankerl::unordered_dense::hash<std::string_view>{}(buffer);
+}
+
+
+// Gets the string value of an object key, or the source text of a scalar value
+bool get_scalar_token_text(std::string_view source, const Token& tok, std::string& out_text)
+{
+    if (tok.type == TokenType::String)
+    {
+        ErrorInfo err;
+        return util::parse_string_token(tok, out_text, err);
+    }
+    out_text.assign(source.substr(tok.start_idx, tok.end_idx - tok.start_idx));
+    return true;
+}
+
+} // namespace
+
+
+// static
+uint64_t RecordIndex::hash_key(std::string_view key)
+{
+    // zero is reserved for records with no key
+    const uint64_t result = hash_buffer(key);
+    return (result != 0) ? result : 1;
+}
+
+
+// static
+bool RecordIndex::get_record_key(std::string_view record_source, std::string_view key_field, std::string& out_key)
+{
+    JumpParser parser(record_source);
+    if (!parser.next() || parser.value().type != ElementType::BeginObject)
+    {
+        return false;
+    }
+
+    std::string key;
+    while (parser.next())
+    {
+        const Element& ele = parser.value();
+        if (ele.type == ElementType::EndObject)
+        {
+            return false;
+        }
+        else if (ele.type == ElementType::Comment)
+        {
+            continue;
+        }
+
+        if (!get_scalar_token_text(record_source, ele.token, key))
+        {
+            return false;
+        }
+
+        if (key != key_field)
+        {
+            if (!parser.skip_value())
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (!parser.next())
+        {
+            return false;
+        }
+
+        switch (parser.value().type)
+        {
+        case ElementType::Number:
+        case ElementType::Bool:
+        case ElementType::Null:
+        case ElementType::String:
+        case ElementType::Bytes:
+        case ElementType::DateTime:
+            return get_scalar_token_text(record_source, parser.value().token, out_key);
+        default:
+            break;
+        }
+        return false;
+    }
+    return false;
+}
+
+
+// static
+bool RecordIndex::build(std::string_view buffer, RecordLayout layout, std::string_view key_field, RecordIndex& out_index, ErrorInfo& out_error)
+{
+    out_index = RecordIndex{};
+    out_index.layout = layout;
+    out_index.key_field = std::string(key_field);
+    out_index.source_size = static_cast<uint64_t>(buffer.size());
+    out_index.source_content_hash = hash_buffer(buffer);
+
+    // record contents are skipped, and skipping with a structural index doesn't need to lex anything
+    StructuralIndex structural_index;
+    JumpParser parser = structural_index.build(buffer) ? JumpParser(buffer, structural_index) : JumpParser(buffer);
+
+    auto set_error = [&](ErrorInfo&& err)
+    {
+        out_error = std::move(err);
+        out_error.get_line_and_col_from_buffer(buffer);
+        out_index.records.clear();
+        return false;
+    };
+
+    std::string key;
+    auto add_record = [&]()
+    {
+        const Element& ele = parser.value();
+        const size_t start_idx = ele.annotation ? ele.annotation[0].start_idx : ele.token.start_idx;
+        const bool is_object = ele.type == ElementType::BeginObject;
+        if (!parser.skip_value())
+        {
+            return false;
+        }
+
+        Record rec;
+        rec.start_idx = static_cast<uint64_t>(start_idx);
+        rec.end_idx = static_cast<uint64_t>(parser.value().token.end_idx);
+        if (is_object && key_field.size() > 0
+            && get_record_key(buffer.substr(start_idx, static_cast<size_t>(rec.end_idx) - start_idx), key_field, key))
+        {
+            rec.key_hash = hash_key(key);
+        }
+        out_index.records.push_back(rec);
+        return true;
+    };
+
+    switch (layout)
+    {
+    case RecordLayout::ArrayElements:
+    {
+        bool found_array = false;
+        while (parser.next())
+        {
+            const Element& ele = parser.value();
+            if (ele.type == ElementType::Comment)
+            {
+                continue;
+            }
+            else if (found_array || ele.type != ElementType::BeginArray)
+            {
+                return set_error(ErrorInfo(found_array ? "Expected only one top-level array" : "Expected a top-level array",
+                    ele.token.start_idx, ele.token.end_idx));
+            }
+
+            found_array = true;
+            while (parser.next())
+            {
+                const ElementType ele_type = parser.value().type;
+                if (ele_type == ElementType::EndArray)
+                {
+                    break;
+                }
+                else if (ele_type != ElementType::Comment && !add_record())
+                {
+                    break;
+                }
+            }
+        }
+        break;
+    }
+
+    case RecordLayout::Documents:
+        while (parser.next())
+        {
+            if (parser.value().type != ElementType::Comment && !add_record())
+            {
+                break;
+            }
+        }
+        break;
+
+    default:
+        return set_error(ErrorInfo(jxc::format("Invalid record layout {}", static_cast<int>(layout))));
+    }
+
+    if (parser.has_error())
+    {
+        return set_error(ErrorInfo(parser.get_error()));
+    }
+
+    out_index.build_key_order();
+    return true;
+}
+
+
+void RecordIndex::build_key_order()
+{
+    key_order.clear();
+    if (key_field.size() == 0)
+    {
+        return;
+    }
+
+    key_order.reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].key_hash != 0)
+        {
+            key_order.push_back(i);
+        }
+    }
+
+    // stable, so records with the same key stay in file order
+    std::stable_sort(key_order.begin(), key_order.end(), [this](size_t lhs, size_t rhs)
+    {
+        return records[lhs].key_hash < records[rhs].key_hash;
+    });
+}
+
+
+bool RecordIndex::set_source_file_stat(const std::string& source_path, std::string* out_error)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const uint64_t file_size = static_cast<uint64_t>(fs::file_size(source_path, ec));
+    const fs::file_time_type modified_time = ec ? fs::file_time_type{} : fs::last_write_time(source_path, ec);
+    if (ec)
+    {
+        if (out_error != nullptr)
+        {
+            *out_error = jxc::format("Failed to read file info for {}: {}", detail::debug_string_repr(source_path), ec.message());
+        }
+        return false;
+    }
+
+    source_size = file_size;
+    source_modified_time = static_cast<int64_t>(modified_time.time_since_epoch().count());
+    return true;
+}
+
+
+bool RecordIndex::save(const std::string& index_path, std::string* out_error) const
+{
+    std::string data;
+    const bool has_keys = key_field.size() > 0;
+    data.reserve(64 + key_field.size() + records.size() * (has_keys ? 24 : 16));
+
+    data.append(index_file_magic, sizeof(index_file_magic));
+    write_int<uint32_t>(data, file_format_version);
+    write_int<uint8_t>(data, static_cast<uint8_t>(layout));
+    write_int<uint32_t>(data, static_cast<uint32_t>(key_field.size()));
+    data.append(key_field);
+    write_int<uint64_t>(data, source_size);
+    write_int<int64_t>(data, source_modified_time);
+    write_int<uint64_t>(data, source_content_hash);
+    write_int<uint64_t>(data, static_cast<uint64_t>(records.size()));
+    for (const Record& rec : records)
+    {
+        write_int<uint64_t>(data, rec.start_idx);
+        write_int<uint64_t>(data, rec.end_idx - rec.start_idx);
+        if (has_keys)
+        {
+            write_int<uint64_t>(data, rec.key_hash);
+        }
+    }
+
+    // write to a temp file first, so that readers never see a partially written index
+    const std::string temp_path = index_path + ".tmp";
+    {
+        std::ofstream fp(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        fp.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!fp)
+        {
+            if (out_error != nullptr)
+            {
+                *out_error = jxc::format("Failed to write record index {}", detail::debug_string_repr(temp_path));
+            }
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temp_path, index_path, ec);
+    if (ec)
+    {
+        if (out_error != nullptr)
+        {
+            *out_error = jxc::format("Failed to write record index {}: {}", detail::debug_string_repr(index_path), ec.message());
+        }
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+
+bool RecordIndex::load(const std::string& index_path, std::string* out_error)
+{
+    *this = RecordIndex{};
+
+    std::optional<std::string> data = detail::read_file_to_string(index_path, out_error);
+    if (!data.has_value())
+    {
+        return false;
+    }
+
+    auto set_error = [&](std::string_view reason)
+    {
+        if (out_error != nullptr)
+        {
+            *out_error = jxc::format("Invalid record index {}: {}", detail::debug_string_repr(index_path), reason);
+        }
+        *this = RecordIndex{};
+        return false;
+    };
+
+    IndexFileReader reader{ *data };
+    std::string_view magic;
+    uint32_t version = 0;
+    uint8_t layout_value = 0;
+    uint32_t key_field_size = 0;
+    std::string_view key_field_view;
+    uint64_t num_records = 0;
+    if (!reader.read_bytes(sizeof(index_file_magic), magic) || memcmp(magic.data(), index_file_magic, sizeof(index_file_magic)) != 0)
+    {
+        return set_error("not a record index file");
+    }
+    else if (!reader.read_int(version) || version != file_format_version)
+    {
+        return set_error(jxc::format("expected version {}, got {}", file_format_version, version));
+    }
+    else if (!reader.read_int(layout_value) || layout_value > static_cast<uint8_t>(RecordLayout::Documents)
+        || !reader.read_int(key_field_size) || !reader.read_bytes(key_field_size, key_field_view)
+        || !reader.read_int(source_size) || !reader.read_int(source_modified_time) || !reader.read_int(source_content_hash)
+        || !reader.read_int(num_records))
+    {
+        return set_error("invalid header");
+    }
+
+    layout = static_cast<RecordLayout>(layout_value);
+    key_field = std::string(key_field_view);
+
+    const bool has_keys = key_field.size() > 0;
+    const uint64_t record_size = has_keys ? 24 : 16;
+    if ((data->size() - reader.pos) / record_size < num_records)
+    {
+        return set_error("file is truncated");
+    }
+
+    records.resize(static_cast<size_t>(num_records));
+    for (Record& rec : records)
+    {
+        uint64_t record_len = 0;
+        reader.read_int(rec.start_idx);
+        reader.read_int(record_len);
+        rec.end_idx = rec.start_idx + record_len;
+        if (has_keys)
+        {
+            reader.read_int(rec.key_hash);
+        }
+
+        if (rec.end_idx < rec.start_idx || rec.end_idx > source_size)
+        {
+            return set_error("record is outside the source buffer");
+        }
+    }
+
+    build_key_order();
+    return true;
+}
+
+
+bool RecordIndex::matches_file_stat(const std::string& source_path) const
+{
+    RecordIndex current;
+    return current.set_source_file_stat(source_path)
+        && current.source_size == source_size
+        && current.source_modified_time == source_modified_time;
+}
+
+
+bool RecordIndex::matches_content(std::string_view source_buffer) const
+{
+    return static_cast<uint64_t>(source_buffer.size()) == source_size && hash_buffer(source_buffer) == source_content_hash;
+}
+
+
+std::vector<size_t> RecordIndex::find_key_candidates(std::string_view key) const
+{
+    const uint64_t key_hash = hash_key(key);
+    const auto first = std::lower_bound(key_order.begin(), key_order.end(), key_hash, [this](size_t record_idx, uint64_t hash)
+    {
+        return records[record_idx].key_hash < hash;
+    });
+    const auto last = std::upper_bound(first, key_order.end(), key_hash, [this](uint64_t hash, size_t record_idx)
+    {
+        return hash < records[record_idx].key_hash;
+    });
+    return std::vector<size_t>(first, last);
+}
+
+
+RecordFile::RecordFile()
+    : value_parser(parser, parse_error)
+{
+}
+
+
+bool RecordFile::open(const std::string& source_path, const RecordFileSettings& settings, ErrorInfo& out_error)
+{
+    close();
+
+    std::string io_error;
+    if (!file.open(source_path, &io_error))
+    {
+        out_error = ErrorInfo(std::move(io_error));
+        return false;
+    }
+
+    const std::string index_path = (settings.index_path.size() > 0) ? settings.index_path : source_path + ".jxcidx";
+    // load() sets stale_reason if the sidecar is missing or invalid
+    std::string stale_reason;
+    if (index.load(index_path, &stale_reason))
+    {
+        if (index.get_layout() != settings.layout || index.get_key_field() != settings.key_field)
+        {
+            stale_reason = "index was built with different settings";
+        }
+        else if (settings.verify_content_hash ? !index.matches_content(file.get_view()) : !index.matches_file_stat(source_path))
+        {
+            stale_reason = "source file has changed";
+        }
+    }
+
+    if (stale_reason.size() > 0)
+    {
+        if (!settings.rebuild_if_stale)
+        {
+            out_error = ErrorInfo(jxc::format("Record index {} can't be used: {}", detail::debug_string_repr(index_path), stale_reason));
+            close();
+            return false;
+        }
+
+        if (!RecordIndex::build(file.get_view(), settings.layout, settings.key_field, index, out_error)
+            || !index.set_source_file_stat(source_path, &io_error)
+            || (settings.save_rebuilt_index && !index.save(index_path, &io_error)))
+        {
+            if (io_error.size() > 0)
+            {
+                out_error = ErrorInfo(std::move(io_error));
+            }
+            close();
+            return false;
+        }
+        index_was_rebuilt = true;
+    }
+    return true;
+}
+
+
+void RecordFile::close()
+{
+    parser.reset(std::string_view{});
+    parse_error = ErrorInfo{};
+    index = RecordIndex{};
+    file.close();
+    index_was_rebuilt = false;
+}
+
+
+void RecordFile::record_error_to_file_error(size_t idx, ErrorInfo& err) const
+{
+    const size_t record_start_idx = static_cast<size_t>(index[idx].start_idx);
+    if (err.buffer_start_idx != invalid_idx)
+    {
+        err.buffer_start_idx += record_start_idx;
+    }
+    if (err.buffer_end_idx != invalid_idx)
+    {
+        err.buffer_end_idx += record_start_idx;
+    }
+    err.get_line_and_col_from_buffer(file.get_view());
+}
+
+
+bool RecordFile::read(size_t idx, Value& out_value, ErrorInfo& out_error)
+{
+    JXC_ASSERTF(idx < index.size(), "Record index {} out of range (file has {} records)", idx, index.size());
+    parser.reset(get_record_source(idx));
+    parse_error = ErrorInfo{};
+
+    if (parser.next())
+    {
+        out_value = value_parser.parse(parser.value());
+    }
+    else if (!parser.has_error())
+    {
+        parse_error = ErrorInfo("Empty record (is the index stale?)", 0, 0);
+    }
+
+    if (!parse_error.is_err && parser.has_error())
+    {
+        parse_error = parser.get_error();
+    }
+
+    if (parse_error.is_err)
+    {
+        out_error = std::move(parse_error);
+        record_error_to_file_error(idx, out_error);
+        return false;
+    }
+    return true;
+}
+
+
+std::optional<size_t> RecordFile::find(std::string_view key) const
+{
+    std::string record_key;
+    for (size_t idx : index.find_key_candidates(key))
+    {
+        if (RecordIndex::get_record_key(get_record_source(idx), index.get_key_field(), record_key) && record_key == key)
+        {
+            return idx;
+        }
+    }
+    return std::nullopt;
+}
+
+
+JXC_END_NAMESPACE(jxc)
@@ -0,0 +1,641 @@
+#include "jxc_cpp/jxc_tape.h"
+#include <bit>
+
+
+JXC_BEGIN_NAMESPACE(jxc)
+
+const char* tape_type_to_string(TapeType type)
+{
+    switch (type)
+    {
+    case JXC_ENUMSTR(TapeType, Invalid);
+    case JXC_ENUMSTR(TapeType, Null);
+    case JXC_ENUMSTR(TapeType, Bool);
+    case JXC_ENUMSTR(TapeType, SignedInteger);
+    case JXC_ENUMSTR(TapeType, UnsignedInteger);
+    case JXC_ENUMSTR(TapeType, Float);
+    case JXC_ENUMSTR(TapeType, String);
+    case JXC_ENUMSTR(TapeType, Bytes);
+    case JXC_ENUMSTR(TapeType, DateTime);
+    case JXC_ENUMSTR(TapeType, Expression);
+    case JXC_ENUMSTR(TapeType, Annotation);
+    case JXC_ENUMSTR(TapeType, BeginArray);
+    case JXC_ENUMSTR(TapeType, EndArray);
+    case JXC_ENUMSTR(TapeType, BeginObject);
+    case JXC_ENUMSTR(TapeType, EndObject);
+    default:
+        break;
+    }
+    return "INVALID";
+}
+
+
+namespace
+{
+
+class TapeBuilder
+{
+    struct Container
+    {
+        size_t begin_idx;
+        uint64_t num_items;
+    };
+
+    JumpParser parser;
+    std::string_view buffer;
+    std::vector<uint64_t>& tape;
+    std::string& string_buffer;
+    ErrorInfo& error;
+    std::vector<Container> container_stack;
+
+public:
+    TapeBuilder(std::string_view buffer, std::vector<uint64_t>& out_tape, std::string& out_string_buffer, ErrorInfo& out_error)
+        : parser(buffer)
+        , buffer(buffer)
+        , tape(out_tape)
+        , string_buffer(out_string_buffer)
+        , error(out_error)
+    {
+    }
+
+private:
+    inline void push(TapeType type, uint64_t payload)
+    {
+        tape.push_back(TapeDocument::make_entry(type, payload));
+    }
+
+    // Returns the payload for a string that's either in the source buffer, or copied into the string buffer if it isn't
+    uint64_t get_string_data_payload(std::string_view str)
+    {
+        if (str.data() >= buffer.data() && str.data() + str.size() <= buffer.data() + buffer.size())
+        {
+            return static_cast<uint64_t>(str.data() - buffer.data());
+        }
+        const size_t offset = string_buffer.size();
+        string_buffer.append(str);
+        return TapeDocument::string_buffer_flag | static_cast<uint64_t>(offset);
+    }
+
+    void push_string_data(TapeType type, std::string_view str)
+    {
+        push(type, get_string_data_payload(str));
+        tape.push_back(static_cast<uint64_t>(str.size()));
+    }
+
+    void push_number(TapeType type, uint64_t value_bits, std::string_view suffix)
+    {
+        uint64_t payload = 0;
+        if (suffix.size() > 0)
+        {
+            payload = get_string_data_payload(suffix);
+            payload = (payload & TapeDocument::string_buffer_flag)
+                | (static_cast<uint64_t>(suffix.size()) << TapeDocument::suffix_offset_bits)
+                | (payload & TapeDocument::suffix_offset_mask);
+        }
+        push(type, payload);
+        tape.push_back(value_bits);
+    }
+
+    void push_annotation(TokenView anno)
+    {
+        const size_t start = anno[0].start_idx;
+        const size_t end = anno[anno.size() - 1].end_idx;
+        JXC_DEBUG_ASSERT(end >= start && end <= buffer.size());
+        push_string_data(TapeType::Annotation, buffer.substr(start, end - start));
+    }
+
+    bool push_number_value(const Token& tok)
+    {
+        util::NumberTokenSplitResult number;
+        if (!util::split_number_token_value(tok, number, error))
+        {
+            return false;
+        }
+
+        if (number.is_floating_point())
+        {
+            double number_value = 0.0;
+            if (!util::parse_number(tok, number_value, number, error))
+            {
+                return false;
+            }
+            push_number(TapeType::Float, std::bit_cast<uint64_t>(number_value), number.suffix);
+        }
+        else
+        {
+            int64_t number_value = 0;
+            if (!util::parse_number(tok, number_value, number, error))
+            {
+                return false;
+            }
+            push_number(TapeType::SignedInteger, static_cast<uint64_t>(number_value), number.suffix);
+        }
+        return true;
+    }
+
+    bool push_string_value(const Token& tok)
+    {
+        std::string_view string_value;
+        bool is_raw_string = false;
+        if (!util::string_token_to_value(tok, string_value, is_raw_string, error))
+        {
+            return false;
+        }
+
+        if (is_raw_string || !util::string_has_escape_chars(string_value))
+        {
+            push_string_data(TapeType::String, string_value);
+            return true;
+        }
+
+        // unescape into the string buffer
+        const size_t offset = string_buffer.size();
+        const size_t req_buf_size = util::get_string_required_buffer_size(string_value, is_raw_string);
+        string_buffer.resize(offset + req_buf_size);
+        size_t num_chars_written = 0;
+        if (req_buf_size > 0 && !util::parse_string_escapes_to_buffer(string_value, tok.start_idx, tok.end_idx,
+            string_buffer.data() + offset, req_buf_size, num_chars_written, error))
+        {
+            return false;
+        }
+        string_buffer.resize(offset + num_chars_written);
+
+        push(TapeType::String, TapeDocument::string_buffer_flag | static_cast<uint64_t>(offset));
+        tape.push_back(static_cast<uint64_t>(num_chars_written));
+        return true;
+    }
+
+    bool push_bytes_value(const Token& tok)
+    {
+        const size_t offset = string_buffer.size();
+        const size_t req_buf_size = util::get_byte_buffer_required_size(tok.value.data(), tok.value.size());
+        string_buffer.resize(offset + req_buf_size);
+        size_t num_bytes_written = 0;
+        if (!util::parse_bytes_token(tok, reinterpret_cast<uint8_t*>(string_buffer.data() + offset), req_buf_size, num_bytes_written, error))
+        {
+            return false;
+        }
+        string_buffer.resize(offset + num_bytes_written);
+
+        push(TapeType::Bytes, TapeDocument::string_buffer_flag | static_cast<uint64_t>(offset));
+        tape.push_back(static_cast<uint64_t>(num_bytes_written));
+        return true;
+    }
+
+    // Object keys are converted the same way as ValueParser::parse_key(), except that all integer keys are signed
+    bool push_key(const Token& tok)
+    {
+        switch (tok.type)
+        {
+        case TokenType::Identifier:
+            push_string_data(TapeType::String, tok.value.as_view());
+            return true;
+        case TokenType::True:
+            push(TapeType::Bool, 1);
+            return true;
+        case TokenType::False:
+            push(TapeType::Bool, 0);
+            return true;
+        case TokenType::Null:
+            push(TapeType::Null, 0);
+            return true;
+        case TokenType::Number:
+        {
+            std::string_view int_key_suffix;
+            int64_t int_key_value = 0;
+            if (!util::parse_number_object_key<int64_t>(tok, int_key_value, error, &int_key_suffix))
+            {
+                return false;
+            }
+            push_number(TapeType::SignedInteger, static_cast<uint64_t>(int_key_value), int_key_suffix);
+            return true;
+        }
+        case TokenType::String:
+            return push_string_value(tok);
+        case TokenType::ByteString:
+            return push_bytes_value(tok);
+        default:
+            break;
+        }
+
+        error = ErrorInfo(jxc::format("Invalid token for object key: {}", tok.to_repr()), tok.start_idx, tok.end_idx);
+        return false;
+    }
+
+    // Expressions are stored as their source text, and only parsed if they're converted to a Value
+    bool push_expression()
+    {
+        const size_t start_idx = parser.value().token.start_idx;
+        while (parser.next())
+        {
+            if (parser.value().type == ElementType::EndExpression)
+            {
+                const size_t end_idx = parser.value().token.end_idx;
+                push_string_data(TapeType::Expression, buffer.substr(start_idx, end_idx - start_idx));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void begin_container(TapeType type)
+    {
+        container_stack.push_back(Container{ tape.size(), 0 });
+        // both entries are filled in when the container ends
+        push(type, 0);
+        tape.push_back(0);
+    }
+
+    void end_container(TapeType begin_type, TapeType end_type)
+    {
+        JXC_ASSERT(container_stack.size() > 0);
+        const Container container = container_stack.back();
+        container_stack.pop_back();
+        JXC_DEBUG_ASSERT(TapeDocument::get_entry_type(tape[container.begin_idx]) == begin_type);
+        tape[container.begin_idx] = TapeDocument::make_entry(begin_type, static_cast<uint64_t>(tape.size()));
+        tape[container.begin_idx + 1] = container.num_items;
+        push(end_type, static_cast<uint64_t>(container.begin_idx));
+    }
+
+    bool push_element(const Element& ele)
+    {
+        // count array items and object keys
+        if (container_stack.size() > 0 && ele.type != ElementType::EndArray && ele.type != ElementType::EndObject)
+        {
+            Container& parent = container_stack.back();
+            if (TapeDocument::get_entry_type(tape[parent.begin_idx]) == TapeType::BeginArray || ele.type == ElementType::ObjectKey)
+            {
+                ++parent.num_items;
+            }
+        }
+
+        if (ele.annotation.size() > 0)
+        {
+            push_annotation(ele.annotation);
+        }
+
+        switch (ele.type)
+        {
+        case ElementType::Number:
+            return push_number_value(ele.token);
+        case ElementType::Bool:
+            push(TapeType::Bool, (ele.token.type == TokenType::True) ? 1 : 0);
+            return true;
+        case ElementType::Null:
+            push(TapeType::Null, 0);
+            return true;
+        case ElementType::Bytes:
+            return push_bytes_value(ele.token);
+        case ElementType::String:
+            return push_string_value(ele.token);
+        case ElementType::DateTime:
+            push_string_data(TapeType::DateTime, ele.token.value.as_view());
+            return true;
+        case ElementType::BeginExpression:
+            return push_expression();
+        case ElementType::BeginArray:
+            begin_container(TapeType::BeginArray);
+            return true;
+        case ElementType::EndArray:
+            end_container(TapeType::BeginArray, TapeType::EndArray);
+            return true;
+        case ElementType::BeginObject:
+            begin_container(TapeType::BeginObject);
+            return true;
+        case ElementType::EndObject:
+            end_container(TapeType::BeginObject, TapeType::EndObject);
+            return true;
+        case ElementType::ObjectKey:
+            return push_key(ele.token);
+        default:
+            break;
+        }
+
+        error = ErrorInfo(jxc::format("Unexpected element {}", element_type_to_string(ele.type)), ele.token.start_idx, ele.token.end_idx);
+        return false;
+    }
+
+public:
+    bool build()
+    {
+        while (parser.next())
+        {
+            if (parser.value().type == ElementType::Comment)
+            {
+                continue;
+            }
+
+            if (!push_element(parser.value()))
+            {
+                if (!error.is_err && parser.has_error())
+                {
+                    error = parser.get_error();
+                }
+                JXC_DEBUG_ASSERT(error.is_err);
+                return false;
+            }
+
+            // only the first value in the buffer is parsed
+            if (container_stack.size() == 0)
+            {
+                return true;
+            }
+        }
+
+        if (parser.has_error())
+        {
+            error = parser.get_error();
+            return false;
+        }
+        else if (container_stack.size() > 0)
+        {
+            error = ErrorInfo("Unexpected end of stream", buffer.size(), buffer.size());
+            return false;
+        }
+
+        // empty document
+        return true;
+    }
+};
+
+} // namespace
+
+
+bool TapeDocument::parse(std::string_view in_buffer)
+{
+    owned_buffer.clear();
+    return parse_internal(in_buffer);
+}
+
+
+bool TapeDocument::parse(std::string&& in_buffer)
+{
+    owned_buffer = std::move(in_buffer);
+    return parse_internal(owned_buffer);
+}
+
+
+bool TapeDocument::parse_internal(std::string_view in_buffer)
+{
+    buffer = in_buffer;
+    tape.clear();
+    string_buffer.clear();
+    parse_error = ErrorInfo{};
+
+    // typical documents need between one tape entry per 4 and per 16 bytes of source, so start at the low end to avoid
+    // over-allocating for text-heavy documents
+    tape.reserve(buffer.size() / 16 + 8);
+
+    TapeBuilder builder(buffer, tape, string_buffer, parse_error);
+    if (!builder.build())
+    {
+        tape.clear();
+        string_buffer.clear();
+        return false;
+    }
+    return true;
+}
+
+
+std::string TapeDocument::dump() const
+{
+    std::string result;
+    size_t idx = 0;
+    while (idx < tape.size())
+    {
+        const uint64_t entry = tape[idx];
+        const TapeType type = get_entry_type(entry);
+        const uint64_t payload = entry & payload_mask;
+        result += jxc::format("{}: {}", idx, tape_type_to_string(type));
+        switch (type)
+        {
+        case TapeType::Null:
+            idx += 1;
+            break;
+        case TapeType::Bool:
+            result += (payload != 0) ? " true" : " false";
+            idx += 1;
+            break;
+        case TapeType::EndArray:
+        case TapeType::EndObject:
+            result += jxc::format(" (begin {})", payload);
+            idx += 1;
+            break;
+        case TapeType::BeginArray:
+        case TapeType::BeginObject:
+            result += jxc::format(" (end {}, {} items)", payload, tape[idx + 1]);
+            idx += 2;
+            break;
+        default:
+            result += " " + TapeCursor(this, idx).to_value().to_repr();
+            if (type == TapeType::Annotation)
+            {
+                result += " " + detail::debug_string_repr(TapeCursor(this, idx).get_annotation_source());
+            }
+            idx += 2;
+            break;
+        }
+        result += "\n";
+    }
+    return result;
+}
+
+
+std::string_view TapeCursor::get_source_span(size_t idx) const
+{
+    JXC_DEBUG_ASSERT(idx + 1 < doc->tape.size());
+    const uint64_t data_payload = doc->tape[idx] & TapeDocument::payload_mask;
+    const size_t offset = static_cast<size_t>(data_payload & TapeDocument::offset_mask);
+    const size_t len = static_cast<size_t>(doc->tape[idx + 1]);
+    return (data_payload & TapeDocument::string_buffer_flag)
+        ? std::string_view(doc->string_buffer).substr(offset, len)
+        : doc->buffer.substr(offset, len);
+}
+
+
+bool TapeCursor::as_bool() const
+{
+    JXC_ASSERT(is_bool());
+    return (doc->tape[value_idx()] & TapeDocument::payload_mask) != 0;
+}
+
+
+int64_t TapeCursor::as_signed_integer() const
+{
+    JXC_ASSERT(get_type() == TapeType::SignedInteger);
+    return static_cast<int64_t>(doc->tape[value_idx() + 1]);
+}
+
+
+uint64_t TapeCursor::as_unsigned_integer() const
+{
+    JXC_ASSERT(get_type() == TapeType::UnsignedInteger);
+    return doc->tape[value_idx() + 1];
+}
+
+
+double TapeCursor::as_float() const
+{
+    JXC_ASSERT(is_float());
+    return std::bit_cast<double>(doc->tape[value_idx() + 1]);
+}
+
+
+std::string_view TapeCursor::as_string() const
+{
+    JXC_ASSERT(is_string());
+    return get_source_span(value_idx());
+}
+
+
+BytesView TapeCursor::as_bytes() const
+{
+    JXC_ASSERT(is_bytes());
+    const std::string_view data = get_source_span(value_idx());
+    return BytesView(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+}
+
+
+std::string_view TapeCursor::as_datetime_source() const
+{
+    JXC_ASSERT(is_datetime());
+    return get_source_span(value_idx());
+}
+
+
+std::string_view TapeCursor::as_expression_source() const
+{
+    JXC_ASSERT(is_expression());
+    return get_source_span(value_idx());
+}
+
+
+std::string_view TapeCursor::get_number_suffix() const
+{
+    JXC_ASSERT(is_number());
+    const uint64_t number_payload = doc->tape[value_idx()] & TapeDocument::payload_mask;
+    const size_t suffix_len = static_cast<size_t>((number_payload & TapeDocument::offset_mask) >> TapeDocument::suffix_offset_bits);
+    if (suffix_len == 0)
+    {
+        return std::string_view{};
+    }
+    const size_t offset = static_cast<size_t>(number_payload & TapeDocument::suffix_offset_mask);
+    return (number_payload & TapeDocument::string_buffer_flag)
+        ? std::string_view(doc->string_buffer).substr(offset, suffix_len)
+        : doc->buffer.substr(offset, suffix_len);
+}
+
+
+std::string_view TapeCursor::get_annotation_source() const
+{
+    return (is_valid() && has_annotation()) ? get_source_span(start_idx) : std::string_view{};
+}
+
+
+size_t TapeCursor::size() const
+{
+    JXC_ASSERT(is_array() || is_object());
+    return static_cast<size_t>(doc->tape[value_idx() + 1]);
+}
+
+
+TapeCursor TapeCursor::at(size_t idx) const
+{
+    JXC_ASSERT(is_array());
+    if (idx >= size())
+    {
+        return TapeCursor(doc, invalid_idx);
+    }
+    TapeCursor result = first_child();
+    for (size_t i = 0; i < idx; i++)
+    {
+        result = result.next_sibling();
+    }
+    return result;
+}
+
+
+TapeCursor TapeCursor::find(std::string_view key) const
+{
+    JXC_ASSERT(is_object());
+    for (TapeCursor cur_key = first_child(); cur_key.is_valid(); )
+    {
+        TapeCursor val = cur_key.next_sibling();
+        if (cur_key.is_string() && cur_key.as_string() == key)
+        {
+            return val;
+        }
+        cur_key = val.next_sibling();
+    }
+    return TapeCursor(doc, invalid_idx);
+}
+
+
+Value TapeCursor::to_value() const
+{
+    Value result;
+    switch (get_type())
+    {
+    case TapeType::Null:
+        result = Value(default_null);
+        break;
+    case TapeType::Bool:
+        result = Value(as_bool());
+        break;
+    case TapeType::SignedInteger:
+        result = Value(as_signed_integer(), get_number_suffix());
+        break;
+    case TapeType::UnsignedInteger:
+        result = Value(as_unsigned_integer(), get_number_suffix());
+        break;
+    case TapeType::Float:
+        result = Value(as_float(), get_number_suffix());
+        break;
+    case TapeType::String:
+        result = Value(as_string());
+        break;
+    case TapeType::Bytes:
+        result = Value(as_bytes());
+        break;
+    case TapeType::Expression:
+    {
+        // parse the expression the same way jxc::parse() does
+        ErrorInfo err;
+        JumpParser parser(as_expression_source());
+        if (parser.next())
+        {
+            detail::ValueParser value_parser(parser, err);
+            result = value_parser.parse(parser.value());
+        }
+        break;
+    }
+    case TapeType::BeginArray:
+    {
+        result = Value(default_array);
+        for (TapeCursor item : *this)
+        {
+            result.push_back(item.to_value());
+        }
+        break;
+    }
+    case TapeType::BeginObject:
+        result = Value(default_object);
+        for_each_pair([&result](TapeCursor key, TapeCursor val)
+        {
+            result.set_key(key.to_value(), val.to_value());
+        });
+        break;
+    default:
+        // Value has no DateTime type, so jxc::parse() returns an invalid value for those too
+        return default_invalid;
+    }
+
+    if (has_annotation())
+    {
+        result.set_annotation(get_annotation_source());
+    }
+    return result;
+}
+
+
+JXC_END_NAMESPACE(jxc)
@@ -1,5 +1,6 @@
 #include "jxc_cpp/jxc_value.h"
 #include "jxc_cpp/jxc_document.h"
+#include <mutex>
 
 
 JXC_BEGIN_NAMESPACE(jxc)
@@ -28,13 +29,12 @@ const char* value_type_to_string(ValueType type)
 JXC_BEGIN_NAMESPACE(mem)
 
 template<typename T, typename AllocatorType = std::allocator<T>>
-static T* create(size_t count = 1)
+static T* create(size_t count = 1, AllocatorType alloc = AllocatorType{})
 {
     static_assert(std::is_default_constructible_v<T>, "mem::create requires a default-constructible type");
     JXC_DEBUG_ASSERT(count > 0);
 
     // borrowed from nlohmann_json (MIT licensed) - exception-safe allocation method
-    AllocatorType alloc;
     using AllocatorTraits = std::allocator_traits<AllocatorType>;
     auto deleter = [&](T* ptr)
     {
@@ -58,10 +58,9 @@ static T* create(size_t count = 1)
 }
 
 template<typename T, typename AllocatorType = std::allocator<T>>
-static void destroy(T* ptr, size_t count = 1)
+static void destroy(T* ptr, size_t count = 1, AllocatorType alloc = AllocatorType{})
 {
     JXC_DEBUG_ASSERT(count > 0);
-    AllocatorType alloc;
     if constexpr (!std::is_trivially_constructible_v<T>)
     {
         std::allocator_traits<decltype(alloc)>::destroy(alloc, ptr);
@@ -73,53 +72,58 @@ JXC_END_NAMESPACE(mem)
 
 
 // static
-uint8_t* Value::create_buffer(size_t buf_len)
+uint8_t* Value::create_buffer(size_t buf_len, std::pmr::memory_resource* resource)
 {
-    return mem::create<uint8_t, byte_allocator_t>(buf_len);
+    return mem::create<uint8_t, byte_allocator_t>(buf_len, byte_allocator_t(resource));
 }
 
 
 // static
-void Value::destroy_buffer(uint8_t* buf, size_t buf_len)
+void Value::destroy_buffer(uint8_t* buf, size_t buf_len, std::pmr::memory_resource* resource)
 {
-    mem::destroy<uint8_t, byte_allocator_t>(buf, buf_len);
+    mem::destroy<uint8_t, byte_allocator_t>(buf, buf_len, byte_allocator_t(resource));
 }
 
 
-void Value::alloc_buffer_from(string_view_vt val)
+void Value::alloc_buffer(size_t buf_len, std::pmr::memory_resource* resource)
+{
+    data.buffer_ptr.resource = resource;
+    data.buffer_ptr.ptr = create_buffer(buf_len, data.buffer_ptr.resource);
+    data.buffer_ptr.len = buf_len;
+}
+
+
+void Value::alloc_buffer_from(string_view_vt val, std::pmr::memory_resource* resource)
 {
     JXC_DEBUG_ASSERT(val.data() != nullptr && val.size() > 0);
     const size_t buf_size = val.size();
-    uint8_t* buf = create_buffer(buf_size);
-    JXC_STRNCPY((char*)buf, buf_size, val.data(), buf_size);
-    data.buffer_ptr.ptr = buf;
-    data.buffer_ptr.len = buf_size;
+    alloc_buffer(buf_size, resource);
+    JXC_STRNCPY((char*)data.buffer_ptr.ptr, buf_size, val.data(), buf_size);
 }
 
 
-void Value::alloc_buffer_from(bytes_view_vt val)
+void Value::alloc_buffer_from(bytes_view_vt val, std::pmr::memory_resource* resource)
 {
     JXC_DEBUG_ASSERT(val.data() != nullptr && val.size() > 0);
     const size_t buf_size = val.size();
-    uint8_t* buf = create_buffer(buf_size);
-    JXC_MEMCPY(buf, buf_size, val.data(), buf_size);
-    data.buffer_ptr.ptr = buf;
-    data.buffer_ptr.len = buf_size;
+    alloc_buffer(buf_size, resource);
+    JXC_MEMCPY(data.buffer_ptr.ptr, buf_size, val.data(), buf_size);
 }
 
 
 void Value::free_buffer()
 {
     JXC_DEBUG_ASSERT(data.buffer_ptr.ptr != nullptr);
-    destroy_buffer(data.buffer_ptr.ptr, data.buffer_ptr.len);
+    destroy_buffer(data.buffer_ptr.ptr, data.buffer_ptr.len, data.buffer_ptr.resource);
     data.buffer_ptr.ptr = nullptr;
     data.buffer_ptr.len = 0;
+    data.buffer_ptr.resource = nullptr;
 }
 
 
-Value::array_vt& Value::alloc_array()
+Value::array_vt& Value::alloc_array(size_t capacity)
 {
-    data.value_array = mem::create<array_vt, array_allocator_t>();
+    data.value_array = array_vt::create(capacity, detail::ValueMemory());
     return *data.value_array;
 }
 
@@ -127,14 +131,215 @@ Value::array_vt& Value::alloc_array()
 void Value::free_array()
 {
     JXC_DEBUG_ASSERT(data.value_array != nullptr);
-    mem::destroy<array_vt, array_allocator_t>(data.value_array);
+    // frees to the memory resource the array was allocated from
+    switch (type.get_array_storage())
+    {
+    case ArrayStorageType::PackedFloat:
+        free_packed_array_expanded_items();
+        packed_float_array_vt::destroy(data.value_packed_float_array);
+        break;
+    case ArrayStorageType::PackedSignedInteger:
+        free_packed_array_expanded_items();
+        packed_signed_integer_array_vt::destroy(data.value_packed_signed_integer_array);
+        break;
+    default:
+        // arena items that only use memory from the same arena have nothing to free
+        array_vt::destroy(data.value_array, items_modified || !data.value_array->is_in_arena());
+        break;
+    }
     data.value_array = nullptr;
+    items_modified = false;
+}
+
+
+bool Value::convert_to_packed_array()
+{
+    JXC_ASSERT(type.data == ValueType::Array);
+    if (is_packed_array())
+    {
+        return true;
+    }
+    else if (data.value_array == nullptr || data.value_array->size() == 0)
+    {
+        return false;
+    }
+
+    const array_vt& arr = as_array_unchecked();
+    const ValueType item_type = arr[0].type.data;
+    if (item_type != ValueType::Float && item_type != ValueType::SignedInteger)
+    {
+        return false;
+    }
+
+    for (const Value& item : arr)
+    {
+        if (item.type.data != item_type || item.has_annotation() || item.get_number_suffix().size() > 0)
+        {
+            return false;
+        }
+    }
+
+    const detail::ValueMemory memory = arr.get_memory();
+    const size_t num_items = arr.size();
+    if (item_type == ValueType::Float)
+    {
+        packed_float_array_vt* packed = packed_float_array_vt::create(num_items, memory);
+        for (const Value& item : arr)
+        {
+            packed_float_array_vt::emplace_back(packed, item.data.value_float.value);
+        }
+        free_array();
+        data.value_packed_float_array = packed;
+        type.set_array_storage(ArrayStorageType::PackedFloat);
+    }
+    else
+    {
+        packed_signed_integer_array_vt* packed = packed_signed_integer_array_vt::create(num_items, memory);
+        for (const Value& item : arr)
+        {
+            packed_signed_integer_array_vt::emplace_back(packed, item.data.value_signed_integer.value);
+        }
+        free_array();
+        data.value_packed_signed_integer_array = packed;
+        type.set_array_storage(ArrayStorageType::PackedSignedInteger);
+    }
+    return true;
 }
 
 
-Value::object_vt& Value::alloc_object()
+JXC_BEGIN_NAMESPACE(detail)
+
+// Serializes making the Values that const access reads packed arrays through. They're allocated from the packed array's
+// memory, which can be a ValueArena shared with the rest of the tree.
+static std::mutex s_packed_array_expand_mutex;
+
+template<typename T>
+static Value::array_vt* get_or_create_expanded_items(const ValueArrayStorage<T>& packed)
 {
-    data.value_object = mem::create<object_vt, object_allocator_t>();
+    if (Value::array_vt* items = packed.get_expanded_items())
+    {
+        return items;
+    }
+
+    std::lock_guard<std::mutex> lock(s_packed_array_expand_mutex);
+    Value::array_vt* items = packed.get_expanded_items();
+    if (items == nullptr)
+    {
+        items = Value::array_vt::create(packed.size(), packed.get_memory());
+        for (T item : packed)
+        {
+            Value::array_vt::emplace_back(items, item);
+        }
+        packed.set_expanded_items(items);
+    }
+    return items;
+}
+
+JXC_END_NAMESPACE(detail)
+
+
+Value::array_vt* Value::get_packed_array_expanded_items() const
+{
+    JXC_DEBUG_ASSERT(is_packed_array());
+    if (data.value_array == nullptr)
+    {
+        return nullptr;
+    }
+    else if (type.get_array_storage() == ArrayStorageType::PackedFloat)
+    {
+        return detail::get_or_create_expanded_items(*data.value_packed_float_array);
+    }
+    return detail::get_or_create_expanded_items(*data.value_packed_signed_integer_array);
+}
+
+
+void Value::free_packed_array_expanded_items()
+{
+    JXC_DEBUG_ASSERT(is_packed_array() && data.value_array != nullptr);
+    array_vt* items = (type.get_array_storage() == ArrayStorageType::PackedFloat)
+        ? data.value_packed_float_array->get_expanded_items()
+        : data.value_packed_signed_integer_array->get_expanded_items();
+    if (items != nullptr)
+    {
+        // the items are plain numbers, so there's nothing to destroy if they're in an arena
+        array_vt::destroy(items, !items->is_in_arena());
+        if (type.get_array_storage() == ArrayStorageType::PackedFloat)
+        {
+            data.value_packed_float_array->set_expanded_items(nullptr);
+        }
+        else
+        {
+            data.value_packed_signed_integer_array->set_expanded_items(nullptr);
+        }
+    }
+}
+
+
+void Value::expand_packed_array_internal()
+{
+    JXC_DEBUG_ASSERT(is_packed_array());
+    array_vt* arr = nullptr;
+    if (data.value_array != nullptr)
+    {
+        // takes over the Values used for const access, so they aren't made twice
+        arr = get_packed_array_expanded_items();
+        if (type.get_array_storage() == ArrayStorageType::PackedFloat)
+        {
+            data.value_packed_float_array->set_expanded_items(nullptr);
+        }
+        else
+        {
+            data.value_packed_signed_integer_array->set_expanded_items(nullptr);
+        }
+        free_array();
+    }
+    data.value_array = arr;
+    type.set_array_storage(ArrayStorageType::Values);
+}
+
+
+bool Value::try_push_back_packed(const Value& rhs)
+{
+    JXC_DEBUG_ASSERT(is_packed_array());
+    if (!rhs.is_number() || rhs.has_annotation() || rhs.get_number_suffix().size() > 0)
+    {
+        return false;
+    }
+
+    if (data.value_array != nullptr)
+    {
+        // the Values used for const access no longer match
+        free_packed_array_expanded_items();
+    }
+
+    if (rhs.type.data == ValueType::Float && type.get_array_storage() == ArrayStorageType::PackedFloat)
+    {
+        packed_float_array_vt::emplace_back(data.value_packed_float_array, rhs.data.value_float.value);
+        return true;
+    }
+    else if (rhs.type.data == ValueType::SignedInteger && type.get_array_storage() == ArrayStorageType::PackedSignedInteger)
+    {
+        packed_signed_integer_array_vt::emplace_back(data.value_packed_signed_integer_array, rhs.data.value_signed_integer.value);
+        return true;
+    }
+    return false;
+}
+
+
+Value Value::get_packed_array_item(size_t idx) const
+{
+    JXC_DEBUG_ASSERT(is_packed_array() && idx < size());
+    if (type.get_array_storage() == ArrayStorageType::PackedFloat)
+    {
+        return Value((*data.value_packed_float_array)[idx]);
+    }
+    return Value((*data.value_packed_signed_integer_array)[idx]);
+}
+
+
+Value::object_vt& Value::alloc_object(size_t capacity)
+{
+    data.value_object = object_vt::create(capacity, detail::ValueMemory());
     return *data.value_object;
 }
 
@@ -142,8 +347,56 @@ Value::object_vt& Value::alloc_object()
 void Value::free_object()
 {
     JXC_DEBUG_ASSERT(data.value_object != nullptr);
-    mem::destroy<object_vt, object_allocator_t>(data.value_object);
+    // arena pairs that only use memory from the same arena have nothing to free
+    object_vt::destroy(data.value_object, items_modified || !data.value_object->is_in_arena());
     data.value_object = nullptr;
+    items_modified = false;
+}
+
+
+bool Value::only_uses_memory_from(const std::pmr::memory_resource* resource) const
+{
+    // lazy values are materialized to the heap
+    if (type.buffer == ByteBufferType::Lazy || !annotation.only_uses_memory_from(type.anno, resource))
+    {
+        return false;
+    }
+
+    switch (type.data)
+    {
+    case ValueType::String:
+        // fallthrough
+    case ValueType::Bytes:
+        return type.buffer != ByteBufferType::Owned || data.buffer_ptr.resource == resource;
+    case ValueType::Array:
+        return data.value_array == nullptr || (get_memory_resource() == resource && (is_packed_array() || !items_modified));
+    case ValueType::Object:
+        return data.value_object == nullptr || (data.value_object->get_resource() == resource && !items_modified);
+    default:
+        break;
+    }
+    return true;
+}
+
+
+void Value::update_items_modified()
+{
+    items_modified = false;
+    if (type.data == ValueType::Array && data.value_array != nullptr && !is_packed_array())
+    {
+        for (const Value& item : as_array_unchecked())
+        {
+            note_item_added(item);
+        }
+    }
+    else if (type.data == ValueType::Object && data.value_object != nullptr)
+    {
+        for (const auto& pair : as_object_unchecked())
+        {
+            note_item_added(pair.first);
+            note_item_added(pair.second);
+        }
+    }
 }
 
 
@@ -158,6 +411,12 @@ void Value::copy_from_internal(const Value& rhs)
 
     type.anno = annotation.copy_from(type.anno, rhs.type.anno, rhs.annotation);
 
+    if (type.buffer == ByteBufferType::Lazy)
+    {
+        data.lazy_token = rhs.data.lazy_token;
+        return;
+    }
+
     switch (type.data)
     {
     case ValueType::Invalid:
@@ -188,6 +447,9 @@ void Value::copy_from_internal(const Value& rhs)
         case ByteBufferType::Owned:
             alloc_buffer_from(rhs.data.get_buffer_ptr_as_string_view());
             break;
+        case ByteBufferType::Lazy:
+            // handled above
+            break;
         }
         break;
     case ValueType::Bytes:
@@ -202,24 +464,39 @@ void Value::copy_from_internal(const Value& rhs)
         case ByteBufferType::Owned:
             alloc_buffer_from(rhs.data.get_buffer_ptr_as_bytes_view());
             break;
+        case ByteBufferType::Lazy:
+            // handled above
+            break;
         }
         break;
     case ValueType::Array:
-        if (rhs.data.value_array != nullptr && rhs.data.value_array->size() > 0)
+        data.value_array = nullptr;
+        if (rhs.data.value_array != nullptr && rhs.size() > 0)
         {
-            array_vt& arr = alloc_array();
-            arr = rhs.as_array_unchecked();
+            switch (type.get_array_storage())
+            {
+            case ArrayStorageType::PackedFloat:
+                data.value_packed_float_array = packed_float_array_vt::create_copy(*rhs.data.value_packed_float_array, detail::ValueMemory());
+                break;
+            case ArrayStorageType::PackedSignedInteger:
+                data.value_packed_signed_integer_array = packed_signed_integer_array_vt::create_copy(*rhs.data.value_packed_signed_integer_array, detail::ValueMemory());
+                break;
+            default:
+                data.value_array = array_vt::create_copy(rhs.as_array_unchecked(), detail::ValueMemory());
+                update_items_modified();
+                break;
+            }
         }
         else
         {
-            data.value_array = nullptr;
+            type.set_array_storage(ArrayStorageType::Values);
         }
         break;
     case ValueType::Object:
         if (rhs.data.value_object != nullptr && rhs.data.value_object->size() > 0)
         {
-            object_vt& obj = alloc_object();
-            obj = rhs.as_object_unchecked();
+            data.value_object = object_vt::create_copy(rhs.as_object_unchecked(), detail::ValueMemory());
+            update_items_modified();
         }
         else
         {
@@ -240,15 +517,21 @@ void Value::move_from_internal(Value&& rhs)
     type = rhs.type;
     type.anno = annotation.move_from(type.anno, rhs.type.anno, std::move(rhs.annotation));
 
+    if (type.buffer == ByteBufferType::Lazy)
+    {
+        data.lazy_token = rhs.data.lazy_token;
+        return;
+    }
+
     auto move_byte_buffer = [this, &rhs]()
     {
         // move-specific logic for owned string/bytes
         JXC_DEBUG_ASSERT(&rhs != this);
         JXC_DEBUG_ASSERT(rhs.type.data == ValueType::String || rhs.type.data == ValueType::Bytes);
-        data.buffer_ptr.ptr = rhs.data.buffer_ptr.ptr;
-        data.buffer_ptr.len = rhs.data.buffer_ptr.len;
+        data.buffer_ptr = rhs.data.buffer_ptr;
         rhs.data.buffer_ptr.ptr = nullptr;
         rhs.data.buffer_ptr.len = 0;
+        rhs.data.buffer_ptr.resource = nullptr;
     };
 
     switch (type.data)
@@ -281,6 +564,9 @@ void Value::move_from_internal(Value&& rhs)
         case ByteBufferType::Owned:
             move_byte_buffer();
             break;
+        case ByteBufferType::Lazy:
+            // handled above
+            break;
         }
         break;
     case ValueType::Bytes:
@@ -295,18 +581,23 @@ void Value::move_from_internal(Value&& rhs)
         case ByteBufferType::Owned:
             move_byte_buffer();
             break;
+        case ByteBufferType::Lazy:
+            // handled above
+            break;
         }
         break;
     case ValueType::Array:
-        if (rhs.data.value_array != nullptr && rhs.data.value_array->size() > 0)
+        if (rhs.data.value_array != nullptr && rhs.size() > 0)
         {
-            // move array ownership
+            // move array ownership (the storage type was copied along with the rest of the type)
             data.value_array = rhs.data.value_array;
+            items_modified = rhs.items_modified;
             rhs.data.value_array = nullptr;
         }
         else
         {
             data.value_array = nullptr;
+            type.set_array_storage(ArrayStorageType::Values);
         }
         break;
     case ValueType::Object:
@@ -314,6 +605,7 @@ void Value::move_from_internal(Value&& rhs)
         {
             // move object ownership
             data.value_object = rhs.data.value_object;
+            items_modified = rhs.items_modified;
             rhs.data.value_object = nullptr;
         }
         else
@@ -364,6 +656,7 @@ void Value::assign_from_view(bytes_view_vt view)
 //static
 std::string Value::value_to_string_internal(const Value& val, bool repr_mode, int float_precision, bool fixed_precision)
 {
+    val.materialize_lazy();
     if (repr_mode)
     {
         return val.to_repr(float_precision, fixed_precision);
@@ -388,7 +681,7 @@ std::string Value::value_to_string_internal(const Value& val, bool repr_mode, in
     case ValueType::Bytes:
         return detail::encode_bytes_to_string(val.as_bytes_view_unchecked());
     case ValueType::Array:
-        return array_to_string_internal(val.as_array_unchecked(), repr_mode, float_precision, fixed_precision);
+        return array_to_string_internal(val, repr_mode, float_precision, fixed_precision);
     case ValueType::Object:
         return object_to_string_internal(val.as_object_unchecked(), repr_mode, float_precision, fixed_precision);
     default:
@@ -400,18 +693,23 @@ std::string Value::value_to_string_internal(const Value& val, bool repr_mode, in
 
 
 // static
-std::string Value::array_to_string_internal(const array_vt& val, bool repr_mode, int float_precision, bool fixed_precision)
+std::string Value::array_to_string_internal(const Value& val, bool repr_mode, int float_precision, bool fixed_precision)
 {
     std::ostringstream ss;
     ss << '[';
-    for (size_t i = 0; i < val.size(); i++)
+    bool first = true;
+    val.for_each_item([&](const Value& item)
     {
-        if (i > 0)
+        if (first)
+        {
+            first = false;
+        }
+        else
         {
             ss << ", ";
         }
-        ss << value_to_string_internal(val[i], repr_mode, float_precision, fixed_precision);
-    }
+        ss << value_to_string_internal(item, repr_mode, float_precision, fixed_precision);
+    });
     ss << ']';
     return ss.str();
 }
@@ -513,7 +811,7 @@ bool Value::set_annotation(std::string_view new_anno, std::string* out_anno_pars
 }
 
 
-bool Value::set_annotation(TokenView new_anno_tokens, bool as_view)
+bool Value::set_annotation(TokenView new_anno_tokens, bool as_view, const detail::ValueMemory& memory)
 {
     if (as_view)
     {
@@ -525,7 +823,7 @@ bool Value::set_annotation(TokenView new_anno_tokens, bool as_view)
     }
     else
     {
-        type.anno = annotation.assign_tokens_owned_copy_from_view(type.anno, new_anno_tokens);
+        type.anno = annotation.assign_tokens_owned_copy_from_view(type.anno, new_anno_tokens, memory.resource);
     }
     return true;
 }
@@ -585,7 +883,7 @@ TokenList Value::get_annotation_tokens() const
 
 bool Value::is_owned(bool recursive) const
 {
-    if (!is_owned_annotation())
+    if (!is_owned_annotation() || is_lazy())
     {
         return false;
     }
@@ -597,7 +895,7 @@ bool Value::is_owned(bool recursive) const
     case ValueType::Bytes:
         return is_owned_value();
     case ValueType::Array:
-        if (recursive && data.value_array != nullptr)
+        if (recursive && data.value_array != nullptr && !is_packed_array())
         {
             for (const auto& item : as_array_unchecked())
             {
@@ -628,8 +926,95 @@ bool Value::is_owned(bool recursive) const
 }
 
 
+size_t Value::get_heap_usage(bool recursive, size_t* out_num_allocations) const
+{
+    size_t num_allocations = 0;
+    size_t num_bytes = 0;
+
+    if (type.anno == AnnotationDataType::TokensOwned && annotation.tokens_owned.list != nullptr)
+    {
+        num_allocations += 1;
+        num_bytes += sizeof(TokenList);
+    }
+
+    switch (type.data)
+    {
+    case ValueType::String:
+        // fallthrough
+    case ValueType::Bytes:
+        if (type.buffer == ByteBufferType::Owned && data.buffer_ptr.ptr != nullptr)
+        {
+            num_allocations += 1;
+            num_bytes += data.buffer_ptr.len;
+        }
+        break;
+    case ValueType::Array:
+        if (data.value_array != nullptr && type.get_array_storage() == ArrayStorageType::PackedFloat)
+        {
+            num_allocations += 1;
+            num_bytes += data.value_packed_float_array->get_allocation_size();
+            if (const array_vt* items = data.value_packed_float_array->get_expanded_items())
+            {
+                num_allocations += 1;
+                num_bytes += items->get_allocation_size();
+            }
+        }
+        else if (data.value_array != nullptr && type.get_array_storage() == ArrayStorageType::PackedSignedInteger)
+        {
+            num_allocations += 1;
+            num_bytes += data.value_packed_signed_integer_array->get_allocation_size();
+            if (const array_vt* items = data.value_packed_signed_integer_array->get_expanded_items())
+            {
+                num_allocations += 1;
+                num_bytes += items->get_allocation_size();
+            }
+        }
+        else if (data.value_array != nullptr)
+        {
+            const array_vt& arr = as_array_unchecked();
+            num_allocations += 1;
+            num_bytes += arr.get_allocation_size();
+            if (recursive)
+            {
+                for (const auto& item : arr)
+                {
+                    num_bytes += item.get_heap_usage(recursive, &num_allocations);
+                }
+            }
+        }
+        break;
+    case ValueType::Object:
+        if (data.value_object != nullptr)
+        {
+            const object_vt& obj = as_object_unchecked();
+            num_allocations += 1;
+            num_bytes += obj.get_allocation_size();
+            if (recursive)
+            {
+                for (const auto& pair : obj)
+                {
+                    num_bytes += pair.first.get_heap_usage(recursive, &num_allocations);
+                    num_bytes += pair.second.get_heap_usage(recursive, &num_allocations);
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (out_num_allocations != nullptr)
+    {
+        *out_num_allocations += num_allocations;
+    }
+    return num_bytes;
+}
+
+
 Value& Value::convert_to_owned(bool recursive)
 {
+    materialize_lazy();
+
     // if annotation data is a view, convert it to owned
     if (type.anno == AnnotationDataType::TokensView)
     {
@@ -652,8 +1037,10 @@ Value& Value::convert_to_owned(bool recursive)
         }
         break;
     case ValueType::Array:
-        if (recursive && data.value_array != nullptr)
+        // packed array items have nothing to own
+        if (recursive && data.value_array != nullptr && !is_packed_array())
         {
+            items_modified = true;
             for (auto& item : as_array_unchecked())
             {
                 item.convert_to_owned(recursive);
@@ -663,8 +1050,9 @@ Value& Value::convert_to_owned(bool recursive)
     case ValueType::Object:
         if (recursive && data.value_object != nullptr)
         {
+            items_modified = true;
             object_vt& obj = as_object_unchecked();
-            for (auto& pair : obj.values())
+            for (auto& pair : obj)
             {
                 // NB. Need to be careful modifying object keys here - we don't want to change their hash value by accident.
                 const_cast<Value&>(pair.first).convert_to_owned(recursive);
@@ -693,6 +1081,7 @@ Value& Value::convert_to_owned_annotation()
 
 Value& Value::convert_to_owned_string()
 {
+    materialize_lazy();
     if (type.data != ValueType::String || type.buffer != ByteBufferType::View)
     {
         return *this;
@@ -710,7 +1099,7 @@ Value& Value::convert_to_owned_string()
     }
     else
     {
-        data.buffer_ptr.ptr = create_buffer(buf_len);
+        alloc_buffer(buf_len);
         JXC_STRNCPY((char*)data.buffer_ptr.ptr, buf_len, view.data(), buf_len);
         JXC_DEBUG_ASSERT(data.buffer_ptr.len == buf_len);
         type.buffer = ByteBufferType::Owned;
@@ -739,7 +1128,7 @@ Value& Value::convert_to_owned_bytes()
     }
     else
     {
-        data.buffer_ptr.ptr = create_buffer(buf_len);
+        alloc_buffer(buf_len);
         JXC_MEMCPY(data.buffer_ptr.ptr, buf_len, view.data(), buf_len);
         JXC_DEBUG_ASSERT(data.buffer_ptr.len == buf_len);
         type.buffer = ByteBufferType::Owned;
@@ -758,7 +1147,7 @@ Value Value::substr(size_t start, size_t count) const
 
     if (type.data == ValueType::String)
     {
-        return Value(as_string_view_unchecked().substr(start, count));
+        return Value(as_string().substr(start, count));
     }
     else
     {
@@ -777,7 +1166,7 @@ Value Value::substr_view(size_t start, size_t count) const
 
     if (type.data == ValueType::String)
     {
-        return Value(as_string_view_unchecked().substr(start, count), AsView{});
+        return Value(as_string().substr(start, count), AsView{});
     }
     else
     {
@@ -787,9 +1176,10 @@ Value Value::substr_view(size_t start, size_t count) const
 }
 
 
-void Value::resize_buffer(size_t new_size, size_t max_inline_size)
+void Value::resize_buffer(size_t new_size, size_t max_inline_size, std::pmr::memory_resource* resource)
 {
     JXC_DEBUG_ASSERT(type.data == ValueType::String || type.data == ValueType::Bytes);
+    materialize_lazy();
     if (type.buffer == ByteBufferType::Inline)
     {
         if (new_size == (size_t)data.buffer_inline.len)
@@ -805,7 +1195,7 @@ void Value::resize_buffer(size_t new_size, size_t max_inline_size)
         {
             // currently inline and the new size does not fit. need to switch to an allocated buffer.
             auto existing_data_view = as_bytes_view_unchecked();
-            uint8_t* buf = create_buffer(new_size);
+            uint8_t* buf = create_buffer(new_size, resource);
             if (existing_data_view.size() > 0)
             {
                 JXC_MEMCPY(buf, new_size, existing_data_view.data(), existing_data_view.size());
@@ -813,6 +1203,7 @@ void Value::resize_buffer(size_t new_size, size_t max_inline_size)
             data.clear();
             data.buffer_ptr.ptr = buf;
             data.buffer_ptr.len = new_size;
+            data.buffer_ptr.resource = resource;
             type.buffer = ByteBufferType::Owned;
         }
     }
@@ -825,6 +1216,7 @@ void Value::resize_buffer(size_t new_size, size_t max_inline_size)
         }
 
         auto existing_data_view = data.get_buffer_ptr_as_bytes_view();
+        std::pmr::memory_resource* existing_resource = data.buffer_ptr.resource;
         const size_t num_bytes_to_copy = std::min(existing_data_view.size(), new_size);
 
         if (new_size <= max_inline_size)
@@ -840,8 +1232,8 @@ void Value::resize_buffer(size_t new_size, size_t max_inline_size)
         }
         else
         {
-            // currently owned, new size also requires owned, so we need to reallocate
-            uint8_t* new_buf = create_buffer(new_size);
+            // currently owned, new size also requires owned, so we need to reallocate (from the same memory resource)
+            uint8_t* new_buf = create_buffer(new_size, existing_resource);
             if (num_bytes_to_copy > 0)
             {
                 JXC_MEMCPY(new_buf, new_size, existing_data_view.data(), num_bytes_to_copy);
@@ -851,13 +1243,14 @@ void Value::resize_buffer(size_t new_size, size_t max_inline_size)
         }
 
         // destroy original buffer
-        destroy_buffer(const_cast<uint8_t*>(existing_data_view.data()), existing_data_view.size());
+        destroy_buffer(const_cast<uint8_t*>(existing_data_view.data()), existing_data_view.size(), existing_resource);
     }
 }
 
 
 Value::string_view_vt Value::get_number_suffix() const
 {
+    materialize_lazy();
     switch (type.data)
     {
     case ValueType::SignedInteger:
@@ -877,6 +1270,7 @@ Value::string_view_vt Value::get_number_suffix() const
 void Value::set_number_suffix(string_view_vt new_tag)
 {
     JXC_ASSERT(new_tag.size() <= max_number_tag_len);
+    materialize_lazy();
     switch (type.data)
     {
     case ValueType::SignedInteger:
@@ -928,8 +1322,94 @@ void Value::reset()
 }
 
 
+void Value::materialize_lazy_or_invalidate() const
+{
+    // ValueParser only creates lazy values that parse successfully (strings have their escapes checked when they're parsed,
+    // and numbers that might not fit are never lazy). A lazy value built by hand that fails to parse becomes invalid.
+    ErrorInfo err;
+    (void)materialize_lazy_internal(err);
+}
+
+
+bool Value::materialize_lazy_internal(ErrorInfo& out_error) const
+{
+    JXC_DEBUG_ASSERT(type.buffer == ByteBufferType::Lazy);
+    const std::string_view token_source = { data.lazy_token.ptr, data.lazy_token.len };
+    const size_t start_idx = data.lazy_token.start_idx;
+
+    // the token has the same offsets it had in the source buffer, so errors point at the original token
+    Value result = default_invalid;
+    if (type.data == ValueType::String)
+    {
+        const Token tok(TokenType::String, start_idx, start_idx + token_source.size(), FlexString::make_view(token_source));
+        result = detail::ValueParser::make_string(tok, true, out_error);
+    }
+    else
+    {
+        const Token tok(TokenType::Number, start_idx, start_idx + token_source.size(), FlexString::make_view(token_source));
+        result = detail::ValueParser::make_number(tok, out_error);
+        JXC_DEBUG_ASSERT(result.is_invalid() || result.type.data == type.data);
+    }
+
+    // take over the parsed value's data, keeping our annotation
+    type.data = result.type.data;
+    type.buffer = result.type.buffer;
+    data = result.data;
+    result.type.reset();
+    result.data.clear();
+    return !is_invalid();
+}
+
+
+bool Value::materialize(ErrorInfo& out_error, bool recursive)
+{
+    if (is_lazy() && !materialize_lazy_internal(out_error))
+    {
+        return false;
+    }
+
+    if (recursive)
+    {
+        switch (type.data)
+        {
+        case ValueType::Array:
+            // packed arrays are never lazy
+            if (data.value_array != nullptr && !is_packed_array())
+            {
+                for (auto& item : as_array_unchecked())
+                {
+                    if (!item.materialize(out_error, recursive))
+                    {
+                        return false;
+                    }
+                }
+            }
+            break;
+        case ValueType::Object:
+            // object keys are never lazy, so only the values need to be checked
+            if (data.value_object != nullptr)
+            {
+                for (auto& pair : as_object_unchecked())
+                {
+                    if (!pair.second.materialize(out_error, recursive))
+                    {
+                        return false;
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+
 Value::size_type Value::size() const
 {
+    materialize_lazy();
     switch (type.data)
     {
         // can use the exact same logic for string and bytes - they share storage
@@ -938,7 +1418,19 @@ Value::size_type Value::size() const
     case ValueType::Bytes:
         return static_cast<size_type>(bytes_or_string_len_unchecked());
     case ValueType::Array:
-        return (data.value_array == nullptr) ? 0 : data.value_array->size();
+        if (data.value_array == nullptr)
+        {
+            return 0;
+        }
+        switch (type.get_array_storage())
+        {
+        case ArrayStorageType::PackedFloat:
+            return data.value_packed_float_array->size();
+        case ArrayStorageType::PackedSignedInteger:
+            return data.value_packed_signed_integer_array->size();
+        default:
+            return data.value_array->size();
+        }
     case ValueType::Object:
         return (data.value_object == nullptr) ? 0 : data.value_object->size();
     default:
@@ -949,8 +1441,52 @@ Value::size_type Value::size() const
 }
 
 
+bool Value::array_eq_internal(const Value& rhs) const
+{
+    JXC_DEBUG_ASSERT(type.data == ValueType::Array && rhs.type.data == ValueType::Array);
+    const size_t num_items = size();
+    if (num_items != rhs.size())
+    {
+        return false;
+    }
+    else if (num_items == 0)
+    {
+        return true;
+    }
+    else if (!is_packed_array() && !rhs.is_packed_array())
+    {
+        return as_array_unchecked() == rhs.as_array_unchecked();
+    }
+
+    // compare packed items as temporary Values so the result is the same as comparing the expanded arrays
+    for (size_t i = 0; i < num_items; i++)
+    {
+        bool items_equal = false;
+        if (is_packed_array())
+        {
+            items_equal = rhs.is_packed_array()
+                ? get_packed_array_item(i) == rhs.get_packed_array_item(i)
+                : get_packed_array_item(i) == rhs.as_array_unchecked()[i];
+        }
+        else
+        {
+            items_equal = as_array_unchecked()[i] == rhs.get_packed_array_item(i);
+        }
+
+        if (!items_equal)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 bool Value::operator==(const Value& rhs) const
 {
+    materialize_lazy();
+    rhs.materialize_lazy();
+
     if (!annotation.eq(type.anno, rhs.type.anno, rhs.annotation))
     {
         return false;
@@ -1022,13 +1558,9 @@ bool Value::operator==(const Value& rhs) const
         case ValueType::Bytes:
             return as_bytes_view_unchecked() == rhs.as_bytes_view_unchecked();
         case ValueType::Array:
-            return (data.value_array && rhs.data.value_array)
-                ? (as_array_unchecked() == rhs.as_array_unchecked())
-                : (data.value_array == rhs.data.value_array);
+            return array_eq_internal(rhs);
         case ValueType::Object:
-            return (data.value_object && rhs.data.value_object)
-                ? (as_object_unchecked() == rhs.as_object_unchecked())
-                : (data.value_object == rhs.data.value_object);
+            return as_object() == rhs.as_object();
         default:
             break;
         }
@@ -1039,6 +1571,7 @@ bool Value::operator==(const Value& rhs) const
 
 Value Value::operator-() const
 {
+    materialize_lazy();
     switch (type.data)
     {
     case ValueType::SignedInteger:
@@ -1186,17 +1719,13 @@ static uint64_t hash_bytes(BytesView value)
 }
 
 
-static uint64_t hash_array(const Value::array_vt* value)
+static uint64_t hash_array(const Value& value)
 {
-    const size_t num_items = (value != nullptr) ? value->size() : 0;
-    uint64_t result = hash_enum_hash_pair(ValueType::Array, hash_uint64(num_items));
-    if (num_items > 0)
+    uint64_t result = hash_enum_hash_pair(ValueType::Array, hash_uint64(value.size()));
+    value.for_each_item([&result](const Value& item)
     {
-        for (size_t i = 0; i < num_items; i++)
-        {
-            jxc::detail::hash_combine<uint64_t>(result, (*value)[i].hash());
-        }
-    }
+        jxc::detail::hash_combine<uint64_t>(result, item.hash());
+    });
     return result;
 }
 
@@ -1212,6 +1741,7 @@ JXC_END_NAMESPACE(tvhash)
 
 uint64_t Value::hash() const
 {
+    materialize_lazy();
     switch (type.data)
     {
     case ValueType::Invalid: return tvhash::s_hash_invalid;
@@ -1222,7 +1752,7 @@ uint64_t Value::hash() const
     case ValueType::Float: return tvhash::hash_float(data.value_float.value, data.value_float.get_tag());
     case ValueType::String: return tvhash::hash_string(as_string_view_unchecked());
     case ValueType::Bytes: return tvhash::hash_bytes(as_bytes_view_unchecked());
-    case ValueType::Array: return tvhash::hash_array(data.value_array);
+    case ValueType::Array: return tvhash::hash_array(*this);
     case ValueType::Object: return tvhash::hash_object(data.value_object);
     default: break;
     }
@@ -1240,6 +1770,7 @@ std::string Value::to_string(const SerializerSettings& settings) const
 
 std::string Value::to_repr(int float_precision, bool fixed_precision) const
 {
+    materialize_lazy();
     auto number_repr = [float_precision, fixed_precision]<typename T, size_t MaxTagLen>(const detail::TaggedNum<T, MaxTagLen>& num) -> std::string
     {
         detail::MiniBuffer<char, 48> buf;
@@ -1287,7 +1818,7 @@ std::string Value::to_repr(int float_precision, bool fixed_precision) const
         return jxc::format("Value({}, {}{})", value_type_str, detail::debug_bytes_repr(as_bytes_view_unchecked()), anno_repr());
     case ValueType::Array:
         return jxc::format("Value({}, {}{})", value_type_str,
-            data.value_array ? array_to_string_internal(as_array_unchecked(), true, float_precision, fixed_precision) : "[]", anno_repr());
+            array_to_string_internal(*this, true, float_precision, fixed_precision), anno_repr());
     case ValueType::Object:
         return jxc::format("Value({}, {}{})", value_type_str,
             data.value_object ? object_to_string_internal(as_object_unchecked(), true, float_precision, fixed_precision) : "{}", anno_repr());
@@ -1300,6 +1831,7 @@ std::string Value::to_repr(int float_precision, bool fixed_precision) const
 
 std::string Value::cast_to_string_internal(int float_precision, bool fixed_precision) const
 {
+    materialize_lazy();
     switch (type.data)
     {
     case ValueType::Invalid:
@@ -1319,7 +1851,7 @@ std::string Value::cast_to_string_internal(int float_precision, bool fixed_preci
     case ValueType::Bytes:
         return detail::encode_bytes_to_string(as_bytes_view_unchecked());
     case ValueType::Array:
-        return data.value_array ? array_to_string_internal(as_array_unchecked(), false, float_precision, fixed_precision) : "[]";
+        return array_to_string_internal(*this, false, float_precision, fixed_precision);
     case ValueType::Object:
         return data.value_object ? object_to_string_internal(as_object_unchecked(), false, float_precision, fixed_precision) : "{}";
     default:
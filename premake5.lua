@@ -38,6 +38,7 @@ project "jxc"
         "%{prj.location}/jxc/include/jxc/jxc_memory.h",
         "%{prj.location}/jxc/include/jxc/jxc_parser.h",
         "%{prj.location}/jxc/include/jxc/jxc_serializer.h",
+        "%{prj.location}/jxc/include/jxc/jxc_simd.h",
         "%{prj.location}/jxc/include/jxc/jxc_string.h",
         "%{prj.location}/jxc/include/jxc/jxc_type_traits.h",
         "%{prj.location}/jxc/include/jxc/jxc_util.h",
@@ -52,6 +53,7 @@ project "jxc"
 
         "%{prj.location}/jxc/src/jxc_parser.cpp",
         "%{prj.location}/jxc/src/jxc_serializer.cpp",
+        "%{prj.location}/jxc/src/jxc_simd.cpp",
         "%{prj.location}/jxc/src/jxc_string.cpp",
         "%{prj.location}/jxc/src/jxc_util.cpp",
 
@@ -89,9 +91,17 @@ project "jxc_cpp"
         "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_converter_enum.h",
         "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_document.h",
         "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_map.h",
+        "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_query.h",
+        "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_batch.h",
+        "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_record_index.h",
+        "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_tape.h",
         "%{prj.location}/jxc_cpp/include/jxc_cpp/jxc_value.h",
 
         "%{prj.location}/jxc_cpp/src/jxc_document.cpp",
+        "%{prj.location}/jxc_cpp/src/jxc_query.cpp",
+        "%{prj.location}/jxc_cpp/src/jxc_batch.cpp",
+        "%{prj.location}/jxc_cpp/src/jxc_record_index.cpp",
+        "%{prj.location}/jxc_cpp/src/jxc_tape.cpp",
         "%{prj.location}/jxc_cpp/src/jxc_value.cpp",
         "%{prj.location}/jxc_cpp/src/jxc_converter.cpp",
     }
@@ -101,6 +101,7 @@ ext_modules = [
             "jxc/src/jxc_lexer_gen.re.cpp",
             "jxc/src/jxc_parser.cpp",
             "jxc/src/jxc_serializer.cpp",
+            "jxc/src/jxc_simd.cpp",
             "jxc/src/jxc_string.cpp",
             "jxc/src/jxc_util.cpp",
 
@@ -388,6 +388,13 @@ TEST(jxc_cpp_converter, ConverterParseDateTimes)
 {
     EXPECT_CONV_PARSE_EQ(jxc::Date, "dt'2007-04-30'", jxc::Date(2007, 4, 30));
     EXPECT_CONV_PARSE_EQ(jxc::DateTime, "dt'2007-04-30T17:32:01Z'", jxc::DateTime(2007, 4, 30, 17, 32, 1, 0));
+
+    using namespace std::chrono;
+    EXPECT_CONV_PARSE_EQ(sys_seconds, "dt'2007-04-30T17:32:01Z'", sys_seconds(seconds(1177954321)));
+    EXPECT_CONV_PARSE_EQ(sys_seconds, "dt'2007-04-30T10:32:01-07:00'", sys_seconds(seconds(1177954321)));
+    EXPECT_CONV_PARSE_EQ(sys_seconds, "dt'2007-04-30'", sys_seconds(seconds(1177891200)));
+    EXPECT_CONV_PARSE_EQ(sys_time<milliseconds>, "dt'1969-12-31T23:59:59.250Z'", sys_time<milliseconds>(milliseconds(-750)));
+    EXPECT_CONV_PARSE_EQ(sys_time<nanoseconds>, "dt'2025-08-21T10:25:05.383201024Z'", sys_time<nanoseconds>(nanoseconds(1755771905383201024)));
 }
 
 
@@ -395,6 +402,10 @@ TEST(jxc_cpp_converter, ConverterSerializeDateTimes)
 {
     EXPECT_CONV_SERIALIZE_EQ(jxc::Date(2007, 4, 30), "dt\"2007-04-30\"");
     EXPECT_CONV_SERIALIZE_EQ(jxc::DateTime(2007, 4, 30, 17, 32, 1, 0), "dt\"2007-04-30T17:32:01Z\"");
+
+    using namespace std::chrono;
+    EXPECT_CONV_SERIALIZE_EQ(sys_seconds(seconds(1177954321)), "dt\"2007-04-30T17:32:01Z\"");
+    EXPECT_CONV_SERIALIZE_EQ(sys_time<milliseconds>(milliseconds(-750)), "dt\"1969-12-31T23:59:59.250Z\"");
 }
 
 
@@ -1033,6 +1044,88 @@ TEST(jxc_cpp_converter, TestFullyCustomStructTests)
 }
 
 
-//TODO: Add tests for structs with extra_field defined (jxc::def_extra)
+struct TestExtraFieldsStruct
+{
+    std::string name;
+    std::map<std::string, int64_t> extra_ints;
+
+    // equality operator required for tests to work
+    inline bool operator==(const TestExtraFieldsStruct& rhs) const
+    {
+        return name == rhs.name && extra_ints == rhs.extra_ints;
+    }
+};
+
+
+JXC_DEFINE_STRUCT_CONVERTER(
+    TestExtraFieldsStruct,
+    jxc::def_struct<TestExtraFieldsStruct>("TestExtraFieldsStruct")
+        .def_field("name", &TestExtraFieldsStruct::name)
+        .def_extra(
+            [](jxc::conv::Parser& parser, const std::string& field_key, TestExtraFieldsStruct& out_value)
+            {
+                // keep integer fields, and skip over anything else
+                if (parser.value().type == jxc::ElementType::Number)
+                {
+                    out_value.extra_ints.insert_or_assign(field_key, parser.parse_value<int64_t>());
+                }
+                else
+                {
+                    parser.require_skip_value();
+                }
+            })
+);
+
+
+struct TestIgnoreUnknownFieldsStruct
+{
+    int32_t id = 0;
+    bool enabled = false;
+
+    // equality operator required for tests to work
+    inline bool operator==(const TestIgnoreUnknownFieldsStruct& rhs) const
+    {
+        return id == rhs.id && enabled == rhs.enabled;
+    }
+};
+
+
+JXC_DEFINE_STRUCT_CONVERTER(
+    TestIgnoreUnknownFieldsStruct,
+    jxc::def_struct<TestIgnoreUnknownFieldsStruct>("TestIgnoreUnknownFieldsStruct", jxc::StructFlags::IgnoreUnknownFields)
+        .def_field("id", &TestIgnoreUnknownFieldsStruct::id)
+        .def_field("enabled", &TestIgnoreUnknownFieldsStruct::enabled)
+);
+
+
+TEST(jxc_cpp_converter, TestStructUnknownFields)
+{
+    EXPECT_CONV_PARSE_EQ(
+        TestExtraFieldsStruct,
+        "TestExtraFieldsStruct{ a: 1, name: 'abc', b: [1, 2, { c: 3 }], d: vec3{ x: 1, y: 2, z: 3 }, e: (1 + 2), f: -5 }",
+        (TestExtraFieldsStruct{ "abc", { { "a", 1 }, { "f", -5 } } }));
+
+    EXPECT_CONV_PARSE_EQ(
+        TestIgnoreUnknownFieldsStruct,
+        "TestIgnoreUnknownFieldsStruct{\n"
+        "    id: 5\n"
+        "    history: [ { id: 4, enabled: false }, { id: 3, tags: ['a', r'(])}')', b64'AAAA'] } ]  # ignored ]\n"
+        "    meta: !annotated<list<int>> [1, 2, 3]\n"
+        "    expr: (1 + (2 * [3]) / { x: 4 })\n"
+        "    name: 'closing brackets in strings: ]}'\n"
+        "    enabled: true\n"
+        "}",
+        (TestIgnoreUnknownFieldsStruct{ 5, true }));
+
+    // unknown fields are still an error without the flag
+    EXPECT_THROW(jxc::conv::parse<TestSimpleAutoStruct>(
+        "TestSimpleAutoStruct{ id: 1, name: 'jxc', url: null, extra: [1, 2] }"),
+        jxc::parse_error);
+
+    // skipped values still need balanced brackets
+    EXPECT_THROW(jxc::conv::parse<TestIgnoreUnknownFieldsStruct>(
+        "TestIgnoreUnknownFieldsStruct{ id: 1, extra: [1, 2, enabled: true }"),
+        jxc::parse_error);
+}
 
 
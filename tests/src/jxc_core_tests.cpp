@@ -1,4 +1,6 @@
 #include "jxc_core_tests.h"
+#include <sstream>
+#include <thread>
 
 
 struct TestJumpParser
@@ -492,6 +494,60 @@ TEST(jxc_core, JumpParserAnnotations)
 }
 
 
+TEST(jxc_core, LexerWhitespaceAndComments)
+{
+    using namespace jxc;
+
+    // long runs of indentation and long comments so that the vectorized whitespace/comment scanning is used
+    const std::string indent = std::string(70, ' ') + "\t\t" + std::string(40, ' ');
+    const std::string comment = "# " + std::string(100, 'c');
+    const std::string buf = "{\r\n"
+        + indent + "a: 1,  " + comment + "\n"
+        + indent + "\n\n"
+        + indent + "b: r'(x\ny)'\n"
+        + comment + "\n"
+        + indent + "c: (1 +" + indent + "\n"
+        + indent + "2)\n"
+        + "}" + indent;
+
+    Lexer lexer(buf.data(), buf.size());
+    ErrorInfo err;
+    std::vector<Token> tokens;
+    Token tok;
+    while (lexer.next(tok, err))
+    {
+        tokens.push_back(tok.copy());
+    }
+    ASSERT_FALSE(err.is_err) << err.to_string(buf);
+
+    const std::vector<TokenType> expected_types = {
+        TokenType::BraceOpen, TokenType::LineBreak,
+        TokenType::Identifier, TokenType::Colon, TokenType::Number, TokenType::Comma, TokenType::Comment, TokenType::LineBreak,
+        TokenType::Identifier, TokenType::Colon, TokenType::String, TokenType::LineBreak,
+        TokenType::Comment, TokenType::LineBreak,
+        TokenType::Identifier, TokenType::Colon, TokenType::ParenOpen, TokenType::Number, TokenType::Plus, TokenType::LineBreak,
+        TokenType::Number, TokenType::ParenClose, TokenType::LineBreak,
+        TokenType::BraceClose,
+    };
+
+    ASSERT_EQ(tokens.size(), expected_types.size());
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        EXPECT_EQ(tokens[i].type, expected_types[i]) << "token " << i;
+    }
+
+    // comments stop at the line break, and line break tokens never include leading or trailing indentation
+    EXPECT_EQ(tokens[1].value.as_view(), "\r\n");
+    EXPECT_EQ(tokens[6].value.as_view(), comment);
+    EXPECT_EQ(tokens[7].value.as_view(), jxc::format("\n{}\n\n", indent));
+    EXPECT_EQ(tokens[12].value.as_view(), comment);
+    EXPECT_EQ(tokens[19].value.as_view(), "\n");
+
+    // line count includes line breaks inside raw strings
+    EXPECT_EQ(lexer.line, 10u);
+}
+
+
 testing::AssertionResult test_parse_number(
     const char* jxc_number_str,
     const char* split_result_str,
@@ -609,6 +665,105 @@ TEST(jxc_core, NumberParsing)
 }
 
 
+TEST(jxc_core, NumberTokenSplit)
+{
+    using namespace jxc;
+
+    // the lexer only finds where a number ends - split_number_token_value finds its parts when the number is read
+    const std::vector<std::tuple<std::string, std::string, int32_t, std::string, bool>> numbers = {
+        // token, value, exponent, suffix, is_integer
+        { "0", "0", 0, "", true },
+        { "-1", "1", 0, "", true },
+        { "+12", "12", 0, "", true },
+        { "0_x", "0", 0, "x", true },
+        { "0%", "0", 0, "%", true },
+        { "1e5", "1", 5, "", true },
+        { "1.5E-3", "1.5", -3, "", false },
+        { "-2.0e+10_px", "2.0", 10, "px", false },
+        { "0x1f", "1f", 0, "", true },
+        { "-0xFF_u8", "FF", 0, "u8", true },
+        { "0b101%", "101", 0, "%", true },
+        { "0o777_abc", "777", 0, "abc", true },
+        { "123456789012345678901234567890", "123456789012345678901234567890", 0, "", true },
+        { "3.14159", "3.14159", 0, "", false },
+        { "1e5_e", "1", 5, "e", true },
+        { "1e-0", "1", 0, "", true },
+        { "2e-07", "2", -7, "", false },
+        { "0.0_f", "0.0", 0, "f", false },
+    };
+
+    for (const auto& [number_str, value, exponent, suffix, is_integer] : numbers)
+    {
+        Lexer lexer(number_str.data(), number_str.size());
+        Token lexed_token;
+        ErrorInfo err;
+        ASSERT_TRUE(lexer.next(lexed_token, err)) << number_str;
+        ASSERT_EQ(lexed_token.type, TokenType::Number) << number_str;
+        EXPECT_EQ(lexed_token.value.as_view(), number_str) << number_str;
+
+        util::NumberTokenSplitResult split;
+        ASSERT_TRUE(util::split_number_token_value(lexed_token, split, err)) << err.to_string(number_str);
+        EXPECT_EQ(split.value, value) << number_str;
+        EXPECT_EQ(split.exponent, exponent) << number_str;
+        EXPECT_EQ(split.suffix, suffix) << number_str;
+        EXPECT_EQ(split.is_integer(), is_integer) << number_str;
+    }
+
+    // numbers inside expressions use a different lexer rule
+    ExpressionLexer expr_lexer("1.5e3_m + x");
+    Token tok;
+    ASSERT_TRUE(expr_lexer.next(tok));
+    EXPECT_EQ(tok.type, TokenType::Number);
+    EXPECT_EQ(tok.value.as_view(), "1.5e3_m");
+    ASSERT_TRUE(expr_lexer.next(tok));
+    EXPECT_EQ(tok.type, TokenType::Plus);
+
+    // exponents scale the value by powers of 10
+    double float_value = 0.0;
+    EXPECT_TRUE(util::parse_number_simple("1.5e-3", float_value));
+    EXPECT_DOUBLE_EQ(float_value, 0.0015);
+    EXPECT_TRUE(util::parse_number_simple("-2.5E+2", float_value));
+    EXPECT_DOUBLE_EQ(float_value, -250.0);
+    EXPECT_TRUE(util::parse_number_simple("3e-2", float_value));
+    EXPECT_DOUBLE_EQ(float_value, 0.03);
+
+    // the value and exponent are parsed together, so the result is the nearest double (no double rounding)
+    EXPECT_TRUE(util::parse_number_simple("4.35e-7", float_value));
+    EXPECT_EQ(float_value, 4.35e-7);
+    EXPECT_TRUE(util::parse_number_simple("-1.7976931348623157e308", float_value));
+    EXPECT_EQ(float_value, -1.7976931348623157e308);
+    EXPECT_TRUE(util::parse_number_simple("2.2250738585072014E-308_f", float_value));
+    EXPECT_EQ(float_value, 2.2250738585072014e-308);
+    EXPECT_TRUE(util::parse_number_simple("5e-324", float_value));
+    EXPECT_EQ(float_value, 5e-324);
+
+    // when the lexer backs out of a fraction or exponent that has no digits, the number ends before it
+    const std::vector<std::pair<std::string, std::string>> partial_numbers = {
+        { "1.x", "1" }, { "2e", "2" }, { "3E+x", "3" }, { "4.5e-", "4.5" }, { "6e_x", "6" },
+    };
+    for (const auto& [input, number_str] : partial_numbers)
+    {
+        Lexer lexer(input.data(), input.size());
+        Token lexed_token;
+        ErrorInfo err;
+        ASSERT_TRUE(lexer.next(lexed_token, err)) << input;
+        ASSERT_EQ(lexed_token.type, TokenType::Number) << input;
+        EXPECT_EQ(lexed_token.value.as_view(), number_str) << input;
+
+        util::NumberTokenSplitResult split;
+        ASSERT_TRUE(util::split_number_token_value(lexed_token, split, err)) << err.to_string(input);
+        EXPECT_EQ(split.exponent, 0) << input;
+        EXPECT_EQ(split.suffix, "") << input;
+        EXPECT_EQ(split.is_floating_point(), number_str.find('.') != std::string::npos) << input;
+
+        ExpressionLexer expr_lexer(input);
+        ASSERT_TRUE(expr_lexer.next(tok)) << input;
+        ASSERT_EQ(tok.type, TokenType::Number) << input;
+        EXPECT_EQ(tok.value.as_view(), number_str) << input;
+    }
+}
+
+
 testing::AssertionResult test_parse_string_internal(const std::string& jxc_string, std::string& out_parsed_string)
 {
     jxc::JumpParser parser(jxc_string);
@@ -718,6 +873,423 @@ TEST(jxc_core, RawStringParsing)
 }
 
 
+TEST(jxc_core, LongStringParsing)
+{
+    using jxc::detail::simd::InstructionSet;
+
+    // long strings with special chars on both sides of the 16 and 32 byte vector block boundaries
+    const std::string padding(45, 'x');
+    const std::string raw_padding = padding + ")\"" + padding + ")DELI" + padding;
+    const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+    for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::SSSE3, InstructionSet::AVX2 })
+    {
+        jxc::detail::simd::set_runtime_instruction_set(iset);
+        SCOPED_TRACE(jxc::detail::simd::instruction_set_to_string(jxc::detail::simd::get_runtime_instruction_set()));
+
+        EXPECT_PARSE_STRING("'" + padding + "'", padding);
+        EXPECT_PARSE_STRING("\"" + padding + "'" + padding + "\"", padding + "'" + padding);
+        EXPECT_PARSE_STRING("'" + padding + "\\n" + padding + "\\'" + padding + "'", padding + "\n" + padding + "'" + padding);
+        EXPECT_PARSE_STRING("'" + padding + "\\x41\\u0042" + padding + "'", padding + "AB" + padding);
+        EXPECT_PARSE_STRING("r\"DELIM(" + raw_padding + "\n" + raw_padding + ")DELIM\"", raw_padding + "\n" + raw_padding);
+        EXPECT_PARSE_STRING("r\"(" + padding + ")'" + padding + ")\"", padding + ")'" + padding);
+
+        EXPECT_PARSE_STRING_FAIL("'" + padding + "\n" + padding + "'") << "line break inside string";
+        EXPECT_PARSE_STRING_FAIL("'" + padding + padding) << "missing end quote";
+        EXPECT_PARSE_STRING_FAIL("'" + padding + "\\") << "missing end quote after escape";
+        EXPECT_PARSE_STRING_FAIL("r\"DELIM(" + raw_padding + ")DELIM'") << "wrong end quote";
+    }
+    jxc::detail::simd::set_runtime_instruction_set(supported);
+}
+
+
+std::vector<std::string> parse_element_reprs(std::string_view buf, const jxc::StructuralIndex* index)
+{
+    std::vector<std::string> result;
+    jxc::JumpParser parser = (index != nullptr) ? jxc::JumpParser(buf, *index) : jxc::JumpParser(buf);
+    while (parser.next())
+    {
+        const jxc::Element& ele = parser.value();
+        result.push_back(jxc::format("{} [{}, {}]", ele.to_repr(), ele.token.start_idx, ele.token.end_idx));
+    }
+    if (parser.has_error())
+    {
+        result.push_back(jxc::format("Error: {}", parser.get_error().to_string(buf)));
+    }
+    return result;
+}
+
+
+TEST(jxc_core, StructuralIndex)
+{
+    // strings with escapes, raw strings and multiline base64 are skipped by the index, so any structural chars inside them must be ignored
+    const std::string padding(40, ' ');
+    const std::string doc = "# comment with 'quotes' and {braces}\n"
+        "vec3<'a,b'>{\n"
+        "    key: 'value', 'quoted key': \"abc\", " + padding + "escaped: 'a\\'b\\\\',\n"
+        "    raw: r\"HEREDOC(has ) \" and ] chars)HEREDOC\", bytes: b64\"( anVu\n aW9y )\",\n"
+        "    expr: (1 + 2 * [3, 4]), dt: dt'2023-01-01', # trailing comment\n"
+        "    list: [1, 2.5e3, true, null, {a: [], 'b': {}}, '" + padding + "'],\r\n"
+        "}\n";
+
+    const jxc::StructuralIndex index(doc);
+    EXPECT_TRUE(index.is_complete());
+    EXPECT_GT(index.size(), 0u);
+    EXPECT_EQ(parse_element_reprs(doc, &index), parse_element_reprs(doc, nullptr));
+
+    // the index stops at an unterminated string, and the parser should report the same error as without the index
+    const std::string bad_doc = "[1, 2, 'abc\n]";
+    const jxc::StructuralIndex bad_index(bad_doc);
+    EXPECT_FALSE(bad_index.is_complete());
+    EXPECT_EQ(parse_element_reprs(bad_doc, &bad_index), parse_element_reprs(bad_doc, nullptr));
+}
+
+
+// Parses the buffer, skipping the value of every object key that starts with `skip`, and the rest of any array with the annotation `rest`
+std::vector<std::string> parse_element_reprs_with_skips(std::string_view buf, const jxc::StructuralIndex* index)
+{
+    auto element_desc = [](const jxc::Element& ele)
+    {
+        return jxc::format("{} {}", jxc::element_type_to_string(ele.type), ele.token.value.as_view());
+    };
+
+    std::vector<std::string> result;
+    jxc::JumpParser parser = (index != nullptr) ? jxc::JumpParser(buf, *index) : jxc::JumpParser(buf);
+    while (parser.next())
+    {
+        const jxc::Element& ele = parser.value();
+        result.push_back(element_desc(ele));
+        if (ele.type == jxc::ElementType::ObjectKey && ele.token.value.as_view().starts_with("skip"))
+        {
+            if (!parser.skip_value())
+            {
+                break;
+            }
+        }
+        else if (ele.type == jxc::ElementType::BeginArray && ele.annotation.source().as_view() == "rest")
+        {
+            if (!parser.next() || !parser.skip_to_end_of_container())
+            {
+                break;
+            }
+            result.push_back(element_desc(parser.value()));
+        }
+    }
+    if (parser.has_error())
+    {
+        result.push_back(jxc::format("Error: {}", parser.get_error().to_string(buf)));
+    }
+    return result;
+}
+
+
+TEST(jxc_core, JumpParserSkipValue)
+{
+    const std::string doc = "{\n"
+        "    a: 1\n"
+        "    skip_list: [1, [2, 3], { x: ']' }, r\"(has ] chars)\", b64\"( anVu\n aW9y )\"]  # comment with ]\n"
+        "    skip_obj: vec3<list<int>>{ x: 'a\\'}b', y: [], z: { w: (1 + [2]) } }\n"
+        "    skip_expr: (a + (b * {c}) - [d, 'e)'])\n"
+        "    skip_scalar: 'value'\n"
+        "    b: rest[1, [2], 3, {}]\n"
+        "    c: [true, null]\n"
+        "}\n";
+
+    const std::vector<std::string> expected = {
+        "BeginObject {",
+        "ObjectKey a",
+        "Number 1",
+        "ObjectKey skip_list",
+        "ObjectKey skip_obj",
+        "ObjectKey skip_expr",
+        "ObjectKey skip_scalar",
+        "ObjectKey b",
+        "BeginArray [",
+        "EndArray ]",
+        "ObjectKey c",
+        "BeginArray [",
+        "Bool true",
+        "Null null",
+        "EndArray ]",
+        "EndObject }",
+    };
+
+    const jxc::StructuralIndex index(doc);
+    EXPECT_TRUE(index.is_complete());
+    EXPECT_EQ(parse_element_reprs_with_skips(doc, nullptr), expected);
+    EXPECT_EQ(parse_element_reprs_with_skips(doc, &index), expected);
+
+    // skipping an unterminated container is an error
+    for (const std::string bad_doc : { "{ skip: [1, 2, 3 }", "{ skip: [1, 2, 3", "{ skip: { a: (1 + 2 }" })
+    {
+        const jxc::StructuralIndex bad_index(bad_doc);
+        const std::vector<std::string> result = parse_element_reprs_with_skips(bad_doc, &bad_index);
+        ASSERT_GT(result.size(), 0u);
+        EXPECT_TRUE(result.back().starts_with("Error: ")) << bad_doc;
+        EXPECT_EQ(parse_element_reprs_with_skips(bad_doc, nullptr).back().starts_with("Error: "), true) << bad_doc;
+    }
+
+    // skip_value() on a top-level container skips the whole document
+    jxc::JumpParser parser("[1, [2, 3], 4]");
+    ASSERT_TRUE(parser.next());
+    ASSERT_TRUE(parser.skip_value());
+    EXPECT_EQ(parser.value().type, jxc::ElementType::EndArray);
+    EXPECT_FALSE(parser.next());
+    EXPECT_FALSE(parser.has_error());
+}
+
+
+std::string element_desc_with_annotation(const jxc::Element& ele)
+{
+    return jxc::format("{} `{}` {}", jxc::element_type_to_string(ele.type), ele.annotation.source().as_view(), ele.token.value.as_view());
+}
+
+
+// Feeds the buffer to a PushParser in chunks of chunk_size bytes, reading all available elements after each chunk
+std::vector<std::string> push_parse_element_reprs(std::string_view buf, size_t chunk_size)
+{
+    std::vector<std::string> result;
+    jxc::PushParser parser;
+    auto read_elements = [&]()
+    {
+        while (parser.next())
+        {
+            result.push_back(element_desc_with_annotation(parser.value()));
+        }
+    };
+
+    for (size_t i = 0; i < buf.size() && !parser.has_error(); i += chunk_size)
+    {
+        parser.feed(buf.substr(i, chunk_size));
+        read_elements();
+    }
+    parser.finish();
+    read_elements();
+
+    if (parser.has_error())
+    {
+        result.push_back(jxc::format("Error: {}", parser.get_error().message));
+    }
+    return result;
+}
+
+
+// Feeds the buffer to a PushParser in two chunks, split at split_idx
+std::vector<std::string> push_parse_element_reprs_split(std::string_view buf, size_t split_idx)
+{
+    std::vector<std::string> result;
+    jxc::PushParser parser;
+    auto read_elements = [&]()
+    {
+        while (parser.next())
+        {
+            result.push_back(element_desc_with_annotation(parser.value()));
+        }
+    };
+
+    parser.feed(buf.substr(0, split_idx));
+    read_elements();
+    if (!parser.has_error())
+    {
+        parser.feed(buf.substr(split_idx));
+        read_elements();
+        parser.finish();
+        read_elements();
+    }
+
+    if (parser.has_error())
+    {
+        result.push_back(jxc::format("Error: {}", parser.get_error().message));
+    }
+    return result;
+}
+
+
+TEST(jxc_core, PushParser)
+{
+    const std::string doc = "vec3<float, Map<string, int?>> {\n"
+        "    key_a: [1, 2.5e+10_px, -0x7F, nan, true, false, null]\n"
+        "    \"string key\"  :  'string value with \\\"escapes\\\" and \\u00e9'\n"
+        "    true: r\"HEREDOC(raw ]} string\n   with newlines)HEREDOC\"\n"
+        "    bytes: b64\"aGVsbG8gd29ybGQ=\"\n"
+        "    multiline_bytes: b64'(\n        aGVs bG8g\n        d29y bGQ=\n    )'\n"
+        "    # comment\n"
+        "    dates: [dt\"2024-01-02\", dt'2024-01-02T03:04:05.678+01:00']\n"
+        "    expr: (x * 2 >= -1e5, [a], {b})\n"
+        "    nested.key*: !annotated<T> { a: { b: [[], {}] } }\n"
+        "    last: 123456789\n"
+        "}\n";
+
+    std::vector<std::string> expected;
+    jxc::JumpParser parser(doc);
+    while (parser.next())
+    {
+        expected.push_back(element_desc_with_annotation(parser.value()));
+    }
+    ASSERT_FALSE(parser.has_error()) << parser.get_error().to_string(doc);
+    ASSERT_GT(expected.size(), 40);
+
+    // every chunk size from 1 byte up produces the same elements as parsing the whole buffer at once
+    for (size_t chunk_size = 1; chunk_size <= doc.size(); chunk_size++)
+    {
+        EXPECT_EQ(push_parse_element_reprs(doc, chunk_size), expected) << "chunk_size=" << chunk_size;
+    }
+
+    // so does splitting the buffer at every offset, including right before the closing delimiter of a multi-line string
+    for (const std::string_view split_doc : { std::string_view{ doc }, std::string_view{ "[r\"HD(abc)HD\", b64\"AAAA\", b64\"( AA AA )\"]" } })
+    {
+        std::vector<std::string> split_expected;
+        jxc::JumpParser split_parser(split_doc);
+        while (split_parser.next())
+        {
+            split_expected.push_back(element_desc_with_annotation(split_parser.value()));
+        }
+        ASSERT_FALSE(split_parser.has_error()) << split_parser.get_error().to_string(split_doc);
+
+        for (size_t split_idx = 0; split_idx <= split_doc.size(); split_idx++)
+        {
+            EXPECT_EQ(push_parse_element_reprs_split(split_doc, split_idx), split_expected) << "split_idx=" << split_idx;
+        }
+    }
+
+    // elements are available as soon as they're complete
+    {
+        jxc::PushParser push_parser;
+        push_parser.feed("[1, 2");
+        ASSERT_TRUE(push_parser.next());
+        EXPECT_EQ(push_parser.value().type, jxc::ElementType::BeginArray);
+        ASSERT_TRUE(push_parser.next());
+        EXPECT_EQ(push_parser.value().token.value.as_view(), "1");
+
+        // `2` might be the start of a longer number
+        EXPECT_FALSE(push_parser.next());
+        EXPECT_TRUE(push_parser.needs_more_data());
+        EXPECT_FALSE(push_parser.has_error());
+
+        push_parser.feed("34, 'abc");
+        ASSERT_TRUE(push_parser.next());
+        EXPECT_EQ(push_parser.value().token.value.as_view(), "234");
+        EXPECT_FALSE(push_parser.next());
+        EXPECT_TRUE(push_parser.needs_more_data());
+
+        // input that has already been read is dropped from the buffer
+        push_parser.feed("def']");
+        EXPECT_EQ(push_parser.get_buffer(), ", 'abcdef']");
+        EXPECT_EQ(push_parser.get_buffer_stream_offset(), 7u);
+        ASSERT_TRUE(push_parser.next());
+        EXPECT_EQ(push_parser.value().type, jxc::ElementType::String);
+        EXPECT_EQ(push_parser.value().token.value.as_view(), "'abcdef'");
+        ASSERT_FALSE(push_parser.next());
+        push_parser.finish();
+        ASSERT_TRUE(push_parser.next());
+        EXPECT_EQ(push_parser.value().type, jxc::ElementType::EndArray);
+        EXPECT_FALSE(push_parser.next());
+        EXPECT_FALSE(push_parser.has_error());
+    }
+
+    // errors are reported without waiting for the end of the stream
+    {
+        jxc::PushParser push_parser;
+        push_parser.feed("[1, 2, @, 3");
+        EXPECT_TRUE(push_parser.next());
+        EXPECT_TRUE(push_parser.next());
+        EXPECT_TRUE(push_parser.next());
+        EXPECT_FALSE(push_parser.next());
+        EXPECT_TRUE(push_parser.has_error());
+        EXPECT_FALSE(push_parser.needs_more_data());
+    }
+
+    // incomplete input is an error once the stream is finished
+    for (const std::string_view bad_doc : { "{ a: 'abc", "[r\"HEREDOC(abc", "[r\"HERE", "{ a: b64\"YWJj" })
+    {
+        const std::vector<std::string> result = push_parse_element_reprs(bad_doc, 2);
+        ASSERT_GT(result.size(), 0);
+        EXPECT_TRUE(result.back().starts_with("Error: ")) << bad_doc;
+    }
+}
+
+
+std::vector<std::string> stream_parse_element_reprs(jxc::StreamParser& parser)
+{
+    std::vector<std::string> result;
+    while (parser.next())
+    {
+        result.push_back(element_desc_with_annotation(parser.value()));
+    }
+    if (parser.has_error())
+    {
+        result.push_back(jxc::format("Error: {}", parser.get_error().message));
+    }
+    return result;
+}
+
+
+TEST(jxc_core, StreamParser)
+{
+    std::string doc = "[\n";
+    for (size_t i = 0; i < 200; i++)
+    {
+        doc += "    { id: " + std::to_string(i) + ", name: 'item " + std::to_string(i) + "', tags: [true, null], data: b64'AAEC' }\n";
+    }
+    doc += "    b64'( AAEC AAEC )'\n";
+    doc += "    r\"HEREDOC(a raw string that is larger than the read window)HEREDOC\"\n]\n";
+
+    std::vector<std::string> expected;
+    jxc::JumpParser parser(doc);
+    while (parser.next())
+    {
+        expected.push_back(element_desc_with_annotation(parser.value()));
+    }
+    ASSERT_FALSE(parser.has_error()) << parser.get_error().to_string(doc);
+
+    for (size_t window_size : { 1, 7, 16, 100, 4096 })
+    {
+        std::istringstream stream(doc);
+        jxc::StreamParser stream_parser(stream, window_size);
+        EXPECT_EQ(stream_parse_element_reprs(stream_parser), expected) << "window_size=" << window_size;
+    }
+
+    // FILE* input
+    {
+        FILE* fp = tmpfile();
+        ASSERT_NE(fp, nullptr);
+        ASSERT_EQ(fwrite(doc.data(), 1, doc.size(), fp), doc.size());
+        rewind(fp);
+        jxc::StreamParser stream_parser(fp, 64);
+        EXPECT_EQ(stream_parse_element_reprs(stream_parser), expected);
+        fclose(fp);
+    }
+
+    // custom read function
+    {
+        size_t read_offset = 0;
+        jxc::StreamParser stream_parser([&](char* out_buffer, size_t size) -> int64_t
+        {
+            const size_t num_bytes = std::min(size, doc.size() - read_offset);
+            memcpy(out_buffer, doc.data() + read_offset, num_bytes);
+            read_offset += num_bytes;
+            return static_cast<int64_t>(num_bytes);
+        }, 32);
+        EXPECT_EQ(stream_parse_element_reprs(stream_parser), expected);
+    }
+
+    // read errors
+    {
+        jxc::StreamParser stream_parser([](char*, size_t) -> int64_t { return -1; });
+        EXPECT_FALSE(stream_parser.next());
+        EXPECT_TRUE(stream_parser.has_error());
+    }
+
+    // elements that don't fit in the max buffer size are an error
+    {
+        std::istringstream stream("[1, 2, 'this string is too long for the buffer', 3]");
+        jxc::StreamParser stream_parser(stream, 8, 16);
+        const std::vector<std::string> result = stream_parse_element_reprs(stream_parser);
+        ASSERT_EQ(result.size(), 4);
+        EXPECT_TRUE(result.back().starts_with("Error: ")) << result.back();
+    }
+}
+
+
 testing::AssertionResult test_parse_bytes(const char* jxc_string_str, const char* expected_bytes_str,
     const std::string& jxc_string, std::initializer_list<uint8_t> expected_bytes)
 {
@@ -787,6 +1359,220 @@ TEST(jxc_core, BytesParsing)
 }
 
 
+TEST(jxc_core, LongBytesParsing)
+{
+    using jxc::detail::simd::InstructionSet;
+
+    static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    auto reference_encode = [](const std::vector<uint8_t>& data) -> std::string
+    {
+        std::string result;
+        for (size_t i = 0; i < data.size(); i += 3)
+        {
+            const size_t n = std::min<size_t>(3, data.size() - i);
+            uint32_t group = static_cast<uint32_t>(data[i]) << 16;
+            group |= (n > 1) ? (static_cast<uint32_t>(data[i + 1]) << 8) : 0;
+            group |= (n > 2) ? static_cast<uint32_t>(data[i + 2]) : 0;
+            for (size_t j = 0; j < 4; j++)
+            {
+                result.push_back((j <= n) ? alphabet[(group >> (18 - 6 * j)) & 0x3F] : '=');
+            }
+        }
+        return result;
+    };
+
+    // sizes on both sides of the 12/24 byte vector block sizes
+    std::vector<size_t> sizes;
+    for (size_t i = 0; i <= 100; i++)
+    {
+        sizes.push_back(i);
+    }
+    sizes.push_back(4099);
+
+    const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+    for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::SSSE3, InstructionSet::AVX2 })
+    {
+        jxc::detail::simd::set_runtime_instruction_set(iset);
+        SCOPED_TRACE(jxc::detail::simd::instruction_set_to_string(jxc::detail::simd::get_runtime_instruction_set()));
+
+        uint32_t rng_state = 12345;
+        for (size_t size : sizes)
+        {
+            std::vector<uint8_t> data(size);
+            for (uint8_t& byte : data)
+            {
+                rng_state = rng_state * 1664525u + 1013904223u;
+                byte = static_cast<uint8_t>(rng_state >> 24);
+            }
+
+            const std::string expected_b64 = reference_encode(data);
+            std::string b64(jxc::base64::get_base64_string_size(size), '\0');
+            jxc::base64::bytes_to_base64(data.data(), data.size(), b64.data(), b64.size());
+            EXPECT_EQ(b64, expected_b64) << "size " << size;
+
+            // multiline version, with line breaks that split base64 groups
+            std::string multiline_b64;
+            for (size_t i = 0; i < b64.size(); i++)
+            {
+                multiline_b64.push_back(b64[i]);
+                if (i % 31 == 30)
+                {
+                    multiline_b64 += "\n    ";
+                }
+            }
+
+            for (const std::string& jxc_string : { "b64'" + b64 + "'", "b64'(\n" + multiline_b64 + "\n)'" })
+            {
+                jxc::JumpParser parser(jxc_string);
+                ASSERT_TRUE(parser.next()) << parser.get_error().to_string(jxc_string);
+                std::vector<uint8_t> parsed;
+                jxc::ErrorInfo err;
+                ASSERT_TRUE(jxc::util::parse_bytes_token(parser.value().token, parsed, err)) << err.to_string(jxc_string);
+                EXPECT_EQ(parsed, data) << "size " << size;
+            }
+        }
+    }
+
+    // the vectorized decoders fall back to the scalar path for chars that aren't valid base64, so the output should be identical
+    jxc::detail::simd::set_runtime_instruction_set(InstructionSet::Scalar);
+    std::vector<std::vector<uint8_t>> scalar_results;
+    for (size_t ch = 0; ch < 256; ch++)
+    {
+        std::string b64(64, 'Q');
+        b64[37] = static_cast<char>(ch);
+        std::vector<uint8_t> result(48);
+        jxc::base64::base64_to_bytes(b64.data(), b64.size(), result.data(), result.size());
+        scalar_results.push_back(result);
+    }
+    for (InstructionSet iset : { InstructionSet::SSE2, InstructionSet::SSSE3, InstructionSet::AVX2 })
+    {
+        jxc::detail::simd::set_runtime_instruction_set(iset);
+        for (size_t ch = 0; ch < 256; ch++)
+        {
+            std::string b64(64, 'Q');
+            b64[37] = static_cast<char>(ch);
+            std::vector<uint8_t> result(48);
+            jxc::base64::base64_to_bytes(b64.data(), b64.size(), result.data(), result.size());
+            EXPECT_EQ(result, scalar_results[ch]) << "char " << ch;
+        }
+    }
+    jxc::detail::simd::set_runtime_instruction_set(supported);
+}
+
+
+TEST(jxc_core, Utf8Validation)
+{
+    using jxc::detail::simd::InstructionSet;
+
+    auto find_invalid = [](const std::string& buf) -> size_t
+    {
+        jxc::ErrorInfo err;
+        if (jxc::util::validate_utf8(buf, err))
+        {
+            EXPECT_FALSE(err.is_err);
+            return std::string::npos;
+        }
+        EXPECT_TRUE(err.is_err);
+        return err.buffer_start_idx;
+    };
+
+    // each sequence, and the offset of the first invalid sequence in it (npos if valid)
+    const std::vector<std::pair<std::string, size_t>> sequences = {
+        { "", std::string::npos },
+        { "abc", std::string::npos },
+        { "\xC3\xA9", std::string::npos }, // U+00E9
+        { "\xE2\x82\xAC", std::string::npos }, // U+20AC
+        { "\xF0\x9F\x98\x80", std::string::npos }, // U+1F600
+        { "\xED\x9F\xBF", std::string::npos }, // U+D7FF
+        { "\xEE\x80\x80", std::string::npos }, // U+E000
+        { "\xF4\x8F\xBF\xBF", std::string::npos }, // U+10FFFF
+        { "\xEF\xBF\xBF\xC2\x80", std::string::npos },
+        { "\x80", 0 }, // lone continuation byte
+        { "a\xBF", 1 },
+        { "\xC3\xA9\xA9", 2 }, // extra continuation byte
+        { "\xC3", 0 }, // truncated
+        { "\xE2\x82", 0 },
+        { "\xF0\x9F\x98", 0 },
+        { "\xC3" "a", 0 },
+        { "\xE2\x82" "a", 0 },
+        { "\xF0\x9F\x98\xC3\xA9", 0 },
+        { "\xC0\xAF", 0 }, // overlong
+        { "\xC1\xBF", 0 },
+        { "\xE0\x9F\xBF", 0 },
+        { "\xF0\x8F\xBF\xBF", 0 },
+        { "\xED\xA0\x80", 0 }, // surrogates
+        { "\xED\xBF\xBF", 0 },
+        { "\xF4\x90\x80\x80", 0 }, // above U+10FFFF
+        { "\xF5\x80\x80\x80", 0 },
+        { "\xF8\x88\x80\x80\x80", 0 },
+        { "\xFE", 0 },
+        { "\xFF", 0 },
+        { "ab\xE2\x82\xAC\xE2\x82", 5 },
+    };
+
+    const InstructionSet supported = jxc::detail::simd::get_supported_instruction_set();
+    for (InstructionSet iset : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::SSSE3, InstructionSet::AVX2 })
+    {
+        jxc::detail::simd::set_runtime_instruction_set(iset);
+        SCOPED_TRACE(jxc::detail::simd::instruction_set_to_string(jxc::detail::simd::get_runtime_instruction_set()));
+
+        // move each sequence across the 16 and 32 byte vector block boundaries, with both ascii and multibyte chars before it
+        for (const std::string& prefix_char : { std::string("x"), std::string("\xC3\xA9"), std::string("\xE2\x82\xAC") })
+        {
+            for (size_t prefix_len = 0; prefix_len < 70; prefix_len += prefix_char.size())
+            {
+                std::string prefix;
+                while (prefix.size() + prefix_char.size() <= prefix_len)
+                {
+                    prefix += prefix_char;
+                }
+                for (const auto& [seq, invalid_idx] : sequences)
+                {
+                    const size_t expected = (invalid_idx == std::string::npos) ? std::string::npos : prefix.size() + invalid_idx;
+                    EXPECT_EQ(find_invalid(prefix + seq), expected) << jxc::detail::debug_string_repr(prefix + seq);
+                    EXPECT_EQ(find_invalid(prefix + seq + std::string(40, 'y')), expected) << jxc::detail::debug_string_repr(prefix + seq);
+                }
+            }
+        }
+    }
+
+    // every pair of bytes on a block boundary should match the scalar result
+    jxc::detail::simd::set_runtime_instruction_set(InstructionSet::Scalar);
+    std::vector<size_t> scalar_results;
+    std::string buf(48, 'z');
+    for (size_t pair = 0; pair < 0x10000; pair++)
+    {
+        buf[31] = static_cast<char>(pair >> 8);
+        buf[32] = static_cast<char>(pair & 0xFF);
+        scalar_results.push_back(find_invalid(buf));
+    }
+    for (InstructionSet iset : { InstructionSet::SSE2, InstructionSet::SSSE3, InstructionSet::AVX2 })
+    {
+        jxc::detail::simd::set_runtime_instruction_set(iset);
+        for (size_t pair = 0; pair < 0x10000; pair++)
+        {
+            buf[31] = static_cast<char>(pair >> 8);
+            buf[32] = static_cast<char>(pair & 0xFF);
+            EXPECT_EQ(find_invalid(buf), scalar_results[pair]) << "pair " << pair;
+        }
+    }
+    jxc::detail::simd::set_runtime_instruction_set(supported);
+
+    // JumpParser reports the invalid byte before parsing anything
+    const std::string jxc_buf = "[1, 'abc', 'd\xC3\xA9', 'e\xED\xA0\x80']";
+    jxc::JumpParser parser(jxc_buf);
+    EXPECT_FALSE(parser.validate_utf8());
+    EXPECT_FALSE(parser.next());
+    ASSERT_TRUE(parser.has_error());
+    EXPECT_EQ(parser.get_error().buffer_start_idx, 20);
+
+    const std::string valid_jxc_buf = jxc_buf.substr(0, 16) + "]";
+    jxc::JumpParser valid_parser(valid_jxc_buf);
+    EXPECT_TRUE(valid_parser.validate_utf8());
+    EXPECT_TRUE(valid_parser.next());
+}
+
+
 TEST(jxc_core, DateToISO8601)
 {
     using jxc::Date, jxc::date_to_iso8601;
@@ -896,6 +1682,90 @@ TEST(jxc_core, DateTimeParsing)
     EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.383Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25, 5, 383000000));
     EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.38Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25, 5, 380000000));
     EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.4Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25, 5, 400000000));
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.3832010249Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25, 5, 383201024));
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.383201024999Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25, 5, 383201024));
+
+    // timezones, and shapes that aren't handled by the fixed-layout fast path
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05'", jxc::DateTime::make_local(2025, 8, 21, 10, 25, 5));
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05.5-08:30'", jxc::DateTime(2025, 8, 21, 10, 25, 5, 500000000, -8, 30));
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25:05+05:00'", jxc::DateTime(2025, 8, 21, 10, 25, 5, 0, 5, 0));
+    EXPECT_PARSE_DATETIME("dt'2025-08-21T10:25Z'", jxc::DateTime::make_utc(2025, 8, 21, 10, 25));
+    EXPECT_PARSE_DATETIME("dt'+12025-08-21T10:25:05Z'", jxc::DateTime::make_utc(12025, 8, 21, 10, 25, 5));
+}
+
+
+TEST(jxc_core, DateTimeEpochConversion)
+{
+    using namespace jxc;
+
+    auto parse_epoch_ns = [](const std::string& jxc_string) -> int64_t
+    {
+        JumpParser parser(jxc_string);
+        EXPECT_TRUE(parser.next());
+        int64_t result = 0;
+        ErrorInfo err;
+        EXPECT_TRUE(util::parse_datetime_token_to_epoch_nanoseconds(parser.value().token, result, err)) << err.to_string(jxc_string);
+        return result;
+    };
+
+    EXPECT_EQ(parse_epoch_ns("dt'1970-01-01'"), 0);
+    EXPECT_EQ(parse_epoch_ns("dt'1970-01-01T00:00:00.000000001Z'"), 1);
+    EXPECT_EQ(parse_epoch_ns("dt'1969-12-31T23:59:59Z'"), -1000000000);
+    EXPECT_EQ(parse_epoch_ns("dt'2025-08-21T10:25:05.383201024Z'"), 1755771905383201024);
+    EXPECT_EQ(parse_epoch_ns("dt'2025-08-21T02:25:05.383201024-08:00'"), 1755771905383201024);
+    EXPECT_EQ(parse_epoch_ns("dt'2025-08-21T10:25:05.383201024'"), 1755771905383201024);
+
+    // out of range for int64 nanoseconds
+    {
+        const std::string buf = "dt'1600-01-01'";
+        JumpParser parser(buf);
+        ASSERT_TRUE(parser.next());
+        int64_t result = 0;
+        ErrorInfo err;
+        EXPECT_FALSE(util::parse_datetime_token_to_epoch_nanoseconds(parser.value().token, result, err));
+        EXPECT_TRUE(err.is_err);
+    }
+
+    // the fixed layouts skip DateTime, so check that they agree with the DateTime path (and that the other layouts still work)
+    for (std::string_view jxc_string : {
+        "dt'2024-02-29'", "dt'1969-07-20T20:17:40Z'", "dt'2025-08-21T10:25:05.5-08:30'", "dt'2025-08-21T10:25:05-00:30'",
+        "dt'2025-08-21T10:25:05.123456789012+05:45'", "dt'2025-08-21T10:25:05'", "dt'0001-01-01T00:00:00Z'",
+        "dt'2025-08-21T10:25Z'", "dt'+12025-08-21T10:25:05Z'", "dt'-0044-03-15'" })
+    {
+        JumpParser parser(jxc_string);
+        ASSERT_TRUE(parser.next()) << jxc_string;
+        ErrorInfo err;
+        DateTime dt;
+        ASSERT_TRUE(util::parse_datetime_token(parser.value().token, dt, err)) << err.to_string(jxc_string);
+        int64_t seconds = 0;
+        uint32_t nanosecond = 0;
+        ASSERT_TRUE(util::parse_datetime_token_to_epoch(parser.value().token, seconds, nanosecond, err)) << err.to_string(jxc_string);
+        EXPECT_EQ(seconds, datetime_to_epoch_seconds(dt)) << jxc_string;
+        EXPECT_EQ(nanosecond, dt.nanosecond) << jxc_string;
+    }
+
+    // errors still come from the general parser (the lexer wouldn't produce this token)
+    {
+        const std::string buf = "dt'2025-08-21T10:25:05.Z'";
+        const Token tok(TokenType::DateTime, 0, buf.size(), FlexString::make_view(buf));
+        int64_t seconds = 0;
+        uint32_t nanosecond = 0;
+        ErrorInfo err;
+        EXPECT_FALSE(util::parse_datetime_token_to_epoch(tok, seconds, nanosecond, err));
+        EXPECT_TRUE(err.is_err);
+    }
+
+    EXPECT_EQ(datetime_to_epoch_seconds(DateTime(1600, 1, 1)), -11676096000);
+    EXPECT_EQ(epoch_seconds_to_datetime(-11676096000), DateTime(1600, 1, 1));
+    EXPECT_EQ(epoch_nanoseconds_to_datetime(-1), DateTime::make_utc(1969, 12, 31, 23, 59, 59, 999999999));
+    EXPECT_EQ(epoch_nanoseconds_to_datetime(1755771905383201024), DateTime::make_utc(2025, 8, 21, 10, 25, 5, 383201024));
+
+    // round trip a range of days, including leap years and negative years
+    for (int64_t day = -800000; day <= 800000; day += 997)
+    {
+        const DateTime dt = epoch_seconds_to_datetime(day * 86400 + 3723);
+        EXPECT_EQ(datetime_to_epoch_seconds(dt), day * 86400 + 3723);
+    }
 }
 
 
@@ -1056,3 +1926,134 @@ TEST(jxc_core, SerializerSimple)
         "vec3{x:0,y:1,z:2}");
 
 }
+
+
+TEST(jxc_core, JumpParserProfiler)
+{
+    jxc::JumpParser::reset_profiler();
+    jxc::JumpParser::set_profiler_trace_enabled(true);
+
+    // parse on several threads at once - each thread records into its own profiler buffer
+    const std::string_view doc = "{ a: [1, 2, 3], b: { c: null, d: (1 + 2) }, e: 'str' }";
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++)
+    {
+        threads.emplace_back([doc]()
+        {
+            for (size_t iter = 0; iter < 100; iter++)
+            {
+                jxc::JumpParser parser(doc);
+                while (parser.next()) {}
+                EXPECT_FALSE(parser.has_error());
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // exited threads only contribute to the totals, so record some trace events on this thread
+    {
+        jxc::JumpParser parser(doc);
+        while (parser.next()) {}
+        EXPECT_FALSE(parser.has_error());
+    }
+
+    const std::string results = jxc::JumpParser::get_profiler_results();
+    const std::string trace = jxc::JumpParser::get_profiler_trace_json();
+    if (!jxc::is_profiler_enabled())
+    {
+        EXPECT_TRUE(results.empty());
+        EXPECT_TRUE(trace.empty());
+        EXPECT_FALSE(jxc::JumpParser::is_profiler_trace_enabled());
+        jxc::JumpParser::set_profiler_trace_enabled(false);
+        return;
+    }
+
+    EXPECT_NE(results.find("jp_arrayvalue"), std::string::npos);
+    EXPECT_NE(results.find("(5 threads)"), std::string::npos) << results;
+
+    // the trace is JSON, which is also valid JXC
+    jxc::JumpParser trace_parser(trace);
+    size_t num_events = 0;
+    while (trace_parser.next())
+    {
+        if (trace_parser.value().type == jxc::ElementType::String && trace_parser.value().token.value.as_view() == "\"X\"")
+        {
+            ++num_events;
+        }
+    }
+    EXPECT_FALSE(trace_parser.has_error()) << trace_parser.get_error().to_string(trace);
+    EXPECT_GT(num_events, 0);
+
+    // trace events from exited threads are freed, so only this thread has a track
+    size_t num_tracks = 0;
+    for (size_t pos = trace.find("\"thread_name\""); pos != std::string::npos; pos = trace.find("\"thread_name\"", pos + 1))
+    {
+        ++num_tracks;
+    }
+    EXPECT_EQ(num_tracks, 1);
+
+    // with trace capture off, blocks are still timed but no trace events are recorded
+    jxc::JumpParser::set_profiler_trace_enabled(false);
+    jxc::JumpParser::reset_profiler();
+    {
+        jxc::JumpParser parser(doc);
+        while (parser.next()) {}
+        EXPECT_FALSE(parser.has_error());
+    }
+    EXPECT_NE(jxc::JumpParser::get_profiler_results().find("jp_arrayvalue"), std::string::npos);
+    EXPECT_EQ(jxc::JumpParser::get_profiler_trace_json().find("\"ph\":\"X\""), std::string::npos);
+
+    jxc::JumpParser::reset_profiler();
+    EXPECT_EQ(jxc::JumpParser::get_profiler_results().find("jp_arrayvalue"), std::string::npos);
+}
+
+
+TEST(jxc_core, JumpParserStats)
+{
+    const std::string_view doc = R"JXC(vec3{ x: 1.5, 'y': "a\nb", z: [ 1_px, 2_px, vec3 null ] })JXC";
+
+    jxc::ParseStats stats;
+    jxc::JumpParser parser(doc);
+    parser.set_stats(&stats);
+    while (parser.next()) {}
+    ASSERT_FALSE(parser.has_error()) << parser.get_error().to_string(doc);
+
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::BeginObject), 1);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::ObjectKey), 3);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::Number), 3);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::String), 1);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::Null), 1);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::EndArray), 1);
+    EXPECT_EQ(stats.max_depth, 2);
+
+    // the key `'y'` and the value `"a\nb"` (measured in source chars, before unescaping)
+    EXPECT_EQ(stats.string_bytes, 5);
+    EXPECT_EQ(stats.num_strings_with_escapes, 1);
+    EXPECT_EQ(stats.num_annotations, 2);
+    EXPECT_EQ(stats.get_num_unique_annotations(), 1);
+    EXPECT_EQ(stats.num_number_suffixes, 2);
+
+    // stats accumulate across parsers until reset, and skipped values aren't counted
+    jxc::JumpParser skip_parser(doc);
+    skip_parser.set_stats(&stats);
+    ASSERT_TRUE(skip_parser.next());
+    ASSERT_TRUE(skip_parser.skip_value());
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::BeginObject), 2);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::ObjectKey), 3);
+    EXPECT_EQ(stats.num_annotations, 3);
+    EXPECT_EQ(stats.get_num_unique_annotations(), 1);
+
+    jxc::ParseStats merged;
+    merged.merge(stats);
+    merged.merge(stats);
+    EXPECT_EQ(merged.get_element_count(jxc::ElementType::BeginObject), 4);
+    EXPECT_EQ(merged.max_depth, 2);
+    EXPECT_EQ(merged.get_num_unique_annotations(), 1);
+
+    stats.reset();
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::BeginObject), 0);
+    EXPECT_EQ(stats.get_num_unique_annotations(), 0);
+}
@@ -2,6 +2,7 @@
 #include "gtest/gtest.h"
 #include "jxc_tests.h"
 #include "jxc/jxc.h"
+#include "jxc/jxc_simd.h"
 
 
 // time conversion helpers useful for the date/datetime tests
@@ -1,5 +1,10 @@
 #include "jxc_cpp_tests.h"
 #include "jxc/jxc_serializer.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
 
 // minimal, no-whitespace serializer settings for ease of test string comparisons
 static const jxc::SerializerSettings settings_minimal = {
@@ -283,3 +288,1360 @@ TEST(jxc_cpp_value, ToString)
     EXPECT_EQ(Value(jxc::default_array).to_string(settings_minimal), "[]");
     EXPECT_EQ(Value(jxc::default_object).to_string(settings_minimal), "{}");
 }
+
+
+TEST(jxc_cpp_value, Query)
+{
+    using jxc::Value;
+
+    const std::string doc = R"JXC(
+    {
+        servers: [
+            { name: "alpha", listen: { port: 8080, host: "localhost" }, tags: ["a", "b"] }
+            { name: "beta", listen: { port: 9090 }, tags: [] }
+            { name: "gamma", skipped: (1 + 2), listen: [1, 2] }
+        ]
+        port_min: 1000
+        port_max: 2000
+        "key.with.dots": true
+        "esc\"aped": 5
+    }
+    )JXC";
+
+    auto query_ints = [&doc](std::string_view path) -> std::vector<int64_t>
+    {
+        jxc::ErrorInfo err;
+        std::vector<int64_t> result;
+        for (const Value& val : jxc::query(doc, path, err))
+        {
+            result.push_back(val.as_integer());
+        }
+        EXPECT_FALSE(err.is_err) << err.to_string(doc);
+        return result;
+    };
+
+    EXPECT_EQ(query_ints("servers[*].listen.port"), (std::vector<int64_t>{ 8080, 9090 }));
+    EXPECT_EQ(query_ints("servers[1].listen.port"), (std::vector<int64_t>{ 9090 }));
+    EXPECT_EQ(query_ints("servers[5].listen.port"), (std::vector<int64_t>{}));
+    EXPECT_EQ(query_ints("servers[2].listen[*]"), (std::vector<int64_t>{ 1, 2 }));
+    EXPECT_EQ(query_ints("port_*"), (std::vector<int64_t>{ 1000, 2000 }));
+    EXPECT_EQ(query_ints("*_max"), (std::vector<int64_t>{ 2000 }));
+    EXPECT_EQ(query_ints("servers.port"), (std::vector<int64_t>{}));
+    EXPECT_EQ(query_ints("'esc\"aped'"), (std::vector<int64_t>{ 5 }));
+
+    {
+        const auto result = jxc::query(doc, "servers[*].tags[*]");
+        ASSERT_EQ(result.size(), 2);
+        EXPECT_EQ(result[0].as_string(), "a");
+        EXPECT_EQ(result[1].as_string(), "b");
+    }
+
+    {
+        const auto result = jxc::query(doc, "\"key.with.dots\"");
+        ASSERT_EQ(result.size(), 1);
+        EXPECT_EQ(result[0].as_bool(), true);
+    }
+
+    {
+        // matched containers are returned whole
+        const auto result = jxc::query(doc, "servers[0].listen");
+        ASSERT_EQ(result.size(), 1);
+        EXPECT_EQ(result[0]["host"].as_string(), "localhost");
+
+        // an empty path matches the root value
+        EXPECT_EQ(jxc::query("[1, 2, 3]", "").at(0).size(), 3);
+    }
+
+    // stopping early
+    {
+        jxc::QueryPath path;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(jxc::QueryPath::compile("servers[*].name", path, err));
+        std::vector<std::string> names;
+        EXPECT_TRUE(jxc::query(doc, path, [&names](Value&& val)
+        {
+            names.push_back(std::string(val.as_string()));
+            return names.size() < 2;
+        }, err));
+        EXPECT_FALSE(err.is_err);
+        EXPECT_EQ(names, (std::vector<std::string>{ "alpha", "beta" }));
+    }
+
+    // invalid paths
+    for (std::string_view path : { ".a", "a..b", "a.", "a[", "a[x]", "a[-1]", "'a", "a'b'", "a.[0]", "[0]b" })
+    {
+        jxc::QueryPath compiled;
+        jxc::ErrorInfo err;
+        EXPECT_FALSE(jxc::QueryPath::compile(path, compiled, err)) << path;
+        EXPECT_TRUE(err.is_err) << path;
+    }
+
+    // parse errors after the first match still fail the query
+    {
+        jxc::ErrorInfo err;
+        EXPECT_EQ(jxc::query("{a: 1, b: [1, 2}", "a", err).size(), 0);
+        EXPECT_TRUE(err.is_err);
+    }
+}
+
+
+TEST(jxc_cpp_value, MappedBuffer)
+{
+    using jxc::Value;
+
+    const std::string file_path = (std::filesystem::temp_directory_path() / "jxc_cpp_tests_mapped_buffer.jxc").string();
+    {
+        std::ofstream fp(file_path, std::ios::out | std::ios::binary);
+        fp << "{ name: 'memory mapped file', values: [1, 2, 3] }";
+    }
+
+    {
+        jxc::MappedBuffer mapping;
+        std::string err;
+        ASSERT_TRUE(mapping.open(file_path, &err)) << err;
+        EXPECT_EQ(mapping.get_view(), "{ name: 'memory mapped file', values: [1, 2, 3] }");
+
+        size_t num_elements = 0;
+        jxc::JumpParser parser(mapping);
+        while (parser.next())
+        {
+            ++num_elements;
+        }
+        EXPECT_FALSE(parser.has_error());
+        EXPECT_EQ(num_elements, 10);
+
+        // the Document uses the mapping as-is instead of copying it
+        jxc::Document doc(mapping);
+        EXPECT_EQ(doc.get_buffer().data(), mapping.data());
+        Value doc_val = doc.parse();
+        EXPECT_FALSE(doc.has_error());
+        EXPECT_EQ(doc_val["values"].size(), 3);
+
+        // strings parsed as views point straight into the mapping (short strings are always stored inline, so use a longer one)
+        Value view_val = jxc::parse(mapping, true);
+        const std::string_view name = view_val["name"].as_string();
+        EXPECT_EQ(name, "memory mapped file");
+        EXPECT_GE(name.data(), mapping.data());
+        EXPECT_LE(name.data() + name.size(), mapping.data() + mapping.size());
+
+        jxc::conv::Parser conv_parser(mapping);
+        conv_parser.require_next();
+        EXPECT_EQ(conv_parser.get_buffer().data(), mapping.data());
+
+        // moving the mapping keeps it alive
+        jxc::MappedBuffer moved = std::move(mapping);
+        EXPECT_FALSE(mapping.is_open());
+        EXPECT_TRUE(moved.is_open());
+        EXPECT_EQ(jxc::parse(moved)["values"][2].as_integer(), 3);
+    }
+
+    std::filesystem::remove(file_path);
+
+    {
+        jxc::MappedBuffer mapping;
+        std::string err;
+        EXPECT_FALSE(mapping.open(file_path, &err));
+        EXPECT_FALSE(mapping.is_open());
+        EXPECT_FALSE(err.empty());
+    }
+}
+
+
+TEST(jxc_cpp_value, MappedBufferPageSized)
+{
+    using jxc::Value;
+
+    // files that fill their last page exactly still need a null byte after the data for the lexer
+    // (multiples of 64 KiB are page-sized with 4, 16, and 64 KiB pages)
+    const std::string file_path = (std::filesystem::temp_directory_path() / "jxc_cpp_tests_mapped_page.jxc").string();
+    const std::string index_path = file_path + ".jxcidx";
+    for (const size_t file_size : { size_t(64 * 1024), size_t(128 * 1024) })
+    {
+        std::string number_array = "[1";
+        while (number_array.size() + 3 < file_size)
+        {
+            number_array += ",1";
+        }
+        number_array.resize(file_size - 1, ' ');
+        number_array += "]";
+
+        const std::string long_string = "'" + std::string(file_size - 2, 'x') + "'";
+
+        for (const std::string& contents : { number_array, long_string })
+        {
+            ASSERT_EQ(contents.size(), file_size);
+            {
+                std::ofstream fp(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+                fp << contents;
+            }
+
+            jxc::MappedBuffer mapping;
+            std::string err;
+            ASSERT_TRUE(mapping.open(file_path, &err)) << err;
+            ASSERT_EQ(mapping.size(), file_size);
+            EXPECT_EQ(mapping.data()[mapping.size()], '\0');
+
+            jxc::Document doc(mapping);
+            const Value doc_val = doc.parse();
+            ASSERT_FALSE(doc.has_error()) << doc.get_error().to_string();
+            EXPECT_EQ(doc_val.size(), contents[0] == '[' ? (file_size - 2) / 2 : file_size - 2);
+
+            jxc::conv::Parser conv_parser(mapping);
+            conv_parser.require_next();
+            EXPECT_TRUE(conv_parser.parse_value<Value>() == doc_val);
+
+            // the last record of a documents layout file ends at the end of the mapping
+            std::filesystem::remove(index_path);
+            jxc::RecordFileSettings settings;
+            settings.layout = jxc::RecordLayout::Documents;
+            settings.save_rebuilt_index = false;
+            jxc::RecordFile records;
+            jxc::ErrorInfo parse_err;
+            ASSERT_TRUE(records.open(file_path, settings, parse_err)) << parse_err.to_string();
+            ASSERT_EQ(records.size(), 1);
+            Value record_val;
+            ASSERT_TRUE(records.read(0, record_val, parse_err)) << parse_err.to_string();
+            EXPECT_EQ(record_val, doc_val);
+        }
+    }
+
+    std::filesystem::remove(file_path);
+    std::filesystem::remove(index_path);
+}
+
+
+TEST(jxc_cpp_value, DocumentBufferOwnership)
+{
+    using jxc::Value;
+
+    const std::string source = "Config { name: 'a string too long to store inline', values: [1, 2, 3] }";
+
+    // string literals and C strings are copied
+    {
+        jxc::Document doc("[1, 2, 3]");
+        EXPECT_EQ(doc.parse(), Value({ 1, 2, 3 }));
+        EXPECT_FALSE(doc.has_error());
+
+        const char* c_str = source.c_str();
+        jxc::Document c_str_doc(c_str);
+        EXPECT_NE(c_str_doc.get_buffer().data(), c_str);
+        EXPECT_EQ(c_str_doc.get_buffer(), source);
+    }
+
+    // adopting a std::string doesn't copy its heap buffer
+    {
+        std::string buf = source;
+        const char* buf_data = buf.data();
+        jxc::Document doc(std::move(buf));
+        EXPECT_EQ(doc.get_buffer().data(), buf_data);
+        Value val = doc.parse();
+        EXPECT_FALSE(doc.has_error());
+        EXPECT_EQ(static_cast<size_t>(val["name"].as_string().data() - buf_data), source.find("a string too long"));
+    }
+
+    // Values can outlive the Document as long as the keep-alive handle does
+    {
+        std::shared_ptr<const char[]> buf(new char[source.size()]);
+        memcpy(const_cast<char*>(buf.get()), source.data(), source.size());
+
+        Value val;
+        std::shared_ptr<const void> keep_alive;
+        {
+            jxc::Document doc(buf, source.size());
+            EXPECT_EQ(doc.get_buffer().data(), buf.get());
+            val = doc.parse();
+            keep_alive = doc.get_keep_alive();
+        }
+        EXPECT_EQ(buf.use_count(), 2);
+        EXPECT_EQ(val["name"].as_string(), "a string too long to store inline");
+        EXPECT_EQ(val.get_annotation_source(), "Config");
+        keep_alive.reset();
+        EXPECT_EQ(buf.use_count(), 1);
+    }
+
+    // parse_with_keep_alive() bundles the handle with the Value
+    {
+        std::shared_ptr<const char[]> buf(new char[source.size()]);
+        memcpy(const_cast<char*>(buf.get()), source.data(), source.size());
+
+        jxc::ParsedValue parsed;
+        {
+            jxc::Document doc(buf, source.size());
+            parsed = doc.parse_with_keep_alive();
+            EXPECT_FALSE(doc.has_error());
+        }
+        EXPECT_EQ(buf.use_count(), 2);
+        EXPECT_EQ((*parsed)["name"].as_string().data(), buf.get() + source.find("a string too long"));
+        EXPECT_EQ((*parsed)["name"].as_string(), "a string too long to store inline");
+        EXPECT_EQ(parsed->get_annotation_source(), "Config");
+
+        // copies share the storage
+        jxc::ParsedValue copied = parsed;
+        parsed = jxc::ParsedValue{};
+        EXPECT_EQ(buf.use_count(), 2);
+        EXPECT_EQ((*copied)["values"].size(), 3);
+        copied = jxc::ParsedValue{};
+        EXPECT_EQ(buf.use_count(), 1);
+    }
+
+    // custom deleter
+    {
+        char* raw_buf = new char[source.size()];
+        memcpy(raw_buf, source.data(), source.size());
+        bool deleted = false;
+        {
+            jxc::Document doc(raw_buf, source.size(), [&deleted](const char* ptr)
+            {
+                deleted = true;
+                delete[] ptr;
+            });
+            EXPECT_EQ(doc.get_buffer().data(), raw_buf);
+            EXPECT_EQ(doc.parse()["values"].size(), 3);
+            EXPECT_FALSE(deleted);
+        }
+        EXPECT_TRUE(deleted);
+    }
+}
+
+
+TEST(jxc_cpp_value, ParallelParse)
+{
+    using jxc::Value;
+
+    // large enough that the containers get split up even with the minimum split size
+    std::string doc = "Root {\n  items: [\n";
+    for (size_t i = 0; i < 2000; i++)
+    {
+        doc += "    Item { id: " + std::to_string(i) + ", name: 'item " + std::to_string(i)
+            + "', tags: [r\"(a ] b)\", \"}\", 0x" + std::to_string(i) + "] }, # comment ]\n";
+    }
+    doc += "  ]\n  count: 2000\n  nested: { a: [1, 2, 3], b: null }\n}\n";
+
+    jxc::ParallelParseSettings settings;
+    settings.min_buffer_size = 0;
+
+    jxc::ErrorInfo serial_err;
+    const Value serial_val = jxc::parse(doc, serial_err);
+    ASSERT_FALSE(serial_err.is_err) << serial_err.to_string(doc);
+
+    for (size_t num_threads : { 1, 2, 4, 7 })
+    {
+        settings.num_threads = num_threads;
+        jxc::ErrorInfo err;
+        const Value val = jxc::parse_parallel(doc, err, settings);
+        EXPECT_FALSE(err.is_err) << err.to_string(doc);
+        EXPECT_EQ(val, serial_val);
+        EXPECT_EQ(val.get_annotation_source(), "Root");
+        EXPECT_EQ(val["items"].size(), 2000);
+        EXPECT_EQ(val["items"][1999]["name"].as_string(), "item 1999");
+    }
+
+    // errors are reported the same way as a serial parse
+    settings.num_threads = 4;
+    for (std::string_view bad_value : { "'bad\\q escape'", "[1, }", "1.2.3" })
+    {
+        std::string bad_doc = doc;
+        const size_t pos = bad_doc.find("name: 'item 1234'");
+        ASSERT_NE(pos, std::string::npos);
+        bad_doc.replace(pos + 6, 11, bad_value);
+
+        jxc::ErrorInfo expected_err;
+        const Value expected_val = jxc::parse(bad_doc, expected_err);
+        jxc::ErrorInfo err;
+        const Value val = jxc::parse_parallel(bad_doc, err, settings);
+        EXPECT_EQ(err.is_err, expected_err.is_err) << bad_value;
+        EXPECT_EQ(err.message, expected_err.message) << bad_value;
+        EXPECT_EQ(err.buffer_start_idx, expected_err.buffer_start_idx) << bad_value;
+        EXPECT_EQ(err.buffer_end_idx, expected_err.buffer_end_idx) << bad_value;
+        EXPECT_EQ(val.is_valid(), expected_val.is_valid()) << bad_value;
+    }
+}
+
+
+TEST(jxc_cpp_value, ParseMany)
+{
+    using jxc::Value;
+
+    std::vector<std::string> sources;
+    for (size_t i = 0; i < 500; i++)
+    {
+        sources.push_back((i % 100 == 42)
+            ? "{ id: " + std::to_string(i) + ", name: 'bad\\q' }"
+            : "Message { id: " + std::to_string(i) + ", tags: ['a', 'b'] }");
+    }
+    const std::vector<std::string_view> documents(sources.begin(), sources.end());
+
+    for (size_t num_threads : { 1, 3, 8 })
+    {
+        jxc::ParseManySettings settings;
+        settings.num_threads = num_threads;
+        std::vector<jxc::ErrorInfo> errors;
+        const std::vector<Value> values = jxc::parse_many(documents, errors, settings);
+        ASSERT_EQ(values.size(), documents.size());
+        ASSERT_EQ(errors.size(), documents.size());
+        for (size_t i = 0; i < documents.size(); i++)
+        {
+            if (i % 100 == 42)
+            {
+                EXPECT_TRUE(errors[i].is_err);
+                EXPECT_TRUE(values[i].is_invalid());
+                EXPECT_EQ(errors[i].buffer_start_idx, documents[i].find("'bad"));
+            }
+            else
+            {
+                EXPECT_FALSE(errors[i].is_err) << errors[i].to_string(documents[i]);
+                EXPECT_EQ(values[i]["id"].as_integer(), static_cast<int64_t>(i));
+                EXPECT_EQ(values[i].get_annotation_source(), "Message");
+            }
+        }
+
+        // converter variant
+        std::vector<std::string> array_sources;
+        for (size_t i = 0; i < 500; i++)
+        {
+            array_sources.push_back((i % 100 == 42) ? "[1, 'two']" : jxc::format("[{}, {}]", i, i * 2));
+        }
+        const std::vector<std::string_view> array_documents(array_sources.begin(), array_sources.end());
+        const auto arrays = jxc::conv::parse_many<std::vector<int64_t>>(array_documents, errors, num_threads);
+        ASSERT_EQ(arrays.size(), array_documents.size());
+        for (size_t i = 0; i < array_documents.size(); i++)
+        {
+            EXPECT_EQ(arrays[i].has_value(), i % 100 != 42);
+            EXPECT_EQ(errors[i].is_err, i % 100 == 42);
+            if (arrays[i].has_value())
+            {
+                EXPECT_EQ(*arrays[i], (std::vector<int64_t>{ static_cast<int64_t>(i), static_cast<int64_t>(i * 2) }));
+            }
+        }
+    }
+
+    // annotations survive even when returning views
+    {
+        jxc::ParseManySettings settings;
+        settings.try_return_view = true;
+        std::vector<jxc::ErrorInfo> errors;
+        const std::vector<Value> values = jxc::parse_many(documents, errors, settings);
+        EXPECT_EQ(values[0].get_annotation_source(), "Message");
+        EXPECT_EQ(jxc::parse("[vec3<int> [1]]", true)[0].get_annotation_source(), "vec3<int>");
+    }
+
+    // documents can be views into a larger buffer, and aren't parsed past their end
+    {
+        const std::string buffer = "123 [4, 5, 6] 'str'";
+        const std::vector<std::string_view> slices = {
+            std::string_view(buffer).substr(0, 2), std::string_view(buffer).substr(4, 5), std::string_view(buffer).substr(14, 5) };
+        for (const bool try_return_view : { false, true })
+        {
+            jxc::ParseManySettings settings;
+            settings.num_threads = 2;
+            settings.try_return_view = try_return_view;
+            std::vector<jxc::ErrorInfo> errors;
+            const std::vector<Value> values = jxc::parse_many(slices, errors, settings);
+            ASSERT_EQ(values.size(), slices.size());
+            EXPECT_EQ(values[0], 12);
+            EXPECT_EQ(values[1].size(), 2u);
+            EXPECT_EQ(values[2], "str");
+            EXPECT_TRUE(values[2].is_owned());
+        }
+
+        std::vector<jxc::ErrorInfo> errors;
+        const auto ints = jxc::conv::parse_many<int64_t>(std::span<const std::string_view>(slices.data(), 1), errors);
+        ASSERT_TRUE(ints[0].has_value());
+        EXPECT_EQ(*ints[0], 12);
+    }
+
+    // batch parsers keep their threads and parsers between batches of any size
+    {
+        jxc::ParseManySettings settings;
+        settings.num_threads = 4;
+        jxc::BatchParser batch_parser(settings);
+        jxc::conv::BatchParser conv_batch_parser(4);
+        EXPECT_EQ(batch_parser.get_num_workers(), 4);
+        for (size_t num_docs : { 0, 1, 3, 500, 7 })
+        {
+            const std::span<const std::string_view> batch(documents.data(), num_docs);
+            std::vector<jxc::ErrorInfo> errors;
+            const std::vector<Value> values = batch_parser.parse_many(batch, errors);
+            ASSERT_EQ(values.size(), num_docs);
+            for (size_t i = 0; i < num_docs; i++)
+            {
+                EXPECT_EQ(errors[i].is_err, i % 100 == 42);
+                EXPECT_EQ(values[i].is_valid(), i % 100 != 42);
+            }
+
+            const auto ids = conv_batch_parser.parse_many<std::vector<int64_t>>(batch, errors);
+            ASSERT_EQ(ids.size(), num_docs);
+            for (size_t i = 0; i < num_docs; i++)
+            {
+                // the documents are objects, not arrays
+                EXPECT_FALSE(ids[i].has_value());
+                EXPECT_TRUE(errors[i].is_err);
+            }
+        }
+
+        jxc::ErrorInfo err;
+        EXPECT_EQ(batch_parser.parse_lines("1\n[2, 3]\n\n{ a: 4 }\n", err), jxc::parse_lines("1\n[2, 3]\n\n{ a: 4 }\n", err));
+        EXPECT_FALSE(err.is_err);
+    }
+
+    // worker pools rethrow the first exception, skip the remaining items, and can be reused afterwards
+    {
+        jxc::WorkerPool pool(3);
+        std::atomic<size_t> num_calls = 0;
+        EXPECT_THROW(pool.run(1000, [&](size_t, size_t item_idx)
+        {
+            ++num_calls;
+            if (item_idx == 10)
+            {
+                throw std::runtime_error("item failed");
+            }
+        }), std::runtime_error);
+        EXPECT_LT(num_calls.load(), 1000u);
+
+        std::vector<size_t> item_workers(1000, jxc::invalid_idx);
+        pool.run(item_workers.size(), [&](size_t worker_idx, size_t item_idx) { item_workers[item_idx] = worker_idx; });
+        for (size_t worker_idx : item_workers)
+        {
+            EXPECT_LT(worker_idx, pool.get_num_workers());
+        }
+    }
+}
+
+
+TEST(jxc_cpp_value, JxcLines)
+{
+    using jxc::Value;
+
+    // line breaks inside strings, raw strings, containers, and comments don't end a document
+    const std::string_view buffer = R"JXC(# event log
+Event{ id: 0, msg: "first" }
+
+Event{ id: 1, msg: r"(multi
+line)" }
+Event{
+    id: 2,
+    tags: [
+        'a', 'b',  # trailing comment
+    ],
+}
+3.5  # scalar document
+null
+)JXC";
+
+    std::vector<Value> serial_values;
+    {
+        jxc::LinesReader reader(buffer);
+        for (Value& val : reader)
+        {
+            serial_values.push_back(std::move(val));
+        }
+        EXPECT_FALSE(reader.has_error()) << reader.get_error().to_string(buffer);
+        EXPECT_EQ(reader.get_num_documents(), 5);
+    }
+    ASSERT_EQ(serial_values.size(), 5);
+    EXPECT_EQ(serial_values[0].get_annotation_source(), "Event");
+    EXPECT_EQ(serial_values[1]["msg"].as_string(), "multi\nline");
+    EXPECT_EQ(serial_values[2]["tags"].size(), 2);
+    EXPECT_EQ(serial_values[3].as_float(), 3.5);
+    EXPECT_TRUE(serial_values[4].is_null());
+
+    for (size_t num_threads : { 1, 2, 4 })
+    {
+        jxc::ParseManySettings settings;
+        settings.num_threads = num_threads;
+        jxc::ErrorInfo err;
+        EXPECT_EQ(jxc::parse_lines(buffer, err, settings), serial_values);
+        EXPECT_FALSE(err.is_err) << err.to_string(buffer);
+    }
+
+    // documents on the same line are an error, even though each one is valid on its own
+    for (std::string_view bad_buffer : { std::string_view("1\n2 3\n4"), std::string_view("[1]\n[2, 3] {}\n") })
+    {
+        jxc::LinesReader reader(bad_buffer);
+        Value val;
+        while (reader.next(val)) {}
+        ASSERT_TRUE(reader.has_error());
+        EXPECT_EQ(reader.get_num_documents(), 2);
+        EXPECT_EQ(reader.get_error().line, 2);
+
+        jxc::ParseManySettings settings;
+        settings.num_threads = 2;
+        jxc::ErrorInfo err;
+        EXPECT_TRUE(jxc::parse_lines(bad_buffer, err, settings).empty());
+        EXPECT_EQ(err.message, reader.get_error().message);
+        EXPECT_EQ(err.buffer_start_idx, reader.get_error().buffer_start_idx);
+    }
+
+    // an annotation on its own line belongs to the value on the next line
+    {
+        jxc::ParseManySettings settings;
+        settings.num_threads = 2;
+        jxc::ErrorInfo err;
+        const std::vector<Value> values = jxc::parse_lines("vec3\n[1, 2, 3]\n[4]", err, settings);
+        EXPECT_FALSE(err.is_err) << err.message;
+        ASSERT_EQ(values.size(), 2);
+        EXPECT_EQ(values[0].get_annotation_source(), "vec3");
+    }
+
+    // converter variants
+    std::string array_buffer;
+    for (int64_t i = 0; i < 200; i++)
+    {
+        array_buffer += jxc::format("[{}, {}]\n", i, i * 2);
+    }
+
+    std::vector<std::vector<int64_t>> serial_arrays;
+    for (std::vector<int64_t>& arr : jxc::conv::LinesReader<std::vector<int64_t>>(array_buffer))
+    {
+        serial_arrays.push_back(std::move(arr));
+    }
+    ASSERT_EQ(serial_arrays.size(), 200);
+    EXPECT_EQ(serial_arrays[199], (std::vector<int64_t>{ 199, 398 }));
+    EXPECT_EQ(jxc::conv::parse_lines<std::vector<int64_t>>(array_buffer, 4), serial_arrays);
+
+    array_buffer += "[1, 'two']\n";
+    EXPECT_THROW(jxc::conv::parse_lines<std::vector<int64_t>>(array_buffer, 4), jxc::parse_error);
+}
+
+
+TEST(jxc_cpp_value, RecordIndex)
+{
+    using jxc::Value;
+
+    const std::string file_path = (std::filesystem::temp_directory_path() / "jxc_cpp_tests_records.jxc").string();
+    const std::string index_path = file_path + ".jxcidx";
+    std::filesystem::remove(index_path);
+
+    auto write_records = [&file_path](const std::string& name_prefix)
+    {
+        std::ofstream fp(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        fp << "# record file\n[\n";
+        for (size_t i = 0; i < 100; i++)
+        {
+            // the nested `id` key should never be used as the record's key
+            fp << "    Record{ meta: { id: 'nested' }, id: '" << name_prefix << i << "', n: " << i << " },\n";
+        }
+        fp << "]\n";
+    };
+    write_records("rec-");
+
+    jxc::RecordFileSettings settings;
+    settings.key_field = "id";
+    {
+        jxc::RecordFile records;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(records.open(file_path, settings, err)) << err.to_string();
+        EXPECT_TRUE(records.was_index_rebuilt());
+        EXPECT_TRUE(std::filesystem::exists(index_path));
+        ASSERT_EQ(records.size(), 100);
+
+        Value val;
+        ASSERT_TRUE(records.read(57, val, err)) << err.to_string();
+        EXPECT_EQ(val["n"].as_integer(), 57);
+        EXPECT_EQ(val.get_annotation_source(), "Record");
+        EXPECT_EQ(records.read<Value>(3)["id"].as_string(), "rec-3");
+
+        // errors from read<T> have offsets into the file, like read() does
+        try
+        {
+            (void)records.read<std::string>(3);
+            ADD_FAILURE() << "Expected read<std::string> to throw";
+        }
+        catch (const jxc::parse_error& e)
+        {
+            const jxc::ErrorInfo& read_err = e.get_error();
+            EXPECT_GE(read_err.buffer_start_idx, records.get_index()[3].start_idx);
+            EXPECT_LT(read_err.buffer_start_idx, records.get_index()[4].start_idx);
+            EXPECT_EQ(read_err.line, 6);
+        }
+
+        EXPECT_EQ(records.find("rec-42"), std::optional<size_t>(42));
+        EXPECT_EQ(records.find("nested"), std::nullopt);
+        EXPECT_EQ(records.find("rec-100"), std::nullopt);
+    }
+
+    // the saved sidecar is reused, and matches a freshly built index
+    {
+        jxc::RecordFile records;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(records.open(file_path, settings, err)) << err.to_string();
+        EXPECT_FALSE(records.was_index_rebuilt());
+
+        jxc::RecordIndex built;
+        ASSERT_TRUE(jxc::RecordIndex::build(records.get_buffer(), jxc::RecordLayout::ArrayElements, "id", built, err));
+        ASSERT_EQ(built.size(), records.size());
+        for (size_t i = 0; i < built.size(); i++)
+        {
+            EXPECT_EQ(built[i], records.get_index()[i]);
+        }
+        EXPECT_EQ(records.find("rec-99"), std::optional<size_t>(99));
+    }
+
+    // same size and modified time, but different content - only the content hash check catches it
+    {
+        const auto modified_time = std::filesystem::last_write_time(file_path);
+        write_records("REC-");
+        std::filesystem::last_write_time(file_path, modified_time);
+
+        jxc::RecordFile records;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(records.open(file_path, settings, err)) << err.to_string();
+        EXPECT_FALSE(records.was_index_rebuilt());
+
+        settings.verify_content_hash = true;
+        settings.rebuild_if_stale = false;
+        EXPECT_FALSE(records.open(file_path, settings, err));
+        EXPECT_TRUE(err.is_err);
+
+        settings.rebuild_if_stale = true;
+        ASSERT_TRUE(records.open(file_path, settings, err)) << err.to_string();
+        EXPECT_TRUE(records.was_index_rebuilt());
+        EXPECT_EQ(records.find("REC-42"), std::optional<size_t>(42));
+    }
+
+    // a corrupt sidecar is rebuilt
+    {
+        {
+            std::ofstream fp(index_path, std::ios::out | std::ios::binary | std::ios::trunc);
+            fp << "JXCINDEX";
+        }
+        jxc::RecordFile records;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(records.open(file_path, settings, err)) << err.to_string();
+        EXPECT_TRUE(records.was_index_rebuilt());
+        EXPECT_EQ(records.size(), 100);
+    }
+
+    std::filesystem::remove(file_path);
+    std::filesystem::remove(index_path);
+
+    // documents layout
+    {
+        const std::string_view buffer = "{ id: 1 }\n# comment\n[\n  2, 3\n]\nnull\n";
+        jxc::RecordIndex index;
+        jxc::ErrorInfo err;
+        ASSERT_TRUE(jxc::RecordIndex::build(buffer, jxc::RecordLayout::Documents, "id", index, err)) << err.to_string(buffer);
+        ASSERT_EQ(index.size(), 3);
+        EXPECT_EQ(index.get_record_source(buffer, 0), "{ id: 1 }");
+        EXPECT_EQ(index.get_record_source(buffer, 1), "[\n  2, 3\n]");
+        EXPECT_EQ(index.get_record_source(buffer, 2), "null");
+        EXPECT_EQ(index.find_key_candidates("1"), std::vector<size_t>{ 0 });
+
+        EXPECT_FALSE(jxc::RecordIndex::build(buffer, jxc::RecordLayout::ArrayElements, "", index, err));
+        EXPECT_EQ(err.message, "Expected a top-level array");
+    }
+}
+
+
+TEST(jxc_cpp_value, ParseStatsHeapUsage)
+{
+    // inline strings and scalars don't allocate
+    EXPECT_EQ(jxc::Value("short").get_heap_usage(), 0);
+    EXPECT_EQ(jxc::Value(42).get_heap_usage(), 0);
+
+    size_t num_allocations = 0;
+    const std::string long_str(100, 'x');
+    EXPECT_EQ(jxc::Value(long_str).get_heap_usage(false, &num_allocations), 100);
+    EXPECT_EQ(num_allocations, 1);
+
+    const std::string doc = "[ 1, 2, { key: '" + long_str + "', other: [] } ]";
+    jxc::ParseStats stats;
+    jxc::ErrorInfo err;
+    jxc::JumpParser parser(doc);
+    parser.set_stats(&stats);
+    jxc::detail::ValueParser value_parser(parser, err);
+    value_parser.stats = &stats;
+    ASSERT_TRUE(parser.next());
+    jxc::Value result = value_parser.parse(parser.value());
+    ASSERT_FALSE(err.is_err || parser.has_error());
+
+    // the stats count every Value separately, so they should match the recursive heap usage of the result
+    size_t result_allocations = 0;
+    EXPECT_EQ(stats.value_heap_bytes, result.get_heap_usage(true, &result_allocations));
+    EXPECT_EQ(stats.value_heap_allocations, result_allocations);
+    EXPECT_GT(stats.value_heap_bytes, 100u);
+    EXPECT_EQ(stats.get_element_count(jxc::ElementType::BeginArray), 2);
+}
+
+
+TEST(jxc_cpp_value, ArenaAllocation)
+{
+    // tracks outstanding allocations so we can check that values free their memory to the right place
+    struct CountingResource : public std::pmr::memory_resource
+    {
+        size_t num_allocations = 0;
+        int64_t outstanding_bytes = 0;
+
+        void* do_allocate(size_t num_bytes, size_t alignment) override
+        {
+            ++num_allocations;
+            outstanding_bytes += static_cast<int64_t>(num_bytes);
+            return std::pmr::new_delete_resource()->allocate(num_bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, size_t num_bytes, size_t alignment) override
+        {
+            outstanding_bytes -= static_cast<int64_t>(num_bytes);
+            std::pmr::new_delete_resource()->deallocate(ptr, num_bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& rhs) const noexcept override { return this == &rhs; }
+    };
+
+    const std::string long_str(64, 'x');
+    const std::string buf = "{ a: [1, 2, 3], b: '" + long_str + "', c: { d: null } }";
+
+    CountingResource counter;
+    {
+        jxc::Value arena_value;
+        {
+            jxc::Document owned_doc(buf);
+            owned_doc.set_memory_resource(&counter);
+            arena_value = owned_doc.parse_to_owned();
+            ASSERT_FALSE(owned_doc.has_error()) << owned_doc.get_error().to_string(buf);
+        }
+        EXPECT_GT(counter.num_allocations, 0u);
+        EXPECT_EQ(arena_value.get_memory_resource(), &counter);
+        EXPECT_EQ(arena_value["a"].get_memory_resource(), &counter);
+        EXPECT_EQ(arena_value["b"].get_memory_resource(), &counter);
+
+        // copies are heap-allocated
+        const size_t num_allocations_before_copy = counter.num_allocations;
+        jxc::Value heap_copy = arena_value;
+        EXPECT_EQ(heap_copy, arena_value);
+        EXPECT_EQ(heap_copy.get_memory_resource(), nullptr);
+        EXPECT_EQ(heap_copy["a"].get_memory_resource(), nullptr);
+        EXPECT_EQ(heap_copy["b"].get_memory_resource(), nullptr);
+        EXPECT_EQ(counter.num_allocations, num_allocations_before_copy);
+
+        // containers keep using the resource they came from when they grow
+        for (int64_t i = 4; i < 32; i++)
+        {
+            arena_value["a"].push_back(i);
+        }
+        EXPECT_EQ(arena_value["a"].get_memory_resource(), &counter);
+        EXPECT_GT(counter.num_allocations, num_allocations_before_copy);
+
+        // Document::parse() can use a resource too
+        jxc::Document doc(buf);
+        doc.set_memory_resource(&counter);
+        jxc::Value doc_value = doc.parse();
+        ASSERT_FALSE(doc.has_error());
+        EXPECT_EQ(doc_value, heap_copy);
+        EXPECT_EQ(doc_value["c"].get_memory_resource(), &counter);
+        EXPECT_FALSE(doc_value.as_object().is_in_arena());
+    }
+    EXPECT_EQ(counter.outstanding_bytes, 0);
+
+    // arena parsing
+    jxc::ValueArena arena;
+    jxc::ErrorInfo err;
+    jxc::Value arena_result = jxc::parse(buf, err, arena);
+    ASSERT_FALSE(err.is_err);
+    EXPECT_EQ(arena_result["c"].get_memory_resource(), arena.get_resource());
+    EXPECT_TRUE(arena_result.as_object().is_in_arena());
+    EXPECT_TRUE(arena_result["a"].as_array().is_in_arena());
+    EXPECT_FALSE(jxc::Value(arena_result).as_object().is_in_arena());
+    EXPECT_EQ(arena_result, jxc::parse(buf));
+    EXPECT_EQ(jxc::parse(buf).get_memory_resource(), nullptr);
+
+    // owned annotations come from the memory resource too, including long annotations that don't fit in one allocation
+    const std::string long_anno = "std.map<key_type_with_a_long_name, " + std::string(40, 'v') + ">";
+    const std::string anno_buf = "vec3<float, 3>[ " + long_anno + "{ x: 1, y: '" + long_str + "' }, "
+        "tuple<a, b, c, d, e, f, g, h, i, j>[1, 2], list<int>[3, 4] ]";
+    {
+        jxc::Document anno_doc(anno_buf);
+        anno_doc.set_memory_resource(&counter);
+        jxc::Value anno_value = anno_doc.parse_to_owned();
+        ASSERT_FALSE(anno_doc.has_error()) << anno_doc.get_error().to_string(anno_buf);
+        EXPECT_EQ(anno_value.get_annotation_source(), "vec3<float, 3>");
+        EXPECT_EQ(anno_value[0].get_annotation_source(), long_anno);
+        EXPECT_EQ(anno_value, jxc::parse(anno_buf));
+    }
+    EXPECT_EQ(counter.outstanding_bytes, 0);
+
+    // arena trees can be copied to the heap, then dropped without freeing anything, even after adding heap values to them
+    jxc::Value heap_copy;
+    {
+        jxc::Value anno_result = jxc::parse(anno_buf, err, arena);
+        ASSERT_FALSE(err.is_err) << err.to_string(anno_buf);
+        heap_copy = anno_result;
+        anno_result[1].push_back(jxc::Value(long_str));
+        anno_result.push_back(heap_copy);
+        EXPECT_EQ(anno_result[1].size(), 3);
+        EXPECT_EQ(anno_result[3], heap_copy);
+    }
+    arena_result = jxc::Value();
+    arena.release();
+    EXPECT_EQ(heap_copy, jxc::parse(anno_buf));
+    EXPECT_EQ(heap_copy[0].get_annotation_source(), long_anno);
+    EXPECT_EQ(heap_copy[0]["y"].as_string(), long_str);
+}
+
+
+TEST(jxc_cpp_value, TapeDocument)
+{
+    const std::string buf = R"JXC(
+    # comment
+    vec3{
+        name: 'tape\tdoc',
+        raw: r"(no \escapes)",
+        count: 42,
+        ratio: -1.5_pct,
+        data: b64"AQID",
+        empty: [],
+        items: [ true, null, std.list[1, 2_px, 3], { x: 1, y: 'two' } ],
+        expr: (1 + 2),
+        5: 'int key',
+    }
+    )JXC";
+
+    jxc::TapeDocument doc;
+    ASSERT_TRUE(doc.parse(buf)) << doc.get_error().to_string(buf);
+
+    jxc::TapeCursor root = doc.root();
+    ASSERT_TRUE(root.is_object());
+    EXPECT_EQ(root.get_annotation_source(), "vec3");
+    EXPECT_EQ(root.size(), 9);
+
+    EXPECT_EQ(root["name"].as_string(), "tape\tdoc");
+    EXPECT_EQ(root["raw"].as_string(), "no \\escapes");
+    EXPECT_EQ(root["count"].as_signed_integer(), 42);
+    EXPECT_EQ(root["ratio"].as_float(), -1.5);
+    EXPECT_EQ(root["ratio"].get_number_suffix(), "pct");
+    EXPECT_EQ(root["data"].as_bytes(), jxc::BytesView(std::vector<uint8_t>{ 1, 2, 3 }));
+    EXPECT_EQ(root["empty"].size(), 0);
+    EXPECT_FALSE(root["empty"].first_child().is_valid());
+    EXPECT_EQ(root["expr"].as_expression_source(), "(1 + 2)");
+    EXPECT_FALSE(root["missing"].is_valid());
+
+    jxc::TapeCursor items = root["items"];
+    ASSERT_TRUE(items.is_array());
+    EXPECT_EQ(items.size(), 4);
+    EXPECT_TRUE(items[0].as_bool());
+    EXPECT_TRUE(items[1].is_null());
+    EXPECT_EQ(items[2].get_annotation_source(), "std.list");
+    EXPECT_EQ(items[2][1].get_number_suffix(), "px");
+    EXPECT_EQ(items[3]["y"].as_string(), "two");
+    EXPECT_FALSE(items[4].is_valid());
+
+    // containers are skipped in one step when iterating
+    size_t num_items = 0;
+    for (jxc::TapeCursor item : items)
+    {
+        EXPECT_TRUE(item.is_valid());
+        ++num_items;
+    }
+    EXPECT_EQ(num_items, 4);
+
+    // keys and values alternate
+    std::vector<std::string> keys;
+    root.for_each_pair([&keys](jxc::TapeCursor key, jxc::TapeCursor)
+    {
+        keys.push_back(key.is_string() ? std::string(key.as_string()) : key.to_value().to_string());
+    });
+    EXPECT_EQ(keys, (std::vector<std::string>{ "name", "raw", "count", "ratio", "data", "empty", "items", "expr", "5" }));
+
+    // converting to a Value gives the same result as parsing directly
+    EXPECT_EQ(root.to_value(), jxc::parse(buf));
+    EXPECT_EQ(items[2].to_value(), jxc::parse("std.list[1, 2_px, 3]"));
+
+    // taking ownership of the buffer
+    jxc::TapeDocument owned_doc;
+    ASSERT_TRUE(owned_doc.parse(std::string(buf)));
+    EXPECT_EQ(owned_doc.get_num_entries(), doc.get_num_entries());
+    EXPECT_EQ(owned_doc.root().to_value(), jxc::parse(buf));
+
+    jxc::TapeDocument int_key_doc;
+    ASSERT_TRUE(int_key_doc.parse("{ -5: 1 }"));
+    EXPECT_EQ(int_key_doc.root().first_child().as_signed_integer(), -5);
+
+    // errors
+    jxc::TapeDocument bad_doc;
+    EXPECT_FALSE(bad_doc.parse("[1, 2"));
+    EXPECT_TRUE(bad_doc.has_error());
+    EXPECT_FALSE(bad_doc.root().is_valid());
+}
+
+
+TEST(jxc_cpp_value, ContainerStorage)
+{
+    using object_vt = jxc::Value::object_vt;
+
+    // small objects are searched linearly, and switch to a hash index once they grow past max_linear_scan_size
+    jxc::Value obj = jxc::default_object;
+    for (int64_t i = 0; i < 100; i++)
+    {
+        const std::string key = jxc::format("key_{}", i);
+        EXPECT_FALSE(obj.contains(key));
+        obj[key.c_str()] = i;
+        EXPECT_TRUE(obj.contains(key));
+        EXPECT_EQ(obj.as_object().has_index(), obj.as_object().capacity() > object_vt::max_linear_scan_size);
+    }
+    EXPECT_EQ(obj.size(), 100);
+    EXPECT_TRUE(obj.as_object().has_index());
+
+    // pairs stay in insertion order
+    int64_t expected_value = 0;
+    obj.for_each_pair([&](const jxc::Value& key, const jxc::Value& val)
+    {
+        EXPECT_EQ(key, jxc::format("key_{}", expected_value));
+        EXPECT_EQ(val.as_integer(), expected_value);
+        ++expected_value;
+    });
+
+    // removing a key moves the last pair into its place
+    EXPECT_TRUE(obj.remove_key("key_10"));
+    EXPECT_FALSE(obj.remove_key("key_10"));
+    EXPECT_EQ(obj.size(), 99);
+    EXPECT_FALSE(obj.contains("key_10"));
+    EXPECT_EQ(obj.as_object().begin()[10].first, "key_99");
+    for (int64_t i = 0; i < 100; i++)
+    {
+        EXPECT_EQ(obj.contains(jxc::format("key_{}", i)), i != 10) << i;
+    }
+    for (int64_t i = 0; i < 100; i += 3)
+    {
+        obj.remove_key(jxc::format("key_{}", i).c_str());
+    }
+    for (int64_t i = 0; i < 100; i++)
+    {
+        const std::string key = jxc::format("key_{}", i);
+        EXPECT_EQ(obj.contains(key), i != 10 && i % 3 != 0) << i;
+        if (obj.contains(key))
+        {
+            EXPECT_EQ(obj[key.c_str()].as_integer(), i);
+        }
+    }
+
+    // copies keep their index, and equality ignores order
+    jxc::Value obj_copy = obj;
+    EXPECT_EQ(obj_copy, obj);
+    EXPECT_EQ(jxc::parse("{ a: 1, b: 2 }"), jxc::parse("{ b: 2, a: 1 }"));
+    EXPECT_NE(jxc::parse("{ a: 1, b: 2 }"), jxc::parse("{ a: 1, b: 3 }"));
+    EXPECT_NE(jxc::parse("{ a: 1, b: 2 }"), jxc::parse("{ a: 1, c: 2 }"));
+
+    // non-string keys
+    jxc::Value mixed_keys = jxc::default_object;
+    mixed_keys[1] = "int";
+    mixed_keys[true] = "bool";
+    mixed_keys[jxc::default_null] = "null";
+    mixed_keys["1"] = "string";
+    EXPECT_EQ(mixed_keys.size(), 4);
+    EXPECT_EQ(mixed_keys[1], "int");
+    EXPECT_EQ(mixed_keys["1"], "string");
+
+    // numeric keys of different types are distinct keys, with or without a hash index
+    for (const size_t num_filler_keys : { 0, 20 })
+    {
+        jxc::Value num_keys = jxc::default_object;
+        for (size_t i = 0; i < num_filler_keys; i++)
+        {
+            num_keys.insert_or_assign(jxc::format("filler_{}", i).c_str(), i);
+        }
+        num_keys.insert_or_assign(1, "int");
+        num_keys.insert_or_assign(1u, "unsigned");
+        num_keys.insert_or_assign(1.0, "float");
+        num_keys.insert_or_assign(1.0, "float2");
+        EXPECT_EQ(num_keys.as_object().has_index(), num_filler_keys > object_vt::max_linear_scan_size);
+        EXPECT_EQ(num_keys.size(), num_filler_keys + 3);
+        EXPECT_EQ(num_keys[1], "int");
+        EXPECT_EQ(num_keys[1u], "unsigned");
+        EXPECT_EQ(num_keys.as_object().find(jxc::Value(1.0))->second, "float2");
+        EXPECT_TRUE(num_keys.remove_key(1u));
+        EXPECT_FALSE(num_keys.contains(1u));
+        EXPECT_EQ(num_keys[1], "int");
+        EXPECT_EQ(num_keys.as_object().find(jxc::Value(1.0))->second, "float2");
+    }
+
+    // values that refer to the container they're being added to, when adding them reallocates the container
+    jxc::Value small_obj = jxc::default_object;
+    for (int64_t i = 0; i < 4; i++)
+    {
+        small_obj[jxc::format("k{}", i).c_str()] = jxc::format("long string value that is not stored inline {}", i);
+    }
+    ASSERT_EQ(small_obj.size(), small_obj.as_object().capacity());
+    small_obj.insert_or_assign("copy", small_obj["k0"]);
+    EXPECT_EQ(small_obj["copy"], small_obj["k0"]);
+
+    jxc::Value arr = jxc::default_array;
+    arr.push_back("long string value that is not stored inline");
+    while (arr.size() < arr.as_array().capacity())
+    {
+        arr.push_back(arr.back());
+    }
+    arr.push_back(arr.front());
+    EXPECT_EQ(arr.back(), arr.front());
+
+    arr.resize(2);
+    EXPECT_EQ(arr.size(), 2);
+    arr.resize(4);
+    EXPECT_EQ(arr, jxc::Value({ arr[0], arr[1], jxc::Value(), jxc::Value() }));
+
+    // each container is a single allocation
+    size_t num_allocations = 0;
+    jxc::parse("{ a: [1, 2, 3], b: { c: null } }").get_heap_usage(true, &num_allocations);
+    EXPECT_EQ(num_allocations, 3);
+}
+
+
+TEST(jxc_cpp_value, PackedArrays)
+{
+    auto parse_packed = [](std::string_view buf)
+    {
+        jxc::Document doc(buf);
+        doc.set_pack_numeric_arrays(true);
+        return doc.parse_to_owned();
+    };
+
+    // packing is opt-in
+    EXPECT_FALSE(jxc::parse("[1.5, -2.0, 3.25]").is_packed_array());
+
+    // arrays of plain floats or plain integers are packed when parsed
+    jxc::Value floats = parse_packed("[1.5, -2.0, 3.25]");
+    ASSERT_TRUE(floats.is_packed_float_array());
+    EXPECT_EQ(floats.size(), 3);
+    EXPECT_EQ(floats.as_span<double>()[2], 3.25);
+
+    jxc::Value ints = parse_packed("[1, -2, 3]");
+    ASSERT_TRUE(ints.is_packed_signed_integer_array());
+    EXPECT_EQ(ints.as_span<int64_t>()[1], -2);
+
+    // mixed types, number suffixes, and annotations aren't packed
+    EXPECT_FALSE(parse_packed("[1, 2.5]").is_packed_array());
+    EXPECT_FALSE(parse_packed("[1, 2_px]").is_packed_array());
+    EXPECT_FALSE(parse_packed("[1, vec 2]").is_packed_array());
+    EXPECT_FALSE(parse_packed("[1, null]").is_packed_array());
+    EXPECT_FALSE(parse_packed("[]").is_packed_array());
+
+    // reading through const references doesn't expand the array
+    EXPECT_EQ(floats, jxc::Value({ 1.5, -2.0, 3.25 }));
+    EXPECT_EQ(ints, jxc::parse("[1, -2, 3]"));
+    EXPECT_EQ(ints.hash(), jxc::Value({ 1, -2, 3 }).hash());
+    EXPECT_EQ(floats.to_string(jxc::SerializerSettings::make_compact()), jxc::Value({ 1.5, -2.0, 3.25 }).to_string(jxc::SerializerSettings::make_compact()));
+    EXPECT_EQ(ints.to_repr(), jxc::Value({ 1, -2, 3 }).to_repr());
+    jxc::Value floats_copy = floats;
+    EXPECT_TRUE(floats_copy.is_packed_float_array());
+    EXPECT_TRUE(floats.is_packed_float_array());
+
+    // matching numbers are added without expanding
+    ints.push_back(4);
+    EXPECT_TRUE(ints.is_packed_signed_integer_array());
+    EXPECT_EQ(ints.size(), 4);
+
+    // anything else expands the array to Values
+    ints.push_back(4.5);
+    EXPECT_FALSE(ints.is_packed_array());
+    EXPECT_EQ(ints, jxc::parse("[1, -2, 3, 4, 4.5]"));
+
+    floats[0] = "string";
+    EXPECT_FALSE(floats.is_packed_array());
+    EXPECT_EQ(floats, jxc::Value({ "string", -2.0, 3.25 }));
+    EXPECT_NE(floats, floats_copy);
+
+    // get_item() and for_each_item() read packed arrays by value without expanding them, so they can be read from multiple threads
+    const jxc::Value const_floats = floats_copy;
+    EXPECT_EQ(const_floats.get_item(1), -2.0);
+    EXPECT_EQ(const_floats.get_item(2), floats_copy.as_span<double>()[2]);
+    EXPECT_TRUE(const_floats.is_packed_array());
+    {
+        const jxc::Value shared = parse_packed("[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]");
+        const std::span<const int64_t> items = shared.as_span<int64_t>();
+        std::vector<int64_t> sums(4, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < sums.size(); t++)
+        {
+            threads.emplace_back([&shared, &sums, t]()
+            {
+                for (size_t i = 0; i < shared.size(); i++)
+                {
+                    sums[t] += shared.get_item(i).as_integer();
+                }
+                shared.for_each_item([&sums, t](const jxc::Value& item) { sums[t] += item.as_integer(); });
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(sums, std::vector<int64_t>(4, 90));
+        EXPECT_TRUE(shared.is_packed_array());
+        EXPECT_EQ(items.data(), shared.as_span<int64_t>().data());
+    }
+    jxc::Value expanded = const_floats;
+    expanded.expand_packed_array();
+    EXPECT_EQ(std::as_const(expanded).at(1), -2.0);
+    EXPECT_EQ(expanded, floats_copy);
+
+    // reading items by const reference leaves the array packed, and reads a Value copy of the items made on first access
+    for (const auto& read_item : std::vector<std::function<double(const jxc::Value&)>>{
+        [](const jxc::Value& v) { return v[1].as_float(); },
+        [](const jxc::Value& v) { return v[-2].as_float(); },
+        [](const jxc::Value& v) { return v.at(1).as_float(); },
+        [](const jxc::Value& v) { return v.as_array()[1].as_float(); },
+        [](const jxc::Value& v) { return v.front().as_float() - 3.5; },
+        [](const jxc::Value& v) { return v.back().as_float() - 5.25; },
+    })
+    {
+        const jxc::Value packed = parse_packed("[1.5, -2.0, 3.25]");
+        ASSERT_TRUE(packed.is_packed_float_array());
+        EXPECT_EQ(read_item(packed), -2.0);
+        EXPECT_TRUE(packed.is_packed_float_array());
+        EXPECT_EQ(&packed.as_array()[1], &packed.at(1));
+        EXPECT_EQ(packed, floats_copy);
+    }
+    {
+        const jxc::Value shared = parse_packed("[0, 1, 2, 3, 4, 5, 6, 7, 8, 9]");
+        std::vector<int64_t> sums(4, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < sums.size(); t++)
+        {
+            threads.emplace_back([&shared, &sums, t]()
+            {
+                for (const jxc::Value& item : shared.as_array())
+                {
+                    sums[t] += item.as_integer() + shared[item.as_integer()].as_integer();
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        EXPECT_EQ(sums, std::vector<int64_t>(4, 90));
+        EXPECT_TRUE(shared.is_packed_array());
+    }
+
+    // changing the array replaces the copy, and expanding it takes over the copy
+    jxc::Value packed_ints = parse_packed("[1, 2]");
+    EXPECT_EQ(std::as_const(packed_ints).back(), 2);
+    packed_ints.push_back(3);
+    EXPECT_TRUE(packed_ints.is_packed_array());
+    EXPECT_EQ(std::as_const(packed_ints).back(), 3);
+    const jxc::Value* const_item = &std::as_const(packed_ints).at(0);
+    EXPECT_EQ(&packed_ints.at(0), const_item);
+    EXPECT_FALSE(packed_ints.is_packed_array());
+
+    // arrays can be re-packed
+    jxc::Value to_pack = jxc::Value({ 5, 6, 7 });
+    EXPECT_FALSE(to_pack.is_packed_array());
+    EXPECT_TRUE(to_pack.convert_to_packed_array());
+    EXPECT_EQ(to_pack.as_span<int64_t>().size(), 3);
+    EXPECT_FALSE(jxc::Value({ 5, "x" }).convert_to_packed_array());
+
+    // packed items take 8 bytes each instead of a Value each
+    size_t num_allocations = 0;
+    const size_t packed_bytes = parse_packed("[1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0]").get_heap_usage(true, &num_allocations);
+    EXPECT_EQ(num_allocations, 1);
+    EXPECT_LT(packed_bytes, 8 * sizeof(jxc::Value));
+
+    // vectors of numbers parse and serialize without a converter call per item
+    const std::vector<double> vec = jxc::conv::parse<std::vector<double>>("[1.5, -2, 3e2]");
+    EXPECT_EQ(vec, std::vector<double>({ 1.5, -2.0, 300.0 }));
+    EXPECT_EQ(jxc::conv::parse<std::vector<double>>(jxc::conv::serialize(vec)), vec);
+    EXPECT_THROW(jxc::conv::parse<std::vector<double>>("[1.5, true]"), jxc::parse_error);
+}
+
+
+TEST(jxc_cpp_value, LazyScalars)
+{
+    const std::string_view buf = R"({ a: 1.5, b: -42_px, c: 'abc\ndef', d: ['long string without escapes', 7, null] })";
+
+    jxc::Document doc(buf);
+    doc.set_lazy_scalars(true);
+    jxc::Value val = doc.parse();
+    ASSERT_FALSE(doc.has_error()) << doc.get_error().to_string();
+
+    // scalars aren't parsed until they're read
+    EXPECT_TRUE(val["a"].is_lazy());
+    EXPECT_TRUE(val["b"].is_lazy());
+    EXPECT_TRUE(val["c"].is_lazy());
+    EXPECT_TRUE(val["d"][1].is_lazy());
+    EXPECT_FALSE(val["d"][2].is_lazy());
+    EXPECT_FALSE(val["d"].is_packed_array());
+    EXPECT_FALSE(val.is_owned(true));
+
+    // types are known without parsing
+    EXPECT_TRUE(val["a"].is_float());
+    EXPECT_TRUE(val["b"].is_integer());
+    EXPECT_TRUE(val["c"].is_string());
+
+    // reading a value parses and caches it
+    EXPECT_EQ(val["a"].as_float(), 1.5);
+    EXPECT_FALSE(val["a"].is_lazy());
+    EXPECT_EQ(val["b"].get_number_suffix(), "px");
+    EXPECT_EQ(val["b"].as_integer<int>(), -42);
+    EXPECT_EQ(val["c"].as_string(), "abc\ndef");
+
+    // copies stay lazy, and compare, hash, and serialize the same as eager values
+    const jxc::Value eager = jxc::parse(buf);
+    EXPECT_EQ(val, eager);
+    EXPECT_EQ(val["d"].hash(), eager["d"].hash());
+    EXPECT_EQ(val.to_string(), eager.to_string());
+    EXPECT_EQ(val.to_repr(), eager.to_repr());
+
+    jxc::Document doc2(buf);
+    doc2.set_lazy_scalars(true);
+    jxc::Value val2 = doc2.parse();
+    const jxc::Value str_copy = val2["d"][0];
+    EXPECT_TRUE(str_copy.is_lazy());
+    EXPECT_EQ(str_copy, "long string without escapes");
+    EXPECT_TRUE(val2["d"][0].is_lazy());
+
+    jxc::ErrorInfo err;
+    EXPECT_TRUE(val2.materialize(err, true));
+    EXPECT_FALSE(val2["d"][0].is_lazy());
+    EXPECT_FALSE(val2["d"][1].is_lazy());
+    EXPECT_EQ(val2, eager);
+    val2.convert_to_owned(true);
+    EXPECT_TRUE(val2.is_owned(true));
+
+    // integers that might not fit in an int64 are parsed eagerly, so range errors are reported by parse() as usual
+    for (const std::string_view big_buf : { "[18446744073709551615]", "[0x1FFFFFFFFFFFFFFFF]" })
+    {
+        jxc::ErrorInfo eager_err;
+        jxc::parse(big_buf, eager_err);
+        ASSERT_TRUE(eager_err.is_err) << big_buf;
+
+        jxc::Document big_doc(big_buf);
+        big_doc.set_lazy_scalars(true);
+        big_doc.parse();
+        ASSERT_TRUE(big_doc.has_error()) << big_buf;
+        EXPECT_EQ(big_doc.get_error().message, eager_err.message);
+        EXPECT_EQ(big_doc.get_error().buffer_start_idx, eager_err.buffer_start_idx);
+    }
+
+    // strings with invalid escapes fail the parse with the same error and offsets as an eager parse
+    const std::string_view bad_buf = "[1, 'ab\\qc']";
+    jxc::ErrorInfo eager_err;
+    jxc::parse(bad_buf, eager_err);
+    ASSERT_TRUE(eager_err.is_err);
+    EXPECT_EQ(eager_err.buffer_start_idx, 4u);
+
+    jxc::Document bad_doc(bad_buf);
+    bad_doc.set_lazy_scalars(true);
+    bad_doc.parse();
+    ASSERT_TRUE(bad_doc.has_error());
+    EXPECT_EQ(bad_doc.get_error().message, eager_err.message);
+    EXPECT_EQ(bad_doc.get_error().buffer_start_idx, eager_err.buffer_start_idx);
+    EXPECT_EQ(bad_doc.get_error().buffer_end_idx, eager_err.buffer_end_idx);
+
+    // const values are parsed when they're read, too
+    jxc::Document const_doc(buf);
+    const_doc.set_lazy_scalars(true);
+    const jxc::Value const_val = const_doc.parse();
+    EXPECT_TRUE(const_val["a"].is_lazy());
+    EXPECT_EQ(const_val["a"].as_float(), 1.5);
+    EXPECT_FALSE(const_val["a"].is_lazy());
+
+    // lazy values built by hand that fail to parse report the error from materialize(), and become invalid when read
+    jxc::Value bad_val(jxc::ValueType::String, "'xy\\qz'", 10, jxc::Value::AsLazy{});
+    jxc::ErrorInfo lazy_err;
+    EXPECT_FALSE(bad_val.materialize(lazy_err));
+    EXPECT_EQ(lazy_err.buffer_start_idx, 10u);
+    EXPECT_TRUE(bad_val.is_invalid());
+
+    const jxc::Value bad_read(jxc::ValueType::String, "'xy\\qz'", 10, jxc::Value::AsLazy{});
+    EXPECT_EQ(bad_read.as_string(), "");
+    EXPECT_TRUE(bad_read.is_invalid());
+}
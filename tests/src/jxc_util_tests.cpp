@@ -748,6 +748,130 @@ enum class BitmaskTest : uint8_t
 
 JXC_BITMASK_ENUM(BitmaskTest);
 
+template<typename T>
+testing::AssertionResult test_parse_integer(const char* value_str, const char* expected_str, std::string_view value, T expected)
+{
+    T result = 0;
+    std::string err;
+    if (!jxc::util::parse_number_simple<T>(value, result, &err))
+    {
+        return testing::AssertionFailure() << jxc::format("Failed parsing {} ({}) as {}: {}", value_str, value, jxc::detail::get_type_name<T>(), err);
+    }
+    else if (result != expected)
+    {
+        return testing::AssertionFailure() << jxc::format("Parsed {} ({}) as {}, expected {} ({})", value_str, value, result, expected_str, expected);
+    }
+    return testing::AssertionSuccess();
+}
+
+template<typename T>
+testing::AssertionResult test_parse_integer_overflow(const char* value_str, std::string_view value)
+{
+    T result = 0;
+    std::string err;
+    if (jxc::util::parse_number_simple<T>(value, result, &err))
+    {
+        return testing::AssertionFailure() << jxc::format("Expected parsing {} ({}) as {} to fail, got {}", value_str, value, jxc::detail::get_type_name<T>(), result);
+    }
+    else if (err.find("too large") == std::string::npos)
+    {
+        return testing::AssertionFailure() << jxc::format("Expected an overflow error parsing {} ({}), got {}", value_str, value, err);
+    }
+    return testing::AssertionSuccess();
+}
+
+#define EXPECT_PARSE_INTEGER(TYPE, VALUE, EXPECTED) EXPECT_PRED_FORMAT2(test_parse_integer<TYPE>, VALUE, static_cast<TYPE>(EXPECTED))
+#define EXPECT_PARSE_INTEGER_OVERFLOW(TYPE, VALUE) EXPECT_PRED_FORMAT1(test_parse_integer_overflow<TYPE>, VALUE)
+
+
+TEST(jxc_util, IntegerParsing)
+{
+    // limits for each type, in every base
+    EXPECT_PARSE_INTEGER(uint8_t, "255", 255);
+    EXPECT_PARSE_INTEGER(uint8_t, "0xff", 255);
+    EXPECT_PARSE_INTEGER(uint8_t, "0o377", 255);
+    EXPECT_PARSE_INTEGER(uint8_t, "0b11111111", 255);
+    EXPECT_PARSE_INTEGER(uint8_t, "-0", 0);
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint8_t, "256");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint8_t, "0x100");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint8_t, "0o400");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint8_t, "0b100000000");
+
+    EXPECT_PARSE_INTEGER(int8_t, "127", 127);
+    EXPECT_PARSE_INTEGER(int8_t, "-128", -128);
+    EXPECT_PARSE_INTEGER(int8_t, "-0x80", -128);
+    EXPECT_PARSE_INTEGER(int8_t, "0b1111111", 127);
+    EXPECT_PARSE_INTEGER_OVERFLOW(int8_t, "128");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int8_t, "-129");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int8_t, "0xff");
+
+    EXPECT_PARSE_INTEGER(uint16_t, "65535", 65535);
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint16_t, "65536");
+    EXPECT_PARSE_INTEGER(int16_t, "-32768", -32768);
+    EXPECT_PARSE_INTEGER_OVERFLOW(int16_t, "32768");
+
+    EXPECT_PARSE_INTEGER(uint32_t, "4294967295", UINT32_MAX);
+    EXPECT_PARSE_INTEGER(uint32_t, "0xFFFFFFFF", UINT32_MAX);
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint32_t, "4294967296");
+    EXPECT_PARSE_INTEGER(int32_t, "-2147483648", INT32_MIN);
+    EXPECT_PARSE_INTEGER(int32_t, "2147483647", INT32_MAX);
+    EXPECT_PARSE_INTEGER_OVERFLOW(int32_t, "2147483648");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int32_t, "-2147483649");
+
+    EXPECT_PARSE_INTEGER(uint64_t, "18446744073709551615", UINT64_MAX);
+    EXPECT_PARSE_INTEGER(uint64_t, "00000018446744073709551615", UINT64_MAX);
+    EXPECT_PARSE_INTEGER(uint64_t, "0xFFFFFFFFFFFFFFFF", UINT64_MAX);
+    EXPECT_PARSE_INTEGER(uint64_t, "0x0000FFFFFFFFFFFFFFFF", UINT64_MAX);
+    EXPECT_PARSE_INTEGER(uint64_t, "0o1777777777777777777777", UINT64_MAX);
+    EXPECT_PARSE_INTEGER(uint64_t, "0b" + std::string(64, '1'), UINT64_MAX);
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "18446744073709551616");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "99999999999999999999");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "100000000000000000000");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "0x10000000000000000");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "0o2000000000000000000000");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "0b1" + std::string(64, '0'));
+
+    EXPECT_PARSE_INTEGER(int64_t, "9223372036854775807", INT64_MAX);
+    EXPECT_PARSE_INTEGER(int64_t, "-9223372036854775808", INT64_MIN);
+    EXPECT_PARSE_INTEGER(int64_t, "-0x8000000000000000", INT64_MIN);
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "9223372036854775808");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "-9223372036854775809");
+
+    // exponents are multiplied in with overflow checks
+    EXPECT_PARSE_INTEGER(int64_t, "1e18", 1000000000000000000);
+    EXPECT_PARSE_INTEGER(int64_t, "-9e18", -9000000000000000000);
+    EXPECT_PARSE_INTEGER(uint64_t, "1e19", 10000000000000000000u);
+    EXPECT_PARSE_INTEGER(int8_t, "12e1", 120);
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "1e19");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "-1e19");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "10e18");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "1e400");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint64_t, "2e19");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int8_t, "13e1");
+    EXPECT_PARSE_INTEGER_OVERFLOW(int8_t, "-13e1");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint16_t, "7e4");
+
+    // exponents that can never fit are rejected without looping over them
+    EXPECT_PARSE_INTEGER_OVERFLOW(int64_t, "1e2000000000");
+    EXPECT_PARSE_INTEGER_OVERFLOW(uint8_t, "1e3");
+
+    // every length, with the 8 and 4 digit chunks in different positions
+    uint64_t value = 0;
+    for (int num_digits = 1; num_digits <= 20; num_digits++)
+    {
+        value = value * 10 + static_cast<uint64_t>((num_digits * 7) % 10);
+        EXPECT_PARSE_INTEGER(uint64_t, std::to_string(value), value);
+        EXPECT_PARSE_INTEGER(uint64_t, jxc::format("0x{:x}", value), value);
+        EXPECT_PARSE_INTEGER(uint64_t, jxc::format("0o{:o}", value), value);
+        EXPECT_PARSE_INTEGER(uint64_t, jxc::format("0b{:b}", value), value);
+        if (value <= static_cast<uint64_t>(INT64_MAX))
+        {
+            EXPECT_PARSE_INTEGER(int64_t, "-" + std::to_string(value), -static_cast<int64_t>(value));
+        }
+    }
+}
+
+
 TEST(jxc_util, BitmaskEnums)
 {
     BitmaskTest val = BitmaskTest::A | BitmaskTest::B | BitmaskTest::C;
@@ -16,6 +16,7 @@ SORTED_HEADER_NAMES = [
 
     # jxc library
     'jxc_core.h',
+    'jxc_simd.h',
     'jxc_memory.h',
     'jxc_bytes.h',
     'jxc_string.h',
@@ -32,9 +33,13 @@ SORTED_HEADER_NAMES = [
     'jxc_map.h',
     'jxc_value.h',
     'jxc_document.h',
+    'jxc_query.h',
     'jxc_converter.h',
     'jxc_converter_std.h',
     'jxc_converter_value.h',
+    'jxc_batch.h',
+    'jxc_record_index.h',
+    'jxc_tape.h',
     'jxc_converter_enum.h',
     'jxc_converter_struct.h',
     'jxc_cpp.h', # meta-header for jxc-cpp
@@ -44,6 +49,7 @@ SORTED_HEADER_NAMES = [
 SORTED_CPP_NAMES = [
     # JXC library
     'jxc_core.cpp',
+    'jxc_simd.cpp',
     'jxc_util.cpp',
     'jxc_string.cpp',
     'jxc_lexer.cpp',
@@ -53,8 +59,12 @@ SORTED_CPP_NAMES = [
 
     # JXC-CPP library
     'jxc_document.cpp',
+    'jxc_query.cpp',
     'jxc_value.cpp',
     'jxc_converter.cpp',
+    'jxc_batch.cpp',
+    'jxc_record_index.cpp',
+    'jxc_tape.cpp',
 ]
 
 